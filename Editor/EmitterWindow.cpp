@@ -268,6 +268,24 @@ void EmitterWindow::Create(EditorComponent* _editor)
 	takeColorCheckBox.SetTooltip("If it emits from a mesh, then particle color will be taken from mesh material surface.");
 	AddWidget(&takeColorCheckBox);
 
+	cpuSimulationCheckBox.Create("CPU Simulation: ");
+	cpuSimulationCheckBox.SetPos(XMFLOAT2(x, y += step));
+	cpuSimulationCheckBox.SetSize(XMFLOAT2(itemheight, itemheight));
+	cpuSimulationCheckBox.OnClick([&](wi::gui::EventArgs args) {
+		wi::scene::Scene& scene = editor->GetCurrentScene();
+		for (auto& x : editor->translator.selected)
+		{
+			wi::EmittedParticleSystem* emitter = scene.emitters.GetComponent(x.entity);
+			if (emitter == nullptr)
+				continue;
+			emitter->SetCPUSimulationEnabled(args.bValue);
+			emitter->Restart();
+		}
+	});
+	cpuSimulationCheckBox.SetCheck(false);
+	cpuSimulationCheckBox.SetTooltip("Simulate the particles on the CPU instead of the GPU. This is deterministic and it supports gravity, drag and force fields, but not mesh emission, SPH and collisions.");
+	AddWidget(&cpuSimulationCheckBox);
+
 
 
 	infoLabel.Create("EmitterInfo");
@@ -865,6 +883,7 @@ void EmitterWindow::SetEntity(Entity entity)
 		frameBlendingCheckBox.SetCheck(emitter->IsFrameBlendingEnabled());
 		collidersDisabledCheckBox.SetCheck(emitter->IsCollidersDisabled());
 		takeColorCheckBox.SetCheck(emitter->IsTakeColorFromMesh());
+		cpuSimulationCheckBox.SetCheck(emitter->IsCPUSimulationEnabled());
 		maxParticlesSlider.SetValue((float)emitter->GetMaxParticleCount());
 
 		frameRateInput.SetValue(emitter->frameRate);
@@ -1038,6 +1057,7 @@ void EmitterWindow::ResizeLayout()
 	add_right(frameBlendingCheckBox);
 	add_right(collidersDisabledCheckBox);
 	add_right(takeColorCheckBox);
+	add_right(cpuSimulationCheckBox);
 	add(maxParticlesSlider);
 	add(emitCountSlider);
 	add(emitSizeSlider);
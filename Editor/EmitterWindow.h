@@ -32,6 +32,7 @@ public:
 	wi::gui::CheckBox frameBlendingCheckBox;
 	wi::gui::CheckBox collidersDisabledCheckBox;
 	wi::gui::CheckBox takeColorCheckBox;
+	wi::gui::CheckBox cpuSimulationCheckBox;
 	wi::gui::Slider emitCountSlider;
 	wi::gui::Slider emitSizeSlider;
 	wi::gui::Slider emitRotationSlider;
@@ -115,6 +115,21 @@ void GraphicsWindow::Create(EditorComponent* _editor)
 	}
 	AddWidget(&occlusionCullingCheckBox);
 
+	cpuOcclusionCullingCheckBox.Create("CPU Occlusion Culling: ");
+	cpuOcclusionCullingCheckBox.SetTooltip("Toggle CPU occlusion culling. Meshes that are marked as occluders are rasterized on the CPU, and objects hidden behind them are culled without latency.");
+	cpuOcclusionCullingCheckBox.SetPos(XMFLOAT2(x, y += step));
+	cpuOcclusionCullingCheckBox.SetSize(XMFLOAT2(itemheight, itemheight));
+	cpuOcclusionCullingCheckBox.OnClick([=](wi::gui::EventArgs args) {
+		wi::renderer::SetCPUOcclusionCullingEnabled(args.bValue);
+		editor->main->config.GetSection("graphics").Set("cpu_occlusion_culling", args.bValue);
+		editor->main->config.Commit();
+	});
+	if (editor->main->config.GetSection("graphics").Has("cpu_occlusion_culling"))
+	{
+		wi::renderer::SetCPUOcclusionCullingEnabled(editor->main->config.GetSection("graphics").GetBool("cpu_occlusion_culling"));
+	}
+	AddWidget(&cpuOcclusionCullingCheckBox);
+
 	visibilityComputeShadingCheckBox.Create("Visibility Compute Shading: ");
 	visibilityComputeShadingCheckBox.SetTooltip("Visibility Compute Shading (experimental)\nThis will shade the scene in compute shaders instead of pixel shaders\nThis has a higher initial performance cost, but it will be faster in high polygon scenes.\nIt is not compatible with MSAA and tessellation.");
 	visibilityComputeShadingCheckBox.SetPos(XMFLOAT2(x, y += step));
@@ -1605,6 +1620,7 @@ void GraphicsWindow::Update()
 
 	hdrcalibrationSlider.SetValue(editor->renderPath->getHDRCalibration());
 	occlusionCullingCheckBox.SetCheck(wi::renderer::GetOcclusionCullingEnabled());
+	cpuOcclusionCullingCheckBox.SetCheck(wi::renderer::GetCPUOcclusionCullingEnabled());
 	GIBoostSlider.SetValue(wi::renderer::GetGIBoost());
 	visibilityComputeShadingCheckBox.SetCheck(editor->renderPath->getVisibilityComputeShadingEnabled());
 	meshShaderCheckBox.SetCheck(wi::renderer::IsMeshShaderAllowed());
@@ -1775,6 +1791,7 @@ void GraphicsWindow::ResizeLayout()
 		debugLightCullingCheckBox.SetVisible(false);
 		advancedLightCullingCheckBox.SetVisible(false);
 		occlusionCullingCheckBox.SetVisible(false);
+		cpuOcclusionCullingCheckBox.SetVisible(false);
 		visibilityComputeShadingCheckBox.SetVisible(false);
 		meshShaderCheckBox.SetVisible(false);
 		meshletOcclusionCullingCheckBox.SetVisible(false);
@@ -1794,6 +1811,7 @@ void GraphicsWindow::ResizeLayout()
 		debugLightCullingCheckBox.SetVisible(true);
 		advancedLightCullingCheckBox.SetVisible(true);
 		occlusionCullingCheckBox.SetVisible(true);
+		cpuOcclusionCullingCheckBox.SetVisible(true);
 		visibilityComputeShadingCheckBox.SetVisible(true);
 		meshShaderCheckBox.SetVisible(true);
 		meshletOcclusionCullingCheckBox.SetVisible(true);
@@ -1811,6 +1829,7 @@ void GraphicsWindow::ResizeLayout()
 		add_right(debugLightCullingCheckBox);
 		advancedLightCullingCheckBox.SetPos(XMFLOAT2(debugLightCullingCheckBox.GetPos().x - advancedLightCullingCheckBox.GetSize().x - 70, debugLightCullingCheckBox.GetPos().y));
 		add_right(occlusionCullingCheckBox);
+		add_right(cpuOcclusionCullingCheckBox);
 		add_right(visibilityComputeShadingCheckBox);
 		add_right(meshShaderCheckBox);
 		add_right(meshletOcclusionCullingCheckBox);
@@ -15,6 +15,7 @@ public:
 	wi::gui::Slider pathTraceTargetSlider;
 	wi::gui::Label pathTraceStatisticsLabel;
 	wi::gui::CheckBox occlusionCullingCheckBox;
+	wi::gui::CheckBox cpuOcclusionCullingCheckBox;
 	wi::gui::CheckBox visibilityComputeShadingCheckBox;
 	wi::gui::CheckBox meshShaderCheckBox;
 	wi::gui::CheckBox meshletOcclusionCullingCheckBox;
@@ -182,6 +182,22 @@ void MeshWindow::Create(EditorComponent* _editor)
 	});
 	AddWidget(&doubleSidedShadowCheckBox);
 
+	occluderCheckBox.Create("Occluder: ");
+	occluderCheckBox.SetTooltip("If enabled, the lowest detail LOD of this mesh will be used as occluder for CPU occlusion culling.\nThe mesh should be solid, and the occluder LOD should not extend outside of the visible surface.");
+	occluderCheckBox.SetSize(XMFLOAT2(hei, hei));
+	occluderCheckBox.SetPos(XMFLOAT2(x, y += step));
+	occluderCheckBox.OnClick([&](wi::gui::EventArgs args) {
+		wi::scene::Scene& scene = editor->GetCurrentScene();
+		for (auto& x : editor->translator.selected)
+		{
+			MeshComponent* mesh = get_mesh(scene, x);
+			if (mesh == nullptr)
+				continue;
+			mesh->SetOccluder(args.bValue);
+		}
+	});
+	AddWidget(&occluderCheckBox);
+
 	bvhCheckBox.Create("Enable BVH: ");
 	bvhCheckBox.SetTooltip("Whether to generate BVH (Bounding Volume Hierarchy) for the mesh or not.\nBVH will be used to optimize intersections with the mesh at an additional memory cost.\nIt is recommended to use a BVH for high polygon count meshes that will be used for intersections.\nThis CPU BVH does not support skinned or morphed geometry.");
 	bvhCheckBox.SetSize(XMFLOAT2(hei, hei));
@@ -1142,6 +1158,7 @@ void MeshWindow::SetEntity(Entity entity, int subset)
 
 		doubleSidedCheckBox.SetCheck(mesh->IsDoubleSided());
 		doubleSidedShadowCheckBox.SetCheck(mesh->IsDoubleSidedShadow());
+		occluderCheckBox.SetCheck(mesh->IsOccluder());
 		bvhCheckBox.SetCheck(mesh->bvh.IsValid());
 		quantizeCheckBox.SetCheck(mesh->IsQuantizedPositionsDisabled());
 
@@ -1234,6 +1251,7 @@ void MeshWindow::ResizeLayout()
 	add(subsetLastButton);
 	add_right(doubleSidedCheckBox);
 	add_right(doubleSidedShadowCheckBox);
+	add_right(occluderCheckBox);
 	add_right(bvhCheckBox);
 	add_right(quantizeCheckBox);
 	add_fullwidth(impostorCreateButton);
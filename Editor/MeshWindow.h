@@ -18,6 +18,7 @@ public:
 	wi::gui::ComboBox subsetMaterialComboBox;
 	wi::gui::CheckBox doubleSidedCheckBox;
 	wi::gui::CheckBox doubleSidedShadowCheckBox;
+	wi::gui::CheckBox occluderCheckBox;
 	wi::gui::CheckBox bvhCheckBox;
 	wi::gui::CheckBox quantizeCheckBox;
 	wi::gui::Button impostorCreateButton;
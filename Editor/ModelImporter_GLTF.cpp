@@ -135,6 +135,80 @@ struct LoaderState
 	wi::unordered_map<size_t, TransformComponent> transforms_original; // original transform states
 };
 
+// Accessor conversion helpers, these process a whole accessor at once:
+//	Tightly packed data is copied in bulk, normalized integer data is converted with DirectXMath
+template<typename T>
+void CopyAccessorData(T* dst, const uint8_t* src, size_t stride, size_t count)
+{
+	if (stride == sizeof(T))
+	{
+		std::memcpy(dst, src, count * sizeof(T));
+		return;
+	}
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::memcpy(dst + i, src + i * stride, sizeof(T));
+	}
+}
+template<typename T>
+void ConvertIndices(uint32_t* dst, const uint8_t* src, size_t count, uint32_t vertexOffset)
+{
+	// The winding order is flipped, so the second and third index of each triangle are swapped:
+	const T* indices = (const T*)src;
+	for (size_t i = 0; i < count; i += 3)
+	{
+		dst[i + 0] = vertexOffset + uint32_t(indices[i + 0]);
+		dst[i + 1] = vertexOffset + uint32_t(indices[i + 2]);
+		dst[i + 2] = vertexOffset + uint32_t(indices[i + 1]);
+	}
+}
+void ConvertAccessorFloat2(XMFLOAT2* dst, const uint8_t* src, int componentType, size_t stride, size_t count)
+{
+	switch (componentType)
+	{
+	case TINYGLTF_COMPONENT_TYPE_FLOAT:
+		CopyAccessorData(dst, src, stride, count);
+		break;
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+		for (size_t i = 0; i < count; ++i)
+		{
+			XMStoreFloat2(dst + i, XMLoadUByteN2((const XMUBYTEN2*)(src + i * stride)));
+		}
+		break;
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		for (size_t i = 0; i < count; ++i)
+		{
+			XMStoreFloat2(dst + i, XMLoadUShortN2((const XMUSHORTN2*)(src + i * stride)));
+		}
+		break;
+	default:
+		break;
+	}
+}
+void ConvertAccessorFloat4(XMFLOAT4* dst, const uint8_t* src, int componentType, size_t stride, size_t count)
+{
+	switch (componentType)
+	{
+	case TINYGLTF_COMPONENT_TYPE_FLOAT:
+		CopyAccessorData(dst, src, stride, count);
+		break;
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+		for (size_t i = 0; i < count; ++i)
+		{
+			XMStoreFloat4(dst + i, XMLoadUByteN4((const XMUBYTEN4*)(src + i * stride)));
+		}
+		break;
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		for (size_t i = 0; i < count; ++i)
+		{
+			XMStoreFloat4(dst + i, XMLoadUShortN4((const XMUSHORTN4*)(src + i * stride)));
+		}
+		break;
+	default:
+		break;
+	}
+}
+
 void Import_Extension_VRM(LoaderState& state);
 void Import_Extension_VRMC(LoaderState& state);
 void VRM_ToonMaterialCustomize(const std::string& name, MaterialComponent& material);
@@ -279,9 +353,9 @@ void FlipZAxis(LoaderState& state)
 	Scene& wiscene = *state.scene;
 
 	// Flip mesh data first
-	for(size_t i = 0; i < wiscene.meshes.GetCount(); ++i)
-	{
-		auto& mesh = wiscene.meshes[i];
+	wi::jobsystem::context ctx;
+	wi::jobsystem::Dispatch(ctx, (uint32_t)wiscene.meshes.GetCount(), 1, [&](wi::jobsystem::JobArgs args) {
+		auto& mesh = wiscene.meshes[args.jobIndex];
 		for(auto& v_pos : mesh.vertex_positions)
 		{
 			v_pos.z *= -1.f;
@@ -306,7 +380,8 @@ void FlipZAxis(LoaderState& state)
 			}
 		}
 		mesh.FlipCulling(); // calls CreateRenderData
-	}
+	});
+	wi::jobsystem::Wait(ctx);
 
 	// Flip scene's transformComponents
 	bool state_restore = (state.transforms_original.size() > 0);
@@ -459,6 +534,18 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 	LoaderState state;
 	state.scene = &scene;
 
+	// Timing of import phases, reported to the backlog when finished:
+	wi::Timer timer;
+	wi::Timer phase_timer;
+	std::string timing_report;
+	auto finish_phase = [&](const char* phase) {
+		char text[128] = {};
+		snprintf(text, arraysize(text), "\n\t%s: %.2f ms", phase, phase_timer.elapsed_milliseconds());
+		timing_report += text;
+		phase_timer.record();
+	};
+	wi::jobsystem::context ctx;
+
 	wi::vector<uint8_t> filedata;
 	bool ret = wi::helper::FileRead(fileName, filedata);
 
@@ -498,6 +585,7 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 	{
 		wi::helper::messageBox(err, "GLTF error!");
 	}
+	finish_phase("File parsing");
 
 	state.rootEntity = CreateEntity();
 	scene.transforms.Create(state.rootEntity);
@@ -505,10 +593,13 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 	state.name = name;
 
 	// Create materials:
+	wi::vector<Entity> materialEntities;
+	materialEntities.reserve(state.gltfModel.materials.size());
 	for (auto& x : state.gltfModel.materials)
 	{
 		Entity materialEntity = scene.Entity_CreateMaterial(x.name);
 		scene.Component_Attach(materialEntity, state.rootEntity);
+		materialEntities.push_back(materialEntity);
 
 		MaterialComponent& material = *scene.materials.GetComponent(materialEntity);
 
@@ -1004,26 +1095,69 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 			}
 		}
 
-		material.CreateRenderData();
 	}
+	finish_phase("Materials");
+
+	// Decode images in parallel: each unique image is loaded by one job with the import flags of the first material that uses it
+	//	Then the materials' CreateRenderData() will find them already loaded
+	{
+		struct ImageLoad
+		{
+			std::string name;
+			wi::resourcemanager::Flags flags;
+		};
+		wi::vector<ImageLoad> images;
+		wi::unordered_set<std::string> image_names;
+		for (Entity materialEntity : materialEntities)
+		{
+			MaterialComponent& material = *scene.materials.GetComponent(materialEntity);
+			for (uint32_t slot = 0; slot < MaterialComponent::TEXTURESLOT_COUNT; ++slot)
+			{
+				const std::string& image_name = material.textures[slot].name;
+				if (!image_name.empty() && image_names.insert(image_name).second)
+				{
+					images.push_back({ image_name, material.GetTextureSlotResourceFlags(MaterialComponent::TEXTURESLOT(slot)) });
+				}
+			}
+		}
+		wi::vector<wi::Resource> image_resources(images.size());
+		wi::jobsystem::Dispatch(ctx, (uint32_t)images.size(), 1, [&](wi::jobsystem::JobArgs args) {
+			image_resources[args.jobIndex] = wi::resourcemanager::Load(images[args.jobIndex].name, images[args.jobIndex].flags);
+		});
+		wi::jobsystem::Wait(ctx);
+
+		for (Entity materialEntity : materialEntities)
+		{
+			scene.materials.GetComponent(materialEntity)->CreateRenderData();
+		}
+	}
+	finish_phase("Image decoding");
 
 	// Create meshes:
+	//	Entities are created in order on this thread to keep the scene deterministic, then the mesh data is converted by parallel jobs
+	wi::vector<Entity> meshEntities;
+	meshEntities.reserve(state.gltfModel.meshes.size());
 	for (auto& x : state.gltfModel.meshes)
 	{
 		Entity meshEntity = scene.Entity_CreateMesh(x.name);
 		scene.Component_Attach(meshEntity, state.rootEntity);
-		MeshComponent& mesh = *scene.meshes.GetComponent(meshEntity);
+		meshEntities.push_back(meshEntity);
+
+		if (!x.primitives.empty() && scene.materials.GetCount() == 0)
+		{
+			// Create a material last minute if there was none
+			scene.materials.Create(CreateEntity());
+		}
+	}
+	wi::vector<wi::vector<Entity>> vertexColorMaterials(meshEntities.size()); // material modifications from mesh jobs are applied after the jobs
+	wi::jobsystem::Dispatch(ctx, (uint32_t)meshEntities.size(), 1, [&](wi::jobsystem::JobArgs args) {
+		const tinygltf::Mesh& x = state.gltfModel.meshes[args.jobIndex];
+		MeshComponent& mesh = *scene.meshes.GetComponent(meshEntities[args.jobIndex]);
 
 		for (auto& prim : x.primitives)
 		{
 			mesh.subsets.push_back(MeshComponent::MeshSubset());
-			if (scene.materials.GetCount() == 0)
-			{
-				// Create a material last minute if there was none
-				scene.materials.Create(CreateEntity());
-			}
 			mesh.subsets.back().materialID = scene.materials.GetEntity(std::max(0, prim.material));
-			MaterialComponent* material = scene.materials.GetComponent(mesh.subsets.back().materialID);
 			uint32_t vertexOffset = (uint32_t)mesh.vertex_positions.size();
 
 			const size_t index_remap[] = {
@@ -1048,30 +1182,15 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 
 				if (stride == 1)
 				{
-					for (size_t i = 0; i < indexCount; i += 3)
-					{
-						mesh.indices[indexOffset + i + 0] = vertexOffset + data[i + index_remap[0]];
-						mesh.indices[indexOffset + i + 1] = vertexOffset + data[i + index_remap[1]];
-						mesh.indices[indexOffset + i + 2] = vertexOffset + data[i + index_remap[2]];
-					}
+					ConvertIndices<uint8_t>(mesh.indices.data() + indexOffset, data, indexCount, vertexOffset);
 				}
 				else if (stride == 2)
 				{
-					for (size_t i = 0; i < indexCount; i += 3)
-					{
-						mesh.indices[indexOffset + i + 0] = vertexOffset + ((uint16_t*)data)[i + index_remap[0]];
-						mesh.indices[indexOffset + i + 1] = vertexOffset + ((uint16_t*)data)[i + index_remap[1]];
-						mesh.indices[indexOffset + i + 2] = vertexOffset + ((uint16_t*)data)[i + index_remap[2]];
-					}
+					ConvertIndices<uint16_t>(mesh.indices.data() + indexOffset, data, indexCount, vertexOffset);
 				}
 				else if (stride == 4)
 				{
-					for (size_t i = 0; i < indexCount; i += 3)
-					{
-						mesh.indices[indexOffset + i + 0] = vertexOffset + ((uint32_t*)data)[i + index_remap[0]];
-						mesh.indices[indexOffset + i + 1] = vertexOffset + ((uint32_t*)data)[i + index_remap[1]];
-						mesh.indices[indexOffset + i + 2] = vertexOffset + ((uint32_t*)data)[i + index_remap[2]];
-					}
+					ConvertIndices<uint32_t>(mesh.indices.data() + indexOffset, data, indexCount, vertexOffset);
 				}
 				else
 				{
@@ -1112,10 +1231,7 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 				if (!attr_name.compare("POSITION"))
 				{
 					mesh.vertex_positions.resize(vertexOffset + vertexCount);
-					for (size_t i = 0; i < vertexCount; ++i)
-					{
-						mesh.vertex_positions[vertexOffset + i] = *(const XMFLOAT3*)(data + i * stride);
-					}
+					CopyAccessorData(mesh.vertex_positions.data() + vertexOffset, data, stride, vertexCount);
 
 					if (accessor.sparse.isSparse)
 					{
@@ -1153,10 +1269,7 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 				else if (!attr_name.compare("NORMAL"))
 				{
 					mesh.vertex_normals.resize(vertexOffset + vertexCount);
-					for (size_t i = 0; i < vertexCount; ++i)
-					{
-						mesh.vertex_normals[vertexOffset + i] = *(const XMFLOAT3*)(data + i * stride);
-					}
+					CopyAccessorData(mesh.vertex_normals.data() + vertexOffset, data, stride, vertexCount);
 
 					if (accessor.sparse.isSparse)
 					{
@@ -1194,82 +1307,17 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 				else if (!attr_name.compare("TANGENT"))
 				{
 					mesh.vertex_tangents.resize(vertexOffset + vertexCount);
-					for (size_t i = 0; i < vertexCount; ++i)
-					{
-						mesh.vertex_tangents[vertexOffset + i] = *(const XMFLOAT4*)(data + i * stride);
-					}
+					CopyAccessorData(mesh.vertex_tangents.data() + vertexOffset, data, stride, vertexCount);
 				}
 				else if (!attr_name.compare("TEXCOORD_0"))
 				{
 					mesh.vertex_uvset_0.resize(vertexOffset + vertexCount);
-					if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
-					{
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const XMFLOAT2& tex = *(const XMFLOAT2*)((size_t)data + i * stride);
-
-							mesh.vertex_uvset_0[vertexOffset + i].x = tex.x;
-							mesh.vertex_uvset_0[vertexOffset + i].y = tex.y;
-						}
-					}
-					else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-					{
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const uint8_t& s = *(uint8_t*)((size_t)data + i * stride + 0);
-							const uint8_t& t = *(uint8_t*)((size_t)data + i * stride + 1);
-
-							mesh.vertex_uvset_0[vertexOffset + i].x = s / 255.0f;
-							mesh.vertex_uvset_0[vertexOffset + i].y = t / 255.0f;
-						}
-					}
-					else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-					{
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const uint16_t& s = *(uint16_t*)((size_t)data + i * stride + 0 * sizeof(uint16_t));
-							const uint16_t& t = *(uint16_t*)((size_t)data + i * stride + 1 * sizeof(uint16_t));
-
-							mesh.vertex_uvset_0[vertexOffset + i].x = s / 65535.0f;
-							mesh.vertex_uvset_0[vertexOffset + i].y = t / 65535.0f;
-						}
-					}
+					ConvertAccessorFloat2(mesh.vertex_uvset_0.data() + vertexOffset, data, accessor.componentType, stride, vertexCount);
 				}
 				else if (!attr_name.compare("TEXCOORD_1"))
 				{
 					mesh.vertex_uvset_1.resize(vertexOffset + vertexCount);
-					if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
-					{
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const XMFLOAT2& tex = *(const XMFLOAT2*)((size_t)data + i * stride);
-
-							mesh.vertex_uvset_1[vertexOffset + i].x = tex.x;
-							mesh.vertex_uvset_1[vertexOffset + i].y = tex.y;
-						}
-					}
-					else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-					{
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const uint8_t& s = *(uint8_t*)((size_t)data + i * stride + 0);
-							const uint8_t& t = *(uint8_t*)((size_t)data + i * stride + 1);
-
-							mesh.vertex_uvset_1[vertexOffset + i].x = s / 255.0f;
-							mesh.vertex_uvset_1[vertexOffset + i].y = t / 255.0f;
-						}
-					}
-					else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-					{
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const uint16_t& s = *(uint16_t*)((size_t)data + i * stride + 0 * sizeof(uint16_t));
-							const uint16_t& t = *(uint16_t*)((size_t)data + i * stride + 1 * sizeof(uint16_t));
-
-							mesh.vertex_uvset_1[vertexOffset + i].x = s / 65535.0f;
-							mesh.vertex_uvset_1[vertexOffset + i].y = t / 65535.0f;
-						}
-					}
+					ConvertAccessorFloat2(mesh.vertex_uvset_1.data() + vertexOffset, data, accessor.componentType, stride, vertexCount);
 				}
 				else if (!attr_name.compare("JOINTS_0"))
 				{
@@ -1333,50 +1381,11 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 				else if (!attr_name.compare("WEIGHTS_0"))
 				{
 					mesh.vertex_boneweights.resize(vertexOffset + vertexCount);
-					if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
-					{
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							mesh.vertex_boneweights[vertexOffset + i] = *(XMFLOAT4*)((size_t)data + i * stride);
-						}
-					}
-					else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-					{
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const uint8_t& x = *(uint8_t*)((size_t)data + i * stride + 0);
-							const uint8_t& y = *(uint8_t*)((size_t)data + i * stride + 1);
-							const uint8_t& z = *(uint8_t*)((size_t)data + i * stride + 2);
-							const uint8_t& w = *(uint8_t*)((size_t)data + i * stride + 3);
-
-							mesh.vertex_boneweights[vertexOffset + i].x = x / 255.0f;
-							mesh.vertex_boneweights[vertexOffset + i].x = y / 255.0f;
-							mesh.vertex_boneweights[vertexOffset + i].x = z / 255.0f;
-							mesh.vertex_boneweights[vertexOffset + i].x = w / 255.0f;
-						}
-					}
-					else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-					{
-						for (size_t i = 0; i < vertexCount; ++i)
-						{
-							const uint16_t& x = *(uint8_t*)((size_t)data + i * stride + 0 * sizeof(uint16_t));
-							const uint16_t& y = *(uint8_t*)((size_t)data + i * stride + 1 * sizeof(uint16_t));
-							const uint16_t& z = *(uint8_t*)((size_t)data + i * stride + 2 * sizeof(uint16_t));
-							const uint16_t& w = *(uint8_t*)((size_t)data + i * stride + 3 * sizeof(uint16_t));
-
-							mesh.vertex_boneweights[vertexOffset + i].x = x / 65535.0f;
-							mesh.vertex_boneweights[vertexOffset + i].x = y / 65535.0f;
-							mesh.vertex_boneweights[vertexOffset + i].x = z / 65535.0f;
-							mesh.vertex_boneweights[vertexOffset + i].x = w / 65535.0f;
-						}
-					}
+					ConvertAccessorFloat4(mesh.vertex_boneweights.data() + vertexOffset, data, accessor.componentType, stride, vertexCount);
 				}
 				else if (!attr_name.compare("COLOR_0"))
 				{
-					if(material != nullptr)
-					{
-						material->SetUseVertexColors(true);
-					}
+					vertexColorMaterials[args.jobIndex].push_back(mesh.subsets.back().materialID);
 					mesh.vertex_colors.resize(vertexOffset + vertexCount);
 					if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
 					{
@@ -1524,10 +1533,7 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 							const unsigned char* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
 
 							morph_target.vertex_positions.resize(vertexOffset + vertexCount);
-							for (size_t j = 0; j < vertexCount; ++j)
-							{
-								morph_target.vertex_positions[vertexOffset + j] = ((XMFLOAT3*)data)[j];
-							}
+							CopyAccessorData(morph_target.vertex_positions.data() + vertexOffset, data, stride, vertexCount);
 						}
 					}
 					else if (!attr_name.compare("NORMAL"))
@@ -1581,10 +1587,7 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 							const unsigned char* data = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
 
 							morph_target.vertex_normals.resize(vertexOffset + vertexCount);
-							for (size_t j = 0; j < vertexCount; ++j)
-							{
-								morph_target.vertex_normals[vertexOffset + j] = ((XMFLOAT3*)data)[j];
-							}
+							CopyAccessorData(morph_target.vertex_normals.data() + vertexOffset, data, stride, vertexCount);
 						}
 					}
 				}
@@ -1603,7 +1606,20 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 		}
 
 		mesh.CreateRenderData(); // tangents are generated inside if needed, which must be done before FlipZAxis!
+	});
+	wi::jobsystem::Wait(ctx);
+	for (auto& materials : vertexColorMaterials)
+	{
+		for (Entity materialEntity : materials)
+		{
+			MaterialComponent* material = scene.materials.GetComponent(materialEntity);
+			if (material != nullptr)
+			{
+				material->SetUseVertexColors(true);
+			}
+		}
 	}
+	finish_phase("Meshes (accessor conversion, normals, tangents, meshlets)");
 
 	// Create armatures:
 	for (auto& skin : state.gltfModel.skins)
@@ -1673,12 +1689,18 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 		}
 	}
 
+	finish_phase("Armatures and nodes");
+
 	// Create animations:
+	//	Entities and channels are created in order on this thread, then the keyframe data is converted by parallel jobs
+	wi::vector<Entity> animationEntities;
+	animationEntities.reserve(state.gltfModel.animations.size());
 	for (auto& anim : state.gltfModel.animations)
 	{
 		Entity entity = CreateEntity();
 		scene.names.Create(entity) = anim.name;
 		scene.Component_Attach(entity, state.rootEntity);
+		animationEntities.push_back(entity);
 		AnimationComponent& animationcomponent = scene.animations.Create(entity);
 		animationcomponent.samplers.resize(anim.samplers.size());
 		animationcomponent.channels.resize(anim.channels.size());
@@ -1702,7 +1724,47 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 
 			animationcomponent.samplers[i].data = CreateEntity();
 			scene.Component_Attach(animationcomponent.samplers[i].data, entity);
-			AnimationDataComponent& animationdata = scene.animation_datas.Create(animationcomponent.samplers[i].data);
+			scene.animation_datas.Create(animationcomponent.samplers[i].data);
+		}
+
+		for (size_t i = 0; i < anim.channels.size(); ++i)
+		{
+			auto& channel = anim.channels[i];
+
+			animationcomponent.channels[i].target = state.entityMap[channel.target_node];
+			assert(channel.sampler >= 0);
+			animationcomponent.channels[i].samplerIndex = (uint32_t)channel.sampler;
+
+			if (!channel.target_path.compare("scale"))
+			{
+				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::SCALE;
+			}
+			else if (!channel.target_path.compare("rotation"))
+			{
+				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::ROTATION;
+			}
+			else if (!channel.target_path.compare("translation"))
+			{
+				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::TRANSLATION;
+			}
+			else if (!channel.target_path.compare("weights"))
+			{
+				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::WEIGHTS;
+			}
+			else
+			{
+				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::UNKNOWN;
+			}
+		}
+	}
+	wi::jobsystem::Dispatch(ctx, (uint32_t)animationEntities.size(), 1, [&](wi::jobsystem::JobArgs args) {
+		const tinygltf::Animation& anim = state.gltfModel.animations[args.jobIndex];
+		AnimationComponent& animationcomponent = *scene.animations.GetComponent(animationEntities[args.jobIndex]);
+
+		for (size_t i = 0; i < anim.samplers.size(); ++i)
+		{
+			auto& sam = anim.samplers[i];
+			AnimationDataComponent& animationdata = *scene.animation_datas.GetComponent(animationcomponent.samplers[i].data);
 
 			// AnimationSampler input = keyframe times
 			{
@@ -1721,10 +1783,9 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 
 				assert(stride == 4);
 
-				for (size_t j = 0; j < count; ++j)
+				CopyAccessorData(animationdata.keyframe_times.data(), data, stride, count);
+				for (float time : animationdata.keyframe_times)
 				{
-					float time = ((float*)data)[j];
-					animationdata.keyframe_times[j] = time;
 					animationcomponent.start = std::min(animationcomponent.start, time);
 					animationcomponent.end = std::max(animationcomponent.end, time);
 				}
@@ -1748,30 +1809,21 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 				{
 					assert(stride == sizeof(float));
 					animationdata.keyframe_data.resize(count);
-					for (size_t j = 0; j < count; ++j)
-					{
-						animationdata.keyframe_data[j] = ((float*)data)[j];
-					}
+					CopyAccessorData(animationdata.keyframe_data.data(), data, stride, count);
 				}
 				break;
 				case TINYGLTF_TYPE_VEC3:
 				{
 					assert(stride == sizeof(XMFLOAT3));
 					animationdata.keyframe_data.resize(count * 3);
-					for (size_t j = 0; j < count; ++j)
-					{
-						((XMFLOAT3*)animationdata.keyframe_data.data())[j] = ((XMFLOAT3*)data)[j];
-					}
+					CopyAccessorData((XMFLOAT3*)animationdata.keyframe_data.data(), data, stride, count);
 				}
 				break;
 				case TINYGLTF_TYPE_VEC4:
 				{
 					assert(stride == sizeof(XMFLOAT4));
 					animationdata.keyframe_data.resize(count * 4);
-					for (size_t j = 0; j < count; ++j)
-					{
-						((XMFLOAT4*)animationdata.keyframe_data.data())[j] = ((XMFLOAT4*)data)[j];
-					}
+					CopyAccessorData((XMFLOAT4*)animationdata.keyframe_data.data(), data, stride, count);
 				}
 				break;
 				default: assert(0); break;
@@ -1781,38 +1833,9 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 			}
 
 		}
-
-		for (size_t i = 0; i < anim.channels.size(); ++i)
-		{
-			auto& channel = anim.channels[i];
-
-			animationcomponent.channels[i].target = state.entityMap[channel.target_node];
-			assert(channel.sampler >= 0);
-			animationcomponent.channels[i].samplerIndex = (uint32_t)channel.sampler;
-
-			if (!channel.target_path.compare("scale"))
-			{
-				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::SCALE;
-			}
-			else if (!channel.target_path.compare("rotation"))
-			{
-				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::ROTATION;
-			}
-			else if (!channel.target_path.compare("translation"))
-			{
-				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::TRANSLATION;
-			}
-			else if (!channel.target_path.compare("weights"))
-			{
-				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::WEIGHTS;
-			}
-			else
-			{
-				animationcomponent.channels[i].path = AnimationComponent::AnimationChannel::Path::UNKNOWN;
-			}
-		}
-
-	}
+	});
+	wi::jobsystem::Wait(ctx);
+	finish_phase("Animations");
 
 	// Create lights:
 	int lightIndex = 0;
@@ -2020,6 +2043,7 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 
 	Import_Extension_VRM(state);
 	Import_Extension_VRMC(state);
+	finish_phase("Lights, cameras and extensions");
 
 	//Correct orientation after importing
 	scene.Update(0);
@@ -2031,6 +2055,11 @@ void ImportModel_GLTF(const std::string& fileName, Scene& scene)
 
 	// after scene update, clean up duplicate colliders that could have been loaded by some extension
 	scene.DeleteDuplicateColliders();
+	finish_phase("Orientation fix and scene update");
+
+	char text[64] = {};
+	snprintf(text, arraysize(text), "%.2f ms", timer.elapsed_milliseconds());
+	wi::backlog::post("GLTF import of " + name + " finished in " + text + timing_report);
 }
 
 void Import_Extension_VRM(LoaderState& state)
@@ -0,0 +1,84 @@
+#include "stdafx.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace wi::ecs;
+using namespace wi::scene;
+
+int main(int argc, char* argv[])
+{
+	const int ticks = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000;
+	const int cube_count = argc > 2 ? std::max(0, std::atoi(argv[2])) : 1000;
+	const int character_count = argc > 3 ? std::max(0, std::atoi(argv[3])) : 100;
+	const float dt = 1.0f / 60.0f; // server tick rate
+
+	// Only the systems that the CPU simulation needs are initialized, there is no graphics device:
+	wi::jobsystem::Initialize();
+	wi::physics::Initialize();
+
+	Scene scene;
+	scene.SetHeadless(true);
+
+	Entity ground = scene.Entity_CreatePlane("ground");
+	scene.transforms.GetComponent(ground)->Scale(XMFLOAT3(100, 1, 100));
+	RigidBodyPhysicsComponent& ground_rigidbody = scene.rigidbodies.Create(ground);
+	ground_rigidbody.shape = RigidBodyPhysicsComponent::BOX;
+	ground_rigidbody.box.halfextents = XMFLOAT3(1, 0.1f, 1); // scaled by the transform to 100 x 0.1 x 100
+	ground_rigidbody.mass = 0;
+
+	// All cubes share the same mesh:
+	Entity cube_mesh = scene.Entity_CreateCube("cube");
+	const int grid_size = std::max(1, (int)std::ceil(std::cbrt((float)cube_count)));
+	for (int i = 0; i < cube_count; ++i)
+	{
+		Entity entity = scene.Entity_CreateObject("");
+		ObjectComponent& object = *scene.objects.GetComponent(entity);
+		object.meshID = cube_mesh;
+		TransformComponent& transform = *scene.transforms.GetComponent(entity);
+		transform.Translate(XMFLOAT3(
+			float(i % grid_size) * 3 - grid_size * 1.5f,
+			float((i / grid_size) / grid_size) * 3 + 2,
+			float((i / grid_size) % grid_size) * 3 - grid_size * 1.5f
+		));
+		RigidBodyPhysicsComponent& rigidbody = scene.rigidbodies.Create(entity);
+		rigidbody.shape = RigidBodyPhysicsComponent::BOX;
+		rigidbody.box.halfextents = XMFLOAT3(1, 1, 1);
+		rigidbody.mass = 1;
+	}
+
+	wi::vector<Entity> character_entities;
+	for (int i = 0; i < character_count; ++i)
+	{
+		Entity entity = scene.Entity_CreateTransform("");
+		CharacterComponent& character = scene.characters.Create(entity);
+		const float angle = float(i) / float(character_count) * XM_2PI;
+		character.SetPosition(XMFLOAT3(std::cos(angle) * 20, 0, std::sin(angle) * 20));
+		character_entities.push_back(entity);
+	}
+
+	// Warm up: the first updates create the physics objects and internal allocations
+	for (int i = 0; i < 10; ++i)
+	{
+		scene.Update(dt);
+	}
+
+	wi::Timer timer;
+	for (int tick = 0; tick < ticks; ++tick)
+	{
+		for (size_t i = 0; i < character_entities.size(); ++i)
+		{
+			CharacterComponent* character = scene.characters.GetComponent(character_entities[i]);
+			const float angle = float(tick) * dt + float(i);
+			character->Move(XMFLOAT3(std::cos(angle), 0, std::sin(angle)));
+		}
+		scene.Update(dt);
+	}
+	const double elapsed = timer.elapsed_seconds();
+
+	std::printf("cubes: %d, characters: %d\n", cube_count, character_count);
+	std::printf("%d ticks in %.3f s: %.1f ticks/s, %.3f ms/tick\n", ticks, elapsed, ticks / elapsed, elapsed * 1000.0 / ticks);
+
+	wi::jobsystem::ShutDown();
+	return 0;
+}
@@ -1,4 +1,5 @@
 #include "stdafx.h"
+#include "Utility/basis_universal/encoder/basisu_gpu_texture.h"
 
 #define CONTENT_DIR "../../Content/"
 
@@ -27,6 +28,13 @@ enum TEST_TYPE
 	INVERSEKINEMATICSTEST,
 	INSTANCESTEST,
 	CONTAINERPERF,
+	BLOCKCOMPRESSIONPERF,
+	FRUSTUMCULLINGPERF,
+	OCCLUSIONCULLINGPERF,
+	NETWORKPERF,
+	NETWORKREPLICATIONPERF,
+	PARTICLESIMULATIONCPUPERF,
+	MESHNORMALSPERF,
 };
 
 // Controller Test UI Data, info down below will be using Xbox Controller as reference
@@ -159,6 +167,13 @@ void TestsRenderer::Load()
 	testSelector.AddItem("Inverse Kinematics", INVERSEKINEMATICSTEST);
 	testSelector.AddItem("65k Instances", INSTANCESTEST);
 	testSelector.AddItem("Container perf", CONTAINERPERF);
+	testSelector.AddItem("Block compression perf", BLOCKCOMPRESSIONPERF);
+	testSelector.AddItem("Frustum culling perf", FRUSTUMCULLINGPERF);
+	testSelector.AddItem("CPU occlusion culling perf", OCCLUSIONCULLINGPERF);
+	testSelector.AddItem("Network perf", NETWORKPERF);
+	testSelector.AddItem("Network replication perf", NETWORKREPLICATIONPERF);
+	testSelector.AddItem("CPU particle simulation perf", PARTICLESIMULATIONCPUPERF);
+	testSelector.AddItem("Mesh normals perf", MESHNORMALSPERF);
 	testSelector.SetMaxVisibleItemCount(10);
 	testSelector.OnSelect([=](wi::gui::EventArgs args) {
 
@@ -419,6 +434,34 @@ void TestsRenderer::Load()
 			ContainerTest();
 			break;
 
+		case BLOCKCOMPRESSIONPERF:
+			BlockCompressionTest();
+			break;
+
+		case FRUSTUMCULLINGPERF:
+			FrustumCullingTest();
+			break;
+
+		case OCCLUSIONCULLINGPERF:
+			OcclusionCullingTest();
+			break;
+
+		case NETWORKPERF:
+			NetworkPerfTest();
+			break;
+
+		case NETWORKREPLICATIONPERF:
+			NetworkReplicationPerfTest();
+			break;
+
+		case PARTICLESIMULATIONCPUPERF:
+			ParticleSimulationCPUPerfTest();
+			break;
+
+		case MESHNORMALSPERF:
+			MeshNormalsPerfTest();
+			break;
+
 		default:
 			assert(0);
 			break;
@@ -1161,6 +1204,214 @@ void TestsRenderer::RunNetworkTest()
 	font.params.size = 24;
 	AddFont(&font);
 }
+void TestsRenderer::NetworkPerfTest()
+{
+	const uint32_t packet_count = 100000;
+	const uint32_t packet_size = 64;
+
+	wi::network::Connection connection;
+	connection.ipaddress = { 127,0,0,1 }; // localhost
+	connection.port = 12346;
+
+	std::string ss = "Loopback UDP throughput test with " + std::to_string(packet_count) + " packets of " + std::to_string(packet_size) + " bytes:\n";
+	auto report = [&](const char* name, uint32_t received, double seconds) {
+		ss += "\n" + std::string(name) + ": received " + std::to_string(received) + " packets, " + std::to_string(uint32_t(received / std::max(seconds, 0.000001))) + " packets/s";
+	};
+
+	// One system call per packet:
+	{
+		wi::network::Socket receiver;
+		wi::network::CreateSocket(&receiver);
+		wi::network::ListenPort(&receiver, connection.port);
+
+		wi::Timer timer;
+		std::thread sender([&] {
+			wi::network::Socket sock;
+			wi::network::CreateSocket(&sock);
+			uint8_t data[packet_size] = {};
+			for (uint32_t i = 0; i < packet_count; ++i)
+			{
+				wi::network::Send(&sock, &connection, data, sizeof(data));
+			}
+		});
+
+		uint32_t received = 0;
+		double last_receive_time = 0;
+		uint8_t data[wi::network::PACKET_CAPACITY];
+		wi::network::Connection sender_connection;
+		while (received < packet_count && wi::network::CanReceive(&receiver, 100000))
+		{
+			wi::network::Receive(&receiver, &sender_connection, data, sizeof(data));
+			received++;
+			last_receive_time = timer.elapsed_seconds();
+		}
+		sender.join();
+		report("Send() + CanReceive() + Receive()", received, last_receive_time);
+	}
+
+	// Batched system calls and the receiving job:
+	{
+		wi::network::PacketPool pool;
+		pool.Init(4096);
+
+		wi::network::Socket receiver;
+		wi::network::CreateSocket(&receiver);
+		wi::network::ListenPort(&receiver, connection.port);
+		wi::network::StartReceiving(&receiver, &pool);
+
+		wi::Timer timer;
+		std::thread sender([&] {
+			wi::network::Socket sock;
+			wi::network::CreateSocket(&sock);
+			wi::network::PacketPool send_pool;
+			send_pool.Init(64);
+			wi::network::Packet* packets[64];
+			for (auto& packet : packets)
+			{
+				packet = send_pool.Allocate();
+				packet->connection = connection;
+				packet->size = packet_size;
+			}
+			for (uint32_t sent = 0; sent < packet_count; sent += arraysize(packets))
+			{
+				wi::network::SendBatch(&sock, packets, std::min(packet_count - sent, (uint32_t)arraysize(packets)));
+			}
+		});
+
+		uint32_t received = 0;
+		double last_receive_time = 0;
+		wi::Timer idle_timer;
+		wi::network::Packet* packets[256];
+		while (received < packet_count && idle_timer.elapsed_milliseconds() < 100)
+		{
+			size_t count = wi::network::PollReceived(&receiver, packets, arraysize(packets));
+			if (count > 0)
+			{
+				received += (uint32_t)count;
+				pool.Free(packets, count);
+				last_receive_time = timer.elapsed_seconds();
+				idle_timer.record();
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+		sender.join();
+		wi::network::StopReceiving(&receiver);
+		report("SendBatch() + StartReceiving() + PollReceived()", received, last_receive_time);
+	}
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+void TestsRenderer::NetworkReplicationPerfTest()
+{
+	const uint32_t entity_count = 2000;
+	const uint32_t tick_count = 300;
+
+	// The server and client scenes are separate, and communicate through loopback:
+	Scene server_scene;
+	Scene client_scene;
+	server_scene.SetHeadless();
+	client_scene.SetHeadless();
+
+	wi::network::Socket server_socket;
+	wi::network::CreateSocket(&server_socket);
+	wi::network::ListenPort(&server_socket, 12347);
+	wi::network::Socket client_socket;
+	wi::network::CreateSocket(&client_socket);
+	wi::network::ListenPort(&client_socket, 12348);
+	wi::network::Connection server_connection;
+	server_connection.ipaddress = { 127,0,0,1 }; // localhost
+	server_connection.port = 12347;
+
+	wi::network::ReplicationServer server;
+	server.RegisterTransforms(server_scene.transforms, 2);
+	server.Register<NameComponent>(server_scene.componentLibrary, "wi::scene::Scene::names");
+	server.SetSocket(&server_socket);
+
+	wi::network::ReplicationClient client;
+	client.RegisterTransforms(client_scene.transforms, 2);
+	client.Register<NameComponent>(client_scene.componentLibrary, "wi::scene::Scene::names");
+	client.Connect(&client_socket, server_connection);
+
+	wi::vector<Entity> entities(entity_count);
+	for (uint32_t i = 0; i < entity_count; ++i)
+	{
+		entities[i] = server_scene.Entity_CreateObject("object" + std::to_string(i));
+		TransformComponent* transform = server_scene.transforms.GetComponent(entities[i]);
+		transform->Translate(XMFLOAT3(float(i % 64), 0, float(i / 64)));
+		transform->RotateRollPitchYaw(XMFLOAT3(0, float(i), 0));
+	}
+
+	double server_ms = 0;
+	size_t bytes_sent = 0;
+	size_t items_delayed = 0;
+	for (uint32_t tick = 0; tick < tick_count; ++tick)
+	{
+		// Half of the objects are moving:
+		for (uint32_t i = 0; i < entity_count; i += 2)
+		{
+			TransformComponent* transform = server_scene.transforms.GetComponent(entities[i]);
+			transform->Translate(XMFLOAT3(0, 0.01f, 0));
+			transform->RotateRollPitchYaw(XMFLOAT3(0, 0.01f, 0));
+		}
+
+		wi::Timer timer;
+		server.Update();
+		server_ms += timer.elapsed_milliseconds();
+		bytes_sent += server.GetStats().bytes_sent;
+		items_delayed += server.GetStats().items_delayed;
+
+		client.Update();
+	}
+
+	// Let the last messages arrive:
+	wi::Timer timer;
+	while (client.GetTick() < server.GetTick() && timer.elapsed_milliseconds() < 100)
+	{
+		client.Update();
+	}
+
+	float max_position_error = 0;
+	uint32_t missing = 0;
+	for (uint32_t i = 0; i < entity_count; ++i)
+	{
+		const TransformComponent* client_transform = client_scene.transforms.GetComponent(client.GetLocalEntity(entities[i]));
+		if (client_transform == nullptr)
+		{
+			missing++;
+			continue;
+		}
+		const TransformComponent* server_transform = server_scene.transforms.GetComponent(entities[i]);
+		max_position_error = std::max(max_position_error, wi::math::Distance(server_transform->translation_local, client_transform->translation_local));
+	}
+
+	const size_t full_state_size = entity_count * (sizeof(XMFLOAT3) + sizeof(XMFLOAT4) + sizeof(XMFLOAT3));
+	std::string ss = "Scene replication over loopback, " + std::to_string(entity_count) + " transforms, half of them moving, " + std::to_string(tick_count) + " ticks:\n";
+	ss += "\nServer update: " + std::to_string(server_ms / tick_count) + " ms/tick";
+	ss += "\nSent: " + std::to_string(bytes_sent / tick_count) + " bytes/tick (uncompressed full state: " + std::to_string(full_state_size) + " bytes)";
+	ss += "\nDelayed by bandwidth budget: " + std::to_string(items_delayed) + " components";
+	ss += "\nClient tick: " + std::to_string(client.GetTick()) + " / " + std::to_string(server.GetTick());
+	ss += "\nMissing on client: " + std::to_string(missing);
+	ss += "\nMax position error: " + std::to_string(max_position_error);
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
 void TestsRenderer::ContainerTest()
 {
 	wi::Timer timer;
@@ -1257,3 +1508,428 @@ void TestsRenderer::ContainerTest()
 	font.params.size = 24;
 	this->AddFont(&font);
 }
+
+void TestsRenderer::BlockCompressionTest()
+{
+	using namespace wi::graphics;
+	using namespace wi::texturehelper;
+
+	// Synthetic test image with gradients, noise and hard alpha edges, dimensions are intentionally not multiple of 4:
+	const uint32_t width = 2045;
+	const uint32_t height = 1021;
+	wi::vector<uint8_t> image(width * height * 4);
+	uint32_t seed = 1;
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			uint8_t* pixel = &image[(y * width + x) * 4];
+			seed = seed * 1664525u + 1013904223u;
+			const float noise = float(seed >> 24) / 255.0f;
+			pixel[0] = uint8_t(wi::math::Clamp(127 + 120 * std::sin(x * 0.05f) + 10 * noise, 0, 255));
+			pixel[1] = uint8_t(wi::math::Clamp(y * 255.0f / height + 8 * noise, 0, 255));
+			pixel[2] = uint8_t(wi::math::Clamp(127 + 120 * std::cos((x + y) * 0.03f), 0, 255));
+			pixel[3] = ((x / 32 + y / 32) % 2) ? 255 : uint8_t(x % 256);
+		}
+	}
+
+	struct TestFormat
+	{
+		Format format;
+		basisu::texture_format decode_format;
+		const char* name;
+		uint32_t channel_count; // PSNR is measured for the first channel_count channels
+	};
+	const TestFormat formats[] = {
+		{ Format::BC1_UNORM, basisu::texture_format::cBC1, "BC1", 3 },
+		{ Format::BC3_UNORM, basisu::texture_format::cBC3, "BC3", 4 },
+		{ Format::BC4_UNORM, basisu::texture_format::cBC4, "BC4", 1 },
+		{ Format::BC5_UNORM, basisu::texture_format::cBC5, "BC5", 2 },
+		{ Format::BC7_UNORM, basisu::texture_format::cBC7, "BC7", 4 },
+	};
+	const char* quality_names[] = { "Fast", "Normal", "High" };
+
+	const uint32_t num_blocks_x = (width + 3) / 4;
+	const uint32_t num_blocks_y = (height + 3) / 4;
+
+	std::string ss = "CPU block compression test for " + std::to_string(width) + " x " + std::to_string(height) + " image, " + std::to_string(wi::jobsystem::GetThreadCount()) + " threads:\n\n";
+
+	wi::Timer timer;
+	for (auto& format : formats)
+	{
+		const uint32_t stride = GetFormatStride(format.format);
+		wi::vector<uint8_t> compressed(num_blocks_x * num_blocks_y * stride);
+		for (int quality = 0; quality < arraysize(quality_names); ++quality)
+		{
+			timer.record();
+			BlockCompress(image.data(), width, height, width * 4, format.format, compressed.data(), (BlockCompressionQuality)quality);
+			const double milliseconds = timer.elapsed_milliseconds();
+
+			double error = 0;
+			size_t count = 0;
+			for (uint32_t by = 0; by < num_blocks_y; ++by)
+			{
+				for (uint32_t bx = 0; bx < num_blocks_x; ++bx)
+				{
+					const uint8_t* block = &compressed[(by * num_blocks_x + bx) * stride];
+					basisu::color_rgba decoded[16];
+					if (format.format == Format::BC4_UNORM)
+					{
+						uint8_t values[16 * 4] = {};
+						basisu::unpack_bc4(block, values, 4);
+						for (int i = 0; i < 16; ++i)
+						{
+							decoded[i].r = values[i * 4];
+						}
+					}
+					else
+					{
+						basisu::unpack_block(format.decode_format, block, decoded);
+					}
+					for (uint32_t i = 0; i < 16; ++i)
+					{
+						const uint32_t x = bx * 4 + i % 4;
+						const uint32_t y = by * 4 + i / 4;
+						if (x >= width || y >= height)
+							continue;
+						const uint8_t* pixel = &image[(y * width + x) * 4];
+						for (uint32_t c = 0; c < format.channel_count; ++c)
+						{
+							const double diff = double(decoded[i][c]) - double(pixel[c]);
+							error += diff * diff;
+							count++;
+						}
+					}
+				}
+			}
+			const double mse = std::max(error / double(count), 1e-10);
+			const double psnr = 10 * std::log10(255.0 * 255.0 / mse);
+
+			char text[256];
+			snprintf(text, arraysize(text), "%s %s: %.2f ms, %.1f Mpixel/s, PSNR: %.2f dB\n", format.name, quality_names[quality], milliseconds, double(width * height) / milliseconds / 1000.0, psnr);
+			ss += text;
+		}
+		ss += "\n";
+	}
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::FrustumCullingTest()
+{
+	using namespace wi::primitive;
+
+	// Random boxes scattered around the camera, some of them on an other layer and some of them invalid:
+	const size_t count = 100000;
+	wi::vector<AABB> boxes(count);
+	AABBArray boxes_soa;
+	boxes_soa.resize(count);
+	uint32_t seed = 1;
+	auto random = [&](float range) {
+		seed = seed * 1664525u + 1013904223u;
+		return (float(seed >> 8) / float(1 << 24)) * range;
+	};
+	for (size_t i = 0; i < count; ++i)
+	{
+		const XMFLOAT3 center = XMFLOAT3(random(400) - 200, random(400) - 200, random(400) - 200);
+		const XMFLOAT3 halfwidth = XMFLOAT3(random(5), random(5), random(5));
+		boxes[i].createFromHalfWidth(center, halfwidth);
+		boxes[i].layerMask = (i % 7) == 0 ? 2 : 1;
+		if ((i % 13) == 0)
+		{
+			boxes[i] = AABB();
+		}
+		boxes_soa.set(i, boxes[i]);
+	}
+
+	Frustum frustum;
+	frustum.Create(
+		XMMatrixLookAtLH(XMVectorSet(0, 0, -100, 1), XMVectorSet(0, 0, 0, 1), XMVectorSet(0, 1, 0, 0)) *
+		XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 500, 0.1f) // reversed depth like the engine cameras
+	);
+	const uint32_t layerMask = 1;
+	const int repeat = 20;
+
+	wi::Timer timer;
+	size_t visible_aos = 0;
+	for (int r = 0; r < repeat; ++r)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			if ((boxes[i].layerMask & layerMask) && frustum.CheckBoxFast(boxes[i]))
+			{
+				visible_aos++;
+			}
+		}
+	}
+	const double time_aos = timer.elapsed_milliseconds() / repeat;
+
+	timer.record();
+	size_t visible_soa = 0;
+	for (int r = 0; r < repeat; ++r)
+	{
+		for (size_t block = 0; block < count; block += 64)
+		{
+			visible_soa += countbits(frustum.CheckBoxesFast(boxes_soa, block, (uint32_t)std::min(size_t(64), count - block), layerMask));
+		}
+	}
+	const double time_soa = timer.elapsed_milliseconds() / repeat;
+
+	std::string ss = "Frustum culling test for " + std::to_string(count) + " boxes, single thread:\n\n";
+	char text[256];
+	snprintf(text, arraysize(text), "CheckBoxFast(): %.3f ms, %.1f Mbox/s\n", time_aos, double(count) / time_aos / 1000.0);
+	ss += text;
+#ifdef _XM_AVX2_INTRINSICS_
+	const char* simd = "AVX2, 8 boxes per iteration";
+#else
+	const char* simd = "4 boxes per iteration";
+#endif // _XM_AVX2_INTRINSICS_
+	snprintf(text, arraysize(text), "CheckBoxesFast() (%s): %.3f ms, %.1f Mbox/s, %.1fx\n", simd, time_soa, double(count) / time_soa / 1000.0, time_aos / std::max(time_soa, 0.000001));
+	ss += text;
+	snprintf(text, arraysize(text), "\nVisible: %d, %d (%s)\n", int(visible_aos / repeat), int(visible_soa / repeat), visible_aos == visible_soa ? "match" : "MISMATCH");
+	ss += text;
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::OcclusionCullingTest()
+{
+	using namespace wi::primitive;
+
+	// Occluders are a grid of building blocks, each of them is a box mesh made of 12 triangles:
+	const XMFLOAT3 cube_positions[] = {
+		XMFLOAT3(-1, -1, -1), XMFLOAT3(1, -1, -1), XMFLOAT3(1, 1, -1), XMFLOAT3(-1, 1, -1),
+		XMFLOAT3(-1, -1, 1), XMFLOAT3(1, -1, 1), XMFLOAT3(1, 1, 1), XMFLOAT3(-1, 1, 1),
+	};
+	const uint32_t cube_indices[] = {
+		0, 1, 2, 0, 2, 3,
+		4, 6, 5, 4, 7, 6,
+		0, 5, 1, 0, 4, 5,
+		3, 6, 7, 3, 2, 6,
+		0, 7, 4, 0, 3, 7,
+		1, 6, 2, 1, 5, 6,
+	};
+	wi::vector<XMFLOAT4X4> occluders;
+	for (int x = -10; x <= 10; ++x)
+	{
+		for (int z = 1; z <= 20; ++z)
+		{
+			XMFLOAT4X4 world;
+			XMStoreFloat4x4(&world, XMMatrixScaling(8, 10 + float((x * 7 + z * 3) % 5) * 4, 8) * XMMatrixTranslation(float(x) * 24, 0, float(z) * 24));
+			occluders.push_back(world);
+		}
+	}
+
+	// Occludees are small random boxes scattered between the buildings:
+	const size_t count = 100000;
+	wi::vector<AABB> boxes(count);
+	uint32_t seed = 1;
+	auto random = [&](float range) {
+		seed = seed * 1664525u + 1013904223u;
+		return (float(seed >> 8) / float(1 << 24)) * range;
+	};
+	for (size_t i = 0; i < count; ++i)
+	{
+		const XMFLOAT3 center = XMFLOAT3(random(480) - 240, random(10), random(480) + 10);
+		const XMFLOAT3 halfwidth = XMFLOAT3(0.5f + random(2), 0.5f + random(2), 0.5f + random(2));
+		boxes[i].createFromHalfWidth(center, halfwidth);
+	}
+
+	const XMMATRIX VP =
+		XMMatrixLookToLH(XMVectorSet(0, 2, -20, 1), XMVectorSet(0, 0, 1, 0), XMVectorSet(0, 1, 0, 0)) *
+		XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 1000, 0.1f); // reversed depth like the engine cameras
+	Frustum frustum;
+	frustum.Create(VP);
+
+	const int repeat = 20;
+	wi::OcclusionBuffer occlusion_buffer;
+	wi::Timer timer;
+	for (int r = 0; r < repeat; ++r)
+	{
+		occlusion_buffer.Clear(256, 144, VP);
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, (uint32_t)occluders.size(), 16, [&](wi::jobsystem::JobArgs args) {
+			occlusion_buffer.AddOccluder(cube_positions, cube_indices, arraysize(cube_indices), XMLoadFloat4x4(&occluders[args.jobIndex]));
+		});
+		wi::jobsystem::Wait(ctx);
+		occlusion_buffer.Rasterize();
+	}
+	const double time_rasterize = timer.elapsed_milliseconds() / repeat;
+
+	timer.record();
+	size_t inside_frustum = 0;
+	size_t occluded = 0;
+	for (int r = 0; r < repeat; ++r)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (frustum.CheckBoxFast(boxes[i]))
+			{
+				inside_frustum++;
+				if (occlusion_buffer.IsOccluded(boxes[i]))
+				{
+					occluded++;
+				}
+			}
+		}
+	}
+	const double time_test = timer.elapsed_milliseconds() / repeat;
+
+	std::string ss = "CPU occlusion culling test, " + std::to_string(occlusion_buffer.GetWidth()) + "x" + std::to_string(occlusion_buffer.GetHeight()) + " depth buffer:\n\n";
+	char text[256];
+	snprintf(text, arraysize(text), "Rasterize %d occluders (%d triangles after culling): %.3f ms\n", int(occluders.size()), int(occlusion_buffer.GetTriangleCount()), time_rasterize);
+	ss += text;
+	snprintf(text, arraysize(text), "Test %d boxes, single thread: %.3f ms\n", int(count), time_test);
+	ss += text;
+	snprintf(text, arraysize(text), "\nInside frustum: %d, occluded: %d (%.1f%%)\n", int(inside_frustum / repeat), int(occluded / repeat), 100.0 * double(occluded) / double(std::max(inside_frustum, size_t(1))));
+	ss += text;
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::ParticleSimulationCPUPerfTest()
+{
+	const uint32_t max_particles = 200000;
+	const uint32_t frame_count = 240;
+	const float dt = 1.0f / 60.0f;
+
+	// The scene is headless, so only the CPU simulation is running, without GPU upload and rendering:
+	Scene scene;
+	scene.SetHeadless();
+
+	Entity emitter_entity = scene.Entity_CreateEmitter("emitter");
+	wi::EmittedParticleSystem* emitter = scene.emitters.GetComponent(emitter_entity);
+	emitter->SetCPUSimulationEnabled(true);
+	emitter->SetVolumeEnabled(true);
+	emitter->SetMaxParticleCount(max_particles);
+	emitter->count = 100000;
+	emitter->life = 2;
+	emitter->random_life = 0.5f;
+	emitter->velocity = XMFLOAT3(0, 4, 0);
+	emitter->gravity = XMFLOAT3(0, -9.8f, 0);
+	emitter->drag = 0.98f;
+
+	Entity attractor = scene.Entity_CreateForce("attractor", XMFLOAT3(0, 2, 0));
+	scene.forces.GetComponent(attractor)->type = ForceFieldComponent::Type::Point;
+	scene.forces.GetComponent(attractor)->gravity = 20;
+	scene.forces.GetComponent(attractor)->range = 10;
+	Entity wind = scene.Entity_CreateForce("wind", XMFLOAT3(0, 0, 0));
+	scene.forces.GetComponent(wind)->type = ForceFieldComponent::Type::Plane;
+	scene.forces.GetComponent(wind)->gravity = 5;
+	scene.forces.GetComponent(wind)->range = 50;
+
+	wi::Timer timer;
+	size_t particle_updates = 0;
+	for (uint32_t frame = 0; frame < frame_count; ++frame)
+	{
+		scene.Update(dt);
+		particle_updates += emitter->cpu_particles.count;
+	}
+	const double total_ms = timer.elapsed_milliseconds();
+
+	std::string ss = "CPU particle simulation, " + std::to_string(frame_count) + " frames, 2 force fields:\n\n";
+	char text[256];
+	snprintf(text, arraysize(text), "Alive particles: %d / %d\n", int(emitter->cpu_particles.count), int(max_particles));
+	ss += text;
+	snprintf(text, arraysize(text), "Scene update: %.3f ms/frame\n", total_ms / frame_count);
+	ss += text;
+	snprintf(text, arraysize(text), "Throughput: %.2f million particles/second\n", double(particle_updates) / (total_ms * 1000.0));
+	ss += text;
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
+void TestsRenderer::MeshNormalsPerfTest()
+{
+	// Synthetic wavy grid with a UV seam in the middle, about a million triangles:
+	const uint32_t grid_size = 708;
+	MeshComponent source_mesh;
+	for (uint32_t y = 0; y <= grid_size; ++y)
+	{
+		for (uint32_t x = 0; x <= grid_size; ++x)
+		{
+			const float u = float(x) / float(grid_size);
+			const float v = float(y) / float(grid_size);
+			source_mesh.vertex_positions.push_back(XMFLOAT3(u * 100 - 50, std::sin(u * 40) * std::cos(v * 30), v * 100 - 50));
+			source_mesh.vertex_uvset_0.push_back(XMFLOAT2(u < 0.5f ? u * 2 : u * 2 - 1, v));
+		}
+	}
+	const uint32_t row = grid_size + 1;
+	for (uint32_t y = 0; y < grid_size; ++y)
+	{
+		for (uint32_t x = 0; x < grid_size; ++x)
+		{
+			const uint32_t i0 = y * row + x;
+			const uint32_t i1 = i0 + 1;
+			const uint32_t i2 = i0 + row;
+			const uint32_t i3 = i2 + 1;
+			source_mesh.indices.push_back(i0);
+			source_mesh.indices.push_back(i2);
+			source_mesh.indices.push_back(i1);
+			source_mesh.indices.push_back(i1);
+			source_mesh.indices.push_back(i2);
+			source_mesh.indices.push_back(i3);
+		}
+	}
+	MeshComponent::MeshSubset& subset = source_mesh.subsets.emplace_back();
+	subset.indexOffset = 0;
+	subset.indexCount = (uint32_t)source_mesh.indices.size();
+
+	std::string ss = "MeshComponent::ComputeNormals() with " + std::to_string(source_mesh.indices.size() / 3) + " triangles:\n\n";
+	char text[256];
+
+	const std::pair<MeshComponent::COMPUTE_NORMALS, const char*> modes[] = {
+		{MeshComponent::COMPUTE_NORMALS_HARD, "Hard"},
+		{MeshComponent::COMPUTE_NORMALS_SMOOTH, "Smooth"},
+		{MeshComponent::COMPUTE_NORMALS_SMOOTH_FAST, "Smooth fast"},
+	};
+	for (auto& mode : modes)
+	{
+		MeshComponent mesh;
+		mesh.vertex_positions = source_mesh.vertex_positions;
+		mesh.vertex_uvset_0 = source_mesh.vertex_uvset_0;
+		mesh.indices = source_mesh.indices;
+		mesh.subsets = source_mesh.subsets;
+
+		wi::Timer timer;
+		mesh.ComputeNormals(mode.first);
+		const double elapsed = timer.elapsed_milliseconds();
+
+		snprintf(text, arraysize(text), "%s: %.2f ms, %d vertices\n", mode.second, elapsed, int(mesh.vertex_positions.size()));
+		ss += text;
+	}
+	ss += "\nComputeNormals() also generates the tangents and creates the GPU buffers at the end (CreateRenderData()),\nthe timings include this, so they are higher than the cost of the normal computation alone.";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 24;
+	this->AddFont(&font);
+}
@@ -14,7 +14,14 @@ public:
 	void RunFontTest();
 	void RunSpriteTest();
 	void RunNetworkTest();
+	void NetworkPerfTest();
+	void NetworkReplicationPerfTest();
 	void ContainerTest();
+	void BlockCompressionTest();
+	void FrustumCullingTest();
+	void OcclusionCullingTest();
+	void ParticleSimulationCPUPerfTest();
+	void MeshNormalsPerfTest();
 };
 
 class Tests : public wi::Application
@@ -22,6 +22,7 @@
 #include "wiPlatform.h"
 #include "wiBacklog.h"
 #include "wiPrimitive.h"
+#include "wiOcclusionBuffer.h"
 #include "wiImage.h"
 #include "wiFont.h"
 #include "wiSprite.h"
@@ -61,6 +62,7 @@
 #include "wiGPUSortLib.h"
 #include "wiJobSystem.h"
 #include "wiNetwork.h"
+#include "wiNetworkReplication.h"
 #include "wiEventHandler.h"
 #include "wiShaderCompiler.h"
 #include "wiCanvas.h"
@@ -5,6 +5,8 @@
 #include <mutex>
 #include <string>
 #include <cstdlib>
+#include <atomic>
+#include <algorithm>
 
 std::mutex locker;
 struct ShaderEntry
@@ -357,6 +359,18 @@ wi::vector<Target> targets;
 wi::unordered_map<std::string, wi::shadercompiler::CompilerOutput> results;
 bool rebuild = false;
 bool shaderdump_enabled = false;
+std::string shadercache_directory;
+
+// One compilation task for a shader permutation of a target
+struct Job
+{
+	const ShaderEntry* shader = nullptr;
+	const Target* target = nullptr;
+	ShaderEntry::Permutation permutation;
+	std::string shaderbinaryfilename;
+	wi::shadercompiler::ShaderMetadata metadata;
+	float cost = 0;
+};
 
 using namespace wi::graphics;
 
@@ -374,6 +388,7 @@ int main(int argc, char* argv[])
 	std::cout << "\tdisable_optimization : \tShaders will be compiled without optimizations\n";
 	std::cout << "\tstrip_reflection : \tReflection will be stripped from shader binary to reduce file size\n";
 	std::cout << "\tshaderdump : \t\tShaders will be saved to wiShaderDump.h C++ header file (can be combined with \"rebuild\")\n";
+	std::cout << "\tshadercache=<dir> : \tCompiled shaders will be stored in and reused from a content addressed cache directory, which can be shared between targets and machines\n";
 	std::cout << "Command arguments used: ";
 
 	wi::arguments::Parse(argc, argv);
@@ -416,6 +431,13 @@ int main(int argc, char* argv[])
 		std::cout << "rebuild ";
 	}
 
+	shadercache_directory = wi::arguments::GetArgumentValue("shadercache");
+	if (!shadercache_directory.empty())
+	{
+		wi::helper::MakePathAbsolute(shadercache_directory);
+		std::cout << "shadercache=" << shadercache_directory << " ";
+	}
+
 	if (wi::arguments::HasArgument("disable_optimization"))
 	{
 		compile_flags |= wi::shadercompiler::Flags::DISABLE_OPTIMIZATION;
@@ -494,11 +516,14 @@ int main(int argc, char* argv[])
 	std::cout << "[Wicked Engine Offline Shader Compiler] Searching for outdated shaders...\n";
 	wi::Timer timer;
 	static int errors = 0;
+	static std::atomic<uint32_t> up_to_date_count{ 0 };
+	static std::atomic<uint32_t> cache_hit_count{ 0 };
+	static std::atomic<uint32_t> compiled_count{ 0 };
 
+	wi::vector<Job> jobs;
 	for (auto& target : targets)
 	{
-		std::string SHADERPATH = target.dir;
-		wi::helper::DirectoryCreate(SHADERPATH);
+		wi::helper::DirectoryCreate(target.dir);
 
 		for (auto& shader : shaders)
 		{
@@ -514,110 +539,185 @@ int main(int argc, char* argv[])
 					continue;
 				}
 			}
+			if (shader.minshadermodel > ShaderModel::SM_5_0 && target.format == ShaderFormat::HLSL5)
+			{
+				// if shader format cannot support shader model, then we cancel the task without returning error
+				continue;
+			}
+			if (target.format == ShaderFormat::PS5 && (shader.minshadermodel >= ShaderModel::SM_6_5 || shader.stage == ShaderStage::MS || shader.stage == ShaderStage::AS))
+			{
+				// TODO PS5 raytracing, mesh shader
+				continue;
+			}
+			if (target.format == ShaderFormat::HLSL6_XS && (shader.stage == ShaderStage::MS || shader.stage == ShaderStage::AS))
+			{
+				// TODO Xbox mesh shader
+				continue;
+			}
+
 			wi::vector<ShaderEntry::Permutation> permutations = shader.permutations;
 			if (permutations.empty())
 			{
 				permutations.emplace_back();
 			}
 
-			for (auto permutation : permutations)
+			for (auto& permutation : permutations)
 			{
-				wi::jobsystem::Execute(ctx, [=](wi::jobsystem::JobArgs args) {
-					std::string shaderbinaryfilename = SHADERPATH + shader.name;
-					for (auto& def : permutation.defines)
-					{
-						shaderbinaryfilename += "_" + def;
-					}
-					shaderbinaryfilename += ".cso";
+				Job& job = jobs.emplace_back();
+				job.shader = &shader;
+				job.target = &target;
+				job.permutation = permutation;
+				job.shaderbinaryfilename = target.dir + shader.name;
+				for (auto& def : permutation.defines)
+				{
+					job.shaderbinaryfilename += "_" + def;
+				}
+				job.shaderbinaryfilename += ".cso";
+			}
+		}
+	}
 
-					wi::shadercompiler::CompilerOutput output;
+	// The longest jobs are scheduled first, so that they don't end up as the tail of the build
+	//	The cost is the compile time of the previous compilation, unknown ones are assumed to be the most expensive
+	wi::jobsystem::Dispatch(ctx, (uint32_t)jobs.size(), 64, [&](wi::jobsystem::JobArgs args) {
+		Job& job = jobs[args.jobIndex];
+		wi::shadercompiler::LoadShaderMetadata(job.shaderbinaryfilename, job.metadata);
+		job.cost = job.metadata.compile_time > 0 ? job.metadata.compile_time : std::numeric_limits<float>::max();
+	});
+	wi::jobsystem::Wait(ctx);
+	std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+		return a.cost > b.cost;
+	});
+
+	// Reads a shader that doesn't need to be compiled for the shader dump:
+	auto read_for_shaderdump = [](const std::string& shaderbinaryfilename) {
+		if (!shaderdump_enabled)
+			return;
+		auto vec = std::make_shared<std::vector<uint8_t>>();
+		wi::shadercompiler::CompilerOutput output;
+		if (wi::helper::FileRead(shaderbinaryfilename, *vec))
+		{
+			output.internal_state = vec;
+			output.shaderdata = vec->data();
+			output.shadersize = vec->size();
+			locker.lock();
+			results[shaderbinaryfilename] = output;
+			locker.unlock();
+		}
+		else {
+			locker.lock();
+			std::cerr << "ERROR reading binary shader: " << shaderbinaryfilename << std::endl;
+			locker.unlock();
+		}
+	};
 
-					if (!wi::shadercompiler::IsShaderOutdated(shaderbinaryfilename))
-					{
-						if (!rebuild)
-						{
-							if (shaderdump_enabled)
-							{
-								auto vec = std::make_shared<std::vector<uint8_t>>();
-
-								if (wi::helper::FileRead(shaderbinaryfilename, *vec))
-								{
-									output.internal_state = vec;
-									output.shaderdata = vec->data();
-									output.shadersize = vec->size();
-									locker.lock();
-									results[shaderbinaryfilename] = output;
-									std::cout << "up-to-date: " << shaderbinaryfilename << std::endl;
-									locker.unlock();
-								}
-								else {
-									locker.lock();
-									std::cerr << "ERROR reading binary shader: " << shaderbinaryfilename << std::endl;
-									locker.unlock();
-								}
-							}
-							return;
-						}
-					}
+	for (auto& job : jobs)
+	{
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			const ShaderEntry& shader = *job.shader;
+			const Target& target = *job.target;
+			const std::string& shaderbinaryfilename = job.shaderbinaryfilename;
 
-					wi::shadercompiler::CompilerInput input;
-					input.flags = compile_flags;
-					input.format = target.format;
-					input.stage = shader.stage;
-					input.shadersourcefilename = SHADERSOURCEPATH + shader.name + ".hlsl";
-					input.include_directories.push_back(SHADERSOURCEPATH);
-					input.include_directories.push_back(SHADERSOURCEPATH + wi::helper::GetDirectoryFromPath(shader.name));
-					input.minshadermodel = shader.minshadermodel;
-					input.defines = permutation.defines;
-
-					if (input.minshadermodel > ShaderModel::SM_5_0 && target.format == ShaderFormat::HLSL5)
-					{
-						// if shader format cannot support shader model, then we cancel the task without returning error
-						return;
-					}
-					if (target.format == ShaderFormat::PS5 && (input.minshadermodel >= ShaderModel::SM_6_5 || input.stage == ShaderStage::MS || input.stage == ShaderStage::AS))
-					{
-						// TODO PS5 raytracing, mesh shader
-						return;
-					}
-					if (target.format == ShaderFormat::HLSL6_XS && (input.stage == ShaderStage::MS || input.stage == ShaderStage::AS))
+			if (!rebuild && !wi::shadercompiler::IsShaderOutdated(shaderbinaryfilename))
+			{
+				up_to_date_count.fetch_add(1);
+				if (shaderdump_enabled)
+				{
+					read_for_shaderdump(shaderbinaryfilename);
+					locker.lock();
+					std::cout << "up-to-date: " << shaderbinaryfilename << std::endl;
+					locker.unlock();
+				}
+				return;
+			}
+
+			wi::shadercompiler::CompilerInput input;
+			input.flags = compile_flags;
+			input.format = target.format;
+			input.stage = shader.stage;
+			input.shadersourcefilename = SHADERSOURCEPATH + shader.name + ".hlsl";
+			input.include_directories.push_back(SHADERSOURCEPATH);
+			input.include_directories.push_back(SHADERSOURCEPATH + wi::helper::GetDirectoryFromPath(shader.name));
+			input.minshadermodel = shader.minshadermodel;
+			input.defines = job.permutation.defines;
+
+			// Timestamps can change without content change (for example after checkout), so the content hash decides:
+			wi::vector<std::string> dependencies;
+			const uint64_t input_hash = wi::shadercompiler::ComputeInputHash(input, &dependencies);
+
+			wi::shadercompiler::CompilerOutput output;
+			if (!rebuild && input_hash != 0)
+			{
+				if (job.metadata.input_hash == input_hash && wi::helper::FileExists(shaderbinaryfilename))
+				{
+					wi::helper::FileTouch(shaderbinaryfilename); // so that the timestamp check will be up to date next time
+					up_to_date_count.fetch_add(1);
+					read_for_shaderdump(shaderbinaryfilename);
+					locker.lock();
+					std::cout << "up-to-date (content unchanged): " << shaderbinaryfilename << "\n";
+					locker.unlock();
+					return;
+				}
+				if (!shadercache_directory.empty() && wi::shadercompiler::ShaderCacheRead(shadercache_directory, input_hash, output))
+				{
+					output.dependencies = dependencies;
+					wi::shadercompiler::SaveShaderAndMetadata(shaderbinaryfilename, output);
+					cache_hit_count.fetch_add(1);
+					locker.lock();
+					std::cout << "shader from cache: " << shaderbinaryfilename << "\n";
+					if (shaderdump_enabled)
 					{
-						// TODO Xbox mesh shader
-						return;
+						results[shaderbinaryfilename] = output;
 					}
+					locker.unlock();
+					return;
+				}
+			}
 
-					wi::shadercompiler::Compile(input, output);
+			wi::shadercompiler::Compile(input, output);
 
-					if (output.IsValid())
-					{
-						wi::shadercompiler::SaveShaderAndMetadata(shaderbinaryfilename, output);
-
-						locker.lock();
-						if (!output.error_message.empty())
-						{
-							std::cerr << output.error_message << "\n";
-						}
-						std::cout << "shader compiled: " << shaderbinaryfilename << "\n";
-						if (shaderdump_enabled)
-						{
-							results[shaderbinaryfilename] = output;
-						}
-						locker.unlock();
-					}
-					else
-					{
-						locker.lock();
-						std::cerr << "shader compile FAILED: " << shaderbinaryfilename << "\n" << output.error_message;
-						errors++;
-						locker.unlock();
-					}
+			if (output.IsValid())
+			{
+				output.input_hash = input_hash;
+				wi::shadercompiler::SaveShaderAndMetadata(shaderbinaryfilename, output);
+				if (!shadercache_directory.empty())
+				{
+					wi::shadercompiler::ShaderCacheWrite(shadercache_directory, input_hash, output);
+				}
+				compiled_count.fetch_add(1);
 
-				});
+				locker.lock();
+				if (!output.error_message.empty())
+				{
+					std::cerr << output.error_message << "\n";
+				}
+				std::cout << "shader compiled: " << shaderbinaryfilename << " (" << std::setprecision(3) << output.compile_time << " seconds)\n";
+				if (shaderdump_enabled)
+				{
+					results[shaderbinaryfilename] = output;
+				}
+				locker.unlock();
 			}
-		}
+			else
+			{
+				locker.lock();
+				std::cerr << "shader compile FAILED: " << shaderbinaryfilename << "\n" << output.error_message;
+				errors++;
+				locker.unlock();
+			}
+
+		});
 	}
 	wi::jobsystem::Wait(ctx);
 
+	const uint32_t reused_count = up_to_date_count.load() + cache_hit_count.load();
+	const uint32_t total_count = reused_count + compiled_count.load() + (uint32_t)errors;
+	std::cout << "[Wicked Engine Offline Shader Compiler] " << total_count << " shaders: " << up_to_date_count.load() << " up-to-date, " << cache_hit_count.load() << " from cache, " << compiled_count.load() << " compiled";
+	if (total_count > 0)
+	{
+		std::cout << ", cache hit rate: " << std::setprecision(3) << (100.0 * reused_count / total_count) << "%";
+	}
+	std::cout << "\n";
 	std::cout << "[Wicked Engine Offline Shader Compiler] Finished in " << std::setprecision(4) << timer.elapsed_seconds() << " seconds with " << errors << " errors\n";
 
 	if (shaderdump_enabled)
@@ -38,6 +38,7 @@ static const uint EMITTER_OPTION_BIT_MESH_SHADER_ENABLED = 1 << 2;
 static const uint EMITTER_OPTION_BIT_COLLIDERS_DISABLED = 1 << 3;
 static const uint EMITTER_OPTION_BIT_USE_RAIN_BLOCKER = 1 << 4;
 static const uint EMITTER_OPTION_BIT_TAKE_COLOR_FROM_MESH = 1 << 5;
+static const uint EMITTER_OPTION_BIT_CPU_SIMULATION = 1 << 6;
 
 CBUFFER(EmittedParticleCB, CBSLOT_OTHER_EMITTEDPARTICLE)
 {
@@ -16,6 +16,7 @@ enum IMAGE_FLAGS
 	IMAGE_FLAG_HIGHLIGHT = 1u << 9u,
 	IMAGE_FLAG_CUBEMAP_BASE = 1u << 10u,
 	IMAGE_FLAG_TEXTURE1D_BASE = 1u << 11u,
+	IMAGE_FLAG_INSTANCED = 1u << 12u, // constant buffer only points to an array of ImageConstants with buffer_index and buffer_offset, indexed by SV_InstanceID
 };
 
 struct alignas(16) ImageConstants
@@ -36,8 +36,11 @@ void main(uint3 DTid : SV_DispatchThreadID, uint Gid : SV_GroupIndex)
 	if (DTid.x >= aliveCount)
 		return;
 		
+	// CPU simulated particles are already integrated, they only need the render data to be written:
+	const bool cpu_simulation = xEmitterOptions & EMITTER_OPTION_BIT_CPU_SIMULATION;
+
 	// simulation can be either fixed or variable timestep:
-	const float dt = xEmitterFixedTimestep >= 0 ? xEmitterFixedTimestep : GetFrame().delta_time;
+	const float dt = cpu_simulation ? 0 : (xEmitterFixedTimestep >= 0 ? xEmitterFixedTimestep : GetFrame().delta_time);
 
 	uint particleIndex = aliveBuffer_CURRENT[DTid.x];
 	Particle particle = particleBuffer[particleIndex];
@@ -91,7 +94,8 @@ void main(uint3 DTid : SV_DispatchThreadID, uint Gid : SV_GroupIndex)
 		const bool colliders_disabled = xEmitterOptions & EMITTER_OPTION_BIT_COLLIDERS_DISABLED;
 
 		// process forces and colliders:
-		for (uint i = 0; i < forces().item_count(); ++i)
+		const uint force_count = cpu_simulation ? 0 : forces().item_count();
+		for (uint i = 0; i < force_count; ++i)
 		{
 			ShaderEntity entity = load_entity(forces().first_item() + i);
 
@@ -278,7 +282,7 @@ void main(uint3 DTid : SV_DispatchThreadID, uint Gid : SV_GroupIndex)
 		// Write out render buffers:
 		//	These must be persistent, not culled (raytracing, surfels...)
 
-		float opacity = saturate(lifeOpa * EmitterGetMaterial().GetBaseColor().a);
+		float opacity = cpu_simulation ? 1 : saturate(lifeOpa * EmitterGetMaterial().GetBaseColor().a);
 		float4 particleColor = unpack_rgba(particle.color);
 		particleColor.a *= opacity;
 		
@@ -8,24 +8,37 @@ float Wedge2D(float2 v, float2 w)
 	return v.x * w.y - v.y * w.x;
 }
 
+// Returns the constants of the current image
+//	When images are batched, the constant buffer points to the per instance constants instead
+inline ImageConstants GetImage(uint instanceID)
+{
+	[branch]
+	if (image.flags & IMAGE_FLAG_INSTANCED)
+	{
+		return bindless_buffers[descriptor_index(image.buffer_index)].Load<ImageConstants>(image.buffer_offset + instanceID * sizeof(ImageConstants));
+	}
+	return image;
+}
+
 struct VertextoPixel
 {
 	float4 pos : SV_POSITION;
 	float4 screen : TEXCOORD0;
 	float2 q : TEXCOORD1;
 	float2 edge : TEXCOORD2;
+	nointerpolation uint instanceID : TEXCOORD3;
 
 	float2 uv_screen()
 	{
 		return clipspace_to_uv(screen.xy / screen.w);
 	}
-	float4 compute_uvs()
+	float4 compute_uvs(in ImageConstants img)
 	{
 		float2 uv0;
 		float2 uv1;
 
 		[branch]
-		if (image.flags & IMAGE_FLAG_FULLSCREEN)
+		if (img.flags & IMAGE_FLAG_FULLSCREEN)
 		{
 			uv0 = uv_screen();
 			uv1 = uv0;
@@ -33,9 +46,9 @@ struct VertextoPixel
 		else
 		{
 			// Quad interpolation: http://reedbeta.com/blog/quadrilateral-interpolation-part-2/
-			float2 b1 = image.b1;
-			float2 b2 = image.b2;
-			float2 b3 = image.b3;
+			float2 b1 = img.b1;
+			float2 b2 = img.b2;
+			float2 b3 = img.b3;
 
 			// Set up quadratic formula
 			float A = Wedge2D(b2, b3);
@@ -63,11 +76,11 @@ struct VertextoPixel
 			else
 				uv.x = (q.y - b2.y * uv.y) / denom.y;
 
-			uv0 = mad(uv, image.texMulAdd.xy, image.texMulAdd.zw);
-			uv1 = mad(uv, image.texMulAdd2.xy, image.texMulAdd2.zw);
+			uv0 = mad(uv, img.texMulAdd.xy, img.texMulAdd.zw);
+			uv1 = mad(uv, img.texMulAdd2.xy, img.texMulAdd2.zw);
 		}
 
-		if (image.flags & IMAGE_FLAG_MIRROR)
+		if (img.flags & IMAGE_FLAG_MIRROR)
 		{
 			uv0.x = 1 - uv0.x;
 			uv1.x = 1 - uv1.x;
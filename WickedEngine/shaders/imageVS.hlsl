@@ -8,24 +8,27 @@ static const float2 QUAD_EDGE[] = {
 	float2(1, -1),
 };
 
-VertextoPixel main(uint vI : SV_VertexID)
+VertextoPixel main(uint vI : SV_VertexID, uint instanceID : SV_InstanceID)
 {
+	ImageConstants img = GetImage(instanceID);
+
 	VertextoPixel Out;
 	Out.edge = 0;
+	Out.instanceID = instanceID;
 
 	[branch]
-	if (image.flags & IMAGE_FLAG_FULLSCREEN)
+	if (img.flags & IMAGE_FLAG_FULLSCREEN)
 	{
 		vertexID_create_fullscreen_triangle(vI, Out.pos);
 	}
 	else
 	{
-		Out.pos = bindless_buffers[descriptor_index(image.buffer_index)].Load<float4>(image.buffer_offset + vI * sizeof(float4));
+		Out.pos = bindless_buffers[descriptor_index(img.buffer_index)].Load<float4>(img.buffer_offset + vI * sizeof(float4));
 
 		// Set up inverse bilinear interpolation
-		Out.q = Out.pos.xy - image.b0;
+		Out.q = Out.pos.xy - img.b0;
 
-		if (image.flags & IMAGE_FLAG_CORNER_ROUNDING)
+		if (img.flags & IMAGE_FLAG_CORNER_ROUNDING)
 		{
 			// triangle fan, complex shape; center vertex is not edge, rest are edge:
 			Out.edge = vI == 0 ? 0 : 1;
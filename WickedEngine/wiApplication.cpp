@@ -257,6 +257,9 @@ namespace wi
 
 		Render();
 
+		// All scripts have run for this frame, this is a controlled point for the Lua garbage collection:
+		wi::lua::EndFrame();
+
 		// Begin final compositing:
 		CommandList cmd = graphicsDevice->BeginCommandList();
 
@@ -11,11 +11,12 @@
 // - Thumbnail data [optional] (offset = sizeof(Header), size = header.properties.bits.thumbnail_data_size)
 //		- JPEG compressed image if header.properties.bits.thumbnail_data_size > 0
 // - Data [optionally compressed] (offset = sizeof(Header) + header.properties.bits.thumbnail_data_size, size = remaining)
+//		- if header.properties.bits.chunked (version >= 95), the compressed data is in the wi::helper::CompressChunked() format, otherwise a single zstd frame
 
 namespace wi
 {
 	// this should always be only INCREMENTED and only if a new serialization is implemeted somewhere!
-	static constexpr uint64_t __archiveVersion = 93;
+	static constexpr uint64_t __archiveVersion = 95;
 	// this is the version number of which below the archive is not compatible with the current version
 	static constexpr uint64_t __archiveVersionBarrier = 22;
 
@@ -106,7 +107,14 @@ namespace wi
 				{
 					size_t data_size = data_ptr_size - data_offset;
 					wi::vector<uint8_t> decompressed_part;
-					wi::helper::Decompress(data_ptr + data_offset, data_size, decompressed_part);
+					if (GetVersion() >= 95 && header.properties.bits.chunked)
+					{
+						wi::helper::DecompressChunked(data_ptr + data_offset, data_size, decompressed_part);
+					}
+					else
+					{
+						wi::helper::Decompress(data_ptr + data_offset, data_size, decompressed_part);
+					}
 					wi::vector<uint8_t> final_data(data_offset + decompressed_part.size());
 					size_t _offset = 0;
 					std::memcpy(final_data.data() + _offset, &header, sizeof(Header));
@@ -246,6 +254,34 @@ namespace wi
 		return archive.CreateThumbnailTexture();
 	}
 
+	Archive Archive::CreateReadView(size_t pos) const
+	{
+		Archive view;
+		view.DATA.clear();
+		view.header = header;
+		view.readMode = true;
+		view.pos = pos;
+		view.data_ptr = data_ptr;
+		view.data_ptr_size = data_ptr_size;
+		view.data_already_decompressed = true;
+		view.fileName = fileName;
+		view.directory = directory;
+		return view;
+	}
+
+	Archive Archive::CreateRawReadView(const uint8_t* data, size_t size)
+	{
+		Archive view;
+		view.DATA.clear();
+		view.header.version = __archiveVersion;
+		view.readMode = true;
+		view.pos = 0;
+		view.data_ptr = data;
+		view.data_ptr_size = size;
+		view.data_already_decompressed = true;
+		return view;
+	}
+
 	void Archive::WriteData(wi::vector<uint8_t>& dest) const
 	{
 		if (IsCompressionEnabled())
@@ -263,12 +299,20 @@ namespace wi
 	{
 		Header _header = header;
 		_header.properties.bits.compressed = 1; // force write compressed header
+		_header.properties.bits.chunked = _header.version >= 95 ? 1 : 0; // readers of older versions only know the single frame format
 		size_t data_offset = 0;
 		data_offset += sizeof(Header);
 		data_offset += _header.properties.bits.thumbnail_data_size;
 		size_t data_size = pos - data_offset;
 		wi::vector<uint8_t> compressed_part;
-		wi::helper::Compress(data_ptr + data_offset, data_size, compressed_part, 9);
+		if (_header.properties.bits.chunked)
+		{
+			wi::helper::CompressChunked(data_ptr + data_offset, data_size, compressed_part, 9);
+		}
+		else
+		{
+			wi::helper::Compress(data_ptr + data_offset, data_size, compressed_part, 9);
+		}
 		final_data.resize(data_offset + compressed_part.size());
 		size_t _offset = 0;
 		std::memcpy(final_data.data() + _offset, &_header, sizeof(Header));
@@ -25,7 +25,8 @@ namespace wi
 				{
 					uint64_t thumbnail_data_size : 32;
 					uint64_t compressed : 1;
-					uint64_t reserved : 31;
+					uint64_t chunked : 1; // compressed data is stored in independent chunks that can be decompressed in parallel (only used since version 95)
+					uint64_t reserved : 30;
 				} bits;
 				uint64_t raw = 0;
 			} properties;
@@ -67,6 +68,16 @@ namespace wi
 		Archive& operator=(const Archive&) = default;
 		Archive& operator=(Archive&&) = default;
 
+		// Creates an archive in read mode that refers to the same data as this archive, but has its own position
+		//	The data is not copied, so the view must not outlive this archive
+		//	This can be used to read different parts of the archive from multiple threads
+		Archive CreateReadView(size_t pos) const;
+
+		// Creates an archive in read mode over data that has no archive header, the current archive version is assumed
+		//	The data is not copied, so it must remain valid while the view is used
+		//	This can be used to read data that was written by an archive of the same engine version, like components sent over the network
+		static Archive CreateRawReadView(const uint8_t* data, size_t size);
+
 		void WriteData(wi::vector<uint8_t>& dest) const;
 		const uint8_t* GetData() const { return data_ptr; }
 		const size_t GetSize() const { return data_ptr_size; }
@@ -99,6 +110,7 @@ namespace wi
 
 		// Set whether the archive should be compressed upon saving
 		//	Note that in memory, the archive is uncompressed
+		//	The data is compressed in chunks in parallel, archives compressed as one block by older versions can still be read
 		//	Note that compressed archive will not work with streaming!
 		constexpr void SetCompressionEnabled(bool value) { header.properties.bits.compressed = value; }
 		// Returns true if the archive data is originating from compressed data
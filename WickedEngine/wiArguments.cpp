@@ -37,4 +37,17 @@ namespace wi::arguments
 	{
 		return params.find(value) != params.end();
 	}
+
+	std::string GetArgumentValue(const std::string& name)
+	{
+		const std::string prefix = name + "=";
+		for (auto& x : params)
+		{
+			if (x.compare(0, prefix.length(), prefix) == 0)
+			{
+				return x.substr(prefix.length());
+			}
+		}
+		return "";
+	}
 }
@@ -8,4 +8,6 @@ namespace wi::arguments
 	void Parse(const wchar_t* args);
     void Parse(int argc, char *argv[]);
 	bool HasArgument(const std::string& value);
+	// Returns the value of an argument that was given in the form name=value, or empty string if there is no such argument
+	std::string GetArgumentValue(const std::string& name);
 }
@@ -117,6 +117,26 @@ namespace wi
 			}
 		}
 
+		// Update the node bounds after the leaf AABBs were modified, without changing the tree structure
+		//	This is much faster than Build(), but the tree quality gets worse if the leaves move a lot relative to each other
+		//	The leaf AABB count must be the same that the BVH was built with
+		void Refit(const wi::primitive::AABB* leaf_aabb_data)
+		{
+			// Child nodes are always created after their parent, so iterating backwards processes the children first:
+			for (uint32_t i = node_count; i > 0; --i)
+			{
+				Node& node = nodes[i - 1];
+				if (node.isLeaf())
+				{
+					UpdateNodeBounds(i - 1, leaf_aabb_data);
+				}
+				else
+				{
+					node.aabb = wi::primitive::AABB::Merge(nodes[node.left].aabb, nodes[node.left + 1].aabb);
+				}
+			}
+		}
+
 		template <typename T>
 		void Intersects(
 			const T& primitive,
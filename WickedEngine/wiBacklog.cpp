@@ -15,6 +15,11 @@
 #include <deque>
 #include <limits>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <cstring>
 
 using namespace wi::graphics;
 using namespace std::chrono_literals;
@@ -42,18 +47,243 @@ namespace wi::backlog
 
 	bool locked = false;
 	bool blockLuaExec = false;
-	LogLevel logLevel = LogLevel::Default;
+	std::atomic<LogLevel> logLevel{ LogLevel::Default };
 	LogLevel unseen = LogLevel::None;
 
 	std::deque<LogEntry> history;
 	std::mutex historyLock;
 
+	// Messages are not written to the backlog directly by the posting threads:
+	//	Each thread owns a single producer, single consumer ring buffer, that is pushed to without locking
+	//	A single consumer (the logger thread) drains the rings in posting order to the console, the backlog entries and the log file
+	struct Message
+	{
+		uint64_t sequence = 0;
+		LogLevel level = LogLevel::Default;
+		std::string text; // capacity is retained between uses of the ring slot
+		DeferredFormatter formatter = nullptr; // if set, the text will be formatted by the consumer
+		const char* format = nullptr;
+		uint64_t args[deferred_arg_capacity] = {};
+	};
+	struct ThreadQueue
+	{
+		static constexpr uint32_t capacity = 256; // must be power of two
+		Message messages[capacity];
+		std::atomic<uint32_t> head{ 0 }; // written by producer thread
+		std::atomic<uint32_t> tail{ 0 }; // written by consumer
+		std::atomic_bool retired{ false }; // set when the producer thread exits, the consumer frees the queue after it was drained
+	};
+
+	// Threads can exit after the internal state was destroyed at application exit (for example job system workers), they must not touch it after that:
+	std::atomic_bool internal_state_destroyed{ false };
+
 	struct InternalState
 	{
 		// These must have common lifetime and destruction order, so keep them together in a struct:
 		std::deque<LogEntry> entries;
 		std::mutex entriesLock;
 
+		wi::vector<std::unique_ptr<ThreadQueue>> queues;
+		std::mutex queuesLock; // only for registering new thread queues and overflow
+		std::deque<Message> overflow; // used when a thread queue is full, guarded by queuesLock
+		std::atomic<uint64_t> sequence{ 0 };
+
+		std::mutex drainLock; // ensures that there is only a single consumer at a time
+		wi::vector<Message> drained;
+		std::atomic_bool signaled{ false };
+		std::atomic_bool exiting{ false };
+		std::mutex signalLock;
+		std::condition_variable signal;
+		std::thread consumer;
+
+		ThreadQueue* getThreadQueue()
+		{
+			// The owner retires the queue of the thread when the thread exits:
+			struct ThreadQueueOwner
+			{
+				ThreadQueue* queue = nullptr;
+				~ThreadQueueOwner()
+				{
+					if (queue != nullptr && !internal_state_destroyed.load())
+					{
+						queue->retired.store(true, std::memory_order_release);
+						queue = nullptr;
+					}
+				}
+			};
+			thread_local ThreadQueueOwner owner;
+			ThreadQueue*& queue = owner.queue;
+			if (queue == nullptr)
+			{
+				std::scoped_lock lck(queuesLock);
+				queues.push_back(std::make_unique<ThreadQueue>());
+				queue = queues.back().get();
+				if (!consumer.joinable() && !exiting.load())
+				{
+					consumer = std::thread([this] {
+						while (!exiting.load(std::memory_order_relaxed))
+						{
+							{
+								std::unique_lock lck(signalLock);
+								signal.wait_for(lck, 100ms, [this] { return signaled.load() || exiting.load(); });
+							}
+							drain();
+						}
+					});
+				}
+			}
+			return queue;
+		}
+
+		// Producer side: no locks and no allocations in the common case
+		template<typename F>
+		void push(LogLevel level, F&& fill)
+		{
+			ThreadQueue* queue = getThreadQueue();
+			const uint32_t head = queue->head.load(std::memory_order_relaxed);
+			if (head - queue->tail.load(std::memory_order_acquire) < ThreadQueue::capacity)
+			{
+				Message& message = queue->messages[head & (ThreadQueue::capacity - 1)];
+				message.sequence = sequence.fetch_add(1, std::memory_order_relaxed);
+				message.level = level;
+				fill(message);
+				queue->head.store(head + 1, std::memory_order_release);
+			}
+			else
+			{
+				// The consumer is behind, fall back to the locked overflow queue instead of losing messages:
+				std::scoped_lock lck(queuesLock);
+				Message& message = overflow.emplace_back();
+				message.sequence = sequence.fetch_add(1, std::memory_order_relaxed);
+				message.level = level;
+				fill(message);
+			}
+			if (!signaled.exchange(true, std::memory_order_acq_rel))
+			{
+				signal.notify_one();
+			}
+		}
+
+		// Consumer side: can be called from any thread, but only one of them will drain at a time
+		void drain()
+		{
+			thread_local bool draining = false;
+			if (draining)
+				return; // messages posted while draining (on the same thread) will be picked up by the next drain
+			draining = true;
+			drainMessages();
+			draining = false;
+		}
+		void drainMessages()
+		{
+			std::scoped_lock lck(drainLock);
+			signaled.store(false);
+
+			drained.clear();
+			{
+				std::scoped_lock lck_queues(queuesLock);
+				for (auto& queue : queues)
+				{
+					const uint32_t tail = queue->tail.load(std::memory_order_relaxed);
+					const uint32_t head = queue->head.load(std::memory_order_acquire);
+					for (uint32_t i = tail; i != head; ++i)
+					{
+						Message& src = queue->messages[i & (ThreadQueue::capacity - 1)];
+						Message& dst = drained.emplace_back();
+						dst.sequence = src.sequence;
+						dst.level = src.level;
+						dst.formatter = src.formatter;
+						if (src.formatter == nullptr)
+						{
+							dst.text = src.text; // copy, to retain capacity in the ring slot
+						}
+						else
+						{
+							dst.format = src.format;
+							std::memcpy(dst.args, src.args, sizeof(src.args));
+						}
+					}
+					queue->tail.store(head, std::memory_order_release);
+				}
+				for (auto& message : overflow)
+				{
+					drained.push_back(std::move(message));
+				}
+				overflow.clear();
+
+				// Free the queues of exited threads once they are empty:
+				queues.erase(std::remove_if(queues.begin(), queues.end(), [](const std::unique_ptr<ThreadQueue>& queue) {
+					return queue->retired.load(std::memory_order_acquire) && queue->tail.load(std::memory_order_relaxed) == queue->head.load(std::memory_order_acquire);
+				}), queues.end());
+			}
+			if (drained.empty())
+				return;
+
+			std::sort(drained.begin(), drained.end(), [](const Message& a, const Message& b) {
+				return a.sequence < b.sequence;
+			});
+
+			bool error = false;
+			for (auto& message : drained)
+			{
+				std::string str;
+				switch (message.level)
+				{
+				default:
+				case LogLevel::Default:
+					break;
+				case LogLevel::Warning:
+					str = "[Warning] ";
+					break;
+				case LogLevel::Error:
+					str = "[Error] ";
+					error = true;
+					break;
+				}
+				if (message.formatter != nullptr)
+				{
+					message.formatter(str, message.format, message.args);
+				}
+				else
+				{
+					str += message.text;
+				}
+				str += '\n';
+
+				switch (message.level)
+				{
+				default:
+				case LogLevel::Default:
+					wi::helper::DebugOut(str, wi::helper::DebugLevel::Normal);
+					break;
+				case LogLevel::Warning:
+					wi::helper::DebugOut(str, wi::helper::DebugLevel::Warning);
+					break;
+				case LogLevel::Error:
+					wi::helper::DebugOut(str, wi::helper::DebugLevel::Error);
+					break;
+				}
+
+				unseen = std::max(unseen, message.level);
+
+				LogEntry entry;
+				entry.text = std::move(str);
+				entry.level = message.level;
+				std::scoped_lock lck_entries(entriesLock);
+				entries.push_back(std::move(entry));
+				if (entries.size() > deletefromline)
+				{
+					entries.pop_front();
+				}
+			}
+			refitscroll = true;
+
+			if (error)
+			{
+				writeLogfile();
+			}
+		}
+
 		std::string getText()
 		{
 			std::scoped_lock lck(entriesLock);
@@ -75,6 +305,17 @@ namespace wi::backlog
 
 		~InternalState()
 		{
+			{
+				std::scoped_lock lck(queuesLock);
+				exiting.store(true);
+			}
+			internal_state_destroyed.store(true);
+			signal.notify_one();
+			if (consumer.joinable())
+			{
+				consumer.join();
+			}
+			drain();
 			// The object will automatically write out the backlog to the temp folder when it's destroyed
 			//	Should happen on application exit
 			writeLogfile();
@@ -318,6 +559,7 @@ namespace wi::backlog
 
 		static std::deque<LogEntry> entriesCopy;
 
+		internal_state.drain();
 		internal_state.entriesLock.lock();
 		// Force copy because drawing text while locking is not safe because an error inside might try to lock again!
 		entriesCopy = internal_state.entries;
@@ -345,76 +587,56 @@ namespace wi::backlog
 
 	std::string getText()
 	{
+		internal_state.drain();
 		return internal_state.getText();
 	}
 	void clear()
 	{
+		internal_state.drain();
 		std::scoped_lock lck(internal_state.entriesLock);
 		internal_state.entries.clear();
 		scroll = 0;
 	}
 	void post(const char* input, LogLevel level)
 	{
-		if (logLevel > level)
+		if (!IsLogLevelEnabled(level))
 		{
 			return;
 		}
 
-		std::string str;
-		switch (level)
-		{
-		default:
-		case LogLevel::Default:
-			str = "";
-			break;
-		case LogLevel::Warning:
-			str = "[Warning] ";
-			break;
-		case LogLevel::Error:
-			str = "[Error] ";
-			break;
-		}
-		str += input;
-		str += '\n';
-		LogEntry entry;
-		entry.text = str;
-		entry.level = level;
+		internal_state.push(level, [input](Message& message) {
+			message.formatter = nullptr;
+			message.text.assign(input);
+		});
 
-		internal_state.entriesLock.lock();
-		internal_state.entries.push_back(entry);
-		if (internal_state.entries.size() > deletefromline)
+		if (level >= LogLevel::Error)
 		{
-			internal_state.entries.pop_front();
+			internal_state.drain(); // errors are written to the log file immediately, in case the application crashes
 		}
-		internal_state.entriesLock.unlock();
-
-		refitscroll = true;
+	}
 
-		switch (level)
-		{
-		default:
-		case LogLevel::Default:
-			wi::helper::DebugOut(str, wi::helper::DebugLevel::Normal);
-			break;
-		case LogLevel::Warning:
-			wi::helper::DebugOut(str, wi::helper::DebugLevel::Warning);
-			break;
-		case LogLevel::Error:
-			wi::helper::DebugOut(str, wi::helper::DebugLevel::Error);
-			break;
-		}
+	void post(const std::string& input, LogLevel level)
+	{
+		post(input.c_str(), level);
+	}
 
-		unseen = std::max(unseen, level);
+	void post_deferred(LogLevel level, DeferredFormatter formatter, const char* format, const uint64_t* args, size_t arg_count)
+	{
+		internal_state.push(level, [=](Message& message) {
+			message.formatter = formatter;
+			message.format = format;
+			std::memcpy(message.args, args, sizeof(uint64_t) * std::min(arg_count, deferred_arg_capacity));
+		});
 
 		if (level >= LogLevel::Error)
 		{
-			internal_state.writeLogfile();  // will lock mutex
+			internal_state.drain();
 		}
 	}
 
-	void post(const std::string& input, LogLevel level)
+	void flush()
 	{
-		post(input.c_str(), level);
+		internal_state.drain();
 	}
 
 	void historyPrev()
@@ -484,7 +706,11 @@ namespace wi::backlog
 
 	void SetLogLevel(LogLevel newLevel)
 	{
-		logLevel = newLevel;
+		logLevel.store(newLevel, std::memory_order_relaxed);
+	}
+	bool IsLogLevelEnabled(LogLevel level)
+	{
+		return logLevel.load(std::memory_order_relaxed) <= level;
 	}
 
 	LogLevel GetUnseenLogLevelMax()
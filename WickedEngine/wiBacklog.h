@@ -7,13 +7,20 @@
 
 #include <string>
 #include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <utility>
+#include <type_traits>
 
-#define wilog_level(str,level,...) {char text[1024]; snprintf(text, sizeof(text), str, ## __VA_ARGS__); wi::backlog::post(text, level);}
+// The log level is checked before formatting, so disabled log levels don't pay for string formatting:
+#define wilog_level(str,level,...) {if(wi::backlog::IsLogLevelEnabled(level)){char text[1024]; snprintf(text, sizeof(text), str, ## __VA_ARGS__); wi::backlog::post(text, level);}}
 #define wilog_messagebox(str,...) {char text[1024]; snprintf(text, sizeof(text), str, ## __VA_ARGS__); wi::backlog::post(text, wi::backlog::LogLevel::Error); wi::helper::messageBox(text, "Error!");}
 #define wilog_warning(str,...) {wilog_level(str, wi::backlog::LogLevel::Warning, ## __VA_ARGS__);}
 #define wilog_error(str,...) {wilog_level(str, wi::backlog::LogLevel::Error, ## __VA_ARGS__);}
 #define wilog(str,...) {wilog_level(str, wi::backlog::LogLevel::Default, ## __VA_ARGS__);}
 #define wilog_assert(cond,str,...) {if(!(cond)){wilog_error(str, ## __VA_ARGS__); assert(cond);}}
+// Deferred formatting variant: arguments are copied and formatting happens on the logging thread (see wi::backlog::postf())
+#define wilog_deferred(str,level,...) {wi::backlog::postf(level, str, ## __VA_ARGS__);}
 
 namespace wi::backlog
 {
@@ -40,11 +47,65 @@ namespace wi::backlog
 		wi::graphics::ColorSpace colorspace = wi::graphics::ColorSpace::SRGB
 	);
 
+	// Returns true if messages with the specified level will be logged with the current log level
+	bool IsLogLevelEnabled(LogLevel level);
+
 	std::string getText();
 	void clear();
+
+	// Posting is lock-free: the message is pushed to a ring buffer of the calling thread,
+	//	and it is written to the console, the backlog and the log file by a single logger thread
+	//	Errors are processed immediately, before returning
 	void post(const char* input, LogLevel level = LogLevel::Default);
 	void post(const std::string& input, LogLevel level = LogLevel::Default);
 
+	// Wait until all the messages that were posted so far are processed
+	void flush();
+
+	static constexpr size_t deferred_arg_capacity = 8;
+	using DeferredFormatter = void(*)(std::string& dst, const char* format, const uint64_t* args);
+	void post_deferred(LogLevel level, DeferredFormatter formatter, const char* format, const uint64_t* args, size_t arg_count);
+
+	namespace detail
+	{
+		template<typename T>
+		inline T unpack_arg(uint64_t value)
+		{
+			T ret;
+			std::memcpy(&ret, &value, sizeof(T));
+			return ret;
+		}
+		template<typename... Args, size_t... I>
+		inline void format_deferred(std::string& dst, const char* format, const uint64_t* args, std::index_sequence<I...>)
+		{
+			char text[1024];
+			snprintf(text, sizeof(text), format, unpack_arg<Args>(args[I])...);
+			dst += text;
+		}
+		template<typename... Args>
+		inline void format_deferred(std::string& dst, const char* format, const uint64_t* args)
+		{
+			format_deferred<Args...>(dst, format, args, std::index_sequence_for<Args...>{});
+		}
+	}
+
+	// Post a printf-style message with deferred formatting: only the arguments are copied on the calling thread,
+	//	the string formatting is done later by the logger thread
+	//	The format string and const char* arguments must remain valid until processed (for example string literals)
+	//	Arguments must be arithmetic types or pointers, at most deferred_arg_capacity of them
+	template<typename... Args>
+	inline void postf(LogLevel level, const char* format, Args... args)
+	{
+		static_assert(sizeof...(Args) <= deferred_arg_capacity, "Too many arguments for deferred formatting!");
+		static_assert(((std::is_arithmetic_v<Args> || std::is_pointer_v<Args>) && ...), "Deferred formatting only supports arithmetic and pointer arguments!");
+		if (!IsLogLevelEnabled(level))
+			return;
+		uint64_t packed[deferred_arg_capacity + 1] = {};
+		size_t i = 0;
+		((std::memcpy(&packed[i++], &args, sizeof(Args))), ...);
+		post_deferred(level, &detail::format_deferred<Args...>, format, packed, sizeof...(Args));
+	}
+
 	void historyPrev();
 	void historyNext();
 
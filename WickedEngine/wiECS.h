@@ -3,6 +3,7 @@
 
 #include "wiArchive.h"
 #include "wiJobSystem.h"
+#include "wiSpinLock.h"
 #include "wiUnorderedMap.h"
 #include "wiUnorderedSet.h"
 #include "wiVector.h"
@@ -10,6 +11,8 @@
 #include <cstdint>
 #include <cassert>
 #include <atomic>
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -41,6 +44,46 @@ namespace wi::ecs
 		ComponentLibrary* componentlibrary = nullptr;
 		wi::unordered_map<std::string, uint64_t> library_versions;
 
+		// Entity remapping that is shared by multiple EntitySerializers which are used in parallel
+		//	It is partitioned by the serialized entity, so that threads rarely need to wait for each other
+		struct SharedRemap
+		{
+			static constexpr size_t partition_count = 64;
+			struct Partition
+			{
+				wi::SpinLock locker;
+				wi::unordered_map<uint64_t, Entity> remap;
+			};
+			Partition partitions[partition_count];
+
+			// Returns the remapped entity, a new one is created if it wasn't remapped before
+			Entity Remap(uint64_t mem)
+			{
+				Partition& partition = partitions[mem % partition_count];
+				partition.locker.lock();
+				auto it = partition.remap.find(mem);
+				Entity entity = INVALID_ENTITY;
+				if (it == partition.remap.end())
+				{
+					entity = CreateEntity();
+					partition.remap[mem] = entity;
+				}
+				else
+				{
+					entity = it->second;
+				}
+				partition.locker.unlock();
+				return entity;
+			}
+		};
+		SharedRemap* shared_remap = nullptr; // if not null, new remappings are looked up from here, and the local remap is just a cache
+
+		// Partial serialization:
+		const wi::unordered_set<std::string>* component_filter = nullptr; // reading: if not null, ComponentLibrary only reads the component managers with these names, the others are skipped without parsing
+		std::function<uint64_t(Entity)> spatial_index; // writing: if set, ComponentLibrary writes a spatial index of the components, this returns the spatial cell of an entity (~0ull means no cell)
+		std::function<bool(uint64_t)> spatial_filter; // reading: if set, ComponentLibrary only reads the components whose spatial cell passes the filter (if the archive has a spatial index)
+		wi::vector<uint64_t>* component_offsets = nullptr; // writing: if not null, the next ComponentManager::Serialize() records the archive position of every component here, followed by the position of the entity array
+
 		~EntitySerializer()
 		{
 			wi::jobsystem::Wait(ctx); // automatically wait for all subtasks after serialization
@@ -83,7 +126,7 @@ namespace wi::ecs
 				auto it = seri.remap.find(mem);
 				if (it == seri.remap.end())
 				{
-					entity = CreateEntity();
+					entity = seri.shared_remap == nullptr ? CreateEntity() : seri.shared_remap->Remap(mem);
 					seri.remap[mem] = entity;
 				}
 				else
@@ -121,6 +164,7 @@ namespace wi::ecs
 		virtual void Merge(ComponentManager_Interface& other) = 0;
 		virtual void Clear() = 0;
 		virtual void Serialize(wi::Archive& archive, EntitySerializer& seri) = 0;
+		virtual void Serialize_Partial(wi::Archive& archive, EntitySerializer& seri, const wi::vector<uint64_t>& offsets, const wi::vector<bool>& selected) = 0;
 		virtual void Component_Serialize(Entity entity, wi::Archive& archive, EntitySerializer& seri) = 0;
 		virtual void Remove(Entity entity) = 0;
 		virtual void Remove_KeepSorted(Entity entity) = 0;
@@ -235,11 +279,26 @@ namespace wi::ecs
 			}
 			else
 			{
+				wi::vector<uint64_t>* offsets = seri.component_offsets;
+				seri.component_offsets = nullptr; // only this component manager will record offsets, not the ones that might be serialized from within components
+				if (offsets != nullptr)
+				{
+					offsets->clear();
+					offsets->reserve(components.size() + 1);
+				}
 				archive << components.size();
 				for (Component& component : components)
 				{
+					if (offsets != nullptr)
+					{
+						offsets->push_back(archive.GetPos());
+					}
 					component.Serialize(archive, seri);
 				}
+				if (offsets != nullptr)
+				{
+					offsets->push_back(archive.GetPos());
+				}
 				for (Entity entity : entities)
 				{
 					SerializeEntity(archive, entity, seri);
@@ -247,6 +306,42 @@ namespace wi::ecs
 			}
 		}
 
+		// Read only the selected components from an archive that was written by Serialize() while recording component offsets
+		//	offsets		: archive position of every component, followed by the archive position of the entity array
+		//	selected	: which components to read, the others are skipped without parsing them
+		inline void Serialize_Partial(wi::Archive& archive, EntitySerializer& seri, const wi::vector<uint64_t>& offsets, const wi::vector<bool>& selected)
+		{
+			assert(archive.IsReadMode());
+			if (offsets.size() != selected.size() + 1)
+			{
+				// Index doesn't match, read everything:
+				Serialize(archive, seri);
+				return;
+			}
+
+			const size_t prev_count = components.size();
+			const size_t count = (size_t)std::count(selected.begin(), selected.end(), true);
+			components.resize(prev_count + count);
+			entities.resize(prev_count + count);
+
+			size_t index = prev_count;
+			for (size_t i = 0; i < selected.size(); ++i)
+			{
+				if (!selected[i])
+					continue;
+				archive.Jump(offsets[i]);
+				components[index].Serialize(archive, seri);
+
+				// Entities are always serialized as uint64_t, so the entity of this component can be found directly:
+				archive.Jump(offsets.back() + i * sizeof(uint64_t));
+				Entity entity;
+				SerializeEntity(archive, entity, seri);
+				entities[index] = entity;
+				lookup[entity] = index;
+				index++;
+			}
+		}
+
 		//Read one single component onto an archive, make sure entity are serialized first
 		inline void Component_Serialize(Entity entity, wi::Archive& archive, EntitySerializer& seri)
 		{
@@ -519,16 +614,25 @@ namespace wi::ecs
 		}
 
 		// Serialize all registered component managers
+		//	When reading, the component managers are read in parallel with wi::jobsystem
 		inline void Serialize(wi::Archive& archive, EntitySerializer& seri)
 		{
 			seri.componentlibrary = this;
 			if(archive.IsReadMode())
 			{
 				bool has_next = false;
-				size_t begin = archive.GetPos();
 
-				// First pass, gather component type versions and jump over all data:
+				// First pass, gather component type versions and the table of contents by jumping over all data:
 				//	This is so that we can look up other component versions within component serialization if needed
+				//	Component managers of names that are not registered are skipped
+				struct Section
+				{
+					ComponentManager_Interface* component_manager = nullptr;
+					uint64_t version = 0;
+					size_t pos = 0; // start of component manager data
+					uint64_t spatial_index_pos = 0; // start of spatial index, 0 if there is none
+				};
+				wi::vector<Section> sections;
 				do
 				{
 					archive >> has_next;
@@ -541,41 +645,83 @@ namespace wi::ecs
 						auto it = entries.find(name);
 						if (it != entries.end())
 						{
-							archive >> seri.version;
-							seri.library_versions[name] = seri.version;
+							Section section;
+							section.component_manager = it->second.component_manager.get();
+							archive >> section.version;
+							seri.library_versions[name] = section.version;
+							if (archive.GetVersion() >= 94)
+							{
+								bool has_spatial_index = false;
+								archive >> has_spatial_index;
+								if (has_spatial_index)
+								{
+									archive >> section.spatial_index_pos;
+								}
+							}
+							section.pos = archive.GetPos();
+							if (seri.component_filter == nullptr || seri.component_filter->count(name) > 0)
+							{
+								sections.push_back(section);
+							}
 						}
 						archive.Jump(jump_pos);
 					}
 				} while (has_next);
-
-				// Jump back to beginning of component library data
-				archive.Jump(begin);
+				const size_t end = archive.GetPos();
 
 				// Second pass, read all component data:
 				//	At this point, all existing component type versions are available
-				do
+				//	Every component manager is read from its own view of the archive and with its own serializer,
+				//	entity remapping is shared between them
+				EntitySerializer::SharedRemap shared_remap;
+				for (auto& x : seri.remap)
 				{
-					archive >> has_next;
-					if(has_next)
+					shared_remap.partitions[x.first % EntitySerializer::SharedRemap::partition_count].remap[x.first] = x.second;
+				}
+				std::unique_ptr<EntitySerializer[]> section_seris = std::make_unique<EntitySerializer[]>(sections.size());
+				wi::jobsystem::context ctx;
+				ctx.priority = seri.ctx.priority;
+				wi::jobsystem::Dispatch(ctx, (uint32_t)sections.size(), 1, [&](wi::jobsystem::JobArgs args) {
+					const Section& section = sections[args.jobIndex];
+					EntitySerializer& section_seri = section_seris[args.jobIndex];
+					section_seri.ctx.priority = seri.ctx.priority;
+					section_seri.allow_remap = seri.allow_remap;
+					section_seri.version = section.version;
+					section_seri.componentlibrary = this;
+					section_seri.library_versions = seri.library_versions;
+					section_seri.shared_remap = &shared_remap;
+					wi::Archive section_archive = archive.CreateReadView(section.pos);
+					if (section.spatial_index_pos > 0 && seri.spatial_filter)
 					{
-						std::string name;
-						archive >> name;
-						uint64_t jump_pos = 0;
-						archive >> jump_pos;
-						auto it = entries.find(name);
-						if(it != entries.end())
+						wi::vector<uint64_t> offsets;
+						wi::vector<uint64_t> cells;
+						wi::Archive index_archive = archive.CreateReadView(section.spatial_index_pos);
+						index_archive >> offsets;
+						index_archive >> cells;
+						wi::vector<bool> selected(cells.size());
+						for (size_t i = 0; i < cells.size(); ++i)
 						{
-							archive >> seri.version;
-							it->second.component_manager->Serialize(archive, seri);
-						}
-						else
-						{
-							// component manager of this name was not registered, skip serialization by jumping over the data
-							archive.Jump(jump_pos);
+							selected[i] = seri.spatial_filter(cells[i]);
 						}
+						section.component_manager->Serialize_Partial(section_archive, section_seri, offsets, selected);
+					}
+					else
+					{
+						section.component_manager->Serialize(section_archive, section_seri);
 					}
+				});
+				wi::jobsystem::Wait(ctx);
+
+				for (size_t i = 0; i < sections.size(); ++i)
+				{
+					wi::jobsystem::Wait(section_seris[i].ctx);
+					seri.resource_registration.insert(section_seris[i].resource_registration.begin(), section_seris[i].resource_registration.end());
 				}
-				while(has_next);
+				for (auto& partition : shared_remap.partitions)
+				{
+					seri.remap.insert(partition.remap.begin(), partition.remap.end());
+				}
+				archive.Jump(end);
 			}
 			else
 			{
@@ -592,7 +738,29 @@ namespace wi::ecs
 					size_t offset = archive.WriteUnknownJumpPosition(); // we will be able to jump from here...
 					archive << it.second.version;
 					seri.version = it.second.version;
-					it.second.component_manager->Serialize(archive, seri);
+					const bool has_spatial_index = bool(seri.spatial_index);
+					archive << has_spatial_index;
+					if (has_spatial_index)
+					{
+						// The spatial index is written after the component data, the position of the component data is recorded for it:
+						size_t spatial_index_offset = archive.WriteUnknownJumpPosition();
+						wi::vector<uint64_t> offsets;
+						seri.component_offsets = &offsets;
+						it.second.component_manager->Serialize(archive, seri);
+						seri.component_offsets = nullptr;
+						archive.PatchUnknownJumpPosition(spatial_index_offset);
+						wi::vector<uint64_t> cells(it.second.component_manager->GetCount());
+						for (size_t i = 0; i < cells.size(); ++i)
+						{
+							cells[i] = seri.spatial_index(it.second.component_manager->GetEntity(i));
+						}
+						archive << offsets;
+						archive << cells;
+					}
+					else
+					{
+						it.second.component_manager->Serialize(archive, seri);
+					}
 					archive.PatchUnknownJumpPosition(offset); // ...to here, if this component manager was not registered
 				}
 				archive << false;
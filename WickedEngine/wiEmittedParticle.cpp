@@ -11,6 +11,7 @@
 #include "wiBacklog.h"
 #include "wiEventHandler.h"
 #include "wiTimer.h"
+#include "wiJobSystem.h"
 #include "wiVector.h"
 
 #include <algorithm>
@@ -48,6 +49,38 @@ namespace wi
 
 	static bool ALLOW_MESH_SHADER = false;
 
+	// SIMD helpers for the CPU simulation, 8-wide with AVX2 or 4-wide DirectXMath fallback (SSE or NEON):
+#ifdef _XM_AVX2_INTRINSICS_
+	using simd_float = __m256;
+	static constexpr uint32_t simd_width = 8;
+	static inline simd_float simd_load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+	static inline void simd_store(float* ptr, simd_float v) { _mm256_storeu_ps(ptr, v); }
+	static inline simd_float simd_set(float value) { return _mm256_set1_ps(value); }
+	static inline simd_float simd_add(simd_float a, simd_float b) { return _mm256_add_ps(a, b); }
+	static inline simd_float simd_sub(simd_float a, simd_float b) { return _mm256_sub_ps(a, b); }
+	static inline simd_float simd_mul(simd_float a, simd_float b) { return _mm256_mul_ps(a, b); }
+	static inline simd_float simd_div(simd_float a, simd_float b) { return _mm256_div_ps(a, b); }
+	static inline simd_float simd_mad(simd_float a, simd_float b, simd_float c) { return _mm256_fmadd_ps(a, b, c); }
+	static inline simd_float simd_sqrt(simd_float a) { return _mm256_sqrt_ps(a); }
+	static inline simd_float simd_min(simd_float a, simd_float b) { return _mm256_min_ps(a, b); }
+	static inline simd_float simd_max(simd_float a, simd_float b) { return _mm256_max_ps(a, b); }
+#else
+	using simd_float = XMVECTOR;
+	static constexpr uint32_t simd_width = 4;
+	static inline simd_float simd_load(const float* ptr) { return XMLoadFloat4((const XMFLOAT4*)ptr); }
+	static inline void simd_store(float* ptr, simd_float v) { XMStoreFloat4((XMFLOAT4*)ptr, v); }
+	static inline simd_float simd_set(float value) { return XMVectorReplicate(value); }
+	static inline simd_float simd_add(simd_float a, simd_float b) { return XMVectorAdd(a, b); }
+	static inline simd_float simd_sub(simd_float a, simd_float b) { return XMVectorSubtract(a, b); }
+	static inline simd_float simd_mul(simd_float a, simd_float b) { return XMVectorMultiply(a, b); }
+	static inline simd_float simd_div(simd_float a, simd_float b) { return XMVectorDivide(a, b); }
+	static inline simd_float simd_mad(simd_float a, simd_float b, simd_float c) { return XMVectorMultiplyAdd(a, b, c); }
+	static inline simd_float simd_sqrt(simd_float a) { return XMVectorSqrt(a); }
+	static inline simd_float simd_min(simd_float a, simd_float b) { return XMVectorMin(a, b); }
+	static inline simd_float simd_max(simd_float a, simd_float b) { return XMVectorMax(a, b); }
+#endif // _XM_AVX2_INTRINSICS_
+	static_assert(EmittedParticleSystem::ParticleArrays::padding % simd_width == 0, "Particle array padding must be multiple of SIMD width");
+
 
 	void EmittedParticleSystem::SetMaxParticleCount(uint32_t value)
 	{
@@ -326,10 +359,43 @@ namespace wi
 		return retVal;
 	}
 
+	void EmittedParticleSystem::ParticleArrays::reserve(size_t capacity)
+	{
+		const size_t padded = capacity + padding;
+		for (auto* arr : { &position_x, &position_y, &position_z, &velocity_x, &velocity_y, &velocity_z, &life, &max_life, &size_begin, &size_end, &size, &rotation, &rotation_velocity, &opacity })
+		{
+			arr->resize(padded);
+		}
+		color.resize(padded);
+		count = std::min(count, capacity);
+	}
+	void EmittedParticleSystem::ParticleArrays::move(size_t dst, size_t src)
+	{
+		position_x[dst] = position_x[src];
+		position_y[dst] = position_y[src];
+		position_z[dst] = position_z[src];
+		velocity_x[dst] = velocity_x[src];
+		velocity_y[dst] = velocity_y[src];
+		velocity_z[dst] = velocity_z[src];
+		life[dst] = life[src];
+		max_life[dst] = max_life[src];
+		size_begin[dst] = size_begin[src];
+		size_end[dst] = size_end[src];
+		size[dst] = size[src];
+		rotation[dst] = rotation[src];
+		rotation_velocity[dst] = rotation_velocity[src];
+		opacity[dst] = opacity[src];
+		color[dst] = color[src];
+	}
+
 	void EmittedParticleSystem::UpdateCPU(const TransformComponent& transform, float dt)
 	{
 		this->dt = dt;
-		CreateSelfBuffers();
+		GraphicsDevice* device = wi::graphics::GetDevice();
+		if (device != nullptr)
+		{
+			CreateSelfBuffers();
+		}
 
 		if (IsPaused() || dt == 0)
 			return;
@@ -359,16 +425,27 @@ namespace wi
 		// Swap CURRENT alivelist with NEW alivelist
 		std::swap(aliveList[0], aliveList[1]);
 
-		// Read back statistics (with GPU delay):
-		const uint32_t oldest_stat_index = wi::graphics::GetDevice()->GetBufferIndex();
-		memcpy(&statistics, statisticsReadbackBuffer[oldest_stat_index].mapped_data, sizeof(statistics));
-
-		if (statistics.aliveCount > 0 || statistics.aliveCount_afterSimulation > 0)
+		if (IsCPUSimulationEnabled())
 		{
-			active_frames |= 1; // activate current frame
+			// Statistics are known immediately, SimulateCPU() will update them:
+			if (cpu_particles.count > 0)
+			{
+				active_frames |= 1; // activate current frame
+			}
+		}
+		else if (device != nullptr)
+		{
+			// Read back statistics (with GPU delay):
+			const uint32_t oldest_stat_index = device->GetBufferIndex();
+			memcpy(&statistics, statisticsReadbackBuffer[oldest_stat_index].mapped_data, sizeof(statistics));
+
+			if (statistics.aliveCount > 0 || statistics.aliveCount_afterSimulation > 0)
+			{
+				active_frames |= 1; // activate current frame
+			}
 		}
 
-		if (!opacityCurveTex.IsValid())
+		if (device != nullptr && !opacityCurveTex.IsValid())
 		{
 			SetOpacityCurveControl(opacityCurveControlPeakStart, opacityCurveControlPeakEnd);
 		}
@@ -422,6 +499,265 @@ namespace wi
 	{
 		SetPaused(false);
 		counterBuffer = {}; // will be recreated
+		cpu_particles.clear();
+		cpu_rng.seed(1);
+	}
+
+	void EmittedParticleSystem::SimulateCPU(const ForceFieldComponent* forces, size_t force_count, const MaterialComponent* material)
+	{
+		if (!IsCPUSimulationEnabled() || IsPaused() || dt == 0)
+			return;
+
+		ParticleArrays& particles = cpu_particles;
+		if (particles.position_x.size() != MAX_PARTICLES + ParticleArrays::padding)
+		{
+			particles.reserve(MAX_PARTICLES);
+		}
+
+		// Emit new particles to the end of the arrays, the same way as the GPU emitter does it without a mesh:
+		uint32_t emitted = 0;
+		if (!emit_locations.empty())
+		{
+			const XMMATRIX W = XMLoadFloat4x4(&worldMatrix);
+			XMFLOAT3 emit_velocity;
+			XMStoreFloat3(&emit_velocity, XMVector3TransformNormal(XMLoadFloat3(&velocity), W));
+			const XMFLOAT4 material_color = material == nullptr ? XMFLOAT4(1, 1, 1, 1) : material->baseColor;
+			const float particle_rotation = rotation * XM_PI;
+			wi::random::RNG& rng = cpu_rng;
+
+			for (auto& location : emit_locations)
+			{
+				XMFLOAT4X4 mat = location.transform.GetMatrix();
+				const XMMATRIX M = W * XMMatrixTranspose(XMLoadFloat4x4(&mat));
+				const XMFLOAT4 location_color = wi::Color(location.color).toFloat4();
+				const XMFLOAT4 base_color = XMFLOAT4(
+					material_color.x * location_color.x,
+					material_color.y * location_color.y,
+					material_color.z * location_color.z,
+					material_color.w * location_color.w
+				);
+
+				for (uint32_t i = 0; i < location.count && particles.count < MAX_PARTICLES; ++i)
+				{
+					XMFLOAT3 emit_pos = XMFLOAT3(0, 0, 0);
+					if (IsVolumeEnabled())
+					{
+						emit_pos.x = rng.next_float() * 2 - 1;
+						emit_pos.y = rng.next_float() * 2 - 1;
+						emit_pos.z = rng.next_float() * 2 - 1;
+					}
+					XMFLOAT3 pos;
+					XMStoreFloat3(&pos, XMVector3Transform(XMLoadFloat3(&emit_pos), M));
+
+					const float starting_size = size + size * (rng.next_float() - 0.5f) * random_factor;
+
+					const size_t index = particles.count++;
+					particles.position_x[index] = pos.x;
+					particles.position_y[index] = pos.y;
+					particles.position_z[index] = pos.z;
+					particles.velocity_x[index] = emit_velocity.x + (rng.next_float() - 0.5f) * random_factor * normal_factor;
+					particles.velocity_y[index] = emit_velocity.y + (rng.next_float() - 0.5f) * random_factor * normal_factor;
+					particles.velocity_z[index] = emit_velocity.z + (rng.next_float() - 0.5f) * random_factor * normal_factor;
+					particles.rotation[index] = (rng.next_float() - 0.5f) * random_factor * XM_2PI;
+					particles.rotation_velocity[index] = particle_rotation * (rng.next_float() - 0.5f) * (1 + random_factor);
+					particles.max_life[index] = life + life * (rng.next_float() - 0.5f) * random_life;
+					particles.life[index] = particles.max_life[index];
+					particles.size_begin[index] = starting_size;
+					particles.size_end[index] = starting_size * scaleX;
+					particles.size[index] = starting_size;
+					particles.opacity[index] = 0;
+
+					XMFLOAT4 color = base_color;
+					color.x *= wi::math::Lerp(1.0f, rng.next_float(), random_color);
+					color.y *= wi::math::Lerp(1.0f, rng.next_float(), random_color);
+					color.z *= wi::math::Lerp(1.0f, rng.next_float(), random_color);
+					particles.color[index] = wi::Color::fromFloat4(color).rgba;
+
+					emitted++;
+				}
+			}
+			emit_locations.clear();
+		}
+
+		// Force fields are converted to a flat list (up to 64), fields without range have no effect:
+		struct Field
+		{
+			XMFLOAT3 position;
+			XMFLOAT3 direction;
+			float gravity;
+			float range_rcp;
+			bool point;
+		};
+		Field fields[64];
+		uint32_t field_count = 0;
+		for (size_t i = 0; i < force_count && field_count < arraysize(fields); ++i)
+		{
+			const ForceFieldComponent& force = forces[i];
+			if (force.GetRange() <= 0 || (force.layerMask & layerMask) == 0)
+				continue;
+			Field& field = fields[field_count++];
+			field.position = force.position;
+			field.direction = force.direction;
+			field.gravity = force.gravity;
+			field.range_rcp = 1.0f / force.GetRange();
+			field.point = force.type == ForceFieldComponent::Type::Point;
+		}
+
+		// The opacity curve is evaluated analytically with the same shape as the opacity curve texture:
+		//	ramp up with smoothstep until peak start, keep until peak end, then ramp down with smoothstep
+		const float peak_start = opacityCurveControlPeakStart;
+		const float peak_end = std::max(peak_start, opacityCurveControlPeakEnd);
+		const float rampup_mul = peak_start > 0 ? 1.0f / peak_start : 0.0f;
+		const float rampup_add = peak_start > 0 ? 0.0f : 1.0f;
+		const float rampdown_mul = peak_end < 1 ? 1.0f / (1 - peak_end) : 0.0f;
+		const float rampdown_add = peak_end < 1 ? -peak_end * rampdown_mul : 0.0f;
+
+		const float step = FIXED_TIMESTEP >= 0 ? FIXED_TIMESTEP : dt;
+
+		// Simulate in chunks, each chunk compacts its own alive particles to the beginning of its range:
+		static constexpr uint32_t chunk_size = 1024;
+		static_assert(chunk_size % simd_width == 0);
+		const uint32_t particle_count = (uint32_t)particles.count;
+		const uint32_t chunk_count = (particle_count + chunk_size - 1) / chunk_size;
+		uint32_t chunk_alive_counts_local[64];
+		wi::vector<uint32_t> chunk_alive_counts_heap;
+		uint32_t* chunk_alive_counts = chunk_alive_counts_local;
+		if (chunk_count > arraysize(chunk_alive_counts_local))
+		{
+			chunk_alive_counts_heap.resize(chunk_count);
+			chunk_alive_counts = chunk_alive_counts_heap.data();
+		}
+
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, chunk_count, 1, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t begin = args.jobIndex * chunk_size;
+			const uint32_t end = std::min(begin + chunk_size, particle_count);
+
+			const simd_float zero = simd_set(0);
+			const simd_float one = simd_set(1);
+			const simd_float three = simd_set(3);
+			const simd_float two = simd_set(2);
+			const simd_float epsilon = simd_set(1e-12f);
+			const simd_float timestep = simd_set(step);
+			const simd_float drag_factor = simd_set(drag);
+			const simd_float gravity_x = simd_set(gravity.x);
+			const simd_float gravity_y = simd_set(gravity.y);
+			const simd_float gravity_z = simd_set(gravity.z);
+			const simd_float up_mul = simd_set(rampup_mul);
+			const simd_float up_add = simd_set(rampup_add);
+			const simd_float down_mul = simd_set(rampdown_mul);
+			const simd_float down_add = simd_set(rampdown_add);
+
+			// The last vector can read and write the padding after the last particle:
+			for (uint32_t i = begin; i < end; i += simd_width)
+			{
+				const simd_float particle_life = simd_sub(simd_load(&particles.life[i]), timestep);
+				const simd_float life_lerp = simd_sub(one, simd_div(particle_life, simd_load(&particles.max_life[i])));
+				simd_store(&particles.life[i], particle_life);
+
+				// size over lifetime:
+				const simd_float size_begin = simd_load(&particles.size_begin[i]);
+				simd_store(&particles.size[i], simd_mad(simd_sub(simd_load(&particles.size_end[i]), size_begin), life_lerp, size_begin));
+
+				// opacity over lifetime:
+				simd_float up = simd_min(one, simd_max(zero, simd_mad(life_lerp, up_mul, up_add)));
+				up = simd_mul(simd_mul(up, up), simd_sub(three, simd_mul(two, up)));
+				simd_float down = simd_min(one, simd_max(zero, simd_mad(life_lerp, down_mul, down_add)));
+				down = simd_sub(one, simd_mul(simd_mul(down, down), simd_sub(three, simd_mul(two, down))));
+				simd_store(&particles.opacity[i], simd_mul(up, down));
+
+				simd_float position_x = simd_load(&particles.position_x[i]);
+				simd_float position_y = simd_load(&particles.position_y[i]);
+				simd_float position_z = simd_load(&particles.position_z[i]);
+				simd_float velocity_x = simd_load(&particles.velocity_x[i]);
+				simd_float velocity_y = simd_load(&particles.velocity_y[i]);
+				simd_float velocity_z = simd_load(&particles.velocity_z[i]);
+
+				// forces:
+				simd_float force_x = gravity_x;
+				simd_float force_y = gravity_y;
+				simd_float force_z = gravity_z;
+				for (uint32_t f = 0; f < field_count; ++f)
+				{
+					const Field& field = fields[f];
+					const simd_float dir_x = simd_sub(simd_set(field.position.x), position_x);
+					const simd_float dir_y = simd_sub(simd_set(field.position.y), position_y);
+					const simd_float dir_z = simd_sub(simd_set(field.position.z), position_z);
+					const simd_float dist = simd_sqrt(simd_max(epsilon, simd_mad(dir_x, dir_x, simd_mad(dir_y, dir_y, simd_mul(dir_z, dir_z)))));
+					const simd_float falloff = simd_sub(one, simd_min(one, simd_mul(dist, simd_set(field.range_rcp))));
+					const simd_float strength = simd_mul(simd_set(field.gravity), falloff);
+					if (field.point)
+					{
+						const simd_float strength_normalized = simd_div(strength, dist);
+						force_x = simd_mad(dir_x, strength_normalized, force_x);
+						force_y = simd_mad(dir_y, strength_normalized, force_y);
+						force_z = simd_mad(dir_z, strength_normalized, force_z);
+					}
+					else
+					{
+						force_x = simd_mad(simd_set(field.direction.x), strength, force_x);
+						force_y = simd_mad(simd_set(field.direction.y), strength, force_y);
+						force_z = simd_mad(simd_set(field.direction.z), strength, force_z);
+					}
+				}
+
+				// integrate:
+				velocity_x = simd_mad(force_x, timestep, velocity_x);
+				velocity_y = simd_mad(force_y, timestep, velocity_y);
+				velocity_z = simd_mad(force_z, timestep, velocity_z);
+				simd_store(&particles.position_x[i], simd_mad(velocity_x, timestep, position_x));
+				simd_store(&particles.position_y[i], simd_mad(velocity_y, timestep, position_y));
+				simd_store(&particles.position_z[i], simd_mad(velocity_z, timestep, position_z));
+
+				// drag:
+				simd_store(&particles.velocity_x[i], simd_mul(velocity_x, drag_factor));
+				simd_store(&particles.velocity_y[i], simd_mul(velocity_y, drag_factor));
+				simd_store(&particles.velocity_z[i], simd_mul(velocity_z, drag_factor));
+
+				simd_store(&particles.rotation[i], simd_mad(simd_load(&particles.rotation_velocity[i]), timestep, simd_load(&particles.rotation[i])));
+			}
+
+			// kill:
+			uint32_t alive = begin;
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				if (particles.life[i] > 0)
+				{
+					if (alive != i)
+					{
+						particles.move(alive, i);
+					}
+					alive++;
+				}
+			}
+			chunk_alive_counts[args.jobIndex] = alive - begin;
+		});
+		wi::jobsystem::Wait(ctx);
+
+		// Close the gaps between chunks, this keeps the emission order of particles:
+		size_t alive_count = chunk_count > 0 ? chunk_alive_counts[0] : 0;
+		for (uint32_t chunk = 1; chunk < chunk_count; ++chunk)
+		{
+			const size_t src = chunk * chunk_size;
+			const uint32_t count = chunk_alive_counts[chunk];
+			if (alive_count != src && count > 0)
+			{
+				for (auto* arr : { &particles.position_x, &particles.position_y, &particles.position_z, &particles.velocity_x, &particles.velocity_y, &particles.velocity_z, &particles.life, &particles.max_life, &particles.size_begin, &particles.size_end, &particles.size, &particles.rotation, &particles.rotation_velocity, &particles.opacity })
+				{
+					std::memmove(arr->data() + alive_count, arr->data() + src, sizeof(float) * count);
+				}
+				std::memmove(particles.color.data() + alive_count, particles.color.data() + src, sizeof(uint32_t) * count);
+			}
+			alive_count += count;
+		}
+		particles.count = alive_count;
+
+		statistics.aliveCount = (uint32_t)particles.count;
+		statistics.deadCount = MAX_PARTICLES - (uint32_t)particles.count;
+		statistics.realEmitCount = emitted;
+		statistics.aliveCount_afterSimulation = (uint32_t)particles.count;
+		statistics.culledCount = 0;
+		statistics.cellAllocator = 0;
 	}
 
 	void EmittedParticleSystem::UpdateGPU(uint32_t instanceIndex, const MeshComponent* mesh, CommandList cmd) const
@@ -434,6 +770,8 @@ namespace wi
 		GraphicsDevice* device = wi::graphics::GetDevice();
 		device->EventBegin("UpdateEmittedParticles", cmd);
 
+		const bool cpu_simulation = IsCPUSimulationEnabled();
+
 		if (!IsPaused() && dt > 0)
 		{
 			auto alloc = device->AllocateGPU(sizeof(EmitLocation) * emit_locations.size(), cmd);
@@ -525,6 +863,13 @@ namespace wi
 			{
 				cb.xEmitterOptions |= EMITTER_OPTION_BIT_TAKE_COLOR_FROM_MESH;
 			}
+			if (cpu_simulation)
+			{
+				// The GPU simulation pass will only write the render data of the uploaded particles:
+				cb.xEmitterOptions &= ~(EMITTER_OPTION_BIT_SPH_ENABLED | EMITTER_OPTION_BIT_USE_RAIN_BLOCKER);
+				cb.xEmitterOptions |= EMITTER_OPTION_BIT_CPU_SIMULATION;
+				cb.xParticleDrag = 1;
+			}
 
 			// SPH:
 			cb.xSPH_h = SPH_h;
@@ -569,19 +914,81 @@ namespace wi
 
 			device->Barrier(&barrier_indirect_uav, 1, cmd);
 
-			// emit the required amounts
-			device->EventBegin("Emit", cmd);
-			device->BindComputeShader(mesh == nullptr ? (IsVolumeEnabled() ? &emitCS_VOLUME : &emitCS) : &emitCS_FROMMESH, cmd);
-			uint bufferoffset = (uint)alloc.offset;
-			for (auto& location : emit_locations)
+			if (cpu_simulation)
 			{
-				device->PushConstants(&bufferoffset, sizeof(bufferoffset), cmd);
-				device->Dispatch((location.count + 63u) / 64u, 1, 1, cmd);
-				bufferoffset += sizeof(EmitLocation);
+				// upload the CPU simulated particles instead of emitting:
+				device->EventBegin("Upload", cmd);
+				const ParticleArrays& particles = cpu_particles;
+				const uint32_t particleCount = (uint32_t)std::min(particles.count, (size_t)MAX_PARTICLES);
+				{
+					GPUBarrier barriers[] = {
+						GPUBarrier::Buffer(&particleBuffer, ResourceState::SHADER_RESOURCE, ResourceState::COPY_DST),
+						GPUBarrier::Buffer(&aliveList[0], ResourceState::SHADER_RESOURCE, ResourceState::COPY_DST),
+						GPUBarrier::Buffer(&counterBuffer, ResourceState::SHADER_RESOURCE, ResourceState::COPY_DST),
+					};
+					device->Barrier(barriers, arraysize(barriers), cmd);
+				}
+				if (particleCount > 0)
+				{
+					auto particle_alloc = device->AllocateGPU(sizeof(Particle) * particleCount, cmd);
+					auto alivelist_alloc = device->AllocateGPU(sizeof(uint32_t) * particleCount, cmd);
+					Particle* particle_data = (Particle*)particle_alloc.data;
+					uint32_t* alivelist_data = (uint32_t*)alivelist_alloc.data;
+
+					wi::jobsystem::context ctx;
+					wi::jobsystem::Dispatch(ctx, particleCount, 4096, [&](wi::jobsystem::JobArgs args) {
+						const uint32_t i = args.jobIndex;
+						Particle particle;
+						particle.position = XMFLOAT3(particles.position_x[i], particles.position_y[i], particles.position_z[i]);
+						particle.mass = mass;
+						particle.force = XMFLOAT3(0, 0, 0);
+						particle.rotation_rotationVelocity = wi::math::pack_half2(XMScalarModAngle(particles.rotation[i]), particles.rotation_velocity[i]);
+						particle.velocity = XMFLOAT3(particles.velocity_x[i], particles.velocity_y[i], particles.velocity_z[i]);
+						particle.maxLife = particles.max_life[i];
+						particle.sizeBeginEnd = XMFLOAT2(particles.size_begin[i], particles.size_end[i]);
+						particle.life = particles.life[i];
+						wi::Color color = particles.color[i];
+						color.setA(uint8_t(color.getA() * wi::math::saturate(particles.opacity[i])));
+						particle.color = color.rgba;
+						std::memcpy(particle_data + i, &particle, sizeof(particle));
+						alivelist_data[i] = i;
+					});
+					wi::jobsystem::Wait(ctx);
+
+					device->CopyBuffer(&particleBuffer, 0, &particle_alloc.buffer, particle_alloc.offset, sizeof(Particle) * particleCount, cmd);
+					device->CopyBuffer(&aliveList[0], 0, &alivelist_alloc.buffer, alivelist_alloc.offset, sizeof(uint32_t) * particleCount, cmd);
+				}
+				uint32_t counters[sizeof(ParticleCounters) / sizeof(uint32_t)] = {};
+				counters[PARTICLECOUNTER_OFFSET_ALIVECOUNT / sizeof(uint32_t)] = particleCount;
+				counters[PARTICLECOUNTER_OFFSET_DEADCOUNT / sizeof(uint32_t)] = MAX_PARTICLES - particleCount;
+				counters[PARTICLECOUNTER_OFFSET_ALIVECOUNT_AFTERSIMULATION / sizeof(uint32_t)] = particleCount; // kickoff will take this as the alive count
+				device->UpdateBuffer(&counterBuffer, counters, cmd);
+				{
+					GPUBarrier barriers[] = {
+						GPUBarrier::Buffer(&particleBuffer, ResourceState::COPY_DST, ResourceState::UNORDERED_ACCESS),
+						GPUBarrier::Buffer(&aliveList[0], ResourceState::COPY_DST, ResourceState::UNORDERED_ACCESS),
+						GPUBarrier::Buffer(&counterBuffer, ResourceState::COPY_DST, ResourceState::UNORDERED_ACCESS),
+					};
+					device->Barrier(barriers, arraysize(barriers), cmd);
+				}
+				device->EventEnd(cmd);
+			}
+			else
+			{
+				// emit the required amounts
+				device->EventBegin("Emit", cmd);
+				device->BindComputeShader(mesh == nullptr ? (IsVolumeEnabled() ? &emitCS_VOLUME : &emitCS) : &emitCS_FROMMESH, cmd);
+				uint bufferoffset = (uint)alloc.offset;
+				for (auto& location : emit_locations)
+				{
+					device->PushConstants(&bufferoffset, sizeof(bufferoffset), cmd);
+					device->Dispatch((location.count + 63u) / 64u, 1, 1, cmd);
+					bufferoffset += sizeof(EmitLocation);
+				}
+				emit_locations.clear();
+				device->Barrier(GPUBarrier::Memory(), cmd);
+				device->EventEnd(cmd);
 			}
-			emit_locations.clear();
-			device->Barrier(GPUBarrier::Memory(), cmd);
-			device->EventEnd(cmd);
 
 			// kick off indirect updating
 			device->EventBegin("KickOff Update", cmd);
@@ -591,7 +998,7 @@ namespace wi
 
 			device->Barrier(&barrier_uav_indirect, 1, cmd);
 
-			if (IsSPHEnabled())
+			if (IsSPHEnabled() && !cpu_simulation)
 			{
 				auto range = wi::profiler::BeginRangeGPU("SPH - Simulation", cmd);
 
@@ -740,7 +1147,7 @@ namespace wi
 			// update CURRENT alive list, write NEW alive list
 			if (IsSorted())
 			{
-				if (IsDepthCollisionEnabled())
+				if (IsDepthCollisionEnabled() && !cpu_simulation)
 				{
 					device->BindComputeShader(&simulateCS_SORTING_DEPTHCOLLISIONS, cmd);
 				}
@@ -751,7 +1158,7 @@ namespace wi
 			}
 			else
 			{
-				if (IsDepthCollisionEnabled())
+				if (IsDepthCollisionEnabled() && !cpu_simulation)
 				{
 					device->BindComputeShader(&simulateCS_DEPTHCOLLISIONS, cmd);
 				}
@@ -8,6 +8,7 @@
 #include "wiECS.h"
 #include "wiScene_Decl.h"
 #include "wiScene_Components.h"
+#include "wiRandom.h"
 
 namespace wi
 {
@@ -56,6 +57,28 @@ namespace wi
 
 		wi::graphics::RaytracingAccelerationStructure BLAS;
 
+		// Structure of arrays particle storage for the CPU simulation
+		//	The arrays are padded, so SIMD loops can always process full vectors
+		struct ParticleArrays
+		{
+			static constexpr size_t padding = 8;
+			wi::vector<float> position_x, position_y, position_z;
+			wi::vector<float> velocity_x, velocity_y, velocity_z;
+			wi::vector<float> life, max_life;
+			wi::vector<float> size_begin, size_end, size;
+			wi::vector<float> rotation, rotation_velocity;
+			wi::vector<float> opacity; // opacity curve value at the current lifetime
+			wi::vector<uint32_t> color; // base color at emission
+			size_t count = 0;
+
+			void reserve(size_t capacity);
+			void clear() { count = 0; }
+			// Moves the particle from index src to index dst
+			void move(size_t dst, size_t src);
+		};
+		ParticleArrays cpu_particles;
+		wi::random::RNG cpu_rng = wi::random::RNG(1);
+
 	private:
 		void CreateSelfBuffers();
 
@@ -75,6 +98,13 @@ namespace wi
 		void Burst(int num, const XMFLOAT4X4& transform, const wi::Color& color = wi::Color::White());
 		void Restart();
 
+		// Emit and simulate particles on the CPU, only used when IsCPUSimulationEnabled() is true. Call it after UpdateCPU()
+		//	forces		: force fields that affect the particles if their layerMask intersects the emitter layerMask (can be nullptr if force_count is 0)
+		//	material	: the base color of the emitter material tints the particles (can be nullptr)
+		//	The simulation runs in parallel with the job system and it is deterministic for the same inputs
+		//	The GPU update will only upload the results and create render data for them
+		void SimulateCPU(const wi::scene::ForceFieldComponent* forces, size_t force_count, const wi::scene::MaterialComponent* material = nullptr);
+
 		// Must have a transform and material component, but mesh is optional
 		void UpdateGPU(uint32_t instanceIndex, const wi::scene::MeshComponent* mesh, wi::graphics::CommandList cmd) const;
 		void Draw(const wi::scene::MaterialComponent& material, wi::graphics::CommandList cmd, const PARTICLESHADERTYPE* shadertype_override = nullptr) const;
@@ -96,6 +126,7 @@ namespace wi
 			FLAG_COLLIDERS_DISABLED = 1 << 7,
 			FLAG_USE_RAIN_BLOCKER = 1 << 8,
 			FLAG_TAKE_COLOR_FROM_MESH = 1 << 9,
+			FLAG_CPU_SIMULATION = 1 << 10,
 		};
 		uint32_t _flags = FLAG_EMPTY;
 
@@ -157,6 +188,7 @@ namespace wi
 		inline bool IsFrameBlendingEnabled() const { return _flags & FLAG_FRAME_BLENDING; }
 		inline bool IsCollidersDisabled() const { return _flags & FLAG_COLLIDERS_DISABLED; }
 		inline bool IsTakeColorFromMesh() const { return _flags & FLAG_TAKE_COLOR_FROM_MESH; }
+		inline bool IsCPUSimulationEnabled() const { return _flags & FLAG_CPU_SIMULATION; }
 
 		inline void SetDebug(bool value) { if (value) { _flags |= FLAG_DEBUG; } else { _flags &= ~FLAG_DEBUG; } }
 		inline void SetPaused(bool value) { if (value) { _flags |= FLAG_PAUSED; } else { _flags &= ~FLAG_PAUSED; } }
@@ -167,6 +199,9 @@ namespace wi
 		inline void SetFrameBlendingEnabled(bool value) { if (value) { _flags |= FLAG_FRAME_BLENDING; } else { _flags &= ~FLAG_FRAME_BLENDING; } }
 		inline void SetCollidersDisabled(bool value) { if (value) { _flags |= FLAG_COLLIDERS_DISABLED; } else { _flags &= ~FLAG_COLLIDERS_DISABLED; } }
 		inline void SetTakeColorFromMesh(bool value) { if (value) { _flags |= FLAG_TAKE_COLOR_FROM_MESH; } else { _flags &= ~FLAG_TAKE_COLOR_FROM_MESH; } }
+		// CPU simulation supports emission from the center point or volume, gravity, drag, force fields, lifetime, size and opacity
+		//	Mesh emission, SPH, colliders and depth buffer collisions are only supported by the GPU simulation
+		inline void SetCPUSimulationEnabled(bool value) { if (value) { _flags |= FLAG_CPU_SIMULATION; } else { _flags &= ~FLAG_CPU_SIMULATION; } }
 
 		// Set the opacity curve parameters
 		//	peak : start peak of the opacity relative to particle lifetime [0,1]
@@ -116,6 +116,15 @@ namespace wi::graphics
 		//	One PipelineState object can be compiled internally for multiple render target or depth-stencil formats, or sample counts
 		virtual size_t GetActivePipelineCount() const = 0;
 
+		// Set the policy for pipelines that are not yet compiled for the current render pass when drawing:
+		//	false (default): the pipeline is compiled immediately, which can cause a hitch
+		//	true: the pipeline is compiled in the background, and draw calls using it are skipped until it is finished
+		virtual void SetPipelineCompilationAsync(bool value) {}
+		virtual bool IsPipelineCompilationAsync() const { return false; }
+
+		// Returns true if pipelines are being compiled in the background
+		virtual bool IsPipelineCompilationActive() const { return false; }
+
 		// Returns the number of elapsed frames (submits)
 		//	It is incremented when calling SubmitCommandLists()
 		constexpr uint64_t GetFrameCount() const { return FRAMECOUNT; }
@@ -167,6 +176,15 @@ namespace wi::graphics
 		// Returns video memory statistics for the current application
 		virtual MemoryUsage GetMemoryUsage() const = 0;
 
+		struct UploadStats
+		{
+			uint64_t bytes = 0ull;	// amount of resource initial data that was uploaded (in bytes)
+			uint32_t uploads = 0;	// number of resources that were initialized
+			uint32_t submits = 0;	// number of queue submissions that were needed for the uploads
+		};
+		// Returns statistics of the resource initial data uploads made in the last frame
+		virtual UploadStats GetUploadStats() const { return {}; }
+
 		// Returns the maximum amount of viewports that can be bound at once
 		virtual uint32_t GetMaxViewportCount() const = 0;
 
@@ -27,6 +27,7 @@
 #include <cstring>
 #include <iostream>
 #include <algorithm>
+#include <numeric>
 
 namespace wi::graphics
 {
@@ -636,6 +637,12 @@ namespace vulkan_internal
 	{
 		return wi::helper::GetCurrentPath() + "/pso_cache_vulkan";
 	}
+	inline std::string get_pipeline_manifest_path()
+	{
+		return wi::helper::GetCurrentPath() + "/pso_manifest_vulkan";
+	}
+	static constexpr uint32_t pipeline_manifest_magic = 0x4D4F5350; // "PSOM"
+	static constexpr uint32_t pipeline_manifest_version = 2;
 
 	struct BindingUsage
 	{
@@ -903,6 +910,8 @@ namespace vulkan_internal
 		VkDeviceSize uniform_buffer_sizes[DESCRIPTORBINDER_CBV_COUNT] = {};
 		wi::vector<uint32_t> uniform_buffer_dynamic_slots;
 
+		uint64_t hash = 0; // hash of the shader binary, it is persistent between runs
+
 		~Shader_Vulkan()
 		{
 			if (allocationhandler == nullptr)
@@ -943,6 +952,8 @@ namespace vulkan_internal
 		VkSampleMask samplemask = {};
 		VkPipelineTessellationStateCreateInfo tessellationInfo = {};
 
+		uint64_t manifest_hash = 0; // hash of shaders and states, it is persistent between runs unlike the PipelineState pointer
+
 		~PipelineState_Vulkan()
 		{
 			if (allocationhandler == nullptr)
@@ -1110,6 +1121,253 @@ namespace vulkan_internal
 		return static_cast<VideoDecoder_Vulkan*>(param->internal_state.get());
 	}
 
+	// Persistent hash of a pipeline state description, the pipeline manifest refers to pipeline states by this
+	uint64_t ComputePipelineManifestHash(const PipelineStateDesc& desc)
+	{
+		uint64_t hash = wi::helper::stable_hash_seed;
+		const Shader* shaders[] = { desc.vs, desc.ps, desc.hs, desc.ds, desc.gs, desc.ms, desc.as };
+		for (const Shader* shader : shaders)
+		{
+			hash = wi::helper::stable_hash(hash, shader == nullptr ? 0ull : to_internal(shader)->hash);
+		}
+		if (desc.bs != nullptr)
+		{
+			hash = wi::helper::stable_hash(hash, desc.bs->alpha_to_coverage_enable);
+			hash = wi::helper::stable_hash(hash, desc.bs->independent_blend_enable);
+			for (auto& x : desc.bs->render_target)
+			{
+				hash = wi::helper::stable_hash(hash, x.blend_enable);
+				hash = wi::helper::stable_hash(hash, x.src_blend);
+				hash = wi::helper::stable_hash(hash, x.dest_blend);
+				hash = wi::helper::stable_hash(hash, x.blend_op);
+				hash = wi::helper::stable_hash(hash, x.src_blend_alpha);
+				hash = wi::helper::stable_hash(hash, x.dest_blend_alpha);
+				hash = wi::helper::stable_hash(hash, x.blend_op_alpha);
+				hash = wi::helper::stable_hash(hash, x.render_target_write_mask);
+			}
+		}
+		if (desc.rs != nullptr)
+		{
+			hash = wi::helper::stable_hash(hash, desc.rs->fill_mode);
+			hash = wi::helper::stable_hash(hash, desc.rs->cull_mode);
+			hash = wi::helper::stable_hash(hash, desc.rs->front_counter_clockwise);
+			hash = wi::helper::stable_hash(hash, desc.rs->depth_bias);
+			hash = wi::helper::stable_hash(hash, desc.rs->depth_bias_clamp);
+			hash = wi::helper::stable_hash(hash, desc.rs->slope_scaled_depth_bias);
+			hash = wi::helper::stable_hash(hash, desc.rs->depth_clip_enable);
+			hash = wi::helper::stable_hash(hash, desc.rs->multisample_enable);
+			hash = wi::helper::stable_hash(hash, desc.rs->antialiased_line_enable);
+			hash = wi::helper::stable_hash(hash, desc.rs->conservative_rasterization_enable);
+			hash = wi::helper::stable_hash(hash, desc.rs->forced_sample_count);
+		}
+		if (desc.dss != nullptr)
+		{
+			hash = wi::helper::stable_hash(hash, desc.dss->depth_enable);
+			hash = wi::helper::stable_hash(hash, desc.dss->depth_write_mask);
+			hash = wi::helper::stable_hash(hash, desc.dss->depth_func);
+			hash = wi::helper::stable_hash(hash, desc.dss->stencil_enable);
+			hash = wi::helper::stable_hash(hash, desc.dss->stencil_read_mask);
+			hash = wi::helper::stable_hash(hash, desc.dss->stencil_write_mask);
+			for (auto& x : { desc.dss->front_face, desc.dss->back_face })
+			{
+				hash = wi::helper::stable_hash(hash, x.stencil_fail_op);
+				hash = wi::helper::stable_hash(hash, x.stencil_depth_fail_op);
+				hash = wi::helper::stable_hash(hash, x.stencil_pass_op);
+				hash = wi::helper::stable_hash(hash, x.stencil_func);
+			}
+			hash = wi::helper::stable_hash(hash, desc.dss->depth_bounds_test_enable);
+		}
+		if (desc.il != nullptr)
+		{
+			for (auto& x : desc.il->elements)
+			{
+				hash = wi::helper::stable_hash(hash, x.semantic_name);
+				hash = wi::helper::stable_hash(hash, x.semantic_index);
+				hash = wi::helper::stable_hash(hash, x.format);
+				hash = wi::helper::stable_hash(hash, x.input_slot);
+				hash = wi::helper::stable_hash(hash, x.aligned_byte_offset);
+				hash = wi::helper::stable_hash(hash, x.input_slot_class);
+			}
+		}
+		hash = wi::helper::stable_hash(hash, desc.pt);
+		hash = wi::helper::stable_hash(hash, desc.patch_control_points);
+		hash = wi::helper::stable_hash(hash, desc.sample_mask);
+		return hash;
+	}
+
+	// Creates the concrete pipeline of a PipelineState for a specific render pass configuration
+	//	This can be called from any thread, the pipeline cache is internally synchronized
+	VkPipeline CreateGraphicsPipelineInternal(
+		VkDevice device,
+		VkPipelineCache pipelineCache,
+		const PipelineState_Vulkan& internal_state,
+		const PipelineStateDesc& desc,
+		const RenderPassInfo& renderpass_info
+	)
+	{
+		VkGraphicsPipelineCreateInfo pipelineInfo = internal_state.pipelineInfo; // make a copy here
+
+		// MSAA:
+		VkPipelineMultisampleStateCreateInfo multisampling = {};
+		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampling.sampleShadingEnable = VK_FALSE;
+		multisampling.rasterizationSamples = (VkSampleCountFlagBits)renderpass_info.sample_count;
+		if (desc.rs != nullptr)
+		{
+			const RasterizerState& rs = *desc.rs;
+			if (rs.forced_sample_count > 1)
+			{
+				multisampling.rasterizationSamples = (VkSampleCountFlagBits)rs.forced_sample_count;
+			}
+		}
+		multisampling.minSampleShading = 1.0f;
+		VkSampleMask samplemask = internal_state.samplemask;
+		samplemask = desc.sample_mask;
+		multisampling.pSampleMask = &samplemask;
+		if (desc.bs != nullptr)
+		{
+			multisampling.alphaToCoverageEnable = desc.bs->alpha_to_coverage_enable ? VK_TRUE : VK_FALSE;
+		}
+		else
+		{
+			multisampling.alphaToCoverageEnable = VK_FALSE;
+		}
+		multisampling.alphaToOneEnable = VK_FALSE;
+
+		pipelineInfo.pMultisampleState = &multisampling;
+
+
+		// Blending:
+		uint32_t numBlendAttachments = 0;
+		VkPipelineColorBlendAttachmentState colorBlendAttachments[8] = {};
+		for (size_t i = 0; i < renderpass_info.rt_count; ++i)
+		{
+			size_t attachmentIndex = 0;
+			if (desc.bs->independent_blend_enable)
+				attachmentIndex = i;
+
+			const auto& rt_desc = desc.bs->render_target[attachmentIndex];
+			VkPipelineColorBlendAttachmentState& attachment = colorBlendAttachments[numBlendAttachments];
+			numBlendAttachments++;
+
+			attachment.blendEnable = rt_desc.blend_enable ? VK_TRUE : VK_FALSE;
+
+			attachment.colorWriteMask = 0;
+			if (has_flag(rt_desc.render_target_write_mask, ColorWrite::ENABLE_RED))
+			{
+				attachment.colorWriteMask |= VK_COLOR_COMPONENT_R_BIT;
+			}
+			if (has_flag(rt_desc.render_target_write_mask, ColorWrite::ENABLE_GREEN))
+			{
+				attachment.colorWriteMask |= VK_COLOR_COMPONENT_G_BIT;
+			}
+			if (has_flag(rt_desc.render_target_write_mask, ColorWrite::ENABLE_BLUE))
+			{
+				attachment.colorWriteMask |= VK_COLOR_COMPONENT_B_BIT;
+			}
+			if (has_flag(rt_desc.render_target_write_mask, ColorWrite::ENABLE_ALPHA))
+			{
+				attachment.colorWriteMask |= VK_COLOR_COMPONENT_A_BIT;
+			}
+
+			attachment.srcColorBlendFactor = _ConvertBlend(rt_desc.src_blend);
+			attachment.dstColorBlendFactor = _ConvertBlend(rt_desc.dest_blend);
+			attachment.colorBlendOp = _ConvertBlendOp(rt_desc.blend_op);
+			attachment.srcAlphaBlendFactor = _ConvertBlend(rt_desc.src_blend_alpha);
+			attachment.dstAlphaBlendFactor = _ConvertBlend(rt_desc.dest_blend_alpha);
+			attachment.alphaBlendOp = _ConvertBlendOp(rt_desc.blend_op_alpha);
+		}
+
+		VkPipelineColorBlendStateCreateInfo colorBlending = {};
+		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlending.logicOpEnable = VK_FALSE;
+		colorBlending.logicOp = VK_LOGIC_OP_COPY;
+		colorBlending.attachmentCount = numBlendAttachments;
+		colorBlending.pAttachments = colorBlendAttachments;
+		colorBlending.blendConstants[0] = 1.0f;
+		colorBlending.blendConstants[1] = 1.0f;
+		colorBlending.blendConstants[2] = 1.0f;
+		colorBlending.blendConstants[3] = 1.0f;
+
+		pipelineInfo.pColorBlendState = &colorBlending;
+
+		// Input layout:
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		wi::vector<VkVertexInputBindingDescription> bindings;
+		wi::vector<VkVertexInputAttributeDescription> attributes;
+		if (desc.il != nullptr)
+		{
+			uint32_t lastBinding = 0xFFFFFFFF;
+			for (auto& x : desc.il->elements)
+			{
+				if (x.input_slot == lastBinding)
+					continue;
+				lastBinding = x.input_slot;
+				VkVertexInputBindingDescription& bind = bindings.emplace_back();
+				bind.binding = x.input_slot;
+				bind.inputRate = x.input_slot_class == InputClassification::PER_VERTEX_DATA ? VK_VERTEX_INPUT_RATE_VERTEX : VK_VERTEX_INPUT_RATE_INSTANCE;
+				bind.stride = GetFormatStride(x.format);
+			}
+
+			uint32_t offset = 0;
+			uint32_t i = 0;
+			lastBinding = 0xFFFFFFFF;
+			for (auto& x : desc.il->elements)
+			{
+				VkVertexInputAttributeDescription attr = {};
+				attr.binding = x.input_slot;
+				if (attr.binding != lastBinding)
+				{
+					lastBinding = attr.binding;
+					offset = 0;
+				}
+				attr.format = _ConvertFormat(x.format);
+				attr.location = i;
+				attr.offset = x.aligned_byte_offset;
+				if (attr.offset == InputLayout::APPEND_ALIGNED_ELEMENT)
+				{
+					// need to manually resolve this from the format spec.
+					attr.offset = offset;
+					offset += GetFormatStride(x.format);
+				}
+
+				attributes.push_back(attr);
+
+				i++;
+			}
+
+			vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindings.size());
+			vertexInputInfo.pVertexBindingDescriptions = bindings.data();
+			vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size());
+			vertexInputInfo.pVertexAttributeDescriptions = attributes.data();
+		}
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+
+		pipelineInfo.renderPass = VK_NULL_HANDLE; // instead we use VkPipelineRenderingCreateInfo
+
+		VkPipelineRenderingCreateInfo renderingInfo = {};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		renderingInfo.viewMask = 0;
+		renderingInfo.colorAttachmentCount = renderpass_info.rt_count;
+		VkFormat formats[8] = {};
+		for (uint32_t i = 0; i < renderpass_info.rt_count; ++i)
+		{
+			formats[i] = _ConvertFormat(renderpass_info.rt_formats[i]);
+		}
+		renderingInfo.pColorAttachmentFormats = formats;
+		renderingInfo.depthAttachmentFormat = _ConvertFormat(renderpass_info.ds_format);
+		if (IsFormatStencilSupport(renderpass_info.ds_format))
+		{
+			renderingInfo.stencilAttachmentFormat = renderingInfo.depthAttachmentFormat;
+		}
+		pipelineInfo.pNext = &renderingInfo;
+
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		vulkan_check(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline));
+		return pipeline;
+	}
+
 	bool CreateSwapChainInternal(
 		SwapChain_Vulkan* internal_state,
 		VkPhysicalDevice physicalDevice,
@@ -1426,37 +1684,179 @@ using namespace vulkan_internal;
 	void GraphicsDevice_Vulkan::CopyAllocator::init(GraphicsDevice_Vulkan* device)
 	{
 		this->device = device;
+
+		VkSemaphoreTypeCreateInfo timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		timelineInfo.initialValue = 0;
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &timelineInfo;
+		vulkan_check(vkCreateSemaphore(device->device, &semaphoreInfo, nullptr, &timeline));
+		device->set_semaphore_name(timeline, "CopyAllocator::timeline");
+		vulkan_check(vkCreateSemaphore(device->device, &semaphoreInfo, nullptr, &transfer_timeline));
+		device->set_semaphore_name(transfer_timeline, "CopyAllocator::transfer_timeline");
+
+		GPUBufferDesc uploaddesc;
+		uploaddesc.size = ring_size;
+		uploaddesc.usage = Usage::UPLOAD;
+		bool upload_success = device->CreateBuffer(&uploaddesc, nullptr, &ring);
+		assert(upload_success);
+		device->SetName(&ring, "CopyAllocator::ring");
 	}
 	void GraphicsDevice_Vulkan::CopyAllocator::destroy()
 	{
+		flush();
 		vkQueueWaitIdle(device->queue_init.queue);
-		for (auto& x : freelist)
+		vkQueueWaitIdle(device->queues[QUEUE_GRAPHICS].queue);
+		for (auto* list : { &freelist, &pending, &inflight })
 		{
-			vkDestroyCommandPool(device->device, x.transferCommandPool, nullptr);
-			vkDestroyCommandPool(device->device, x.transitionCommandPool, nullptr);
-			vkDestroySemaphore(device->device, x.semaphore, nullptr);
-			vkDestroyFence(device->device, x.fence, nullptr);
+			for (auto& x : *list)
+			{
+				vkDestroyCommandPool(device->device, x.transferCommandPool, nullptr);
+				vkDestroyCommandPool(device->device, x.transitionCommandPool, nullptr);
+			}
+			list->clear();
 		}
+		ring_allocations.clear();
+		vkDestroySemaphore(device->device, timeline, nullptr);
+		timeline = VK_NULL_HANDLE;
+		vkDestroySemaphore(device->device, transfer_timeline, nullptr);
+		transfer_timeline = VK_NULL_HANDLE;
 	}
-	GraphicsDevice_Vulkan::CopyAllocator::CopyCMD GraphicsDevice_Vulkan::CopyAllocator::allocate(uint64_t staging_size)
+	void GraphicsDevice_Vulkan::CopyAllocator::update_locked()
 	{
-		CopyCMD cmd;
+		uint64_t completed_value = 0;
+		vulkan_check(vkGetSemaphoreCounterValue(device->device, timeline, &completed_value));
 
-		locker.lock();
-		// Try to search for a staging buffer that can fit the request:
-		for (size_t i = 0; i < freelist.size(); ++i)
+		// Command buffers of completed uploads can be reused, dedicated staging buffers are released:
+		for (size_t i = 0; i < inflight.size();)
 		{
-			if (freelist[i].uploadbuffer.desc.size >= staging_size)
+			if (inflight[i].fence_value <= completed_value)
 			{
-				cmd = std::move(freelist[i]);
-				std::swap(freelist[i], freelist.back());
-				freelist.pop_back();
+				CopyCMD& cmd = freelist.emplace_back();
+				cmd.transferCommandPool = inflight[i].transferCommandPool;
+				cmd.transferCommandBuffer = inflight[i].transferCommandBuffer;
+				cmd.transitionCommandPool = inflight[i].transitionCommandPool;
+				cmd.transitionCommandBuffer = inflight[i].transitionCommandBuffer;
+				std::swap(inflight[i], inflight.back());
+				inflight.pop_back();
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		// Ring space is reclaimed in allocation order:
+		while (!ring_allocations.empty())
+		{
+			const RingAllocation& allocation = ring_allocations.front();
+			if (allocation.fence_value == 0 || allocation.fence_value > completed_value)
 				break;
+			ring_tail = allocation.end;
+			ring_allocations.pop_front();
+			ring_allocation_first_id++;
+		}
+		if (ring_allocations.empty())
+		{
+			ring_head = 0;
+			ring_tail = 0;
+		}
+	}
+	bool GraphicsDevice_Vulkan::CopyAllocator::ring_allocate_locked(uint64_t size, uint64_t alignment, uint64_t& offset)
+	{
+		if (ring_allocations.empty())
+		{
+			offset = 0;
+		}
+		else
+		{
+			const uint64_t aligned = AlignTo(ring_head, alignment);
+			if (ring_head > ring_tail)
+			{
+				// free space is at the end and at the beginning:
+				if (aligned + size <= ring_size)
+				{
+					offset = aligned;
+				}
+				else if (size <= ring_tail)
+				{
+					offset = 0;
+				}
+				else
+				{
+					return false;
+				}
+			}
+			else if (aligned + size <= ring_tail) // head == tail means full when there are allocations
+			{
+				offset = aligned;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		ring_head = offset + size;
+		ring_allocations.emplace_back().end = ring_head;
+		return true;
+	}
+	GraphicsDevice_Vulkan::CopyAllocator::CopyCMD GraphicsDevice_Vulkan::CopyAllocator::allocate(uint64_t staging_size, uint64_t alignment)
+	{
+		CopyCMD cmd;
+		cmd.size = staging_size;
+
+		std::unique_lock lock(locker);
+		update_locked();
+
+		if (staging_size > 0 && staging_size <= ring_size / 2)
+		{
+			uint64_t offset = 0;
+			while (!ring_allocate_locked(staging_size, alignment, offset))
+			{
+				// The ring is full, wait for the oldest uploads to finish:
+				flush_locked();
+				const uint64_t wait_value = ring_allocations.front().fence_value;
+				lock.unlock();
+				if (wait_value == 0)
+				{
+					// the oldest allocation is still being recorded by an other thread:
+					std::this_thread::yield();
+				}
+				else
+				{
+					VkSemaphoreWaitInfo waitInfo = {};
+					waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+					waitInfo.semaphoreCount = 1;
+					waitInfo.pSemaphores = &timeline;
+					waitInfo.pValues = &wait_value;
+					while (vulkan_check(vkWaitSemaphores(device->device, &waitInfo, timeout_value)) == VK_TIMEOUT)
+					{
+						wilog_error("[CopyAllocator::allocate] vkWaitSemaphores resulted in VK_TIMEOUT");
+						std::this_thread::yield();
+					}
+				}
+				lock.lock();
+				update_locked();
 			}
+			cmd.ring_id = ring_allocation_first_id + ring_allocations.size() - 1;
+			cmd.uploadbuffer = to_internal(&ring)->resource;
+			cmd.uploadbuffer_offset = offset;
+			cmd.mapped_data = (uint8_t*)ring.mapped_data + offset;
+		}
+
+		if (!freelist.empty())
+		{
+			const CopyCMD& reuse = freelist.back();
+			cmd.transferCommandPool = reuse.transferCommandPool;
+			cmd.transferCommandBuffer = reuse.transferCommandBuffer;
+			cmd.transitionCommandPool = reuse.transitionCommandPool;
+			cmd.transitionCommandBuffer = reuse.transitionCommandBuffer;
+			freelist.pop_back();
 		}
-		locker.unlock();
+		lock.unlock();
 
-		// If no buffer was found that fits the data, create one:
 		if (!cmd.IsValid())
 		{
 			VkCommandPoolCreateInfo poolInfo = {};
@@ -1475,24 +1875,20 @@ using namespace vulkan_internal;
 			vulkan_check(vkAllocateCommandBuffers(device->device, &commandBufferInfo, &cmd.transferCommandBuffer));
 			commandBufferInfo.commandPool = cmd.transitionCommandPool;
 			vulkan_check(vkAllocateCommandBuffers(device->device, &commandBufferInfo, &cmd.transitionCommandBuffer));
+		}
 
-			VkFenceCreateInfo fenceInfo = {};
-			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-			vulkan_check(vkCreateFence(device->device, &fenceInfo, nullptr, &cmd.fence));
-			device->set_fence_name(cmd.fence, "CopyAllocator::fence");
-
-			VkSemaphoreCreateInfo semaphoreInfo = {};
-			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-			vulkan_check(vkCreateSemaphore(device->device, &semaphoreInfo, nullptr, &cmd.semaphore));
-			device->set_semaphore_name(cmd.semaphore, "CopyAllocator::semaphore");
-
+		if (staging_size > ring_size / 2)
+		{
+			// Too large request would stall the ring, it gets its own staging buffer which is released after the upload:
 			GPUBufferDesc uploaddesc;
-			uploaddesc.size = wi::math::GetNextPowerOfTwo(staging_size);
-			uploaddesc.size = std::max(uploaddesc.size, uint64_t(65536));
+			uploaddesc.size = staging_size;
 			uploaddesc.usage = Usage::UPLOAD;
-			bool upload_success = device->CreateBuffer(&uploaddesc, nullptr, &cmd.uploadbuffer);
+			bool upload_success = device->CreateBuffer(&uploaddesc, nullptr, &cmd.dedicated);
 			assert(upload_success);
-			device->SetName(&cmd.uploadbuffer, "CopyAllocator::uploadBuffer");
+			device->SetName(&cmd.dedicated, "CopyAllocator::dedicated");
+			cmd.uploadbuffer = to_internal(&cmd.dedicated)->resource;
+			cmd.uploadbuffer_offset = 0;
+			cmd.mapped_data = cmd.dedicated.mapped_data;
 		}
 
 		// begin command list in valid state:
@@ -1506,8 +1902,6 @@ using namespace vulkan_internal;
 		vulkan_check(vkBeginCommandBuffer(cmd.transferCommandBuffer, &beginInfo));
 		vulkan_check(vkBeginCommandBuffer(cmd.transitionCommandBuffer, &beginInfo));
 
-		vulkan_check(vkResetFences(device->device, 1, &cmd.fence));
-
 		return cmd;
 	}
 	void GraphicsDevice_Vulkan::CopyAllocator::submit(CopyCMD cmd)
@@ -1515,25 +1909,70 @@ using namespace vulkan_internal;
 		vulkan_check(vkEndCommandBuffer(cmd.transferCommandBuffer));
 		vulkan_check(vkEndCommandBuffer(cmd.transitionCommandBuffer));
 
+		std::scoped_lock lock(locker);
+		stats_current.bytes += cmd.size;
+		stats_current.uploads++;
+		pending_size += cmd.size;
+		pending.push_back(std::move(cmd));
+		if (pending_size >= flush_threshold)
+		{
+			flush_locked();
+		}
+	}
+	uint64_t GraphicsDevice_Vulkan::CopyAllocator::flush(bool frame_end)
+	{
+		std::scoped_lock lock(locker);
+		flush_locked();
+		if (frame_end)
+		{
+			stats_last = stats_current;
+			stats_current = {};
+			update_locked();
+		}
+		return timeline_value;
+	}
+	void GraphicsDevice_Vulkan::CopyAllocator::flush_locked()
+	{
+		if (pending.empty())
+			return;
+
+		// The transfer queue signals the value on transfer_timeline, the graphics queue waits for it, performs the layout transitions and signals the same value on timeline
+		//	Each timeline semaphore is only signaled by one queue, so the values can't be signaled out of order, and timeline only completes after the layout transitions
+		const uint64_t value = ++timeline_value;
+
+		static thread_local wi::vector<VkCommandBufferSubmitInfo> transfer_infos;
+		static thread_local wi::vector<VkCommandBufferSubmitInfo> transition_infos;
+		transfer_infos.clear();
+		transition_infos.clear();
+		for (auto& cmd : pending)
+		{
+			VkCommandBufferSubmitInfo& transfer_info = transfer_infos.emplace_back();
+			transfer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+			transfer_info.commandBuffer = cmd.transferCommandBuffer;
+			VkCommandBufferSubmitInfo& transition_info = transition_infos.emplace_back();
+			transition_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+			transition_info.commandBuffer = cmd.transitionCommandBuffer;
+		}
+
 		VkSubmitInfo2 submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
 
-		VkCommandBufferSubmitInfo cbSubmitInfo = {};
-		cbSubmitInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
-
 		VkSemaphoreSubmitInfo signalSemaphoreInfo = {};
 		signalSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+		signalSemaphoreInfo.value = value;
+		signalSemaphoreInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
 
 		VkSemaphoreSubmitInfo waitSemaphoreInfo = {};
 		waitSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+		waitSemaphoreInfo.semaphore = transfer_timeline;
+		waitSemaphoreInfo.value = value;
+		waitSemaphoreInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
 
 		{
-			cbSubmitInfo.commandBuffer = cmd.transferCommandBuffer;
-			signalSemaphoreInfo.semaphore = cmd.semaphore; // signal for graphics queue
-			signalSemaphoreInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			signalSemaphoreInfo.semaphore = transfer_timeline; // signal for graphics queue
 
-			submitInfo.commandBufferInfoCount = 1;
-			submitInfo.pCommandBufferInfos = &cbSubmitInfo;
+			submitInfo.commandBufferInfoCount = (uint32_t)transfer_infos.size();
+			submitInfo.pCommandBufferInfos = transfer_infos.data();
 			submitInfo.signalSemaphoreInfoCount = 1;
 			submitInfo.pSignalSemaphoreInfos = &signalSemaphoreInfo;
 
@@ -1542,30 +1981,31 @@ using namespace vulkan_internal;
 		}
 
 		{
-			waitSemaphoreInfo.semaphore = cmd.semaphore; // wait for init queue
-			waitSemaphoreInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-
-			cbSubmitInfo.commandBuffer = cmd.transitionCommandBuffer;
+			signalSemaphoreInfo.semaphore = timeline; // completion of the uploads, including the layout transitions
 
 			submitInfo.waitSemaphoreInfoCount = 1;
 			submitInfo.pWaitSemaphoreInfos = &waitSemaphoreInfo;
-			submitInfo.commandBufferInfoCount = 1;
-			submitInfo.pCommandBufferInfos = &cbSubmitInfo;
-			submitInfo.signalSemaphoreInfoCount = 0;
-			submitInfo.pSignalSemaphoreInfos = nullptr;
+			submitInfo.commandBufferInfoCount = (uint32_t)transition_infos.size();
+			submitInfo.pCommandBufferInfos = transition_infos.data();
+			submitInfo.signalSemaphoreInfoCount = 1;
+			submitInfo.pSignalSemaphoreInfos = &signalSemaphoreInfo;
 
 			std::scoped_lock lock(*device->queues[QUEUE_GRAPHICS].locker);
-			vulkan_check(vkQueueSubmit2(device->queues[QUEUE_GRAPHICS].queue, 1, &submitInfo, cmd.fence));
+			vulkan_check(vkQueueSubmit2(device->queues[QUEUE_GRAPHICS].queue, 1, &submitInfo, VK_NULL_HANDLE));
 		}
 
-		while (vulkan_check(vkWaitForFences(device->device, 1, &cmd.fence, VK_TRUE, timeout_value)) == VK_TIMEOUT)
+		for (auto& cmd : pending)
 		{
-			wilog_error("[CopyAllocator::submit] vkWaitForFences resulted in VK_TIMEOUT");
-			std::this_thread::yield();
+			cmd.fence_value = value;
+			if (cmd.ring_id != ~0ull)
+			{
+				ring_allocations[cmd.ring_id - ring_allocation_first_id].fence_value = value;
+			}
+			inflight.push_back(std::move(cmd));
 		}
-
-		std::scoped_lock lock(locker);
-		freelist.push_back(cmd);
+		pending.clear();
+		pending_size = 0;
+		stats_current.submits++;
 	}
 
 	void GraphicsDevice_Vulkan::DescriptorBinderPool::init(GraphicsDevice_Vulkan* device)
@@ -2119,11 +2559,11 @@ using namespace vulkan_internal;
 		dirty = DIRTY_NONE;
 	}
 
-	void GraphicsDevice_Vulkan::pso_validate(CommandList cmd)
+	bool GraphicsDevice_Vulkan::pso_validate(CommandList cmd)
 	{
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		if (!commandlist.dirty_pso)
-			return;
+			return true;
 
 		const PipelineState* pso = commandlist.active_pso;
 		const PipelineHash& pipeline_hash = commandlist.prev_pipeline_hash;
@@ -2144,165 +2584,26 @@ using namespace vulkan_internal;
 
 			if (pipeline == VK_NULL_HANDLE)
 			{
-				VkGraphicsPipelineCreateInfo pipelineInfo = internal_state->pipelineInfo; // make a copy here
-
-				// MSAA:
-				VkPipelineMultisampleStateCreateInfo multisampling = {};
-				multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-				multisampling.sampleShadingEnable = VK_FALSE;
-				multisampling.rasterizationSamples = (VkSampleCountFlagBits)commandlist.renderpass_info.sample_count;
-				if (pso->desc.rs != nullptr)
-				{
-					const RasterizerState& desc = *pso->desc.rs;
-					if (desc.forced_sample_count > 1)
-					{
-						multisampling.rasterizationSamples = (VkSampleCountFlagBits)desc.forced_sample_count;
-					}
-				}
-				multisampling.minSampleShading = 1.0f;
-				VkSampleMask samplemask = internal_state->samplemask;
-				samplemask = pso->desc.sample_mask;
-				multisampling.pSampleMask = &samplemask;
-				if (pso->desc.bs != nullptr)
+				// It could have been compiled in the background already:
+				std::scoped_lock lck(pipelines_async_locker);
+				auto it_async = pipelines_async.find(pipeline_hash);
+				if (it_async != pipelines_async.end())
 				{
-					multisampling.alphaToCoverageEnable = pso->desc.bs->alpha_to_coverage_enable ? VK_TRUE : VK_FALSE;
+					pipeline = it_async->second;
 				}
-				else
-				{
-					multisampling.alphaToCoverageEnable = VK_FALSE;
-				}
-				multisampling.alphaToOneEnable = VK_FALSE;
-
-				pipelineInfo.pMultisampleState = &multisampling;
-
-
-				// Blending:
-				uint32_t numBlendAttachments = 0;
-				VkPipelineColorBlendAttachmentState colorBlendAttachments[8] = {};
-				for (size_t i = 0; i < commandlist.renderpass_info.rt_count; ++i)
-				{
-					size_t attachmentIndex = 0;
-					if (pso->desc.bs->independent_blend_enable)
-						attachmentIndex = i;
-
-					const auto& desc = pso->desc.bs->render_target[attachmentIndex];
-					VkPipelineColorBlendAttachmentState& attachment = colorBlendAttachments[numBlendAttachments];
-					numBlendAttachments++;
-
-					attachment.blendEnable = desc.blend_enable ? VK_TRUE : VK_FALSE;
-
-					attachment.colorWriteMask = 0;
-					if (has_flag(desc.render_target_write_mask, ColorWrite::ENABLE_RED))
-					{
-						attachment.colorWriteMask |= VK_COLOR_COMPONENT_R_BIT;
-					}
-					if (has_flag(desc.render_target_write_mask, ColorWrite::ENABLE_GREEN))
-					{
-						attachment.colorWriteMask |= VK_COLOR_COMPONENT_G_BIT;
-					}
-					if (has_flag(desc.render_target_write_mask, ColorWrite::ENABLE_BLUE))
-					{
-						attachment.colorWriteMask |= VK_COLOR_COMPONENT_B_BIT;
-					}
-					if (has_flag(desc.render_target_write_mask, ColorWrite::ENABLE_ALPHA))
-					{
-						attachment.colorWriteMask |= VK_COLOR_COMPONENT_A_BIT;
-					}
-
-					attachment.srcColorBlendFactor = _ConvertBlend(desc.src_blend);
-					attachment.dstColorBlendFactor = _ConvertBlend(desc.dest_blend);
-					attachment.colorBlendOp = _ConvertBlendOp(desc.blend_op);
-					attachment.srcAlphaBlendFactor = _ConvertBlend(desc.src_blend_alpha);
-					attachment.dstAlphaBlendFactor = _ConvertBlend(desc.dest_blend_alpha);
-					attachment.alphaBlendOp = _ConvertBlendOp(desc.blend_op_alpha);
-				}
-
-				VkPipelineColorBlendStateCreateInfo colorBlending = {};
-				colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-				colorBlending.logicOpEnable = VK_FALSE;
-				colorBlending.logicOp = VK_LOGIC_OP_COPY;
-				colorBlending.attachmentCount = numBlendAttachments;
-				colorBlending.pAttachments = colorBlendAttachments;
-				colorBlending.blendConstants[0] = 1.0f;
-				colorBlending.blendConstants[1] = 1.0f;
-				colorBlending.blendConstants[2] = 1.0f;
-				colorBlending.blendConstants[3] = 1.0f;
-
-				pipelineInfo.pColorBlendState = &colorBlending;
-
-				// Input layout:
-				VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-				vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-				wi::vector<VkVertexInputBindingDescription> bindings;
-				wi::vector<VkVertexInputAttributeDescription> attributes;
-				if (pso->desc.il != nullptr)
-				{
-					uint32_t lastBinding = 0xFFFFFFFF;
-					for (auto& x : pso->desc.il->elements)
-					{
-						if (x.input_slot == lastBinding)
-							continue;
-						lastBinding = x.input_slot;
-						VkVertexInputBindingDescription& bind = bindings.emplace_back();
-						bind.binding = x.input_slot;
-						bind.inputRate = x.input_slot_class == InputClassification::PER_VERTEX_DATA ? VK_VERTEX_INPUT_RATE_VERTEX : VK_VERTEX_INPUT_RATE_INSTANCE;
-						bind.stride = GetFormatStride(x.format);
-					}
-
-					uint32_t offset = 0;
-					uint32_t i = 0;
-					lastBinding = 0xFFFFFFFF;
-					for (auto& x : pso->desc.il->elements)
-					{
-						VkVertexInputAttributeDescription attr = {};
-						attr.binding = x.input_slot;
-						if (attr.binding != lastBinding)
-						{
-							lastBinding = attr.binding;
-							offset = 0;
-						}
-						attr.format = _ConvertFormat(x.format);
-						attr.location = i;
-						attr.offset = x.aligned_byte_offset;
-						if (attr.offset == InputLayout::APPEND_ALIGNED_ELEMENT)
-						{
-							// need to manually resolve this from the format spec.
-							attr.offset = offset;
-							offset += GetFormatStride(x.format);
-						}
-
-						attributes.push_back(attr);
-
-						i++;
-					}
-
-					vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindings.size());
-					vertexInputInfo.pVertexBindingDescriptions = bindings.data();
-					vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size());
-					vertexInputInfo.pVertexAttributeDescriptions = attributes.data();
-				}
-				pipelineInfo.pVertexInputState = &vertexInputInfo;
-
-				pipelineInfo.renderPass = VK_NULL_HANDLE; // instead we use VkPipelineRenderingCreateInfo
+			}
 
-				VkPipelineRenderingCreateInfo renderingInfo = {};
-				renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
-				renderingInfo.viewMask = 0;
-				renderingInfo.colorAttachmentCount = commandlist.renderpass_info.rt_count;
-				VkFormat formats[8] = {};
-				for (uint32_t i = 0; i < commandlist.renderpass_info.rt_count; ++i)
-				{
-					formats[i] = _ConvertFormat(commandlist.renderpass_info.rt_formats[i]);
-				}
-				renderingInfo.pColorAttachmentFormats = formats;
-				renderingInfo.depthAttachmentFormat = _ConvertFormat(commandlist.renderpass_info.ds_format);
-				if (IsFormatStencilSupport(commandlist.renderpass_info.ds_format))
+			if (pipeline == VK_NULL_HANDLE)
+			{
+				if (pipeline_compilation_async)
 				{
-					renderingInfo.stencilAttachmentFormat = renderingInfo.depthAttachmentFormat;
+					// The draw will be skipped until the background compilation is finished:
+					pso_compile_async(pso, commandlist.renderpass_info);
+					return false;
 				}
-				pipelineInfo.pNext = &renderingInfo;
 
-				vulkan_check(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline));
+				pipeline = CreateGraphicsPipelineInternal(device, pipelineCache, *internal_state, pso->desc, commandlist.renderpass_info);
+				pso_manifest_record(internal_state->manifest_hash, commandlist.renderpass_info);
 
 				commandlist.pipelines_worker.push_back(std::make_pair(pipeline_hash, pipeline));
 			}
@@ -2315,14 +2616,53 @@ using namespace vulkan_internal;
 
 		vkCmdBindPipeline(commandlist.GetCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 		commandlist.dirty_pso = false;
+		return true;
+	}
+	void GraphicsDevice_Vulkan::pso_compile_async(const PipelineState* pso, const RenderPassInfo& renderpass_info) const
+	{
+		PipelineHash pipeline_hash;
+		pipeline_hash.pso = pso;
+		pipeline_hash.renderpass_hash = renderpass_info.get_hash();
+		{
+			std::scoped_lock lck(pipelines_async_locker);
+			if (pipelines_async.count(pipeline_hash) > 0 || !pipelines_async_pending.insert(pipeline_hash).second)
+				return;
+		}
+
+		// The job keeps the internal state alive and works on a copy of the description, because the PipelineState can be recreated in the meantime
+		std::shared_ptr<PipelineState_Vulkan> internal_state = std::static_pointer_cast<PipelineState_Vulkan>(pso->internal_state);
+		const PipelineStateDesc desc = pso->desc;
+		wi::jobsystem::Execute(pipelines_async_ctx, [this, pipeline_hash, internal_state, desc, renderpass_info](wi::jobsystem::JobArgs args) {
+			VkPipeline pipeline = CreateGraphicsPipelineInternal(device, pipelineCache, *internal_state, desc, renderpass_info);
+			pso_manifest_record(internal_state->manifest_hash, renderpass_info);
+
+			std::scoped_lock lck(pipelines_async_locker);
+			pipelines_async_pending.erase(pipeline_hash);
+			pipelines_async[pipeline_hash] = pipeline;
+		});
+	}
+	void GraphicsDevice_Vulkan::pso_manifest_record(uint64_t pso_hash, const RenderPassInfo& renderpass_info) const
+	{
+		const uint64_t renderpass_hash = renderpass_info.get_hash();
+		std::scoped_lock lck(pipeline_manifest_locker);
+		wi::vector<RenderPassInfo>& entries = pipeline_manifest[pso_hash];
+		for (auto& x : entries)
+		{
+			if (x.get_hash() == renderpass_hash)
+				return;
+		}
+		entries.push_back(renderpass_info);
+		pipeline_manifest_dirty = true;
 	}
 
-	void GraphicsDevice_Vulkan::predraw(CommandList cmd)
+	bool GraphicsDevice_Vulkan::predraw(CommandList cmd)
 	{
-		pso_validate(cmd);
+		if (!pso_validate(cmd))
+			return false;
 
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		commandlist.binder.flush(true, cmd);
+		return true;
 	}
 	void GraphicsDevice_Vulkan::predispatch(CommandList cmd)
 	{
@@ -2743,6 +3083,7 @@ using namespace vulkan_internal;
 			assert(features2.features.textureCompressionBC == VK_TRUE);
 			assert(features2.features.occlusionQueryPrecise == VK_TRUE);
 			assert(features_1_2.descriptorIndexing == VK_TRUE);
+			assert(features_1_2.timelineSemaphore == VK_TRUE);
 			assert(features_1_3.dynamicRendering == VK_TRUE);
 
 			// Init adapter properties
@@ -3499,6 +3840,48 @@ using namespace vulkan_internal;
 			vulkan_check(vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache));
 		}
 
+		// Pipeline manifest
+		{
+			// The pipelines in the manifest will be compiled in the background when their PipelineState is created
+			pipelines_async_ctx.priority = wi::jobsystem::Priority::Low;
+
+			wi::vector<uint8_t> manifestData;
+			if (wi::helper::FileRead(get_pipeline_manifest_path(), manifestData) && manifestData.size() >= sizeof(uint32_t) * 3)
+			{
+				size_t offset = 0;
+				auto read = [&](void* dst, size_t size) {
+					if (offset + size > manifestData.size())
+						return false;
+					std::memcpy(dst, manifestData.data() + offset, size);
+					offset += size;
+					return true;
+				};
+				uint32_t magic = 0;
+				uint32_t version = 0;
+				uint32_t count = 0;
+				read(&magic, sizeof(magic));
+				read(&version, sizeof(version));
+				read(&count, sizeof(count));
+				if (magic == pipeline_manifest_magic && version == pipeline_manifest_version)
+				{
+					for (uint32_t i = 0; i < count; ++i)
+					{
+						uint64_t pso_hash = 0;
+						RenderPassInfo renderpass_info;
+						if (!read(&pso_hash, sizeof(pso_hash)) ||
+							!read(renderpass_info.rt_formats, sizeof(renderpass_info.rt_formats)) ||
+							!read(&renderpass_info.rt_count, sizeof(renderpass_info.rt_count)) ||
+							!read(&renderpass_info.ds_format, sizeof(renderpass_info.ds_format)) ||
+							!read(&renderpass_info.sample_count, sizeof(renderpass_info.sample_count)))
+						{
+							break;
+						}
+						pipeline_manifest[pso_hash].push_back(renderpass_info);
+					}
+				}
+			}
+		}
+
 		// Static samplers:
 		{
 			VkSamplerCreateInfo createInfo = {};
@@ -3620,8 +4003,37 @@ using namespace vulkan_internal;
 	}
 	GraphicsDevice_Vulkan::~GraphicsDevice_Vulkan()
 	{
+		wi::jobsystem::Wait(pipelines_async_ctx);
 		vulkan_check(vkDeviceWaitIdle(device));
 
+		if (pipeline_manifest_dirty)
+		{
+			wi::vector<uint8_t> data;
+			auto write = [&](const void* src, size_t size) {
+				data.insert(data.end(), (const uint8_t*)src, (const uint8_t*)src + size);
+			};
+			uint32_t count = 0;
+			for (auto& x : pipeline_manifest)
+			{
+				count += (uint32_t)x.second.size();
+			}
+			write(&pipeline_manifest_magic, sizeof(pipeline_manifest_magic));
+			write(&pipeline_manifest_version, sizeof(pipeline_manifest_version));
+			write(&count, sizeof(count));
+			for (auto& x : pipeline_manifest)
+			{
+				for (auto& renderpass_info : x.second)
+				{
+					write(&x.first, sizeof(x.first));
+					write(renderpass_info.rt_formats, sizeof(renderpass_info.rt_formats));
+					write(&renderpass_info.rt_count, sizeof(renderpass_info.rt_count));
+					write(&renderpass_info.ds_format, sizeof(renderpass_info.ds_format));
+					write(&renderpass_info.sample_count, sizeof(renderpass_info.sample_count));
+				}
+			}
+			wi::helper::FileWrite(get_pipeline_manifest_path(), data.data(), data.size());
+		}
+
 		for (uint32_t fr = 0; fr < BUFFERCOUNT; ++fr)
 		{
 			for (int queue = 0; queue < QUEUE_COUNT; ++queue)
@@ -3670,6 +4082,10 @@ using namespace vulkan_internal;
 		{
 			vkDestroyPipeline(device, x.second, nullptr);
 		}
+		for (auto& x : pipelines_async)
+		{
+			vkDestroyPipeline(device, x.second, nullptr);
+		}
 
 		for (auto& x : semaphore_pool)
 		{
@@ -4022,7 +4438,7 @@ using namespace vulkan_internal;
 			else
 			{
 				cmd = copyAllocator.allocate(desc->size);
-				mapped_data = cmd.uploadbuffer.mapped_data;
+				mapped_data = cmd.mapped_data;
 			}
 
 			init_callback(mapped_data);
@@ -4031,12 +4447,12 @@ using namespace vulkan_internal;
 			{
 				VkBufferCopy copyRegion = {};
 				copyRegion.size = buffer->desc.size;
-				copyRegion.srcOffset = 0;
+				copyRegion.srcOffset = cmd.uploadbuffer_offset;
 				copyRegion.dstOffset = 0;
 
 				vkCmdCopyBuffer(
 					cmd.transferCommandBuffer,
-					to_internal(&cmd.uploadbuffer)->resource,
+					cmd.uploadbuffer,
 					internal_state->resource,
 					1,
 					&copyRegion
@@ -4502,8 +4918,10 @@ using namespace vulkan_internal;
 			}
 			else
 			{
-				cmd = copyAllocator.allocate(internal_state->allocation->GetSize());
-				mapped_data = cmd.uploadbuffer.mapped_data;
+				// the staging offset must be a multiple of the texel block size:
+				const uint64_t alignment = std::lcm(uint64_t(256), uint64_t(GetFormatStride(desc->format)));
+				cmd = copyAllocator.allocate(internal_state->allocation->GetSize(), alignment);
+				mapped_data = cmd.mapped_data;
 			}
 
 			wi::vector<VkBufferImageCopy> copyRegions;
@@ -4542,7 +4960,7 @@ using namespace vulkan_internal;
 					if (cmd.IsValid())
 					{
 						VkBufferImageCopy copyRegion = {};
-						copyRegion.bufferOffset = copyOffset;
+						copyRegion.bufferOffset = cmd.uploadbuffer_offset + copyOffset;
 						copyRegion.bufferRowLength = 0;
 						copyRegion.bufferImageHeight = 0;
 
@@ -4598,7 +5016,7 @@ using namespace vulkan_internal;
 
 				vkCmdCopyBufferToImage(
 					cmd.transferCommandBuffer,
-					to_internal(&cmd.uploadbuffer)->resource,
+					cmd.uploadbuffer,
 					internal_state->resource,
 					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 					(uint32_t)copyRegions.size(),
@@ -4715,6 +5133,8 @@ using namespace vulkan_internal;
 		moduleInfo.pCode = (const uint32_t*)shadercode;
 		vulkan_check(vkCreateShaderModule(device, &moduleInfo, nullptr, &internal_state->shaderModule));
 
+		internal_state->hash = wi::helper::stable_hash(wi::helper::stable_hash_seed, shadercode, shadercode_size);
+
 		internal_state->stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		internal_state->stageInfo.module = internal_state->shaderModule;
 		internal_state->stageInfo.pName = "main";
@@ -5276,6 +5696,7 @@ using namespace vulkan_internal;
 		internal_state->allocationhandler = allocationhandler;
 		pso->internal_state = internal_state;
 		pso->desc = *desc;
+		internal_state->manifest_hash = ComputePipelineManifestHash(*desc);
 
 		VkResult res = VK_SUCCESS;
 
@@ -5889,6 +6310,22 @@ using namespace vulkan_internal;
 
 			vulkan_check(vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &internal_state->pipeline));
 		}
+		else
+		{
+			// Render pass configurations that this pipeline state was used with in previous runs are compiled in the background:
+			wi::vector<RenderPassInfo> manifest_entries;
+			pipeline_manifest_locker.lock();
+			auto it = pipeline_manifest.find(internal_state->manifest_hash);
+			if (it != pipeline_manifest.end())
+			{
+				manifest_entries = it->second;
+			}
+			pipeline_manifest_locker.unlock();
+			for (auto& x : manifest_entries)
+			{
+				pso_compile_async(pso, x);
+			}
+		}
 
 		return res == VK_SUCCESS;
 	}
@@ -7191,6 +7628,24 @@ using namespace vulkan_internal;
 	}
 	void GraphicsDevice_Vulkan::SubmitCommandLists()
 	{
+		// Pending resource uploads are submitted before the frame:
+		//	The graphics queue is ordered after them by submission order, the other queues must wait for the upload timeline
+		const uint64_t upload_value = copyAllocator.flush(true);
+		if (upload_value > upload_value_waited)
+		{
+			upload_value_waited = upload_value;
+			for (int q = 0; q < QUEUE_COUNT; ++q)
+			{
+				if (q == QUEUE_GRAPHICS || queues[q].queue == VK_NULL_HANDLE)
+					continue;
+				VkSemaphoreSubmitInfo& waitSemaphore = queues[q].submit_waitSemaphoreInfos.emplace_back();
+				waitSemaphore.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+				waitSemaphore.semaphore = copyAllocator.timeline;
+				waitSemaphore.value = upload_value;
+				waitSemaphore.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			}
+		}
+
 		// Submit current frame:
 		{
 			uint32_t cmd_last = cmd_count;
@@ -7276,6 +7731,24 @@ using namespace vulkan_internal;
 				commandlist.pipelines_worker.clear();
 			}
 
+			// Pipelines that were compiled in the background are merged into the global cache:
+			pipelines_async_locker.lock();
+			for (auto& x : pipelines_async)
+			{
+				if (pipelines_global.count(x.first) == 0)
+				{
+					pipelines_global[x.first] = x.second;
+				}
+				else
+				{
+					allocationhandler->destroylocker.lock();
+					allocationhandler->destroyer_pipelines.push_back(std::make_pair(x.second, FRAMECOUNT));
+					allocationhandler->destroylocker.unlock();
+				}
+			}
+			pipelines_async.clear();
+			pipelines_async_locker.unlock();
+
 			// final submits with fences:
 			for (int q = 0; q < QUEUE_COUNT; ++q)
 			{
@@ -7347,10 +7820,13 @@ using namespace vulkan_internal;
 
 	void GraphicsDevice_Vulkan::WaitForGPU() const
 	{
+		copyAllocator.flush();
 		vulkan_check(vkDeviceWaitIdle(device));
 	}
 	void GraphicsDevice_Vulkan::ClearPipelineStateCache()
 	{
+		wi::jobsystem::Wait(pipelines_async_ctx);
+
 		allocationhandler->destroylocker.lock();
 
 		pso_layout_cache_mutex.lock();
@@ -7368,6 +7844,15 @@ using namespace vulkan_internal;
 		}
 		pipelines_global.clear();
 
+		pipelines_async_locker.lock();
+		for (auto& x : pipelines_async)
+		{
+			allocationhandler->destroyer_pipelines.push_back(std::make_pair(x.second, FRAMECOUNT));
+		}
+		pipelines_async.clear();
+		pipelines_async_pending.clear();
+		pipelines_async_locker.unlock();
+
 		for (auto& x : commandlists)
 		{
 			for (auto& y : x->pipelines_worker)
@@ -8419,45 +8904,52 @@ using namespace vulkan_internal;
 	}
 	void GraphicsDevice_Vulkan::Draw(uint32_t vertexCount, uint32_t startVertexLocation, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		vkCmdDraw(commandlist.GetCommandBuffer(), vertexCount, 1, startVertexLocation, 0);
 	}
 	void GraphicsDevice_Vulkan::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		vkCmdDrawIndexed(commandlist.GetCommandBuffer(), indexCount, 1, startIndexLocation, baseVertexLocation, 0);
 	}
 	void GraphicsDevice_Vulkan::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		vkCmdDraw(commandlist.GetCommandBuffer(), vertexCount, instanceCount, startVertexLocation, startInstanceLocation);
 	}
 	void GraphicsDevice_Vulkan::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		vkCmdDrawIndexed(commandlist.GetCommandBuffer(), indexCount, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
 	}
 	void GraphicsDevice_Vulkan::DrawInstancedIndirect(const GPUBuffer* args, uint64_t args_offset, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		auto internal_state = to_internal(args);
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		vkCmdDrawIndirect(commandlist.GetCommandBuffer(), internal_state->resource, args_offset, 1, (uint32_t)sizeof(VkDrawIndirectCommand));
 	}
 	void GraphicsDevice_Vulkan::DrawIndexedInstancedIndirect(const GPUBuffer* args, uint64_t args_offset, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		auto internal_state = to_internal(args);
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		vkCmdDrawIndexedIndirect(commandlist.GetCommandBuffer(), internal_state->resource, args_offset, 1, sizeof(VkDrawIndexedIndirectCommand));
 	}
 	void GraphicsDevice_Vulkan::DrawInstancedIndirectCount(const GPUBuffer* args, uint64_t args_offset, const GPUBuffer* count, uint64_t count_offset, uint32_t max_count, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		auto args_internal = to_internal(args);
 		auto count_internal = to_internal(count);
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
@@ -8465,7 +8957,8 @@ using namespace vulkan_internal;
 	}
 	void GraphicsDevice_Vulkan::DrawIndexedInstancedIndirectCount(const GPUBuffer* args, uint64_t args_offset, const GPUBuffer* count, uint64_t count_offset, uint32_t max_count, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		auto args_internal = to_internal(args);
 		auto count_internal = to_internal(count);
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
@@ -8486,20 +8979,23 @@ using namespace vulkan_internal;
 	}
 	void GraphicsDevice_Vulkan::DispatchMesh(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		vkCmdDrawMeshTasksEXT(commandlist.GetCommandBuffer(), threadGroupCountX, threadGroupCountY, threadGroupCountZ);
 	}
 	void GraphicsDevice_Vulkan::DispatchMeshIndirect(const GPUBuffer* args, uint64_t args_offset, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		auto internal_state = to_internal(args);
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
 		vkCmdDrawMeshTasksIndirectEXT(commandlist.GetCommandBuffer(), internal_state->resource, args_offset, 1, sizeof(VkDispatchIndirectCommand));
 	}
 	void GraphicsDevice_Vulkan::DispatchMeshIndirectCount(const GPUBuffer* args, uint64_t args_offset, const GPUBuffer* count, uint64_t count_offset, uint32_t max_count, CommandList cmd)
 	{
-		predraw(cmd);
+		if (!predraw(cmd))
+			return;
 		auto args_internal = to_internal(args);
 		auto count_internal = to_internal(count);
 		CommandList_Vulkan& commandlist = GetCommandList(cmd);
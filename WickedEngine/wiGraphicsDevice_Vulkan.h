@@ -9,6 +9,8 @@
 #ifdef WICKEDENGINE_BUILD_VULKAN
 #include "wiGraphicsDevice.h"
 #include "wiUnorderedMap.h"
+#include "wiUnorderedSet.h"
+#include "wiJobSystem.h"
 #include "wiVector.h"
 #include "wiSpinLock.h"
 #include "wiBacklog.h"
@@ -215,8 +217,14 @@ namespace wi::graphics
 		CommandQueue queue_init;
 		CommandQueue queue_sparse;
 
+		// Uploads resource initial data through a persistent staging ring buffer
+		//	Many uploads from multiple threads are batched together into one submission, which is made when the pending data reaches flush_threshold, or at the latest in SubmitCommandLists()
+		//	Completion is tracked with a timeline semaphore, so producer threads don't need to wait for the GPU
 		struct CopyAllocator
 		{
+			static constexpr uint64_t ring_size = 64ull * 1024ull * 1024ull;
+			static constexpr uint64_t flush_threshold = 16ull * 1024ull * 1024ull;
+
 			GraphicsDevice_Vulkan* device = nullptr;
 			std::mutex locker;
 
@@ -226,19 +234,53 @@ namespace wi::graphics
 				VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE;
 				VkCommandPool transitionCommandPool = VK_NULL_HANDLE;
 				VkCommandBuffer transitionCommandBuffer = VK_NULL_HANDLE;
-				VkFence fence = VK_NULL_HANDLE;
-				VkSemaphore semaphore = VK_NULL_HANDLE;
-				GPUBuffer uploadbuffer;
+				VkBuffer uploadbuffer = VK_NULL_HANDLE;	// staging buffer, copies must read from uploadbuffer_offset
+				uint64_t uploadbuffer_offset = 0;
+				void* mapped_data = nullptr;			// staging memory for the requested size, already offset
+				uint64_t size = 0;
+				uint64_t ring_id = ~0ull;				// sub-allocation in the ring, or ~0 if not using the ring
+				GPUBuffer dedicated;					// staging for requests that are too large for the ring
+				uint64_t fence_value = 0;				// timeline value that signals completion
 				constexpr bool IsValid() const { return transferCommandBuffer != VK_NULL_HANDLE; }
 			};
-			wi::vector<CopyCMD> freelist;
+			wi::vector<CopyCMD> freelist;	// ready to be reused
+			wi::vector<CopyCMD> pending;	// recorded, waiting for flush
+			wi::vector<CopyCMD> inflight;	// flushed, waiting for the GPU
+			uint64_t pending_size = 0;
+
+			GPUBuffer ring;
+			uint64_t ring_head = 0;
+			uint64_t ring_tail = 0;
+			struct RingAllocation
+			{
+				uint64_t end = 0;
+				uint64_t fence_value = 0;	// 0 while it is not flushed yet
+			};
+			std::deque<RingAllocation> ring_allocations; // in allocation order, reclaimed from the front
+			uint64_t ring_allocation_first_id = 0;
+
+			VkSemaphore timeline = VK_NULL_HANDLE;			// signaled only by the graphics queue after the layout transitions, the uploads are complete when it is reached
+			VkSemaphore transfer_timeline = VK_NULL_HANDLE;	// signaled only by the transfer queue, the graphics queue waits for it before the layout transitions
+			uint64_t timeline_value = 0;	// the last value that was submitted for signaling (the same value is used on both timelines)
+
+			UploadStats stats_current;
+			UploadStats stats_last;
 
 			void init(GraphicsDevice_Vulkan* device);
 			void destroy();
-			CopyCMD allocate(uint64_t staging_size);
+			CopyCMD allocate(uint64_t staging_size, uint64_t alignment = 256);
 			void submit(CopyCMD cmd);
+			// Submits all pending uploads, and returns the timeline value that will be signaled when all uploads so far are completed
+			//	frame_end: the upload statistics of the current frame are finalized
+			uint64_t flush(bool frame_end = false);
+
+			// these must be called while locker is held:
+			void flush_locked();
+			void update_locked();
+			bool ring_allocate_locked(uint64_t size, uint64_t alignment, uint64_t& offset);
 		};
 		mutable CopyAllocator copyAllocator;
+		uint64_t upload_value_waited = 0;
 
 		VkFence frame_fence[BUFFERCOUNT][QUEUE_COUNT] = {};
 
@@ -393,9 +435,24 @@ namespace wi::graphics
 		VkPipelineCache pipelineCache = VK_NULL_HANDLE;
 		wi::unordered_map<PipelineHash, VkPipeline> pipelines_global;
 
-		void pso_validate(CommandList cmd);
+		// Pipelines compiled by background jobs, they are moved to pipelines_global in SubmitCommandLists()
+		mutable wi::unordered_map<PipelineHash, VkPipeline> pipelines_async;
+		mutable wi::unordered_set<PipelineHash> pipelines_async_pending;
+		mutable std::mutex pipelines_async_locker;
+		mutable wi::jobsystem::context pipelines_async_ctx;
+		bool pipeline_compilation_async = false;
 
-		void predraw(CommandList cmd);
+		// Pipeline manifest: the render pass configurations that each pipeline state was compiled for, keyed by the persistent hash of the pipeline state
+		//	It is saved next to the pipeline cache, and used to compile pipelines in the background in the next run
+		mutable wi::unordered_map<uint64_t, wi::vector<RenderPassInfo>> pipeline_manifest;
+		mutable std::mutex pipeline_manifest_locker;
+		mutable bool pipeline_manifest_dirty = false;
+
+		bool pso_validate(CommandList cmd);
+		void pso_compile_async(const PipelineState* pso, const RenderPassInfo& renderpass_info) const;
+		void pso_manifest_record(uint64_t pso_hash, const RenderPassInfo& renderpass_info) const;
+
+		bool predraw(CommandList cmd);
 		void predispatch(CommandList cmd);
 
 		static constexpr uint32_t immutable_sampler_slot_begin = 100;
@@ -440,6 +497,9 @@ namespace wi::graphics
 		void WaitForGPU() const override;
 		void ClearPipelineStateCache() override;
 		size_t GetActivePipelineCount() const override { return pipelines_global.size(); }
+		void SetPipelineCompilationAsync(bool value) override { pipeline_compilation_async = value; }
+		bool IsPipelineCompilationAsync() const override { return pipeline_compilation_async; }
+		bool IsPipelineCompilationActive() const override { return wi::jobsystem::IsBusy(pipelines_async_ctx); }
 
 		ShaderFormat GetShaderFormat() const override { return ShaderFormat::SPIRV; }
 
@@ -466,6 +526,12 @@ namespace wi::graphics
 			return alignment;
 		}
 
+		UploadStats GetUploadStats() const override
+		{
+			std::scoped_lock lock(copyAllocator.locker);
+			return copyAllocator.stats_last;
+		}
+
 		MemoryUsage GetMemoryUsage() const override
 		{
 			MemoryUsage retval;
@@ -3,6 +3,7 @@
 #include "wiBacklog.h"
 #include "wiEventHandler.h"
 #include "wiMath.h"
+#include "wiJobSystem.h"
 
 #include "Utility/lodepng.h"
 #include "Utility/dds.h"
@@ -1137,6 +1138,18 @@ namespace wi::helper
 		return std::chrono::duration_cast<std::chrono::duration<uint64_t>>(tim.time_since_epoch()).count();
 	}
 
+	bool FileDelete(const std::string& fileName)
+	{
+		std::error_code ec;
+		return std::filesystem::remove(ToNativeString(fileName), ec);
+	}
+
+	void FileTouch(const std::string& fileName)
+	{
+		std::error_code ec;
+		std::filesystem::last_write_time(ToNativeString(fileName), std::filesystem::file_time_type::clock::now(), ec);
+	}
+
 	std::string GetTempDirectoryPath()
 	{
 #if defined(PLATFORM_XBOX) || defined(PLATFORM_PS5)
@@ -1670,6 +1683,118 @@ namespace wi::helper
 		return ZSTD_isError(res) == 0;
 	}
 
+	// Chunked compression layout:
+	//	- ChunkedHeader
+	//	- uint64_t chunk_end_offsets[chunk_count] (seek table, offsets are relative to the first chunk)
+	//	- compressed chunks, each is an independent zstd frame
+	struct ChunkedHeader
+	{
+		uint32_t magic = 0;
+		uint32_t chunk_count = 0;
+		uint64_t chunk_size = 0;
+		uint64_t uncompressed_size = 0;
+	};
+	static constexpr uint32_t chunked_magic = 0x435A4957; // "WIZC"
+	static constexpr uint64_t chunked_max_chunk_size = 256ull * 1024ull * 1024ull; // larger chunk size in a header is considered corrupt
+	static constexpr uint64_t chunked_max_uncompressed_size = 16ull * 1024ull * 1024ull * 1024ull; // larger uncompressed size in a header is considered corrupt, to not allocate it
+
+	bool CompressChunked(const uint8_t* src_data, size_t src_size, wi::vector<uint8_t>& dst_data, int level, size_t chunk_size)
+	{
+		if (chunk_size == 0 || chunk_size > chunked_max_chunk_size || src_size > chunked_max_uncompressed_size)
+			return false;
+		ChunkedHeader header;
+		header.magic = chunked_magic;
+		header.chunk_count = (uint32_t)((src_size + chunk_size - 1) / chunk_size);
+		header.chunk_size = chunk_size;
+		header.uncompressed_size = src_size;
+
+		const size_t table_offset = sizeof(ChunkedHeader);
+		const size_t chunks_offset = table_offset + sizeof(uint64_t) * header.chunk_count;
+		const size_t chunk_bound = ZSTD_compressBound(chunk_size);
+
+		// Every chunk is compressed into its own worst case sized slot first, then the slots are packed together:
+		dst_data.resize(chunks_offset + chunk_bound * header.chunk_count);
+		wi::vector<size_t> compressed_sizes(header.chunk_count);
+		std::atomic_bool success{ true };
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, header.chunk_count, 1, [&](wi::jobsystem::JobArgs args) {
+			const size_t src_offset = args.jobIndex * chunk_size;
+			const size_t size = std::min(chunk_size, src_size - src_offset);
+			size_t res = ZSTD_compress(dst_data.data() + chunks_offset + args.jobIndex * chunk_bound, chunk_bound, src_data + src_offset, size, level);
+			if (ZSTD_isError(res))
+			{
+				success.store(false);
+				return;
+			}
+			compressed_sizes[args.jobIndex] = res;
+		});
+		wi::jobsystem::Wait(ctx);
+		if (!success.load())
+			return false;
+
+		std::memcpy(dst_data.data(), &header, sizeof(header));
+		uint64_t offset = 0;
+		for (uint32_t i = 0; i < header.chunk_count; ++i)
+		{
+			std::memmove(dst_data.data() + chunks_offset + offset, dst_data.data() + chunks_offset + i * chunk_bound, compressed_sizes[i]);
+			offset += compressed_sizes[i];
+			std::memcpy(dst_data.data() + table_offset + sizeof(uint64_t) * i, &offset, sizeof(offset));
+		}
+		dst_data.resize(chunks_offset + offset);
+		return true;
+	}
+
+	bool DecompressChunked(const uint8_t* src_data, size_t src_size, wi::vector<uint8_t>& dst_data)
+	{
+		ChunkedHeader header;
+		if (src_size < sizeof(header))
+			return false;
+		std::memcpy(&header, src_data, sizeof(header));
+		// The header and the seek table are validated before anything is allocated, so corrupt data can't cause a huge allocation or out of bounds read:
+		if (header.magic != chunked_magic || header.chunk_size == 0 || header.chunk_size > chunked_max_chunk_size || header.uncompressed_size > chunked_max_uncompressed_size)
+			return false;
+		const size_t table_offset = sizeof(ChunkedHeader);
+		const size_t chunks_offset = table_offset + sizeof(uint64_t) * header.chunk_count;
+		if (src_size < chunks_offset || header.chunk_count != (header.uncompressed_size + header.chunk_size - 1) / header.chunk_size)
+			return false;
+		auto chunk_end_offset = [&](uint32_t chunk) {
+			uint64_t offset = 0;
+			std::memcpy(&offset, src_data + table_offset + sizeof(uint64_t) * chunk, sizeof(offset)); // source data is not necessarily aligned
+			return offset;
+		};
+		const uint64_t chunks_size = src_size - chunks_offset;
+		uint64_t prev_end = 0;
+		for (uint32_t i = 0; i < header.chunk_count; ++i)
+		{
+			const uint64_t end = chunk_end_offset(i);
+			if (end < prev_end || end > chunks_size)
+				return false;
+			prev_end = end;
+		}
+
+		dst_data.resize(header.uncompressed_size);
+		std::atomic_bool success{ true };
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, header.chunk_count, 1, [&](wi::jobsystem::JobArgs args) {
+			const uint64_t begin = args.jobIndex == 0 ? 0 : chunk_end_offset(args.jobIndex - 1);
+			const uint64_t end = chunk_end_offset(args.jobIndex);
+			const size_t dst_offset = args.jobIndex * header.chunk_size;
+			const size_t size = std::min(size_t(header.chunk_size), size_t(header.uncompressed_size - dst_offset));
+			size_t res = ZSTD_decompress(dst_data.data() + dst_offset, size, src_data + chunks_offset + begin, size_t(end - begin));
+			if (ZSTD_isError(res) || res != size)
+			{
+				success.store(false);
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+		if (!success.load())
+		{
+			dst_data.clear(); // don't leave partially decompressed data
+			return false;
+		}
+		return true;
+	}
+
 	size_t HashByteData(const uint8_t* data, size_t size)
 	{
 		size_t hash = 0;
@@ -6,6 +6,7 @@
 
 #include <string>
 #include <functional>
+#include <type_traits>
 
 #if WI_VECTOR_TYPE
 namespace std
@@ -39,6 +40,30 @@ namespace wi::helper
 		return hash;
 	}
 
+	// 64-bit FNV-1a, this doesn't depend on the platform's std::hash, so the results can be persisted and shared between machines
+	static constexpr uint64_t stable_hash_seed = 0xcbf29ce484222325ull;
+	inline uint64_t stable_hash(uint64_t hash, const void* data, size_t size)
+	{
+		const uint8_t* bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 0x00000100000001b3ull;
+		}
+		return hash;
+	}
+	inline uint64_t stable_hash(uint64_t hash, const std::string& str)
+	{
+		hash = stable_hash(hash, str.c_str(), str.length());
+		return stable_hash(hash, "", 1); // separator, so that {"ab", "c"} and {"a", "bc"} are different
+	}
+	template<typename T>
+	inline uint64_t stable_hash(uint64_t hash, T value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value);
+		return stable_hash(hash, &value, sizeof(value));
+	}
+
 	std::string toUpper(const std::string& s);
 
 	std::string toLower(const std::string& s);
@@ -109,6 +134,12 @@ namespace wi::helper
 
 	uint64_t FileTimestamp(const std::string& fileName);
 
+	// Deletes the file, returns true if successful
+	bool FileDelete(const std::string& fileName);
+
+	// Updates the timestamp of the file to the current time
+	void FileTouch(const std::string& fileName);
+
 	std::string GetTempDirectoryPath();
 	std::string GetCacheDirectoryPath();
 	std::string GetCurrentPath();
@@ -199,6 +230,15 @@ namespace wi::helper
 	// Lossless decompression of byte array that was compressed with wi::helper::Compress()
 	bool Decompress(const uint8_t* src_data, size_t src_size, wi::vector<uint8_t>& dst_data);
 
+	// Lossless compression of byte array into independent chunks which are compressed in parallel with wi::jobsystem
+	//	The result starts with a seek table of the chunks, it must be decompressed with wi::helper::DecompressChunked()
+	//	chunk_size : the uncompressed size of one chunk, smaller chunks allow more parallelism but compress slightly worse
+	bool CompressChunked(const uint8_t* src_data, size_t src_size, wi::vector<uint8_t>& dst_data, int level = 0, size_t chunk_size = 1024 * 1024);
+
+	// Lossless decompression of byte array that was compressed with wi::helper::CompressChunked(), the chunks are decompressed in parallel with wi::jobsystem
+	//	Returns false for corrupt data, the seek table is validated and the uncompressed size is limited before allocating
+	bool DecompressChunked(const uint8_t* src_data, size_t src_size, wi::vector<uint8_t>& dst_data);
+
 	// Hash the contents of a file:
 	size_t HashByteData(const uint8_t* data, size_t size);
 };
@@ -35,6 +35,30 @@ namespace wi::image
 	static thread_local Texture backgroundTexture;
 	static thread_local wi::Canvas canvas;
 
+	struct BatchItem
+	{
+		ImageConstants image;
+		float4 corners[4];
+		const PipelineState* pso;
+		uint32_t stencilRef;
+		XMFLOAT4 rect; // screen space bounds (min x, min y, max x, max y) in normalized device coordinates
+	};
+	struct Batch
+	{
+		bool active = false;
+		CommandList cmd;
+		wi::vector<BatchItem> items;
+		struct Range
+		{
+			const PipelineState* pso;
+			uint32_t stencilRef;
+			XMFLOAT4 rect;
+			wi::vector<uint32_t> items;
+		};
+		wi::vector<Range> ranges;
+	};
+	static thread_local Batch batch;
+
 	void SetBackground(const Texture& texture)
 	{
 		backgroundTexture = texture;
@@ -49,6 +73,14 @@ namespace wi::image
 	{
 		GraphicsDevice* device = wi::graphics::GetDevice();
 
+		// Full screen and rounded images are not batched, but the previously batched images must be drawn before them:
+		assert(!batch.active || batch.cmd.internal_state == cmd.internal_state);
+		const bool batched = batch.active && !params.isFullScreenEnabled() && !params.isCornerRoundingEnabled();
+		if (batch.active && !batched)
+		{
+			FlushBatch(cmd);
+		}
+
 		const Sampler* sampler = &samplers[SAMPLER_LINEAR_CLAMP];
 
 		if (params.quality == QUALITY_NEAREST)
@@ -178,6 +210,7 @@ namespace wi::image
 
 		STRIP_MODE strip_mode = STRIP_ON;
 		uint32_t index_count = 0;
+		float4 corners[4] = {};
 
 		if (params.isFullScreenEnabled())
 		{
@@ -214,7 +247,6 @@ namespace wi::image
 			}
 
 			XMVECTOR V[4];
-			float4 corners[4];
 			for (int i = 0; i < arraysize(params.corners); ++i)
 			{
 				V[i] = XMVectorSet(params.corners[i].x - params.pivot.x, params.corners[i].y - params.pivot.y, 0, 1);
@@ -312,7 +344,7 @@ namespace wi::image
 				indices[ii++] = vi - 1;
 				indices[ii++] = 1;
 			}
-			else
+			else if (!batched)
 			{
 				// Non rounded image will simply use a 4 vertex triangle strip (simple quad)
 				GraphicsDevice::GPUAllocation mem = device->AllocateGPU(sizeof(float4) * 4, cmd);
@@ -364,16 +396,44 @@ namespace wi::image
 		image.texMulAdd2.z += params.texOffset2.x * inv_width;	// texOffset.x: add
 		image.texMulAdd2.w += params.texOffset2.y * inv_height;	// texOffset.y: add
 
-		device->EventBegin("Image", cmd);
-
 		uint32_t stencilRef = params.stencilRef;
 		if (params.stencilRefMode == STENCILREFMODE_USER)
 		{
 			stencilRef = wi::renderer::CombineStencilrefs(STENCILREF_EMPTY, (uint8_t)stencilRef);
 		}
+		const PipelineState* pso = &imagePSO[params.blendFlag][params.stencilComp][params.stencilRefMode][params.isDepthTestEnabled()][strip_mode];
+
+		if (batched)
+		{
+			BatchItem& item = batch.items.emplace_back();
+			item.image = image;
+			std::memcpy(item.corners, corners, sizeof(corners));
+			item.pso = pso;
+			item.stencilRef = stencilRef;
+			item.rect = XMFLOAT4(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+			for (auto& corner : corners)
+			{
+				if (corner.w <= 0)
+				{
+					// behind the projection, the bounds can't be determined, so it's treated as overlapping with everything:
+					item.rect = XMFLOAT4(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+					break;
+				}
+				const float x = corner.x / corner.w;
+				const float y = corner.y / corner.w;
+				item.rect.x = std::min(item.rect.x, x);
+				item.rect.y = std::min(item.rect.y, y);
+				item.rect.z = std::max(item.rect.z, x);
+				item.rect.w = std::max(item.rect.w, y);
+			}
+			return;
+		}
+
+		device->EventBegin("Image", cmd);
+
 		device->BindStencilRef(stencilRef, cmd);
 
-		device->BindPipelineState(&imagePSO[params.blendFlag][params.stencilComp][params.stencilRefMode][params.isDepthTestEnabled()][strip_mode], cmd);
+		device->BindPipelineState(pso, cmd);
 
 		device->BindDynamicConstantBuffer(image, CBSLOT_IMAGE, cmd);
 
@@ -399,6 +459,108 @@ namespace wi::image
 	}
 
 
+	void BeginBatch(CommandList cmd)
+	{
+		assert(!batch.active); // batches can't be nested
+		batch.active = true;
+		batch.cmd = cmd;
+		batch.items.clear();
+	}
+
+	void FlushBatch(CommandList cmd)
+	{
+		if (!batch.active || batch.items.empty())
+			return;
+		assert(batch.cmd.internal_state == cmd.internal_state);
+
+		GraphicsDevice* device = wi::graphics::GetDevice();
+
+		// Group images by render state, textures and samplers don't matter because they are bindless
+		//	An image can only be moved into an earlier range if it doesn't overlap with any image that was drawn after that range
+		batch.ranges.clear();
+		for (uint32_t i = 0; i < (uint32_t)batch.items.size(); ++i)
+		{
+			const BatchItem& item = batch.items[i];
+			Batch::Range* target = nullptr;
+			const int lookback = 32; // limit the search to keep it linear in the image count
+			for (int r = (int)batch.ranges.size() - 1; r >= std::max(0, (int)batch.ranges.size() - lookback); --r)
+			{
+				Batch::Range& range = batch.ranges[r];
+				if (range.pso == item.pso && range.stencilRef == item.stencilRef)
+				{
+					target = &range;
+					break;
+				}
+				const bool overlap =
+					item.rect.x <= range.rect.z && item.rect.z >= range.rect.x &&
+					item.rect.y <= range.rect.w && item.rect.w >= range.rect.y;
+				if (overlap)
+					break;
+			}
+			if (target == nullptr)
+			{
+				target = &batch.ranges.emplace_back();
+				target->pso = item.pso;
+				target->stencilRef = item.stencilRef;
+				target->rect = item.rect;
+				target->items.clear();
+			}
+			else
+			{
+				target->rect.x = std::min(target->rect.x, item.rect.x);
+				target->rect.y = std::min(target->rect.y, item.rect.y);
+				target->rect.z = std::max(target->rect.z, item.rect.z);
+				target->rect.w = std::max(target->rect.w, item.rect.w);
+			}
+			target->items.push_back(i);
+		}
+
+		// Per instance constants are followed by the quad corners in the same allocation:
+		const uint64_t image_count = batch.items.size();
+		const uint64_t corners_offset = sizeof(ImageConstants) * image_count;
+		GraphicsDevice::GPUAllocation mem = device->AllocateGPU(corners_offset + sizeof(float4) * 4 * image_count, cmd);
+		const int descriptor = device->GetDescriptorIndex(&mem.buffer, SubresourceType::SRV);
+		ImageConstants* instances = (ImageConstants*)mem.data;
+		float4* corners = (float4*)((uint8_t*)mem.data + corners_offset);
+
+		device->EventBegin("Image Batch", cmd);
+
+		uint32_t instance_index = 0;
+		for (auto& range : batch.ranges)
+		{
+			const uint32_t first_instance = instance_index;
+			for (uint32_t i : range.items)
+			{
+				BatchItem& item = batch.items[i];
+				item.image.buffer_index = descriptor;
+				item.image.buffer_offset = uint(mem.offset + corners_offset + sizeof(float4) * 4 * instance_index);
+				std::memcpy(instances + instance_index, &item.image, sizeof(ImageConstants));
+				std::memcpy(corners + instance_index * 4, item.corners, sizeof(item.corners));
+				instance_index++;
+			}
+
+			ImageConstants image = {};
+			image.flags = IMAGE_FLAG_INSTANCED;
+			image.buffer_index = descriptor;
+			image.buffer_offset = uint(mem.offset + sizeof(ImageConstants) * first_instance);
+
+			device->BindStencilRef(range.stencilRef, cmd);
+			device->BindPipelineState(range.pso, cmd);
+			device->BindDynamicConstantBuffer(image, CBSLOT_IMAGE, cmd);
+			device->DrawInstanced(4, (uint32_t)range.items.size(), 0, 0, cmd);
+		}
+
+		device->EventEnd(cmd);
+
+		batch.items.clear();
+	}
+
+	void EndBatch(CommandList cmd)
+	{
+		FlushBatch(cmd);
+		batch.active = false;
+	}
+
 	void LoadShaders()
 	{
 		wi::renderer::LoadShader(ShaderStage::VS, vertexShader, "imageVS.cso");
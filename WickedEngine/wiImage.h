@@ -237,6 +237,17 @@ namespace wi::image
 	// Draw the specified texture with the specified parameters
 	void Draw(const wi::graphics::Texture* texture, const Params& params, wi::graphics::CommandList cmd);
 
+	// Begin batching on the current thread: Draw() will only collect images until FlushBatch() or EndBatch()
+	//	The collected images are grouped by render state and drawn with instancing, textures and samplers can differ within the same draw call
+	//	The drawing order is only changed between images that don't overlap on screen
+	//	Full screen and corner rounded images are not batched, they flush the batch before they are drawn
+	//	Other rendering into the command list while batching (fonts, changing scissor, render passes, etc.) must be preceded by FlushBatch()
+	void BeginBatch(wi::graphics::CommandList cmd);
+	// Draw all images that were collected so far, batching remains active
+	void FlushBatch(wi::graphics::CommandList cmd);
+	// Draw all images that were collected so far, and stop batching
+	void EndBatch(wi::graphics::CommandList cmd);
+
 	// Initializes the image renderer
 	void Initialize();
 
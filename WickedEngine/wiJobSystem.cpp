@@ -3,6 +3,7 @@
 #include "wiBacklog.h"
 #include "wiPlatform.h"
 #include "wiTimer.h"
+#include "wiProfiler.h"
 
 #include <memory>
 #include <algorithm>
@@ -33,6 +34,10 @@ namespace wi::jobsystem
 		uint32_t sharedmemory_size;
 		inline uint32_t execute()
 		{
+			static const char* span_names[] = { "Job (High)", "Job (Low)", "Job (Streaming)" };
+			static_assert(arraysize(span_names) == int(Priority::Count));
+			wi::profiler::BeginSpan(span_names[int(ctx->priority)]);
+
 			JobArgs args;
 			args.groupID = groupID;
 			if (sharedmemory_size > 0)
@@ -53,6 +58,8 @@ namespace wi::jobsystem
 				task(args);
 			}
 
+			wi::profiler::EndSpan();
+
 			return ctx->counter.fetch_sub(1); // returns context counter's previous value
 		}
 	};
@@ -229,6 +236,9 @@ namespace wi::jobsystem
 					}
 #endif // PLATFORM_LINUX
 
+					static const char* priority_names[] = { "High", "Low", "Streaming" };
+					wi::profiler::SetThreadName(("wi::jobsystem " + std::string(priority_names[int(priority)]) + " " + std::to_string(threadID)).c_str());
+
 					while (internal_state.alive.load())
 					{
 						res.work(threadID);
@@ -441,6 +451,11 @@ namespace wi::jobsystem
 			// work() will pick up any jobs that are on standby and execute them on this thread:
 			res.work(res.nextQueue.fetch_add(1) % res.numThreads);
 
+			if (!IsBusy(ctx))
+				return;
+
+			// The remaining time spent here is waiting for other threads, which is made visible in profiler captures:
+			wi::profiler::BeginSpan("wi::jobsystem::Wait");
 			while (IsBusy(ctx))
 			{
 				// If we are here, then there are still remaining jobs that work() couldn't pick up.
@@ -451,6 +466,7 @@ namespace wi::jobsystem
 					res.waitingCondition.wait(lock, [&ctx] { return !IsBusy(ctx); });
 				}
 			}
+			wi::profiler::EndSpan();
 		}
 	}
 
@@ -28,8 +28,11 @@
 #include "wiTimer.h"
 #include "wiVector.h"
 #include "wiVersion.h"
+#include "wiProfiler.h"
+#include "wiUnorderedMap.h"
 
 #include <memory>
+#include <mutex>
 
 namespace wi::lua
 {
@@ -38,6 +41,41 @@ namespace wi::lua
 	{
 		lua_State* m_luaState = NULL;
 
+		// The original allocator is wrapped to count allocations:
+		lua_Alloc alloc_function = nullptr;
+		void* alloc_userdata = nullptr;
+		uint64_t alloc_count = 0;
+		uint64_t alloc_bytes = 0;
+
+		// Garbage collection:
+		uint32_t gc_budget = 0; // microseconds, 0 = automatic
+		int gc_pause = 200;
+		int gc_stepmul = 200;
+		bool gc_cycle_finished = false;
+		int gc_baseline_kb = 0; // heap size at the end of the last finished cycle
+		int gc_last_kb = 0; // heap size at the end of the last frame
+
+		// Script profiling:
+		struct ScriptStats
+		{
+			std::string label;
+			double time = 0; // milliseconds
+			uint64_t alloc_count = 0;
+			uint64_t alloc_bytes = 0;
+		};
+		wi::unordered_map<uint32_t, ScriptStats> script_stats; // per PID
+		std::mutex script_names_locker;
+		wi::unordered_map<uint32_t, std::string> script_names; // per PID, can be set from any thread
+		wi::vector<uint32_t> script_releases; // PIDs of scripts that were killed or finished, they are removed at the end of the frame, guarded by script_names_locker
+		struct ProfileScope
+		{
+			uint32_t PID = 0;
+			wi::Timer timer;
+			uint64_t alloc_count = 0;
+			uint64_t alloc_bytes = 0;
+		};
+		wi::vector<ProfileScope> profile_stack;
+
 		~LuaInternal()
 		{
 			if (m_luaState != NULL)
@@ -52,6 +90,22 @@ namespace wi::lua
 		return luainternal;
 	}
 
+	void* CountingAlloc(void* ud, void* ptr, size_t osize, size_t nsize)
+	{
+		LuaInternal& internal = *(LuaInternal*)ud;
+		if (nsize > 0)
+		{
+			// when ptr is null, osize is not a size but the type of the new object
+			const size_t prev_size = ptr == nullptr ? 0 : osize;
+			if (nsize > prev_size)
+			{
+				internal.alloc_count++;
+				internal.alloc_bytes += nsize - prev_size;
+			}
+		}
+		return internal.alloc_function(internal.alloc_userdata, ptr, osize, nsize);
+	}
+
 	wi::Application* editorApplication = nullptr;
 	wi::RenderPath* editorRenderPath = nullptr;
 	int IsThisEditor(lua_State* L)
@@ -124,6 +178,8 @@ namespace wi::lua
 		dynamic_inject += persistent_inject;
 		script = dynamic_inject + customparameters_prepend + script + customparameters_append;
 
+		SetScriptName(PID, filepath);
+
 		return PID;
 	}
 
@@ -262,6 +318,30 @@ namespace wi::lua
 		return 1;
 	}
 
+	int Internal_ScriptProfileBegin(lua_State* L)
+	{
+		uint32_t PID = 0;
+		if (SGetArgCount(L) > 0)
+		{
+			PID = (uint32_t)SGetInt(L, 1); // PID can also be a number string
+		}
+		BeginScriptProfiling(PID);
+		return 0;
+	}
+	int Internal_ScriptProfileEnd(lua_State* L)
+	{
+		EndScriptProfiling();
+		return 0;
+	}
+	int Internal_ScriptProfileRelease(lua_State* L)
+	{
+		if (SGetArgCount(L) > 0)
+		{
+			ReleaseScriptProfiling((uint32_t)SGetInt(L, 1)); // PID can also be a number string
+		}
+		return 0;
+	}
+
 	void Initialize()
 	{
 		if (lua_internal().m_luaState != nullptr)
@@ -270,7 +350,18 @@ namespace wi::lua
 		wi::Timer timer;
 
 		lua_internal().m_luaState = luaL_newstate();
+		lua_internal().alloc_function = lua_getallocf(lua_internal().m_luaState, &lua_internal().alloc_userdata);
+		lua_setallocf(lua_internal().m_luaState, CountingAlloc, &lua_internal());
+		lua_gc(lua_internal().m_luaState, LUA_GCSETPAUSE, lua_internal().gc_pause);
+		lua_gc(lua_internal().m_luaState, LUA_GCSETSTEPMUL, lua_internal().gc_stepmul);
+		if (lua_internal().gc_budget > 0)
+		{
+			lua_gc(lua_internal().m_luaState, LUA_GCSTOP, 0);
+		}
 		luaL_openlibs(lua_internal().m_luaState);
+		RegisterFunc("Internal_ScriptProfileBegin", Internal_ScriptProfileBegin);
+		RegisterFunc("Internal_ScriptProfileEnd", Internal_ScriptProfileEnd);
+		RegisterFunc("Internal_ScriptProfileRelease", Internal_ScriptProfileRelease);
 		RegisterFunc("dofile", Internal_DoFile);
 		RegisterFunc("dobinaryfile", Internal_DoBinaryFile);
 		RegisterFunc("compilebinaryfile", Internal_CompileBinaryFile);
@@ -416,6 +507,176 @@ namespace wi::lua
 		RunText("killProcesses();");
 	}
 
+	void SetGarbageCollectionBudget(uint32_t microseconds)
+	{
+		LuaInternal& internal = lua_internal();
+		internal.gc_budget = microseconds;
+		if (internal.m_luaState != nullptr)
+		{
+			lua_gc(internal.m_luaState, microseconds > 0 ? LUA_GCSTOP : LUA_GCRESTART, 0);
+			internal.gc_last_kb = lua_gc(internal.m_luaState, LUA_GCCOUNT, 0);
+		}
+	}
+	uint32_t GetGarbageCollectionBudget()
+	{
+		return lua_internal().gc_budget;
+	}
+	void SetGarbageCollectorParameters(int pause, int stepmul)
+	{
+		LuaInternal& internal = lua_internal();
+		internal.gc_pause = pause;
+		internal.gc_stepmul = stepmul;
+		if (internal.m_luaState != nullptr)
+		{
+			lua_gc(internal.m_luaState, LUA_GCSETPAUSE, pause);
+			lua_gc(internal.m_luaState, LUA_GCSETSTEPMUL, stepmul);
+		}
+	}
+
+	void EndFrame()
+	{
+		LuaInternal& internal = lua_internal();
+		lua_State* L = internal.m_luaState;
+		if (L == nullptr)
+			return;
+
+		if (internal.gc_budget > 0)
+		{
+			auto range = wi::profiler::BeginRangeCPU("Lua Garbage Collection");
+			wi::Timer timer;
+			const int kb = lua_gc(L, LUA_GCCOUNT, 0);
+			const int threshold_kb = int(int64_t(internal.gc_baseline_kb) * internal.gc_pause / 100);
+			if (!internal.gc_cycle_finished || kb >= threshold_kb)
+			{
+				// Like the automatic collector, a new cycle only starts after the heap grew by the pause ratio since the last cycle
+				internal.gc_cycle_finished = false;
+				// The work for the memory allocated since the last frame is always done (like the automatic collector would do it),
+				//	otherwise a heap that grows faster than the budget could collect would never finish its cycle
+				const int debt_kb = kb - internal.gc_last_kb;
+				if (debt_kb > 0 && lua_gc(L, LUA_GCSTEP, debt_kb))
+				{
+					internal.gc_cycle_finished = true;
+					internal.gc_baseline_kb = lua_gc(L, LUA_GCCOUNT, 0);
+				}
+				else
+				{
+					// The remaining budget is used to advance the cycle further:
+					const double budget = internal.gc_budget / 1000.0;
+					while (timer.elapsed() < budget)
+					{
+						if (lua_gc(L, LUA_GCSTEP, 0))
+						{
+							internal.gc_cycle_finished = true;
+							internal.gc_baseline_kb = lua_gc(L, LUA_GCCOUNT, 0);
+							break;
+						}
+					}
+				}
+			}
+			internal.gc_last_kb = lua_gc(L, LUA_GCCOUNT, 0);
+			wi::profiler::EndRange(range);
+		}
+
+		// Report the script statistics of this frame:
+		if (wi::profiler::IsEnabled())
+		{
+			std::string info;
+			for (auto& x : internal.script_stats)
+			{
+				LuaInternal::ScriptStats& stats = x.second;
+				if (stats.time <= 0 && stats.alloc_count == 0)
+					continue;
+				if (stats.label.empty())
+				{
+					std::string name;
+					internal.script_names_locker.lock();
+					auto it = internal.script_names.find(x.first);
+					if (it != internal.script_names.end())
+					{
+						name = it->second;
+					}
+					internal.script_names_locker.unlock();
+					stats.label = "Lua: " + (name.empty() ? std::string("unknown script") : wi::helper::GetFileNameFromPath(name)) + " [PID " + std::to_string(x.first) + "]";
+				}
+				info = std::to_string(stats.alloc_count) + " allocs, " + std::to_string(stats.alloc_bytes / 1024) + " KB";
+				wi::profiler::AddRangeCPU(stats.label.c_str(), (float)stats.time, info.c_str());
+			}
+			info = std::to_string(lua_gc(L, LUA_GCCOUNT, 0)) + " KB heap";
+			wi::profiler::AddRangeCPU("Lua: total allocations", 0, (std::to_string(internal.alloc_count) + " allocs, " + std::to_string(internal.alloc_bytes / 1024) + " KB, " + info).c_str());
+		}
+		for (auto& x : internal.script_stats)
+		{
+			x.second.time = 0;
+			x.second.alloc_count = 0;
+			x.second.alloc_bytes = 0;
+		}
+		internal.alloc_count = 0;
+		internal.alloc_bytes = 0;
+
+		// The statistics of killed and finished scripts are reported for the last time above, then they are removed:
+		{
+			std::scoped_lock lck(internal.script_names_locker);
+			for (uint32_t PID : internal.script_releases)
+			{
+				internal.script_stats.erase(PID);
+				internal.script_names.erase(PID);
+			}
+			internal.script_releases.clear();
+		}
+	}
+
+	void SetScriptName(uint32_t PID, const std::string& name)
+	{
+		LuaInternal& internal = lua_internal();
+		std::scoped_lock lck(internal.script_names_locker);
+		internal.script_names[PID] = name;
+		// The PID is reused by a new script, so it must not be removed:
+		internal.script_releases.erase(std::remove(internal.script_releases.begin(), internal.script_releases.end(), PID), internal.script_releases.end());
+	}
+	void ReleaseScriptProfiling(uint32_t PID)
+	{
+		LuaInternal& internal = lua_internal();
+		std::scoped_lock lck(internal.script_names_locker);
+		internal.script_releases.push_back(PID);
+	}
+	inline void AccumulateScriptProfiling(LuaInternal& internal, LuaInternal::ProfileScope& scope)
+	{
+		LuaInternal::ScriptStats& stats = internal.script_stats[scope.PID];
+		stats.time += scope.timer.elapsed_milliseconds();
+		stats.alloc_count += internal.alloc_count - scope.alloc_count;
+		stats.alloc_bytes += internal.alloc_bytes - scope.alloc_bytes;
+	}
+	inline void RestartScriptProfiling(LuaInternal& internal, LuaInternal::ProfileScope& scope)
+	{
+		scope.timer.record();
+		scope.alloc_count = internal.alloc_count;
+		scope.alloc_bytes = internal.alloc_bytes;
+	}
+	void BeginScriptProfiling(uint32_t PID)
+	{
+		LuaInternal& internal = lua_internal();
+		if (!internal.profile_stack.empty())
+		{
+			// The outer script is paused, so that nested scripts are measured exclusively:
+			AccumulateScriptProfiling(internal, internal.profile_stack.back());
+		}
+		LuaInternal::ProfileScope& scope = internal.profile_stack.emplace_back();
+		scope.PID = PID;
+		RestartScriptProfiling(internal, scope);
+	}
+	void EndScriptProfiling()
+	{
+		LuaInternal& internal = lua_internal();
+		if (internal.profile_stack.empty())
+			return;
+		AccumulateScriptProfiling(internal, internal.profile_stack.back());
+		internal.profile_stack.pop_back();
+		if (!internal.profile_stack.empty())
+		{
+			RestartScriptProfiling(internal, internal.profile_stack.back());
+		}
+	}
+
 	const char* SGetString(lua_State* L, int stackpos)
 	{
 		const char* str = lua_tostring(L, stackpos);
@@ -53,6 +53,29 @@ namespace wi::lua
 	//kill every running background task (coroutine)
 	void KillProcesses();
 
+	// Garbage collection budget in microseconds per frame:
+	//	0 (default): the Lua garbage collector runs automatically whenever allocations trigger it
+	//	>0: automatic garbage collection is stopped, and EndFrame() performs incremental collection steps until the budget is used up
+	void SetGarbageCollectionBudget(uint32_t microseconds);
+	uint32_t GetGarbageCollectionBudget();
+	// Incremental garbage collector parameters (see Lua manual 2.5.1), also used with budgeted collection:
+	//	pause	: percentage of heap growth after a finished cycle before the next cycle starts (default: 200)
+	//	stepmul	: speed of collection relative to allocation, as a percentage (default: 200)
+	void SetGarbageCollectorParameters(int pause, int stepmul);
+
+	// Performs the budgeted garbage collection and reports script statistics to wi::profiler, this is called once per frame by wi::Application
+	void EndFrame();
+
+	// Script profiling: CPU time and Lua memory allocations are accounted to the script PID between these calls
+	//	Calls can be nested, and then the nested script's time is not counted for the outer script
+	//	Coroutines that are started with runProcess() inside scripts are measured automatically
+	void BeginScriptProfiling(uint32_t PID);
+	void EndScriptProfiling();
+	// Set the name that will be displayed for a script PID in the profiler, AttachScriptParameters() does this automatically
+	void SetScriptName(uint32_t PID, const std::string& name);
+	// Removes the profiling statistics and name of a script PID at the end of the frame, this is called when a script was killed or finished
+	void ReleaseScriptProfiling(uint32_t PID);
+
 	// Generates a unique identifier for a script instance:
 	uint32_t GeneratePID();
 
@@ -30,6 +30,43 @@ end
 -- seeding the system random
 math.randomseed( os.time() )
 
+-- This table is indexed by coroutine and contains the script PID that started it, for profiling
+local PROCESSES_COROUTINE_PID = setmetatable({}, { __mode = "k" })
+-- This table is indexed by script PID and contains the number of its coroutines that are not finished or killed yet
+local PROCESSES_RUNNING = {}
+
+-- The profiling data of a script is released when it has no more running coroutines
+local function untrack_pid(pid)
+	PROCESSES_RUNNING[pid] = nil
+	Internal_ScriptProfileRelease(pid)
+end
+local function trackProcess(co, pid)
+	PROCESSES_COROUTINE_PID[co] = pid
+	PROCESSES_RUNNING[pid] = (PROCESSES_RUNNING[pid] or 0) + 1
+end
+local function untrackProcess(co)
+	local pid = PROCESSES_COROUTINE_PID[co]
+	if pid == nil then return end
+	PROCESSES_COROUTINE_PID[co] = nil
+	local running = (PROCESSES_RUNNING[pid] or 1) - 1
+	if running > 0 then
+		PROCESSES_RUNNING[pid] = running
+	else
+		untrack_pid(pid)
+	end
+end
+
+-- Resume a coroutine while its CPU time and allocations are accounted to its script
+local function resumeProcess(co)
+	Internal_ScriptProfileBegin(PROCESSES_COROUTINE_PID[co] or 0)
+	local success, errorMsg = coroutine.resume(co)
+	Internal_ScriptProfileEnd()
+	if coroutine.status(co) == "dead" then
+		untrackProcess(co)
+	end
+	return success, errorMsg
+end
+
 -- This table is indexed by coroutine and simply contains the time at which the coroutine
 -- should be woken up.
 local WAITING_ON_TIME = {}
@@ -69,7 +106,7 @@ function wakeUpWaitingThreads(deltaTime)
     -- Now wake them all up.
     for _, co in ipairs(threadsToWake) do
         WAITING_ON_TIME[co] = nil -- Setting a field to nil removes it from the table
-        local success, errorMsg = coroutine.resume(co)
+        local success, errorMsg = resumeProcess(co)
 		if not success then
 			error("[Lua Error] "..errorMsg)
 		end
@@ -79,7 +116,7 @@ end
 -- This function is just a quick wrapper to start a coroutine.
 function runProcess(func)  
     local co = coroutine.create(func)
-    local success, errorMsg = coroutine.resume(co)
+    local success, errorMsg = resumeProcess(co)
 	if not success then
 		error("[Lua Error] "..errorMsg)
 	end
@@ -112,7 +149,7 @@ function signal(signalName)
 
     WAITING_ON_SIGNAL[signalName] = nil
     for _, co in ipairs(threads) do
-        local success, errorMsg = coroutine.resume(co)
+        local success, errorMsg = resumeProcess(co)
 		if not success then
 			error("[Lua Error] "..errorMsg)
 		end
@@ -123,6 +160,13 @@ end
 function killProcesses()
 	WAITING_ON_SIGNAL = {}
 	WAITING_ON_TIME = {}
+	-- The coroutine that called this keeps running, so it stays tracked:
+	local current = coroutine.running()
+	for co, _ in pairs(PROCESSES_COROUTINE_PID) do
+		if co ~= current then
+			untrackProcess(co)
+		end
+	end
 end
 
 -- Kill one process, has to know the coroutine first
@@ -136,6 +180,7 @@ function killProcess(co)
     if WAITING_ON_TIME[co] ~= nil then
         WAITING_ON_TIME[co] = nil
     end
+    untrackProcess(co)
 end
 
 -- Track processes by PID and File, useful when you want to kill specifically by file or pid
@@ -147,7 +192,8 @@ PROCESSES_DATA = {}
 -- There is a hook function that exists on the script side
 function Internal_runProcess(file, pid, func)
     local co = coroutine.create(func)
-    local success, errorMsg = coroutine.resume(co)
+    trackProcess(co, pid)
+    local success, errorMsg = resumeProcess(co)
 	if not success then
 		error("[Lua Error] "..errorMsg)
 	end
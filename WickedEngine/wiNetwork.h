@@ -1,8 +1,11 @@
 #pragma once
 #include "CommonInclude.h"
+#include "wiVector.h"
+#include "wiSpinLock.h"
 
 #include <memory>
 #include <array>
+#include <mutex>
 
 namespace wi::network
 {
@@ -46,4 +49,87 @@ namespace wi::network
 	//	data		:	buffer to hold received data, must be already allocated to a sufficient size
 	//	dataSize	:	expected data size in bytes
 	bool Receive(const Socket* sock, Connection* connection, void* data, size_t dataSize);
+
+
+	// Largest UDP payload that fits into a standard 1500 byte MTU without IP fragmentation
+	static constexpr size_t PACKET_CAPACITY = 1472;
+
+	// Fixed size packet storage, used with the batched send and receive functions
+	struct Packet
+	{
+		Connection connection;	// receiver when sending, sender when receiving
+		uint32_t size = 0;		// size of the valid data in bytes
+		uint8_t data[PACKET_CAPACITY];
+	};
+
+	// Preallocated packets that can be handed between the network and the caller without copying or memory allocation
+	//	It is thread safe, so packets can be allocated by the receiving thread and freed by the caller
+	struct PacketPool
+	{
+		wi::vector<Packet> packets;
+		wi::vector<Packet*> freelist;
+		wi::SpinLock locker;
+
+		void Init(size_t packet_count)
+		{
+			packets.resize(packet_count);
+			freelist.resize(packet_count);
+			for (size_t i = 0; i < packet_count; ++i)
+			{
+				freelist[i] = &packets[packet_count - 1 - i];
+			}
+		}
+		// Returns nullptr if all packets are in use
+		Packet* Allocate()
+		{
+			std::scoped_lock lck(locker);
+			if (freelist.empty())
+				return nullptr;
+			Packet* packet = freelist.back();
+			freelist.pop_back();
+			packet->size = 0;
+			return packet;
+		}
+		void Free(Packet* packet)
+		{
+			std::scoped_lock lck(locker);
+			freelist.push_back(packet);
+		}
+		void Free(Packet* const* packets, size_t count)
+		{
+			std::scoped_lock lck(locker);
+			freelist.insert(freelist.end(), packets, packets + count);
+		}
+	};
+
+	// Sends multiple packets, with as few system calls as possible (sendmmsg on Linux)
+	//	sock		:	socket that sends the packets
+	//	packets		:	array of packets, each packet is sent to its own connection
+	//	count		:	number of packets in the array
+	//	returns the number of packets that were sent, which can be less than count if the send buffer stays full or an error occurs
+	size_t SendBatch(const Socket* sock, const Packet* const* packets, size_t count);
+
+	// Receives multiple packets that are already waiting on the socket, without blocking (recvmmsg on Linux)
+	//	sock		:	socket that receives the packets, it must be listening on a port
+	//	pool		:	the packets will be allocated from this pool, the data is received directly into them
+	//	packets		:	array that will be filled with the received packets, the caller must return them to the pool when they are no longer needed
+	//	max_count	:	size of the packets array
+	//	returns the number of packets that were received
+	size_t ReceiveBatch(const Socket* sock, PacketPool* pool, Packet** packets, size_t max_count);
+
+	// Starts receiving packets continuously on a dedicated thread (epoll driven on Linux)
+	//	The received packets are queued up and can be retrieved with PollReceived() without making system calls
+	//	The socket is non-blocking while the thread is running, so Receive() shouldn't be used on it
+	//	sock		:	socket that receives the packets, it must be listening on a port
+	//	pool		:	the packets will be allocated from this pool, it must remain valid until StopReceiving() is called or the socket is destroyed
+	bool StartReceiving(const Socket* sock, PacketPool* pool);
+
+	// Stops and joins the receiving thread that was started with StartReceiving(), it is also stopped when the socket is destroyed
+	//	The packets that were already received remain in the queue
+	void StopReceiving(const Socket* sock);
+
+	// Retrieves the packets that were received by the receiving thread since the last call, returns immediately
+	//	The caller must return the packets to the pool when they are no longer needed
+	//	returns the number of packets that were written to the packets array
+	size_t PollReceived(const Socket* sock, Packet** packets, size_t max_count);
 }
@@ -0,0 +1,902 @@
+#include "wiNetworkReplication.h"
+#include "wiJobSystem.h"
+#include "wiTimer.h"
+#include "wiBacklog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+using namespace wi::ecs;
+using namespace wi::scene;
+
+namespace wi::network
+{
+	enum class MessageKind : uint8_t
+	{
+		Hello,		// client -> server: first message of a client
+		State,		// server -> client: fragment of a tick message
+		Ack,		// client -> server: acknowledgement of received ticks
+	};
+	static constexpr size_t STATE_HEADER_SIZE = 1 + 4 + 2 + 2; // kind, tick, fragment index, fragment count
+	static constexpr size_t ACK_SIZE = 1 + 4 + 8 + 1; // kind, latest tick, received mask, flags
+	static constexpr uint8_t ACK_FLAG_RESYNC = 1 << 0;
+	static constexpr uint32_t ITEM_KEY_TYPE_SHIFT = 48;
+	static constexpr uint64_t ITEM_KEY_ENTITY_MASK = (1ull << ITEM_KEY_TYPE_SHIFT) - 1;
+
+	inline uint64_t make_item_key(uint32_t type_index, Entity entity)
+	{
+		assert(entity <= ITEM_KEY_ENTITY_MASK);
+		return (uint64_t(type_index) << ITEM_KEY_TYPE_SHIFT) | (entity & ITEM_KEY_ENTITY_MASK);
+	}
+	inline bool operator==(const Connection& a, const Connection& b)
+	{
+		return a.ipaddress == b.ipaddress && a.port == b.port;
+	}
+
+	// The quantized transform fields are compared to the baseline one by one, only the changed fields are written
+	//	Translation and scale are written as the difference to the baseline, so slow movement is cheap
+	//	Without baseline, the difference to zero is written
+	void write_transform(BitWriter& writer, const uint8_t* current, const uint8_t* baseline)
+	{
+		uint32_t cur[7];
+		uint32_t base[7] = {};
+		std::memcpy(cur, current, sizeof(cur));
+		if (baseline != nullptr)
+		{
+			std::memcpy(base, baseline, sizeof(base));
+		}
+		uint32_t mask = 0;
+		for (uint32_t i = 0; i < 7; ++i)
+		{
+			if (cur[i] != base[i])
+			{
+				mask |= 1u << i;
+			}
+		}
+		writer.Write(mask, 7);
+		for (uint32_t i = 0; i < 7; ++i)
+		{
+			if ((mask & (1u << i)) == 0)
+				continue;
+			if (i == 3)
+			{
+				writer.Write(cur[i], 32); // packed rotation, difference is meaningless
+			}
+			else
+			{
+				writer.WriteVarInt(int64_t(int32_t(cur[i])) - int64_t(int32_t(base[i])));
+			}
+		}
+	}
+	void read_transform(BitReader& reader, uint8_t* current, const uint8_t* baseline)
+	{
+		uint32_t cur[7] = {};
+		if (baseline != nullptr)
+		{
+			std::memcpy(cur, baseline, sizeof(cur));
+		}
+		const uint32_t mask = reader.Read(7);
+		for (uint32_t i = 0; i < 7; ++i)
+		{
+			if ((mask & (1u << i)) == 0)
+				continue;
+			if (i == 3)
+			{
+				cur[i] = reader.Read(32);
+			}
+			else
+			{
+				cur[i] = uint32_t(int32_t(int64_t(int32_t(cur[i])) + reader.ReadVarInt()));
+			}
+		}
+		std::memcpy(current, cur, sizeof(cur));
+	}
+
+	// Serialized components are compared to the baseline byte by byte, only the changed byte ranges are written as (skip, run, bytes)
+	//	Short unchanged gaps are merged into the runs, because they are cheaper than starting a new range
+	void write_bytes(BitWriter& writer, const uint8_t* current, size_t size, const uint8_t* baseline, size_t baseline_size)
+	{
+		auto equal = [&](size_t i) {
+			return i < baseline_size && baseline[i] == current[i];
+		};
+		writer.WriteVarUint(size);
+		size_t i = 0;
+		while (i < size)
+		{
+			size_t skip = 0;
+			while (i + skip < size && equal(i + skip))
+			{
+				skip++;
+			}
+			i += skip;
+			size_t run = 0;
+			while (i + run < size)
+			{
+				if (!equal(i + run))
+				{
+					run++;
+					continue;
+				}
+				size_t gap = 0;
+				while (i + run + gap < size && equal(i + run + gap))
+				{
+					gap++;
+				}
+				if (gap >= 4 || i + run + gap >= size)
+					break;
+				run += gap;
+			}
+			writer.WriteVarUint(skip);
+			writer.WriteVarUint(run);
+			writer.WriteBytes(current + i, run);
+			i += run;
+		}
+	}
+	void read_bytes(BitReader& reader, wi::vector<uint8_t>& current, const uint8_t* baseline, size_t baseline_size)
+	{
+		const size_t size = (size_t)reader.ReadVarUint();
+		if (reader.overflow || size > reader.bit_size / 8 + baseline_size)
+		{
+			reader.overflow = true;
+			return;
+		}
+		current.resize(size);
+		const size_t copy_size = std::min(size, baseline_size);
+		if (copy_size > 0)
+		{
+			std::memcpy(current.data(), baseline, copy_size);
+		}
+		if (size > copy_size)
+		{
+			std::memset(current.data() + copy_size, 0, size - copy_size);
+		}
+		size_t i = 0;
+		while (i < size && !reader.overflow)
+		{
+			const size_t skip = (size_t)reader.ReadVarUint();
+			const size_t run = (size_t)reader.ReadVarUint();
+			if ((skip == 0 && run == 0) || i + skip + run > size)
+			{
+				reader.overflow = true; // malformed
+				return;
+			}
+			i += skip;
+			reader.ReadBytes(current.data() + i, run);
+			i += run;
+		}
+	}
+
+	void ReplicationBase::RegisterTransforms(ComponentManager<TransformComponent>& manager, float priority)
+	{
+		ReplicatedType& type = types.emplace_back();
+		type.manager = &manager;
+		type.priority = priority;
+		type.transforms = &manager;
+	}
+
+	void ReplicationBase::QuantizeTransform(const TransformComponent& transform, uint8_t* dest) const
+	{
+		auto quantize = [](float value, float precision) {
+			const double q = std::round(double(value) / double(precision));
+			return uint32_t(int32_t(std::clamp(q, double(INT32_MIN), double(INT32_MAX))));
+		};
+		uint32_t values[7];
+		values[0] = quantize(transform.translation_local.x, settings.position_precision);
+		values[1] = quantize(transform.translation_local.y, settings.position_precision);
+		values[2] = quantize(transform.translation_local.z, settings.position_precision);
+
+		// Smallest three: the largest quaternion component is left out and reconstructed from the other three
+		//	The sign of the quaternion is flipped to make the largest component positive, which represents the same rotation
+		XMFLOAT4 q;
+		XMStoreFloat4(&q, XMQuaternionNormalize(XMLoadFloat4(&transform.rotation_local)));
+		const float components[4] = { q.x, q.y, q.z, q.w };
+		uint32_t largest = 0;
+		for (uint32_t i = 1; i < 4; ++i)
+		{
+			if (std::abs(components[i]) > std::abs(components[largest]))
+			{
+				largest = i;
+			}
+		}
+		const float sign = components[largest] < 0 ? -1.0f : 1.0f;
+		uint32_t packed = largest;
+		uint32_t shift = 2;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+			const float value = components[i] * sign * 0.70710678f + 0.5f; // [-1/sqrt2, 1/sqrt2] -> [0, 1]
+			packed |= uint32_t(std::round(wi::math::saturate(value) * 1023.0f)) << shift;
+			shift += 10;
+		}
+		values[3] = packed;
+
+		values[4] = quantize(transform.scale_local.x, settings.scale_precision);
+		values[5] = quantize(transform.scale_local.y, settings.scale_precision);
+		values[6] = quantize(transform.scale_local.z, settings.scale_precision);
+		std::memcpy(dest, values, sizeof(values));
+	}
+
+	void ReplicationBase::DequantizeTransform(const uint8_t* src, TransformComponent& transform) const
+	{
+		uint32_t values[7];
+		std::memcpy(values, src, sizeof(values));
+		transform.translation_local.x = float(int32_t(values[0])) * settings.position_precision;
+		transform.translation_local.y = float(int32_t(values[1])) * settings.position_precision;
+		transform.translation_local.z = float(int32_t(values[2])) * settings.position_precision;
+
+		const uint32_t packed = values[3];
+		const uint32_t largest = packed & 3;
+		float components[4] = {};
+		float sum = 0;
+		uint32_t shift = 2;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+			const float value = float((packed >> shift) & 1023) / 1023.0f;
+			components[i] = (value - 0.5f) * 1.41421356f;
+			sum += components[i] * components[i];
+			shift += 10;
+		}
+		components[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+		XMStoreFloat4(&transform.rotation_local, XMQuaternionNormalize(XMVectorSet(components[0], components[1], components[2], components[3])));
+
+		transform.scale_local.x = float(int32_t(values[4])) * settings.scale_precision;
+		transform.scale_local.y = float(int32_t(values[5])) * settings.scale_precision;
+		transform.scale_local.z = float(int32_t(values[6])) * settings.scale_precision;
+		transform.SetDirty();
+	}
+
+
+	ReplicationServer::Client* ReplicationServer::FindClient(const Connection& connection)
+	{
+		for (auto& client : clients)
+		{
+			if (client.connection == connection)
+				return &client;
+		}
+		return nullptr;
+	}
+
+	void ReplicationServer::AddClient(const Connection& connection)
+	{
+		if (FindClient(connection) != nullptr)
+			return;
+		Client& client = clients.emplace_back();
+		client.connection = connection;
+		client.last_message_tick = tick;
+	}
+
+	void ReplicationServer::RemoveClient(const Connection& connection)
+	{
+		for (size_t i = 0; i < clients.size(); ++i)
+		{
+			if (clients[i].connection == connection)
+			{
+				clients.erase(clients.begin() + i);
+				return;
+			}
+		}
+	}
+
+	void ReplicationServer::Acknowledge(Client& client, uint32_t acked_tick)
+	{
+		auto it = client.sent.find(acked_tick);
+		if (it == client.sent.end())
+			return;
+		const Snapshot& current = history[tick % HISTORY_SIZE];
+		for (const SentItem& sent : it->second)
+		{
+			auto item = client.items.find(sent.key);
+			if (item == client.items.end())
+				continue;
+			if (sent.removed)
+			{
+				if (item->second.acked_tick == 0 && current.items.find(sent.key) == current.items.end())
+				{
+					client.items.erase(item);
+				}
+			}
+			else if (acked_tick > item->second.removed_tick)
+			{
+				item->second.acked_tick = std::max(item->second.acked_tick, acked_tick);
+			}
+		}
+		client.sent.erase(it);
+	}
+
+	void ReplicationServer::ReceiveAcks()
+	{
+		if (pool.packets.empty())
+		{
+			pool.Init(1024);
+		}
+		Packet* packets[64];
+		size_t count = 0;
+		while ((count = ReceiveBatch(socket, &pool, packets, arraysize(packets))) > 0)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Packet& packet = *packets[i];
+				if (packet.size < 1)
+					continue;
+				const MessageKind kind = (MessageKind)packet.data[0];
+				if (kind != MessageKind::Hello && kind != MessageKind::Ack)
+					continue;
+				Client* found = FindClient(packet.connection);
+				if (found == nullptr)
+				{
+					if (!settings.accept_new_clients || clients.size() >= settings.max_clients)
+						continue;
+					AddClient(packet.connection);
+					found = &clients.back();
+				}
+				Client& client = *found;
+				client.last_message_tick = tick;
+				if (kind != MessageKind::Ack || packet.size < ACK_SIZE)
+					continue;
+				client.acknowledged = true;
+				uint32_t latest;
+				uint64_t mask;
+				uint8_t flags;
+				std::memcpy(&latest, packet.data + 1, sizeof(latest));
+				std::memcpy(&mask, packet.data + 5, sizeof(mask));
+				std::memcpy(&flags, packet.data + 13, sizeof(flags));
+				if (flags & ACK_FLAG_RESYNC)
+				{
+					// The client is missing a baseline, so all states will be sent in full:
+					for (auto& it : client.items)
+					{
+						it.second.acked_tick = 0;
+						it.second.removed_tick = latest;
+					}
+					client.sent.clear();
+					continue;
+				}
+				Acknowledge(client, latest);
+				for (uint32_t bit = 0; bit < 64 && bit + 1 < latest; ++bit)
+				{
+					if (mask & (1ull << bit))
+					{
+						Acknowledge(client, latest - 1 - bit);
+					}
+				}
+			}
+			pool.Free(packets, count);
+		}
+	}
+
+	void ReplicationServer::TakeSnapshot()
+	{
+		Snapshot& snapshot = history[tick % HISTORY_SIZE];
+		snapshot.tick = tick;
+		snapshot.items.clear();
+		snapshot.data.clear();
+
+		for (uint32_t type_index = 0; type_index < (uint32_t)types.size(); ++type_index)
+		{
+			const ReplicatedType& type = types[type_index];
+			const wi::vector<Entity>& entities = type.manager->GetEntityArray();
+			if (type.transforms != nullptr)
+			{
+				for (size_t i = 0; i < entities.size(); ++i)
+				{
+					Range range;
+					range.offset = (uint32_t)snapshot.data.size();
+					range.size = (uint32_t)QUANTIZED_TRANSFORM_SIZE;
+					snapshot.data.resize(snapshot.data.size() + QUANTIZED_TRANSFORM_SIZE);
+					QuantizeTransform((*type.transforms)[i], snapshot.data.data() + range.offset);
+					snapshot.items[make_item_key(type_index, entities[i])] = range;
+				}
+				continue;
+			}
+
+			seri.version = type.version;
+			archive.SetReadModeAndResetPos(false);
+			for (size_t i = 0; i < entities.size(); ++i)
+			{
+				const size_t begin = archive.GetPos();
+				type.serialize(entities[i], archive, seri);
+				const size_t end = archive.GetPos();
+				Range range;
+				range.offset = (uint32_t)snapshot.data.size();
+				range.size = (uint32_t)(end - begin);
+				snapshot.data.insert(snapshot.data.end(), archive.GetData() + begin, archive.GetData() + end);
+				snapshot.items[make_item_key(type_index, entities[i])] = range;
+			}
+		}
+	}
+
+	void ReplicationServer::BuildMessage(Client& client, BitWriter& writer, size_t& items_sent, size_t& items_delayed)
+	{
+		struct Candidate
+		{
+			uint64_t key;
+			float priority;
+			const uint8_t* current;
+			uint32_t current_size;
+			const uint8_t* baseline;
+			uint32_t baseline_size;
+			uint32_t baseline_tick;
+			bool removed;
+		};
+		static thread_local wi::vector<Candidate> candidates;
+		candidates.clear();
+
+		if (!client.acknowledged)
+		{
+			// Until the client acknowledges, only an empty message is sent, so a spoofed address receives small packets only:
+			writer.Reset();
+			writer.WriteBool(false); // end of items
+			writer.Flush();
+			return;
+		}
+
+		const Snapshot& current = history[tick % HISTORY_SIZE];
+		for (auto& it : current.items)
+		{
+			const uint64_t key = it.first;
+			const ReplicatedType& type = types[key >> ITEM_KEY_TYPE_SHIFT];
+			ClientItem& item = client.items[key];
+
+			Candidate candidate = {};
+			candidate.key = key;
+			candidate.current = current.data.data() + it.second.offset;
+			candidate.current_size = it.second.size;
+			if (item.acked_tick > 0 && tick - item.acked_tick < HISTORY_SIZE)
+			{
+				const Snapshot& baseline = history[item.acked_tick % HISTORY_SIZE];
+				if (baseline.tick == item.acked_tick)
+				{
+					auto base = baseline.items.find(key);
+					if (base != baseline.items.end())
+					{
+						candidate.baseline = baseline.data.data() + base->second.offset;
+						candidate.baseline_size = base->second.size;
+						candidate.baseline_tick = item.acked_tick;
+					}
+				}
+			}
+			if (candidate.baseline != nullptr && candidate.baseline_size == candidate.current_size && std::memcmp(candidate.baseline, candidate.current, candidate.current_size) == 0)
+			{
+				item.priority = 0;
+				continue; // the client already has this state
+			}
+			item.priority += type.priority;
+			candidate.priority = item.priority;
+			candidates.push_back(candidate);
+		}
+		for (auto& it : client.items)
+		{
+			if (current.items.find(it.first) != current.items.end())
+				continue;
+			// The component was removed since the client received it:
+			const ReplicatedType& type = types[it.first >> ITEM_KEY_TYPE_SHIFT];
+			it.second.priority += type.priority;
+			Candidate candidate = {};
+			candidate.key = it.first;
+			candidate.priority = it.second.priority;
+			candidate.removed = true;
+			candidates.push_back(candidate);
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+			return a.priority > b.priority;
+		});
+
+		wi::vector<SentItem>& sent = client.sent[tick];
+		sent.clear();
+		writer.Reset();
+		for (size_t i = 0; i < candidates.size(); ++i)
+		{
+			const Candidate& candidate = candidates[i];
+			const uint32_t type_index = uint32_t(candidate.key >> ITEM_KEY_TYPE_SHIFT);
+			const ReplicatedType& type = types[type_index];
+
+			const BitWriter::Mark mark = writer.GetMark();
+			writer.WriteBool(true); // item follows
+			writer.WriteVarUint(type_index);
+			writer.WriteVarUint(candidate.key & ITEM_KEY_ENTITY_MASK);
+			writer.WriteBool(candidate.removed);
+			if (!candidate.removed)
+			{
+				writer.WriteVarUint(candidate.baseline == nullptr ? 0 : tick - candidate.baseline_tick);
+				if (type.transforms != nullptr)
+				{
+					write_transform(writer, candidate.current, candidate.baseline);
+				}
+				else
+				{
+					write_bytes(writer, candidate.current, candidate.current_size, candidate.baseline, candidate.baseline_size);
+				}
+			}
+			if (writer.GetByteCount() + 1 > settings.bandwidth_budget && !sent.empty())
+			{
+				// Over budget, the rest of the items will be sent later, their priorities keep accumulating until then
+				writer.Rollback(mark);
+				items_delayed += candidates.size() - i;
+				break;
+			}
+
+			ClientItem& item = client.items[candidate.key];
+			item.priority = 0;
+			if (candidate.removed)
+			{
+				item.acked_tick = 0;
+				item.removed_tick = tick;
+			}
+			sent.push_back({ candidate.key, candidate.removed });
+			items_sent++;
+		}
+		writer.WriteBool(false); // end of items
+		writer.Flush();
+
+		if (sent.empty())
+		{
+			client.sent.erase(tick);
+		}
+	}
+
+	void ReplicationServer::Update()
+	{
+		stats = {};
+		if (socket == nullptr || !socket->IsValid())
+			return;
+
+		ReceiveAcks();
+
+		tick++;
+
+		// Clients that stopped responding are removed:
+		for (size_t i = 0; i < clients.size();)
+		{
+			if (tick - clients[i].last_message_tick > settings.client_timeout)
+			{
+				clients.erase(clients.begin() + i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		wi::Timer timer;
+		TakeSnapshot();
+		stats.snapshot_ms = timer.elapsed_milliseconds();
+
+		timer.record();
+		for (auto& client : clients)
+		{
+			// Items that were not acknowledged in time won't ever be acknowledged, because the baselines are no longer available:
+			for (auto it = client.sent.begin(); it != client.sent.end();)
+			{
+				if (tick - it->first >= HISTORY_SIZE)
+				{
+					it = client.sent.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+
+		// The delta for each client is computed in parallel:
+		writers.resize(clients.size());
+		client_items_sent.resize(clients.size());
+		client_items_delayed.resize(clients.size());
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, (uint32_t)clients.size(), 1, [&](wi::jobsystem::JobArgs args) {
+			client_items_sent[args.jobIndex] = 0;
+			client_items_delayed[args.jobIndex] = 0;
+			BuildMessage(clients[args.jobIndex], writers[args.jobIndex], client_items_sent[args.jobIndex], client_items_delayed[args.jobIndex]);
+		});
+		wi::jobsystem::Wait(ctx);
+
+		// Fragment the messages into packets and send them all at once:
+		const size_t payload_capacity = std::min(settings.max_packet_size, PACKET_CAPACITY) - STATE_HEADER_SIZE;
+		size_t total_fragment_count = 0;
+		for (const BitWriter& writer : writers)
+		{
+			total_fragment_count += std::max(size_t(1), (writer.data.size() + payload_capacity - 1) / payload_capacity);
+		}
+		if (pool.packets.size() < total_fragment_count)
+		{
+			pool.Init(total_fragment_count); // no packets are in use at this point
+		}
+		send_packets.clear();
+		for (size_t client_index = 0; client_index < clients.size(); ++client_index)
+		{
+			stats.items_sent += client_items_sent[client_index];
+			stats.items_delayed += client_items_delayed[client_index];
+
+			const BitWriter& writer = writers[client_index];
+			const size_t message_size = writer.data.size();
+			const size_t fragment_count = std::max(size_t(1), (message_size + payload_capacity - 1) / payload_capacity);
+			if (fragment_count > 0xFFFF || message_size > settings.max_message_size)
+			{
+				wi::backlog::post("wi::network::ReplicationServer: message is too large, increase the max packet size and max message size or decrease the bandwidth budget", wi::backlog::LogLevel::Error);
+				continue;
+			}
+			for (size_t fragment = 0; fragment < fragment_count; ++fragment)
+			{
+				Packet* packet = pool.Allocate();
+				const size_t offset = fragment * payload_capacity;
+				const size_t size = std::min(payload_capacity, message_size - std::min(message_size, offset));
+				const uint16_t fragment_index = (uint16_t)fragment;
+				const uint16_t fragment_total = (uint16_t)fragment_count;
+				packet->connection = clients[client_index].connection;
+				packet->data[0] = (uint8_t)MessageKind::State;
+				std::memcpy(packet->data + 1, &tick, sizeof(tick));
+				std::memcpy(packet->data + 5, &fragment_index, sizeof(fragment_index));
+				std::memcpy(packet->data + 7, &fragment_total, sizeof(fragment_total));
+				if (size > 0)
+				{
+					std::memcpy(packet->data + STATE_HEADER_SIZE, writer.data.data() + offset, size);
+				}
+				packet->size = uint32_t(STATE_HEADER_SIZE + size);
+				send_packets.push_back(packet);
+				stats.bytes_sent += packet->size;
+			}
+		}
+		stats.packets_sent = SendBatch(socket, send_packets.data(), send_packets.size());
+		pool.Free(send_packets.data(), send_packets.size());
+		stats.send_ms = timer.elapsed_milliseconds();
+	}
+
+
+	void ReplicationClient::Connect(const Socket* sock, const Connection& server)
+	{
+		socket = sock;
+		this->server = server;
+		const uint8_t hello = (uint8_t)MessageKind::Hello;
+		Send(socket, &server, &hello, sizeof(hello));
+	}
+
+	Entity ReplicationClient::GetLocalEntity(Entity server_entity) const
+	{
+		auto it = seri.remap.find(server_entity);
+		if (it == seri.remap.end())
+			return INVALID_ENTITY;
+		return it->second;
+	}
+
+	void ReplicationClient::ApplyMessage(uint32_t tick, const uint8_t* data, size_t size)
+	{
+		BitReader reader(data, size);
+		wi::vector<uint8_t> state;
+		while (reader.ReadBool() && !reader.overflow)
+		{
+			const uint32_t type_index = (uint32_t)reader.ReadVarUint();
+			const Entity server_entity = (Entity)reader.ReadVarUint();
+			const bool removed = reader.ReadBool();
+			if (reader.overflow || type_index >= types.size() || server_entity > ITEM_KEY_ENTITY_MASK)
+			{
+				wi::backlog::post("wi::network::ReplicationClient: malformed message", wi::backlog::LogLevel::Warning);
+				return;
+			}
+			const ReplicatedType& type = types[type_index];
+			const uint64_t key = make_item_key(type_index, server_entity);
+			Item& item = items[key];
+
+			if (removed)
+			{
+				if (item.applied_tick < tick)
+				{
+					const Entity entity = GetLocalEntity(server_entity);
+					if (entity != INVALID_ENTITY)
+					{
+						type.manager->Remove(entity);
+					}
+					item.states.clear();
+					item.applied_tick = tick;
+				}
+				continue;
+			}
+
+			const uint32_t age = (uint32_t)reader.ReadVarUint();
+			const ItemState* baseline = nullptr;
+			if (age > 0)
+			{
+				for (const ItemState& it : item.states)
+				{
+					if (it.tick == tick - age)
+					{
+						baseline = &it;
+						break;
+					}
+				}
+			}
+			if (type.transforms != nullptr)
+			{
+				state.resize(QUANTIZED_TRANSFORM_SIZE);
+				read_transform(reader, state.data(), baseline == nullptr ? nullptr : baseline->data.data());
+			}
+			else
+			{
+				read_bytes(reader, state, baseline == nullptr ? nullptr : baseline->data.data(), baseline == nullptr ? 0 : baseline->data.size());
+			}
+			if (reader.overflow)
+			{
+				wi::backlog::post("wi::network::ReplicationClient: malformed message", wi::backlog::LogLevel::Warning);
+				return;
+			}
+			if (age > 0 && baseline == nullptr)
+			{
+				// The message was parsed, but this item can't be reconstructed, ask the server for full states:
+				resync_requested = true;
+				continue;
+			}
+
+			// Remember the state, the server can use it as baseline after it receives the acknowledgement:
+			ItemState* dest = nullptr;
+			for (ItemState& it : item.states)
+			{
+				if (it.tick + ReplicationServer::HISTORY_SIZE <= latest_tick || it.tick == tick)
+				{
+					dest = &it; // reuse outdated state
+					break;
+				}
+			}
+			if (dest == nullptr)
+			{
+				dest = &item.states.emplace_back();
+			}
+			dest->tick = tick;
+			dest->data = state;
+
+			if (item.applied_tick >= tick)
+				continue; // a newer state was already applied
+			item.applied_tick = tick;
+
+			Entity entity = GetLocalEntity(server_entity);
+			if (entity == INVALID_ENTITY)
+			{
+				entity = CreateEntity();
+				seri.remap[server_entity] = entity;
+			}
+			if (type.transforms != nullptr)
+			{
+				TransformComponent* transform = type.transforms->GetComponent(entity);
+				if (transform == nullptr)
+				{
+					transform = &type.transforms->Create(entity);
+				}
+				DequantizeTransform(state.data(), *transform);
+			}
+			else
+			{
+				wi::Archive archive = wi::Archive::CreateRawReadView(state.data(), state.size());
+				seri.version = type.version;
+				type.deserialize(entity, archive, seri);
+			}
+			stats.items_applied++;
+		}
+	}
+
+	void ReplicationClient::SendAck()
+	{
+		uint8_t data[ACK_SIZE];
+		data[0] = (uint8_t)MessageKind::Ack;
+		std::memcpy(data + 1, &latest_tick, sizeof(latest_tick));
+		std::memcpy(data + 5, &received_ticks, sizeof(received_ticks));
+		data[13] = resync_requested ? ACK_FLAG_RESYNC : 0;
+		Send(socket, &server, data, sizeof(data));
+		resync_requested = false;
+	}
+
+	void ReplicationClient::Update()
+	{
+		stats = {};
+		if (socket == nullptr || !socket->IsValid())
+			return;
+		if (pool.packets.empty())
+		{
+			pool.Init(1024);
+		}
+
+		const size_t payload_capacity = std::min(settings.max_packet_size, PACKET_CAPACITY) - STATE_HEADER_SIZE;
+		const size_t max_fragment_count = std::max(size_t(1), (settings.max_message_size + payload_capacity - 1) / payload_capacity);
+		Packet* packets[64];
+		size_t count = 0;
+		while ((count = ReceiveBatch(socket, &pool, packets, arraysize(packets))) > 0)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Packet& packet = *packets[i];
+				if (!(packet.connection == server))
+					continue; // only the server can send state
+				stats.bytes_received += packet.size;
+				if (packet.size < STATE_HEADER_SIZE || (MessageKind)packet.data[0] != MessageKind::State)
+					continue;
+				uint32_t tick;
+				uint16_t fragment_index;
+				uint16_t fragment_count;
+				std::memcpy(&tick, packet.data + 1, sizeof(tick));
+				std::memcpy(&fragment_index, packet.data + 5, sizeof(fragment_index));
+				std::memcpy(&fragment_count, packet.data + 7, sizeof(fragment_count));
+				if (tick == 0 || fragment_count == 0 || fragment_index >= fragment_count || size_t(fragment_count) > max_fragment_count)
+					continue;
+				if (tick == latest_tick || (tick < latest_tick && (latest_tick - tick > TICK_WINDOW || (received_ticks & (1ull << (latest_tick - tick - 1))))))
+					continue; // already applied or too old
+				if (latest_tick > 0 && tick > latest_tick + TICK_WINDOW)
+					continue; // too new
+
+				if (reassemblies.find(tick) == reassemblies.end() && reassemblies.size() >= MAX_REASSEMBLIES)
+				{
+					// Too many incomplete messages, the oldest one is dropped if this is newer:
+					auto oldest = reassemblies.begin();
+					for (auto it = reassemblies.begin(); it != reassemblies.end(); ++it)
+					{
+						if (it->first < oldest->first)
+						{
+							oldest = it;
+						}
+					}
+					if (oldest->first > tick)
+						continue;
+					reassemblies.erase(oldest);
+				}
+				Reassembly& reassembly = reassemblies[tick];
+				if (reassembly.fragment_count == 0)
+				{
+					reassembly.fragment_count = fragment_count;
+					reassembly.received.resize(fragment_count);
+					reassembly.data.resize(fragment_count * payload_capacity);
+				}
+				if (reassembly.fragment_count != fragment_count || reassembly.received[fragment_index])
+					continue;
+				const size_t payload_size = std::min(size_t(packet.size) - STATE_HEADER_SIZE, payload_capacity);
+				std::memcpy(reassembly.data.data() + fragment_index * payload_capacity, packet.data + STATE_HEADER_SIZE, payload_size);
+				if (fragment_index == fragment_count - 1)
+				{
+					reassembly.data.resize(fragment_index * payload_capacity + payload_size);
+				}
+				reassembly.received[fragment_index] = true;
+				reassembly.fragments_received++;
+				if (reassembly.fragments_received < reassembly.fragment_count)
+					continue;
+
+				// All fragments arrived:
+				ApplyMessage(tick, reassembly.data.data(), reassembly.data.size());
+				reassemblies.erase(tick);
+				stats.messages_applied++;
+				if (tick > latest_tick)
+				{
+					const uint32_t shift = tick - latest_tick;
+					received_ticks = shift >= 64 ? 0 : (received_ticks << shift);
+					if (latest_tick > 0 && shift <= 64)
+					{
+						received_ticks |= 1ull << (shift - 1);
+					}
+					latest_tick = tick;
+				}
+				else
+				{
+					received_ticks |= 1ull << (latest_tick - tick - 1);
+				}
+			}
+			pool.Free(packets, count);
+		}
+
+		// Incomplete messages that are too old won't be completed:
+		for (auto it = reassemblies.begin(); it != reassemblies.end();)
+		{
+			if (it->first + TICK_WINDOW < latest_tick)
+			{
+				it = reassemblies.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		if (stats.messages_applied > 0 || resync_requested)
+		{
+			SendAck();
+		}
+	}
+}
@@ -0,0 +1,385 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiNetwork.h"
+#include "wiECS.h"
+#include "wiArchive.h"
+#include "wiVector.h"
+#include "wiUnorderedMap.h"
+#include "wiScene_Components.h"
+
+#include <functional>
+#include <string>
+
+// Scene state replication over UDP
+//	The server takes a snapshot of the registered component types every tick, and sends each client only the components that changed
+//	compared to the last state that the client acknowledged. Transforms are quantized, all data is packed with bit level precision,
+//	the changed components are prioritized to fit into a bandwidth budget, and messages larger than a packet are fragmented.
+namespace wi::network
+{
+	// Writes values with arbitrary bit counts into a byte array
+	struct BitWriter
+	{
+		wi::vector<uint8_t> data;
+		uint64_t scratch = 0;
+		uint32_t scratch_bits = 0;
+		size_t bit_count = 0;
+
+		void Reset()
+		{
+			data.clear();
+			scratch = 0;
+			scratch_bits = 0;
+			bit_count = 0;
+		}
+		void Write(uint32_t value, uint32_t bits)
+		{
+			assert(bits <= 32);
+			if (bits == 0)
+				return;
+			if (bits < 32)
+			{
+				value &= (1u << bits) - 1;
+			}
+			scratch |= uint64_t(value) << scratch_bits;
+			scratch_bits += bits;
+			bit_count += bits;
+			while (scratch_bits >= 8)
+			{
+				data.push_back(uint8_t(scratch));
+				scratch >>= 8;
+				scratch_bits -= 8;
+			}
+		}
+		void WriteBool(bool value)
+		{
+			Write(value ? 1 : 0, 1);
+		}
+		// Variable length unsigned integer, 7 bits per group with a continuation bit, small values are cheap
+		void WriteVarUint(uint64_t value)
+		{
+			do
+			{
+				const uint32_t group = uint32_t(value & 0x7F);
+				value >>= 7;
+				Write(group | (value != 0 ? 0x80 : 0), 8);
+			} while (value != 0);
+		}
+		// Variable length signed integer with zigzag encoding, small absolute values are cheap
+		void WriteVarInt(int64_t value)
+		{
+			WriteVarUint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+		}
+		void WriteBytes(const uint8_t* bytes, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				Write(bytes[i], 8);
+			}
+		}
+		// Writes out the remaining bits, padded to a whole byte
+		void Flush()
+		{
+			if (scratch_bits > 0)
+			{
+				data.push_back(uint8_t(scratch));
+				bit_count += 8 - scratch_bits;
+				scratch = 0;
+				scratch_bits = 0;
+			}
+		}
+		size_t GetByteCount() const { return (bit_count + 7) / 8; }
+
+		// A position in the stream that can be rolled back to
+		struct Mark
+		{
+			size_t byte_count = 0;
+			uint64_t scratch = 0;
+			uint32_t scratch_bits = 0;
+			size_t bit_count = 0;
+		};
+		Mark GetMark() const { return { data.size(), scratch, scratch_bits, bit_count }; }
+		void Rollback(const Mark& mark)
+		{
+			data.resize(mark.byte_count);
+			scratch = mark.scratch;
+			scratch_bits = mark.scratch_bits;
+			bit_count = mark.bit_count;
+		}
+	};
+
+	// Reads values that were written by BitWriter
+	//	Reading past the end returns zeroes and sets the overflow flag, so malformed input can't read out of bounds
+	struct BitReader
+	{
+		const uint8_t* data = nullptr;
+		size_t bit_size = 0;
+		size_t bit_pos = 0;
+		bool overflow = false;
+
+		BitReader() = default;
+		BitReader(const uint8_t* data, size_t size) : data(data), bit_size(size * 8) {}
+
+		uint32_t Read(uint32_t bits)
+		{
+			assert(bits <= 32);
+			if (bit_pos + bits > bit_size)
+			{
+				overflow = true;
+				bit_pos = bit_size;
+				return 0;
+			}
+			uint32_t value = 0;
+			uint32_t written = 0;
+			while (written < bits)
+			{
+				const uint32_t byte_bit = uint32_t(bit_pos & 7);
+				const uint32_t take = std::min(8 - byte_bit, bits - written);
+				const uint32_t chunk = (uint32_t(data[bit_pos >> 3]) >> byte_bit) & ((1u << take) - 1);
+				value |= chunk << written;
+				written += take;
+				bit_pos += take;
+			}
+			return value;
+		}
+		bool ReadBool()
+		{
+			return Read(1) != 0;
+		}
+		uint64_t ReadVarUint()
+		{
+			uint64_t value = 0;
+			for (uint32_t shift = 0; shift < 64; shift += 7)
+			{
+				const uint32_t group = Read(8);
+				value |= uint64_t(group & 0x7F) << shift;
+				if ((group & 0x80) == 0 || overflow)
+					break;
+			}
+			return value;
+		}
+		int64_t ReadVarInt()
+		{
+			const uint64_t value = ReadVarUint();
+			return int64_t(value >> 1) ^ -int64_t(value & 1);
+		}
+		void ReadBytes(uint8_t* bytes, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				bytes[i] = uint8_t(Read(8));
+			}
+		}
+	};
+
+	struct ReplicationSettings
+	{
+		float position_precision = 1.0f / 512.0f; // quantization step of transform translations (in world units)
+		float scale_precision = 1.0f / 1024.0f; // quantization step of transform scales
+		size_t bandwidth_budget = 16 * 1024; // max bytes per client per tick, the lower priority changes are delayed if the changes don't fit
+		size_t max_packet_size = PACKET_CAPACITY; // the messages are fragmented into packets of this size
+		size_t max_message_size = 1024 * 1024; // larger messages are not sent by the server and not reassembled by the client
+		uint32_t max_clients = 64; // the server ignores new clients above this count
+		uint32_t client_timeout = 600; // the server removes clients that didn't send anything for this many ticks
+		bool accept_new_clients = true; // if false, the server only serves the clients that were added with AddClient()
+	};
+
+	// The component types are registered in the same order on the server and the client, the order identifies them
+	struct ReplicatedType
+	{
+		wi::ecs::ComponentManager_Interface* manager = nullptr;
+		uint64_t version = 0; // ComponentLibrary version of the component
+		float priority = 1; // higher priority components are sent first when the bandwidth budget is limited
+		wi::ecs::ComponentManager<wi::scene::TransformComponent>* transforms = nullptr; // if not null, this type is replicated as quantized transforms
+		std::function<void(wi::ecs::Entity entity, wi::Archive& archive, wi::ecs::EntitySerializer& seri)> serialize;
+		std::function<void(wi::ecs::Entity entity, wi::Archive& archive, wi::ecs::EntitySerializer& seri)> deserialize;
+	};
+
+	// Shared by the server and client: registration of the replicated component types
+	class ReplicationBase
+	{
+	public:
+		// Register a component type for replication, it will be serialized with its Serialize() function
+		//	library		:	the component library that contains the component manager (for example Scene::componentLibrary)
+		//	name		:	name of the component manager in the library (for example "wi::scene::Scene::materials")
+		//	priority	:	higher priority components are sent first when the bandwidth budget is limited
+		template<typename T>
+		void Register(wi::ecs::ComponentLibrary& library, const std::string& name, float priority = 1)
+		{
+			wi::ecs::ComponentManager<T>* manager = library.Get<T>(name);
+			assert(manager != nullptr);
+			ReplicatedType& type = types.emplace_back();
+			type.manager = manager;
+			type.version = library.GetVersion(name);
+			type.priority = priority;
+			type.serialize = [manager](wi::ecs::Entity entity, wi::Archive& archive, wi::ecs::EntitySerializer& seri) {
+				manager->GetComponent(entity)->Serialize(archive, seri);
+			};
+			type.deserialize = [manager](wi::ecs::Entity entity, wi::Archive& archive, wi::ecs::EntitySerializer& seri) {
+				T* component = manager->GetComponent(entity);
+				if (component == nullptr)
+				{
+					component = &manager->Create(entity);
+				}
+				component->Serialize(archive, seri);
+			};
+		}
+
+		// Register transforms for replication, they are quantized (see ReplicationSettings) instead of being serialized
+		//	Only the local translation, rotation and scale are replicated
+		void RegisterTransforms(wi::ecs::ComponentManager<wi::scene::TransformComponent>& manager, float priority = 1);
+
+		ReplicationSettings settings;
+
+		// Quantized transform: translation (3 * 32 bits), rotation (smallest three, 32 bits), scale (3 * 32 bits)
+		static constexpr size_t QUANTIZED_TRANSFORM_SIZE = 7 * sizeof(uint32_t);
+		void QuantizeTransform(const wi::scene::TransformComponent& transform, uint8_t* dest) const;
+		void DequantizeTransform(const uint8_t* src, wi::scene::TransformComponent& transform) const;
+
+	protected:
+		wi::vector<ReplicatedType> types;
+	};
+
+	// Sends the scene state to the clients
+	class ReplicationServer : public ReplicationBase
+	{
+	public:
+		// sock	:	the socket that the server uses to send and receive, it must be listening on a port
+		void SetSocket(const Socket* sock) { socket = sock; }
+
+		// Adds a client explicitly, clients also get added automatically when their first message arrives (see ReplicationSettings)
+		//	The client only receives the scene state after it acknowledged the first (empty) message, so unverified addresses can't be flooded
+		void AddClient(const Connection& connection);
+		void RemoveClient(const Connection& connection);
+		size_t GetClientCount() const { return clients.size(); }
+
+		// Receives acknowledgements, takes a snapshot of the registered components and sends the changes to every client
+		void Update();
+
+		uint32_t GetTick() const { return tick; }
+
+		struct Stats
+		{
+			size_t bytes_sent = 0;		// total bytes sent to all clients in the last tick
+			size_t packets_sent = 0;	// total packets sent to all clients in the last tick
+			size_t items_sent = 0;		// changed components sent to all clients in the last tick
+			size_t items_delayed = 0;	// changed components that didn't fit into the bandwidth budget in the last tick
+			double snapshot_ms = 0;		// time spent taking the snapshot in the last tick
+			double send_ms = 0;			// time spent computing deltas, packing and sending in the last tick
+		};
+		const Stats& GetStats() const { return stats; }
+
+		static constexpr uint32_t HISTORY_SIZE = 64; // number of snapshots that are kept to be used as delta baselines
+
+		struct Range
+		{
+			uint32_t offset = 0;
+			uint32_t size = 0;
+		};
+		struct Snapshot
+		{
+			uint32_t tick = 0;
+			wi::unordered_map<uint64_t, Range> items; // key: type index << 48 | entity (entities must fit into 48 bits)
+			wi::vector<uint8_t> data;
+		};
+		struct ClientItem
+		{
+			uint32_t acked_tick = 0; // the newest tick of this item that the client acknowledged, 0 if none
+			uint32_t removed_tick = 0; // the tick when the removal of this item was sent, older acknowledgements are ignored
+			float priority = 0; // accumulated priority while the item is waiting to be sent
+		};
+		struct SentItem
+		{
+			uint64_t key = 0;
+			bool removed = false;
+		};
+		struct Client
+		{
+			Connection connection;
+			uint32_t last_message_tick = 0; // the tick when the last message arrived from the client, used for timeout
+			bool acknowledged = false; // set when the first acknowledgement arrives from the client
+			wi::unordered_map<uint64_t, ClientItem> items;
+			wi::unordered_map<uint32_t, wi::vector<SentItem>> sent; // tick -> items that were sent in that tick, waiting for acknowledgement
+		};
+
+	private:
+		const Socket* socket = nullptr;
+		uint32_t tick = 0;
+		Snapshot history[HISTORY_SIZE];
+		wi::vector<Client> clients;
+		PacketPool pool;
+		wi::Archive archive;
+		wi::ecs::EntitySerializer seri;
+		Stats stats;
+
+		void ReceiveAcks();
+		void Acknowledge(Client& client, uint32_t acked_tick);
+		void TakeSnapshot();
+		void BuildMessage(Client& client, BitWriter& writer, size_t& items_sent, size_t& items_delayed);
+		wi::vector<BitWriter> writers; // one per client
+		wi::vector<size_t> client_items_sent;
+		wi::vector<size_t> client_items_delayed;
+		wi::vector<Packet*> send_packets;
+		Client* FindClient(const Connection& connection);
+	};
+
+	// Receives the scene state from the server and applies it to the registered components
+	class ReplicationClient : public ReplicationBase
+	{
+	public:
+		// Sets the socket used for communication and the server address, a hello message is sent to the server
+		//	sock	:	the socket that the client uses to send and receive, it must be listening on a port
+		void Connect(const Socket* sock, const Connection& server);
+
+		// Receives the server messages, applies the complete ones and sends acknowledgements
+		void Update();
+
+		// The newest server tick that was applied
+		uint32_t GetTick() const { return latest_tick; }
+
+		// Returns the local entity that corresponds to the server's entity, INVALID_ENTITY if it wasn't replicated yet
+		wi::ecs::Entity GetLocalEntity(wi::ecs::Entity server_entity) const;
+
+		struct Stats
+		{
+			size_t bytes_received = 0;		// bytes received in the last update
+			size_t messages_applied = 0;	// complete tick messages applied in the last update
+			size_t items_applied = 0;		// components updated in the last update
+		};
+		const Stats& GetStats() const { return stats; }
+
+		struct ItemState
+		{
+			uint32_t tick = 0;
+			wi::vector<uint8_t> data;
+		};
+		struct Item
+		{
+			uint32_t applied_tick = 0;
+			wi::vector<ItemState> states; // received states that can be used as delta baselines
+		};
+		static constexpr size_t MAX_REASSEMBLIES = 16; // max number of incomplete messages that are kept
+		static constexpr uint32_t TICK_WINDOW = 64; // messages that are older or newer than this compared to the latest applied tick are dropped
+		struct Reassembly
+		{
+			uint32_t fragment_count = 0;
+			uint32_t fragments_received = 0;
+			wi::vector<bool> received;
+			wi::vector<uint8_t> data;
+		};
+
+	private:
+		const Socket* socket = nullptr;
+		Connection server;
+		PacketPool pool;
+		uint32_t latest_tick = 0;
+		uint64_t received_ticks = 0; // bitmask of the received ticks before latest_tick
+		bool resync_requested = false; // set when a delta baseline was missing, the server will send full states
+		wi::unordered_map<uint64_t, Item> items;
+		wi::unordered_map<uint32_t, Reassembly> reassemblies;
+		wi::ecs::EntitySerializer seri;
+		Stats stats;
+
+		void ApplyMessage(uint32_t tick, const uint8_t* data, size_t size);
+		void SendAck();
+	};
+}
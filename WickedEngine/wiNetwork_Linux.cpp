@@ -6,10 +6,17 @@
 #include "wiTimer.h"
 
 #include <string>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <chrono>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
 
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <poll.h>
 #include <netinet/in.h>
 
 namespace wi::network
@@ -23,9 +30,64 @@ namespace wi::network
 		};
 	};
 
+	static constexpr size_t BATCH_SIZE = 64; // max number of packets per sendmmsg/recvmmsg call
+	static constexpr int SEND_RETRY_COUNT = 8; // max number of retries without progress in SendBatch
+	static constexpr int SEND_RETRY_TIMEOUT_MS = 10; // max wait time for a full send buffer in one SendBatch retry
+
+	inline sockaddr_in to_sockaddr(const Connection& connection)
+	{
+		sockaddr_in target = {};
+		target.sin_family = AF_INET;
+		target.sin_port = htons(connection.port);
+		in_addr_union address;
+		address.S_un_b.s_b1 = connection.ipaddress[0];
+		address.S_un_b.s_b2 = connection.ipaddress[1];
+		address.S_un_b.s_b3 = connection.ipaddress[2];
+		address.S_un_b.s_b4 = connection.ipaddress[3];
+		target.sin_addr.s_addr = address.S_addr;
+		return target;
+	}
+	inline Connection to_connection(const sockaddr_in& sender)
+	{
+		Connection connection;
+		connection.port = ntohs(sender.sin_port); // reverse byte order from network to host
+		in_addr_union address;
+		address.S_addr = sender.sin_addr.s_addr;
+		connection.ipaddress[0] = address.S_un_b.s_b1;
+		connection.ipaddress[1] = address.S_un_b.s_b2;
+		connection.ipaddress[2] = address.S_un_b.s_b3;
+		connection.ipaddress[3] = address.S_un_b.s_b4;
+		return connection;
+	}
+
 	struct SocketInternal{
 		int handle;
+
+		// Receiving thread state:
+		int epoll_handle = -1;
+		std::atomic_bool receiving{ false };
+		std::thread receive_thread;
+		PacketPool* receive_pool = nullptr;
+		wi::SpinLock received_locker;
+		wi::vector<Packet*> received;
+
+		void StopReceiving()
+		{
+			if (epoll_handle < 0)
+				return;
+			receiving.store(false);
+			if (receive_thread.joinable())
+			{
+				receive_thread.join();
+			}
+			close(epoll_handle);
+			epoll_handle = -1;
+			int flags = fcntl(handle, F_GETFL, 0);
+			fcntl(handle, F_SETFL, flags & ~O_NONBLOCK);
+		}
+
 		~SocketInternal(){
+			StopReceiving();
 			int result = close(handle);
 			if(result < 0){
 				assert(0);
@@ -57,15 +119,7 @@ namespace wi::network
 	bool Send(const Socket* sock, const Connection* connection, const void* data, size_t dataSize)
 	{
 		if (sock->IsValid()){
-			sockaddr_in target;
-			target.sin_family = AF_INET;
-			target.sin_port = htons(connection->port);
-			in_addr_union address;
-			address.S_un_b.s_b1 = connection->ipaddress[0];
-			address.S_un_b.s_b2 = connection->ipaddress[1];
-			address.S_un_b.s_b3 = connection->ipaddress[2];
-			address.S_un_b.s_b4 = connection->ipaddress[3];
-			target.sin_addr.s_addr = address.S_addr;
+			sockaddr_in target = to_sockaddr(*connection);
 
 			auto socketinternal = to_internal(sock);
 			int result = sendto(socketinternal->handle, (const char*)data, (int)dataSize, 0, (const sockaddr*)&target, sizeof(target));
@@ -114,7 +168,7 @@ namespace wi::network
 			timeout.tv_sec = 0;
 			timeout.tv_usec = timeout_microseconds;
 
-			int result = select(0, &readfds, NULL, NULL, &timeout);
+			int result = select(socketinternal->handle + 1, &readfds, NULL, NULL, &timeout); // first parameter must be the highest descriptor + 1 (it is ignored on Windows, but not here)
 			if (result < 0)
 			{
 				wi::backlog::post("wi::network_Linux error in Send: (Error Code: " + std::to_string(result) + ") " + std::string(strerror(result)));
@@ -142,18 +196,211 @@ namespace wi::network
 				return false;
 			}
 
-			connection->port = htons(sender.sin_port); // reverse byte order from network to host
-			in_addr_union address;
-			address.S_addr = sender.sin_addr.s_addr;
-			connection->ipaddress[0] = address.S_un_b.s_b1;
-			connection->ipaddress[1] = address.S_un_b.s_b2;
-			connection->ipaddress[2] = address.S_un_b.s_b3;
-			connection->ipaddress[3] = address.S_un_b.s_b4;
+			*connection = to_connection(sender);
 
 			return true;
 		}
 		return false;
 	}
+
+	size_t SendBatch(const Socket* sock, const Packet* const* packets, size_t count)
+	{
+		if (!sock->IsValid())
+			return 0;
+		auto socketinternal = to_internal(sock);
+
+		mmsghdr messages[BATCH_SIZE];
+		iovec buffers[BATCH_SIZE];
+		sockaddr_in targets[BATCH_SIZE];
+
+		size_t sent = 0;
+		int retries = 0;
+		while (sent < count)
+		{
+			const unsigned int batch = (unsigned int)std::min(count - sent, BATCH_SIZE);
+			for (unsigned int i = 0; i < batch; ++i)
+			{
+				const Packet* packet = packets[sent + i];
+				targets[i] = to_sockaddr(packet->connection);
+				buffers[i].iov_base = (void*)packet->data;
+				buffers[i].iov_len = packet->size;
+				messages[i] = {};
+				messages[i].msg_hdr.msg_name = &targets[i];
+				messages[i].msg_hdr.msg_namelen = sizeof(targets[i]);
+				messages[i].msg_hdr.msg_iov = &buffers[i];
+				messages[i].msg_hdr.msg_iovlen = 1;
+			}
+			int result = sendmmsg(socketinternal->handle, messages, batch, 0);
+			if (result < 0)
+			{
+				if (errno == EINTR && retries++ < SEND_RETRY_COUNT)
+					continue;
+				if ((errno == EAGAIN || errno == EWOULDBLOCK) && retries++ < SEND_RETRY_COUNT)
+				{
+					// Send buffer is full (non-blocking socket), wait until it can be written, but not indefinitely:
+					pollfd pfd = {};
+					pfd.fd = socketinternal->handle;
+					pfd.events = POLLOUT;
+					const int ready = poll(&pfd, 1, SEND_RETRY_TIMEOUT_MS);
+					if (ready > 0 || (ready < 0 && errno == EINTR))
+						continue;
+					break; // still full, return the partial count
+				}
+				wi::backlog::post("wi::network_Linux error in SendBatch: (Error Code: " + std::to_string(errno) + ") " + std::string(strerror(errno)));
+				break;
+			}
+			sent += (size_t)result;
+			retries = 0;
+		}
+		return sent;
+	}
+
+	// Receives as many packets as available without blocking, returns the received count
+	static size_t receive_batch_internal(int handle, PacketPool* pool, Packet** packets, size_t max_count)
+	{
+		mmsghdr messages[BATCH_SIZE];
+		iovec buffers[BATCH_SIZE];
+		sockaddr_in senders[BATCH_SIZE];
+
+		size_t received = 0;
+		while (received < max_count)
+		{
+			// The data is received directly into the pool packets:
+			unsigned int batch = 0;
+			const size_t batch_max = std::min(max_count - received, BATCH_SIZE);
+			while (batch < batch_max)
+			{
+				Packet* packet = pool->Allocate();
+				if (packet == nullptr)
+					break;
+				packets[received + batch] = packet;
+				buffers[batch].iov_base = packet->data;
+				buffers[batch].iov_len = sizeof(packet->data);
+				messages[batch] = {};
+				messages[batch].msg_hdr.msg_name = &senders[batch];
+				messages[batch].msg_hdr.msg_namelen = sizeof(senders[batch]);
+				messages[batch].msg_hdr.msg_iov = &buffers[batch];
+				messages[batch].msg_hdr.msg_iovlen = 1;
+				batch++;
+			}
+			if (batch == 0)
+				break; // pool is exhausted
+
+			int result = recvmmsg(handle, messages, batch, MSG_DONTWAIT, nullptr);
+			const unsigned int result_count = result < 0 ? 0 : (unsigned int)result;
+			for (unsigned int i = 0; i < result_count; ++i)
+			{
+				Packet* packet = packets[received + i];
+				packet->size = messages[i].msg_len;
+				packet->connection = to_connection(senders[i]);
+			}
+			pool->Free(packets + received + result_count, batch - result_count);
+			received += result_count;
+
+			if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			{
+				wi::backlog::post("wi::network_Linux error in ReceiveBatch: (Error Code: " + std::to_string(errno) + ") " + std::string(strerror(errno)));
+			}
+			if (result_count < batch)
+				break; // no more packets waiting
+		}
+		return received;
+	}
+
+	size_t ReceiveBatch(const Socket* sock, PacketPool* pool, Packet** packets, size_t max_count)
+	{
+		if (!sock->IsValid())
+			return 0;
+		auto socketinternal = to_internal(sock);
+		return receive_batch_internal(socketinternal->handle, pool, packets, max_count);
+	}
+
+	bool StartReceiving(const Socket* sock, PacketPool* pool)
+	{
+		if (!sock->IsValid())
+			return false;
+		auto socketinternal = to_internal(sock);
+		socketinternal->StopReceiving();
+
+		int flags = fcntl(socketinternal->handle, F_GETFL, 0);
+		if (flags < 0 || fcntl(socketinternal->handle, F_SETFL, flags | O_NONBLOCK) < 0)
+		{
+			wi::backlog::post("wi::network_Linux error in StartReceiving: (Error Code: " + std::to_string(errno) + ") " + std::string(strerror(errno)));
+			return false;
+		}
+
+		socketinternal->epoll_handle = epoll_create1(0);
+		if (socketinternal->epoll_handle < 0)
+		{
+			wi::backlog::post("wi::network_Linux error in StartReceiving: (Error Code: " + std::to_string(errno) + ") " + std::string(strerror(errno)));
+			fcntl(socketinternal->handle, F_SETFL, flags);
+			return false;
+		}
+		epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.fd = socketinternal->handle;
+		if (epoll_ctl(socketinternal->epoll_handle, EPOLL_CTL_ADD, socketinternal->handle, &event) < 0)
+		{
+			wi::backlog::post("wi::network_Linux error in StartReceiving: (Error Code: " + std::to_string(errno) + ") " + std::string(strerror(errno)));
+			socketinternal->StopReceiving();
+			return false;
+		}
+
+		socketinternal->receive_pool = pool;
+		socketinternal->receiving.store(true);
+
+		// The receiving loop runs until StopReceiving(), so it gets its own thread instead of occupying a job system worker:
+		socketinternal->receive_thread = std::thread([socketinternal] {
+			Packet* packets[BATCH_SIZE];
+			while (socketinternal->receiving.load())
+			{
+				// The timeout lets the loop check the stop request regularly:
+				epoll_event event;
+				int result = epoll_wait(socketinternal->epoll_handle, &event, 1, 10);
+				if (result <= 0)
+					continue;
+
+				// Drain the socket before waiting again:
+				size_t count = 0;
+				do
+				{
+					count = receive_batch_internal(socketinternal->handle, socketinternal->receive_pool, packets, arraysize(packets));
+					if (count > 0)
+					{
+						std::scoped_lock lck(socketinternal->received_locker);
+						socketinternal->received.insert(socketinternal->received.end(), packets, packets + count);
+					}
+					else
+					{
+						// The socket was readable, so the pool is exhausted, wait for the caller to free packets:
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				} while (count == arraysize(packets));
+			}
+		});
+
+		return true;
+	}
+
+	void StopReceiving(const Socket* sock)
+	{
+		if (!sock->IsValid())
+			return;
+		auto socketinternal = to_internal(sock);
+		socketinternal->StopReceiving();
+	}
+
+	size_t PollReceived(const Socket* sock, Packet** packets, size_t max_count)
+	{
+		if (!sock->IsValid())
+			return 0;
+		auto socketinternal = to_internal(sock);
+		std::scoped_lock lck(socketinternal->received_locker);
+		const size_t count = std::min(max_count, socketinternal->received.size());
+		std::memcpy(packets, socketinternal->received.data(), count * sizeof(Packet*));
+		socketinternal->received.erase(socketinternal->received.begin(), socketinternal->received.begin() + count);
+		return count;
+	}
 }
 
 #endif // LINUX
@@ -6,6 +6,10 @@
 #include "wiTimer.h"
 
 #include <string>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 #include <winsock.h>
 #pragma comment(lib,"ws2_32.lib")
@@ -48,8 +52,25 @@ namespace wi::network
 		std::shared_ptr<NetworkInternal> networkinternal;
 		SOCKET handle = NULL;
 
+		// Receiving thread state:
+		std::atomic_bool receiving{ false };
+		std::thread receive_thread;
+		PacketPool* receive_pool = nullptr;
+		wi::SpinLock received_locker;
+		wi::vector<Packet*> received;
+
+		void StopReceiving()
+		{
+			receiving.store(false);
+			if (receive_thread.joinable())
+			{
+				receive_thread.join();
+			}
+		}
+
 		~SocketInternal()
 		{
+			StopReceiving();
 			int result = closesocket(handle);
 			if (result == SOCKET_ERROR)
 			{
@@ -184,6 +205,127 @@ namespace wi::network
 		return false;
 	}
 
+	// There is no sendmmsg/recvmmsg on Windows, so the batched functions are implemented with one system call per packet:
+
+	size_t SendBatch(const Socket* sock, const Packet* const* packets, size_t count)
+	{
+		size_t sent = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (!Send(sock, &packets[i]->connection, packets[i]->data, packets[i]->size))
+				break;
+			sent++;
+		}
+		return sent;
+	}
+
+	static bool can_receive_internal(SOCKET handle, long timeout_microseconds)
+	{
+		fd_set readfds;
+		FD_ZERO(&readfds);
+		FD_SET(handle, &readfds);
+		timeval timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = timeout_microseconds;
+		int result = select(0, &readfds, NULL, NULL, &timeout);
+		return result > 0 && FD_ISSET(handle, &readfds);
+	}
+
+	static size_t receive_batch_internal(SOCKET handle, PacketPool* pool, Packet** packets, size_t max_count)
+	{
+		size_t received = 0;
+		while (received < max_count && can_receive_internal(handle, 0))
+		{
+			Packet* packet = pool->Allocate();
+			if (packet == nullptr)
+				break; // pool is exhausted
+
+			sockaddr_in sender;
+			int targetsize = sizeof(sender);
+			int result = recvfrom(handle, (char*)packet->data, (int)sizeof(packet->data), 0, (sockaddr*)&sender, &targetsize);
+			if (result == SOCKET_ERROR)
+			{
+				int error = WSAGetLastError();
+				wi::backlog::post("wi::network error in ReceiveBatch: " + std::to_string(error));
+				pool->Free(packet);
+				break;
+			}
+
+			packet->size = (uint32_t)result;
+			packet->connection.port = htons(sender.sin_port); // reverse byte order from network to host
+			packet->connection.ipaddress[0] = sender.sin_addr.S_un.S_un_b.s_b1;
+			packet->connection.ipaddress[1] = sender.sin_addr.S_un.S_un_b.s_b2;
+			packet->connection.ipaddress[2] = sender.sin_addr.S_un.S_un_b.s_b3;
+			packet->connection.ipaddress[3] = sender.sin_addr.S_un.S_un_b.s_b4;
+			packets[received++] = packet;
+		}
+		return received;
+	}
+
+	size_t ReceiveBatch(const Socket* sock, PacketPool* pool, Packet** packets, size_t max_count)
+	{
+		if (!sock->IsValid())
+			return 0;
+		auto socketinternal = to_internal(sock);
+		return receive_batch_internal(socketinternal->handle, pool, packets, max_count);
+	}
+
+	bool StartReceiving(const Socket* sock, PacketPool* pool)
+	{
+		if (!sock->IsValid())
+			return false;
+		auto socketinternal = to_internal(sock);
+		socketinternal->StopReceiving();
+
+		socketinternal->receive_pool = pool;
+		socketinternal->receiving.store(true);
+
+		// The receiving loop runs until StopReceiving(), so it gets its own thread instead of occupying a job system worker:
+		socketinternal->receive_thread = std::thread([socketinternal] {
+			Packet* packets[64];
+			while (socketinternal->receiving.load())
+			{
+				// The timeout lets the loop check the stop request regularly:
+				if (!can_receive_internal(socketinternal->handle, 10000))
+					continue;
+
+				size_t count = receive_batch_internal(socketinternal->handle, socketinternal->receive_pool, packets, arraysize(packets));
+				if (count > 0)
+				{
+					std::scoped_lock lck(socketinternal->received_locker);
+					socketinternal->received.insert(socketinternal->received.end(), packets, packets + count);
+				}
+				else
+				{
+					// Pool is exhausted, wait for the caller to free packets:
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+		});
+
+		return true;
+	}
+
+	void StopReceiving(const Socket* sock)
+	{
+		if (!sock->IsValid())
+			return;
+		auto socketinternal = to_internal(sock);
+		socketinternal->StopReceiving();
+	}
+
+	size_t PollReceived(const Socket* sock, Packet** packets, size_t max_count)
+	{
+		if (!sock->IsValid())
+			return 0;
+		auto socketinternal = to_internal(sock);
+		std::scoped_lock lck(socketinternal->received_locker);
+		const size_t count = std::min(max_count, socketinternal->received.size());
+		std::memcpy(packets, socketinternal->received.data(), count * sizeof(Packet*));
+		socketinternal->received.erase(socketinternal->received.begin(), socketinternal->received.begin() + count);
+		return count;
+	}
+
 }
 
 #endif // PLATFORM_WINDOWS_DESKTOP
@@ -0,0 +1,316 @@
+#include "wiOcclusionBuffer.h"
+#include "wiJobSystem.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+
+using namespace wi::primitive;
+
+namespace wi
+{
+	static constexpr float near_epsilon = 1e-4f;
+
+	// Pixel coordinate of a screen position, the value is clamped to [lo, hi] before the conversion to integer, because out of range conversion is undefined
+	//	The value must not be NaN
+	static inline int pixel_floor(float value, float lo, float hi)
+	{
+		return int(std::floor(std::max(lo, std::min(hi, value))));
+	}
+
+	void OcclusionBuffer::Clear(uint32_t width, uint32_t height, const XMMATRIX& viewProjection)
+	{
+		this->width = std::max(1u, (width + tile_size - 1) / tile_size) * tile_size;
+		this->height = std::max(1u, (height + tile_size - 1) / tile_size) * tile_size;
+		tile_count_x = this->width / tile_size;
+		tile_count_y = this->height / tile_size;
+		XMStoreFloat4x4(&this->viewProjection, viewProjection);
+
+		depth.resize(size_t(this->width) * size_t(this->height));
+		std::fill(depth.begin(), depth.end(), 0.0f);
+		erosion.resize(depth.size());
+		tile_depth.resize(size_t(tile_count_x) * size_t(tile_count_y));
+		std::fill(tile_depth.begin(), tile_depth.end(), 0.0f);
+		triangles.clear();
+	}
+
+	void OcclusionBuffer::AddOccluder(const XMFLOAT3* positions, const uint32_t* indices, uint32_t index_count, const XMMATRIX& world, bool cull_backfaces)
+	{
+		if (width == 0 || height == 0)
+			return;
+
+		const XMMATRIX M = world * XMLoadFloat4x4(&viewProjection);
+		const float fwidth = float(width);
+		const float fheight = float(height);
+
+		// Screen space has flipped Y, so front facing triangles have negative area, unless the world matrix is mirrored:
+		const bool mirrored = XMVectorGetX(XMMatrixDeterminant(world)) < 0;
+
+		// The triangles are first collected locally, to keep the lock time short when many threads are adding occluders:
+		Triangle batch[64];
+		uint32_t batch_count = 0;
+		auto flush = [&]() {
+			if (batch_count == 0)
+				return;
+			std::scoped_lock lck(locker);
+			triangles.insert(triangles.end(), batch, batch + batch_count);
+			batch_count = 0;
+		};
+
+		for (uint32_t i = 0; i + 2 < index_count; i += 3)
+		{
+			XMFLOAT4 clip[3];
+			XMStoreFloat4(&clip[0], XMVector3Transform(XMLoadFloat3(&positions[indices[i + 0]]), M));
+			XMStoreFloat4(&clip[1], XMVector3Transform(XMLoadFloat3(&positions[indices[i + 1]]), M));
+			XMStoreFloat4(&clip[2], XMVector3Transform(XMLoadFloat3(&positions[indices[i + 2]]), M));
+
+			// Near plane clipping is not performed, the triangle is discarded instead, which is conservative
+			if (clip[0].w < near_epsilon || clip[1].w < near_epsilon || clip[2].w < near_epsilon)
+				continue;
+
+			Triangle& tri = batch[batch_count];
+			XMFLOAT3* v[3] = { &tri.v0, &tri.v1, &tri.v2 };
+			for (int j = 0; j < 3; ++j)
+			{
+				const float rcp_w = 1.0f / clip[j].w;
+				v[j]->x = (clip[j].x * rcp_w * 0.5f + 0.5f) * fwidth;
+				v[j]->y = (0.5f - clip[j].y * rcp_w * 0.5f) * fheight;
+				v[j]->z = clip[j].z * rcp_w;
+			}
+			if (!std::isfinite(tri.v0.x + tri.v0.y + tri.v0.z + tri.v1.x + tri.v1.y + tri.v1.z + tri.v2.x + tri.v2.y + tri.v2.z))
+				continue; // NaN or infinite (or overflowing) vertex, the triangle is discarded, which is conservative
+
+			// Trivial reject for off screen and degenerate triangles:
+			const float minx = std::min(tri.v0.x, std::min(tri.v1.x, tri.v2.x));
+			const float maxx = std::max(tri.v0.x, std::max(tri.v1.x, tri.v2.x));
+			const float miny = std::min(tri.v0.y, std::min(tri.v1.y, tri.v2.y));
+			const float maxy = std::max(tri.v0.y, std::max(tri.v1.y, tri.v2.y));
+			if (maxx < 0 || maxy < 0 || minx > fwidth || miny > fheight)
+				continue;
+			if (std::max(tri.v0.z, std::max(tri.v1.z, tri.v2.z)) < 0)
+				continue; // behind far plane
+			const float area = (tri.v1.x - tri.v0.x) * (tri.v2.y - tri.v0.y) - (tri.v1.y - tri.v0.y) * (tri.v2.x - tri.v0.x);
+			if (std::abs(area) < 1e-6f)
+				continue;
+			if (cull_backfaces && ((area > 0) != mirrored))
+				continue;
+			if (area < 0)
+			{
+				// Both windings are accepted, but the rasterizer expects consistent orientation:
+				std::swap(tri.v1, tri.v2);
+			}
+
+			batch_count++;
+			if (batch_count == arraysize(batch))
+			{
+				flush();
+			}
+		}
+		flush();
+	}
+
+	void OcclusionBuffer::Rasterize()
+	{
+		if (width == 0 || height == 0)
+			return;
+
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, tile_count_y, 1, [this](wi::jobsystem::JobArgs args) {
+			const uint32_t tile_y = args.jobIndex;
+			const int row_min = int(tile_y * tile_size);
+			const int row_max = row_min + int(tile_size) - 1;
+			const int column_max = int(width) - 1;
+			const float fwidth = float(width);
+			const float fheight = float(height);
+
+			const XMVECTOR pixel_offsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+
+			for (const Triangle& tri : triangles)
+			{
+				const float fminy = std::min(tri.v0.y, std::min(tri.v1.y, tri.v2.y));
+				const float fmaxy = std::max(tri.v0.y, std::max(tri.v1.y, tri.v2.y));
+				const int y0 = std::max(row_min, pixel_floor(fminy, -1, fheight));
+				const int y1 = std::min(row_max, pixel_floor(fmaxy, -1, fheight));
+				if (y0 > y1)
+					continue;
+				const float fminx = std::min(tri.v0.x, std::min(tri.v1.x, tri.v2.x));
+				const float fmaxx = std::max(tri.v0.x, std::max(tri.v1.x, tri.v2.x));
+				const int x0 = std::max(0, pixel_floor(fminx, -1, fwidth)) & ~3; // 4 pixels are processed at once
+				const int x1 = std::min(column_max, pixel_floor(fmaxx, -1, fwidth));
+				if (x0 > x1)
+					continue;
+
+				// Edge functions: e(x,y) = A * x + B * y + C, positive inside
+				const float A0 = tri.v1.y - tri.v2.y, B0 = tri.v2.x - tri.v1.x, C0 = tri.v1.x * tri.v2.y - tri.v1.y * tri.v2.x;
+				const float A1 = tri.v2.y - tri.v0.y, B1 = tri.v0.x - tri.v2.x, C1 = tri.v2.x * tri.v0.y - tri.v2.y * tri.v0.x;
+				const float A2 = tri.v0.y - tri.v1.y, B2 = tri.v1.x - tri.v0.x, C2 = tri.v0.x * tri.v1.y - tri.v0.y * tri.v1.x;
+
+				// Depth plane from barycentrics: z = z0 * e0 + z1 * e1 + z2 * e2 (normalized)
+				const float rcp_area = 1.0f / (A0 * tri.v0.x + B0 * tri.v0.y + C0);
+				const float ZA = (tri.v0.z * A0 + tri.v1.z * A1 + tri.v2.z * A2) * rcp_area;
+				const float ZB = (tri.v0.z * B0 + tri.v1.z * B1 + tri.v2.z * B2) * rcp_area;
+				const float ZC = (tri.v0.z * C0 + tri.v1.z * C1 + tri.v2.z * C2) * rcp_area;
+
+				const XMVECTOR vA0 = XMVectorReplicate(A0), vA1 = XMVectorReplicate(A1), vA2 = XMVectorReplicate(A2);
+				const XMVECTOR vZA = XMVectorReplicate(ZA);
+				const XMVECTOR step0 = XMVectorReplicate(A0 * 4), step1 = XMVectorReplicate(A1 * 4), step2 = XMVectorReplicate(A2 * 4);
+				const XMVECTOR stepZ = XMVectorReplicate(ZA * 4);
+				const XMVECTOR px = XMVectorAdd(XMVectorReplicate(float(x0)), pixel_offsets);
+
+				for (int y = y0; y <= y1; ++y)
+				{
+					const float py = float(y) + 0.5f;
+					XMVECTOR e0 = XMVectorMultiplyAdd(vA0, px, XMVectorReplicate(B0 * py + C0));
+					XMVECTOR e1 = XMVectorMultiplyAdd(vA1, px, XMVectorReplicate(B1 * py + C1));
+					XMVECTOR e2 = XMVectorMultiplyAdd(vA2, px, XMVectorReplicate(B2 * py + C2));
+					XMVECTOR z = XMVectorMultiplyAdd(vZA, px, XMVectorReplicate(ZB * py + ZC));
+
+					float* row = depth.data() + size_t(y) * size_t(width);
+					for (int x = x0; x <= x1; x += 4)
+					{
+						// Pixel centers are tested, partially covered pixels at the silhouettes are removed after this by erosion:
+						XMVECTOR inside = XMVectorAndInt(XMVectorGreater(e0, XMVectorZero()), XMVectorGreater(e1, XMVectorZero()));
+						inside = XMVectorAndInt(inside, XMVectorGreater(e2, XMVectorZero()));
+						if (XMVector4NotEqualInt(inside, XMVectorFalseInt()))
+						{
+							XMFLOAT4* dst = (XMFLOAT4*)(row + x);
+							const XMVECTOR prev = XMLoadFloat4(dst);
+							XMStoreFloat4(dst, XMVectorSelect(prev, XMVectorMax(prev, z), inside));
+						}
+						e0 = XMVectorAdd(e0, step0);
+						e1 = XMVectorAdd(e1, step1);
+						e2 = XMVectorAdd(e2, step2);
+						z = XMVectorAdd(z, stepZ);
+					}
+				}
+			}
+
+			// Horizontal erosion: farthest depth of the 3 neighboring pixels
+			for (int y = row_min; y <= row_max; ++y)
+			{
+				const float* src = depth.data() + size_t(y) * size_t(width);
+				float* dst = erosion.data() + size_t(y) * size_t(width);
+				for (int x = 0; x <= column_max; ++x)
+				{
+					dst[x] = std::min(src[x], std::min(src[std::max(0, x - 1)], src[std::min(column_max, x + 1)]));
+				}
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+
+		wi::jobsystem::Dispatch(ctx, tile_count_y, 1, [this](wi::jobsystem::JobArgs args) {
+			const uint32_t tile_y = args.jobIndex;
+			const int row_min = int(tile_y * tile_size);
+			const int row_max = row_min + int(tile_size) - 1;
+			const int last_row = int(height) - 1;
+
+			// Vertical erosion: together with the horizontal pass, every pixel gets the farthest depth of its 3x3 neighborhood
+			//	A pixel that is only partially covered by an occluder has an uncovered neighbor, so the occluder silhouettes are never overestimated
+			//	This also makes the depth conservative within the pixel, because the depth was only sampled at pixel centers
+			for (int y = row_min; y <= row_max; ++y)
+			{
+				const float* above = erosion.data() + size_t(std::max(0, y - 1)) * size_t(width);
+				const float* center = erosion.data() + size_t(y) * size_t(width);
+				const float* below = erosion.data() + size_t(std::min(last_row, y + 1)) * size_t(width);
+				float* dst = depth.data() + size_t(y) * size_t(width);
+				for (uint32_t x = 0; x < width; x += 4)
+				{
+					const XMVECTOR farthest = XMVectorMin(XMLoadFloat4((const XMFLOAT4*)(center + x)), XMVectorMin(XMLoadFloat4((const XMFLOAT4*)(above + x)), XMLoadFloat4((const XMFLOAT4*)(below + x))));
+					XMStoreFloat4((XMFLOAT4*)(dst + x), farthest);
+				}
+			}
+
+			// Hierarchical depth: farthest depth of each tile in this row
+			for (uint32_t tile_x = 0; tile_x < tile_count_x; ++tile_x)
+			{
+				XMVECTOR farthest = XMVectorSplatOne();
+				for (uint32_t y = 0; y < tile_size; ++y)
+				{
+					const float* row = depth.data() + size_t(row_min + y) * size_t(width) + size_t(tile_x * tile_size);
+					for (uint32_t x = 0; x < tile_size; x += 4)
+					{
+						farthest = XMVectorMin(farthest, XMLoadFloat4((const XMFLOAT4*)(row + x)));
+					}
+				}
+				XMFLOAT4 f;
+				XMStoreFloat4(&f, farthest);
+				tile_depth[tile_y * tile_count_x + tile_x] = std::min(std::min(f.x, f.y), std::min(f.z, f.w));
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+	}
+
+	bool OcclusionBuffer::IsOccluded(const AABB& aabb) const
+	{
+		if (width == 0 || height == 0 || triangles.empty() || !aabb.IsValid())
+			return false;
+
+		const XMMATRIX VP = XMLoadFloat4x4(&viewProjection);
+		const float fwidth = float(width);
+		const float fheight = float(height);
+
+		float minx = std::numeric_limits<float>::max();
+		float miny = std::numeric_limits<float>::max();
+		float maxx = std::numeric_limits<float>::lowest();
+		float maxy = std::numeric_limits<float>::lowest();
+		float nearest = std::numeric_limits<float>::lowest();
+		for (int i = 0; i < 8; ++i)
+		{
+			const XMFLOAT3 corner = aabb.corner(i);
+			XMFLOAT4 clip;
+			XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), VP));
+			if (clip.w < near_epsilon)
+				return false; // box intersects the near plane
+			const float rcp_w = 1.0f / clip.w;
+			const float x = (clip.x * rcp_w * 0.5f + 0.5f) * fwidth;
+			const float y = (0.5f - clip.y * rcp_w * 0.5f) * fheight;
+			if (std::isnan(x) || std::isnan(y))
+				return false; // can't be decided
+			minx = std::min(minx, x);
+			miny = std::min(miny, y);
+			maxx = std::max(maxx, x);
+			maxy = std::max(maxy, y);
+			nearest = std::max(nearest, clip.z * rcp_w);
+		}
+
+		if (maxx < 0 || maxy < 0 || minx >= fwidth || miny >= fheight)
+			return false; // not on screen, this is left for frustum culling
+
+		// Small relative bias, so that an occluder's own surface lying on its bounding box doesn't hide itself:
+		nearest += std::abs(nearest) * 1e-3f;
+
+		const int x0 = std::max(0, pixel_floor(minx, -1, fwidth));
+		const int y0 = std::max(0, pixel_floor(miny, -1, fheight));
+		const int x1 = std::min(int(width) - 1, pixel_floor(maxx, -1, fwidth));
+		const int y1 = std::min(int(height) - 1, pixel_floor(maxy, -1, fheight));
+
+		const int tile_x0 = x0 / int(tile_size);
+		const int tile_y0 = y0 / int(tile_size);
+		const int tile_x1 = x1 / int(tile_size);
+		const int tile_y1 = y1 / int(tile_size);
+		for (int tile_y = tile_y0; tile_y <= tile_y1; ++tile_y)
+		{
+			for (int tile_x = tile_x0; tile_x <= tile_x1; ++tile_x)
+			{
+				if (tile_depth[tile_y * tile_count_x + tile_x] > nearest)
+					continue; // whole tile is in front of the box
+
+				// Tile depth is not enough, check the covered pixels individually:
+				const int px0 = std::max(x0, tile_x * int(tile_size));
+				const int px1 = std::min(x1, tile_x * int(tile_size) + int(tile_size) - 1);
+				const int py0 = std::max(y0, tile_y * int(tile_size));
+				const int py1 = std::min(y1, tile_y * int(tile_size) + int(tile_size) - 1);
+				for (int y = py0; y <= py1; ++y)
+				{
+					const float* row = depth.data() + size_t(y) * size_t(width);
+					for (int x = px0; x <= px1; ++x)
+					{
+						if (row[x] <= nearest)
+							return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
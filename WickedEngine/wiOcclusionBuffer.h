@@ -0,0 +1,64 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiMath.h"
+#include "wiPrimitive.h"
+#include "wiVector.h"
+#include "wiSpinLock.h"
+
+namespace wi
+{
+	// Low resolution software depth buffer for CPU occlusion culling
+	//	Occluder triangles are rasterized on the CPU with wi::jobsystem, then objects can be tested against it by their bounding box
+	//	The result is available in the same frame, so unlike GPU occlusion queries there is no latency and no popping
+	//	The depth buffer uses reversed Z (1 = near, 0 = far), the same as the engine's cameras
+	class OcclusionBuffer
+	{
+	public:
+		static constexpr uint32_t tile_size = 8; // tiles are tile_size * tile_size pixels, width and height are multiples of tile_size
+
+		// Reset the depth buffer to far plane, and remove all occluders
+		//	width, height	: resolution of the depth buffer, it will be rounded up to multiple of tile_size
+		//	viewProjection	: camera matrix that will be used for both occluders and occludees
+		void Clear(uint32_t width, uint32_t height, const XMMATRIX& viewProjection);
+
+		// Add occluder triangles, this can be called from multiple threads at once, before Rasterize()
+		//	positions	: object space vertex positions
+		//	indices		: triangle list indices
+		//	index_count	: number of indices
+		//	world		: object to world matrix
+		//	cull_backfaces : if true, triangles facing away from the camera are skipped (front faces are counter clockwise like in the renderer)
+		//	Triangles that intersect the near plane are skipped, the occluders must be fully inside the geometry they represent
+		void AddOccluder(const XMFLOAT3* positions, const uint32_t* indices, uint32_t index_count, const XMMATRIX& world, bool cull_backfaces = true);
+
+		// Rasterize all occluders and build the hierarchical tile depths, the work is distributed with wi::jobsystem
+		//	The depth is eroded by one pixel after rasterization, so partially covered pixels don't count as occluded
+		//	This blocks until the rasterization is finished
+		void Rasterize();
+
+		// Test bounding box against the rasterized depth buffer, can be called from multiple threads after Rasterize()
+		//	returns true if the box is certainly not visible, false otherwise
+		bool IsOccluded(const wi::primitive::AABB& aabb) const;
+
+		constexpr uint32_t GetWidth() const { return width; }
+		constexpr uint32_t GetHeight() const { return height; }
+		inline size_t GetTriangleCount() const { return triangles.size(); }
+		inline const float* GetDepth() const { return depth.data(); }
+
+	private:
+		struct Triangle
+		{
+			XMFLOAT3 v0, v1, v2; // screen space pixel coordinates (x, y) and depth (z)
+		};
+		wi::vector<Triangle> triangles;
+		wi::SpinLock locker;
+
+		wi::vector<float> depth;	// per pixel depth, nearest occluder (max value)
+		wi::vector<float> erosion;	// temporary buffer for eroding the depth after rasterization
+		wi::vector<float> tile_depth;	// per tile depth, farthest occluder (min value)
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t tile_count_x = 0;
+		uint32_t tile_count_y = 0;
+		XMFLOAT4X4 viewProjection = wi::math::IDENTITY_MATRIX;
+	};
+}
@@ -7,6 +7,7 @@
 #include "wiEventHandler.h"
 #include "wiTimer.h"
 #include "wiVector.h"
+#include "wiJobSystem.h"
 
 #include <algorithm>
 #include <mutex>
@@ -105,9 +106,56 @@ namespace wi
 		return phillips * expf(-Ksqr * w * w);
 	}
 
+	// In-place radix-2 FFT along the columns of a dim * dim complex array, for 4 adjacent columns at once with SIMD
+	//	The real and imaginary parts are stored in separate row major arrays
+	void FFTColumns4(float* re, float* im, uint32_t dim, uint32_t column, const XMFLOAT2* twiddles, const uint32_t* bitreverse)
+	{
+		static thread_local wi::vector<XMFLOAT4A> scratch;
+		scratch.resize(dim * 2);
+		XMFLOAT4A* vre = scratch.data();
+		XMFLOAT4A* vim = vre + dim;
+		for (uint32_t i = 0; i < dim; ++i)
+		{
+			const uint32_t src = bitreverse[i] * dim + column;
+			XMStoreFloat4A(&vre[i], XMLoadFloat4((const XMFLOAT4*)(re + src)));
+			XMStoreFloat4A(&vim[i], XMLoadFloat4((const XMFLOAT4*)(im + src)));
+		}
+		for (uint32_t half = 1; half < dim; half <<= 1)
+		{
+			const uint32_t twiddle_step = dim / (half * 2);
+			for (uint32_t start = 0; start < dim; start += half * 2)
+			{
+				for (uint32_t k = 0; k < half; ++k)
+				{
+					const XMFLOAT2& twiddle = twiddles[k * twiddle_step];
+					const XMVECTOR wr = XMVectorReplicate(twiddle.x);
+					const XMVECTOR w_im = XMVectorReplicate(twiddle.y);
+					const uint32_t a = start + k;
+					const uint32_t b = a + half;
+					const XMVECTOR re_a = XMLoadFloat4A(&vre[a]);
+					const XMVECTOR im_a = XMLoadFloat4A(&vim[a]);
+					const XMVECTOR re_b = XMLoadFloat4A(&vre[b]);
+					const XMVECTOR im_b = XMLoadFloat4A(&vim[b]);
+					const XMVECTOR tr = XMVectorSubtract(XMVectorMultiply(re_b, wr), XMVectorMultiply(im_b, w_im));
+					const XMVECTOR ti = XMVectorAdd(XMVectorMultiply(re_b, w_im), XMVectorMultiply(im_b, wr));
+					XMStoreFloat4A(&vre[b], XMVectorSubtract(re_a, tr));
+					XMStoreFloat4A(&vim[b], XMVectorSubtract(im_a, ti));
+					XMStoreFloat4A(&vre[a], XMVectorAdd(re_a, tr));
+					XMStoreFloat4A(&vim[a], XMVectorAdd(im_a, ti));
+				}
+			}
+		}
+		for (uint32_t i = 0; i < dim; ++i)
+		{
+			const uint32_t dst = i * dim + column;
+			XMStoreFloat4((XMFLOAT4*)(re + dst), XMLoadFloat4A(&vre[i]));
+			XMStoreFloat4((XMFLOAT4*)(im + dst), XMLoadFloat4A(&vim[i]));
+		}
+	}
 
 
-	void Ocean::Create(const OceanParameters& params)
+
+	void Ocean::Create(const OceanParameters& params, bool gpu)
 	{
 		this->params = params;
 		for (int i = 0; i < arraysize(occlusionQueries); ++i)
@@ -115,14 +163,75 @@ namespace wi
 			occlusionQueries[i] = -1;
 		}
 
-		GraphicsDevice* device = wi::graphics::GetDevice();
-
 		// Height map H(0)
 		int height_map_size = (params.dmap_dim + 4) * (params.dmap_dim + 1);
 		wi::vector<XMFLOAT2> h0_data(height_map_size);
 		wi::vector<float> omega_data(height_map_size);
 		initHeightMap(h0_data.data(), omega_data.data());
 
+		cpu_dim = 0;
+		cpu_simulation_dim_created = params.cpu_simulation_dim;
+		cpu_displacement.clear();
+		if (params.cpu_simulation_dim > 0)
+		{
+			// The CPU simulation uses the central (low frequency) band of the same H(0), so it matches the GPU simulation:
+			uint32_t dim = std::clamp(params.cpu_simulation_dim, 8u, (uint32_t)params.dmap_dim);
+			while ((dim & (dim - 1)) != 0)
+			{
+				dim &= dim - 1; // round down to power of 2
+			}
+			cpu_dim = dim;
+			const uint32_t band_offset = uint32_t(params.dmap_dim / 2) - dim / 2;
+			cpu_h0.resize((dim + 1) * (dim + 1));
+			cpu_omega.resize(dim * dim);
+			for (uint32_t i = 0; i <= dim; ++i)
+			{
+				for (uint32_t j = 0; j <= dim; ++j)
+				{
+					const uint32_t src = (band_offset + i) * (params.dmap_dim + 4) + band_offset + j;
+					cpu_h0[i * (dim + 1) + j] = h0_data[src];
+					if (i < dim && j < dim)
+					{
+						cpu_omega[i * dim + j] = omega_data[src];
+					}
+				}
+			}
+
+			cpu_twiddles.resize(dim / 2);
+			for (uint32_t k = 0; k < dim / 2; ++k)
+			{
+				const float angle = -2 * XM_PI * k / dim;
+				cpu_twiddles[k] = XMFLOAT2(std::cos(angle), std::sin(angle));
+			}
+			uint32_t bits = 0;
+			while ((1u << bits) < dim)
+			{
+				bits++;
+			}
+			cpu_bitreverse.resize(dim);
+			for (uint32_t i = 0; i < dim; ++i)
+			{
+				uint32_t reversed = 0;
+				for (uint32_t b = 0; b < bits; ++b)
+				{
+					reversed |= ((i >> b) & 1) << (bits - 1 - b);
+				}
+				cpu_bitreverse[i] = reversed;
+			}
+
+			for (int i = 0; i < arraysize(cpu_fft); ++i)
+			{
+				cpu_fft[i].resize(dim * dim);
+				cpu_fft_transposed[i].resize(dim * dim);
+			}
+			cpu_displacement.resize(dim * dim);
+			UpdateDisplacementMapCPU();
+		}
+
+		GraphicsDevice* device = wi::graphics::GetDevice();
+		if (!gpu || device == nullptr)
+			return;
+
 		int hmap_dim = params.dmap_dim;
 		int input_full_size = (hmap_dim + 4) * (hmap_dim + 1);
 		// This value should be (hmap_dim / 2 + 1) * hmap_dim, but we use full sized buffer here for simplicity.
@@ -210,9 +319,151 @@ namespace wi
 		device->CreateBuffer(&cb_desc, nullptr, &constantBuffer);
 	}
 
+	void Ocean::UpdateDisplacementMapCPU()
+	{
+		if (cpu_dim == 0)
+			return;
+
+		const uint32_t dim = cpu_dim;
+		float* h_re = cpu_fft[0].data();
+		float* h_im = cpu_fft[1].data();
+		float* dxy_re = cpu_fft[2].data();
+		float* dxy_im = cpu_fft[3].data();
+		wi::jobsystem::context ctx;
+
+		// H(0) -> H(t), D(x, t), D(y, t), the same as oceanSimulatorCS
+		//	Dx and Dy are packed into one complex field as Dx + i * Dy, because both of their space domain results are real
+		wi::jobsystem::Dispatch(ctx, dim, 8, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t y = args.jobIndex;
+			for (uint32_t x = 0; x < dim; ++x)
+			{
+				const uint32_t index = y * dim + x;
+				if (x == 0 || y == 0)
+				{
+					// The Nyquist frequencies have no conjugate pairs, they would make the space domain results complex:
+					h_re[index] = 0;
+					h_im[index] = 0;
+					dxy_re[index] = 0;
+					dxy_im[index] = 0;
+					continue;
+				}
+				const XMFLOAT2 h0_k = cpu_h0[y * (dim + 1) + x];
+				const XMFLOAT2 h0_mk = cpu_h0[(dim - y) * (dim + 1) + (dim - x)];
+				float sin_v, cos_v;
+				XMScalarSinCos(&sin_v, &cos_v, cpu_omega[index] * time * params.time_scale);
+
+				XMFLOAT2 ht;
+				ht.x = (h0_k.x + h0_mk.x) * cos_v - (h0_k.y + h0_mk.y) * sin_v;
+				ht.y = (h0_k.x - h0_mk.x) * sin_v + (h0_k.y - h0_mk.y) * cos_v;
+
+				float kx = x - dim * 0.5f;
+				float ky = y - dim * 0.5f;
+				const float rsqr_k = 1.0f / std::sqrt(kx * kx + ky * ky);
+				kx *= rsqr_k;
+				ky *= rsqr_k;
+				const XMFLOAT2 dt_x = XMFLOAT2(ht.y * kx, -ht.x * kx);
+				const XMFLOAT2 dt_y = XMFLOAT2(ht.y * ky, -ht.x * ky);
+
+				h_re[index] = ht.x;
+				h_im[index] = ht.y;
+				dxy_re[index] = dt_x.x - dt_y.y;
+				dxy_im[index] = dt_x.y + dt_y.x;
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+
+		// 2D FFT: columns, transpose, columns again, the result stays transposed:
+		const uint32_t column_groups = dim / 4;
+		auto fft_columns = [&]() {
+			wi::jobsystem::Dispatch(ctx, column_groups * 2, 4, [&](wi::jobsystem::JobArgs args) {
+				const uint32_t field = args.jobIndex / column_groups;
+				const uint32_t column = (args.jobIndex % column_groups) * 4;
+				FFTColumns4(cpu_fft[field * 2].data(), cpu_fft[field * 2 + 1].data(), dim, column, cpu_twiddles.data(), cpu_bitreverse.data());
+			});
+			wi::jobsystem::Wait(ctx);
+		};
+		fft_columns();
+		wi::jobsystem::Dispatch(ctx, dim, 16, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t y = args.jobIndex;
+			for (int i = 0; i < arraysize(cpu_fft); ++i)
+			{
+				const float* src = cpu_fft[i].data() + y * dim;
+				float* dst = cpu_fft_transposed[i].data() + y;
+				for (uint32_t x = 0; x < dim; ++x)
+				{
+					dst[x * dim] = src[x];
+				}
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+		for (int i = 0; i < arraysize(cpu_fft); ++i)
+		{
+			std::swap(cpu_fft[i], cpu_fft_transposed[i]);
+		}
+		fft_columns();
+
+		// Space domain results -> displacement, the same as oceanUpdateDisplacementMapCS:
+		wi::jobsystem::Dispatch(ctx, dim, 16, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t y = args.jobIndex;
+			for (uint32_t x = 0; x < dim; ++x)
+			{
+				const uint32_t transposed_index = x * dim + y;
+				// cos(pi * (m1 + m2))
+				const float sign_correction = ((x + y) & 1) ? -1.0f : 1.0f;
+				const float dx = cpu_fft[2][transposed_index] * sign_correction * params.choppy_scale;
+				const float dy = cpu_fft[3][transposed_index] * sign_correction * params.choppy_scale;
+				const float dz = cpu_fft[0][transposed_index] * sign_correction;
+				// xzy swizzle, the same as the GPU displacement map is used:
+				cpu_displacement[y * dim + x] = XMFLOAT3(dx, dz, dy);
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+	}
+
+	XMFLOAT3 Ocean::GetDisplacementCPU(float x, float z) const
+	{
+		const float patch_size_rcp = 1.0f / params.patch_length;
+		const float fx = frac(x * patch_size_rcp) * cpu_dim;
+		const float fz = frac(z * patch_size_rcp) * cpu_dim;
+		const uint32_t x0 = uint32_t(fx) & (cpu_dim - 1);
+		const uint32_t z0 = uint32_t(fz) & (cpu_dim - 1);
+		const uint32_t x1 = (x0 + 1) & (cpu_dim - 1);
+		const uint32_t z1 = (z0 + 1) & (cpu_dim - 1);
+		const float tx = fx - std::floor(fx);
+		const float tz = fz - std::floor(fz);
+		const XMFLOAT3 top = wi::math::Lerp(cpu_displacement[z0 * cpu_dim + x0], cpu_displacement[z0 * cpu_dim + x1], tx);
+		const XMFLOAT3 bottom = wi::math::Lerp(cpu_displacement[z1 * cpu_dim + x0], cpu_displacement[z1 * cpu_dim + x1], tx);
+		return wi::math::Lerp(top, bottom, tz);
+	}
+
+	void Ocean::GetDisplacedPositions(const XMFLOAT3* worldPositions, XMFLOAT3* results, size_t count) const
+	{
+		if (!IsCPUSimulationValid())
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				results[i] = GetDisplacedPosition(worldPositions[i]);
+			}
+			return;
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			const XMFLOAT3 displacement = GetDisplacementCPU(worldPositions[i].x, worldPositions[i].z);
+			results[i] = XMFLOAT3(worldPositions[i].x + displacement.x, params.waterHeight + displacement.y, worldPositions[i].z + displacement.z);
+		}
+	}
+
 	XMFLOAT3 Ocean::GetDisplacedPosition(const XMFLOAT3& worldPosition) const
 	{
 		XMFLOAT3 ocean_pos = XMFLOAT3(worldPosition.x, params.waterHeight, worldPosition.z);
+		if (IsCPUSimulationValid())
+		{
+			const XMFLOAT3 displacement = GetDisplacementCPU(worldPosition.x, worldPosition.z);
+			ocean_pos.x += displacement.x;
+			ocean_pos.y += displacement.y;
+			ocean_pos.z += displacement.z;
+			return ocean_pos;
+		}
 		if (displacement_readback_valid[displacement_readback_index])
 		{
 			const Texture& tex = displacementMap_readback[displacement_readback_index];
@@ -295,7 +546,7 @@ namespace wi
 		}
 	}
 
-	OceanCB GetOceanCBAtDim(const Ocean::OceanParameters& params, uint2 dim)
+	OceanCB GetOceanCBAtDim(const Ocean::OceanParameters& params, uint2 dim, float time)
 	{
 		OceanCB cb = {};
 		uint32_t actual_dim = params.dmap_dim;
@@ -312,6 +563,7 @@ namespace wi
 		cb.xOceanDtyAddressOffset = dty_offset;
 
 		cb.xOceanTimeScale = params.time_scale;
+		cb.xOceanTime = time;
 		cb.xOceanChoppyScale = params.choppy_scale;
 		cb.xOceanGridLen = params.dmap_dim / params.patch_length;
 
@@ -337,7 +589,7 @@ namespace wi
 		device->EventBegin("Ocean Simulation", cmd);
 
 		const uint2 dim = uint2(160 * params.surfaceDetail, 90 * params.surfaceDetail);
-		OceanCB cb = GetOceanCBAtDim(params, dim);
+		OceanCB cb = GetOceanCBAtDim(params, dim, time);
 
 		device->Barrier(GPUBarrier::Buffer(&constantBuffer, ResourceState::CONSTANT_BUFFER, ResourceState::COPY_DST), cmd);
 		device->UpdateBuffer(&constantBuffer, &cb, cmd);
@@ -462,7 +714,7 @@ namespace wi
 
 		device->BindPipelineState(&PSO_occlusionTest, cmd);
 
-		OceanCB cb = GetOceanCBAtDim(params, dim);
+		OceanCB cb = GetOceanCBAtDim(params, dim, time);
 		device->BindDynamicConstantBuffer(cb, CB_GETBINDSLOT(OceanCB), cmd);
 
 		device->BindResource(&displacementMap, 0, cmd);
@@ -37,8 +37,18 @@ namespace wi
 			float waterHeight = 0.0f;
 			uint32_t surfaceDetail = 4;
 			float surfaceDisplacementTolerance = 2;
+
+			// Resolution of the optional CPU simulation, 0 = disabled. Must be a power of 2 in the range [8, dmap_dim]
+			//	The CPU simulation evaluates the same spectrum as the GPU, so GetDisplacedPosition() can return the surface of the current frame without GPU readback
+			//	A resolution lower than dmap_dim only evaluates the low frequency band of the spectrum, that is cheaper and still good for buoyancy
+			uint32_t cpu_simulation_dim = 0;
 		};
-		void Create(const OceanParameters& params);
+		// gpu: if false, only the CPU simulation is created (if enabled in params), for example for a headless server
+		void Create(const OceanParameters& params, bool gpu = true);
+
+		// Simulates the displacement map on the CPU at the current time (only if the CPU simulation is enabled)
+		//	The work is multithreaded with the job system, and it is finished when the function returns
+		void UpdateDisplacementMapCPU();
 
 		void UpdateDisplacementMap(wi::graphics::CommandList cmd) const;
 		void RenderForOcclusionTest(const wi::scene::CameraComponent& camera, wi::graphics::CommandList cmd) const;
@@ -52,6 +62,9 @@ namespace wi
 		static void Initialize();
 
 		bool IsValid() const { return displacementMap.IsValid(); }
+		bool IsCPUSimulationValid() const { return !cpu_displacement.empty(); }
+		// The OceanParameters::cpu_simulation_dim that the ocean was created with, if it's different from the current parameter, the ocean must be recreated
+		uint32_t GetCreatedCPUSimulationDim() const { return cpu_simulation_dim_created; }
 
 		// occlusion result history bitfield (32 bit->32 frame history)
 		mutable uint32_t occlusionHistory = ~0u;
@@ -66,9 +79,13 @@ namespace wi
 		}
 
 		// Return the position at world space modified by the ocean displacement map
+		//	If the CPU simulation is enabled, it is used, otherwise the GPU displacement map readback which is delayed by some frames
 		XMFLOAT3 GetDisplacedPosition(const XMFLOAT3& worldPosition) const;
+		// Batched version of GetDisplacedPosition()
+		void GetDisplacedPositions(const XMFLOAT3* worldPositions, XMFLOAT3* results, size_t count) const;
 
 		OceanParameters params;
+		float time = 0; // simulation time in seconds, both the GPU and CPU simulations use it
 
 	protected:
 		wi::graphics::Texture displacementMap;		// (RGBA32F)
@@ -79,6 +96,18 @@ namespace wi
 		mutable uint32_t displacement_readback_index = 0;
 
 		void initHeightMap(XMFLOAT2* out_h0, float* out_omega);
+		XMFLOAT3 GetDisplacementCPU(float x, float z) const;
+
+		// CPU simulation:
+		uint32_t cpu_simulation_dim_created = 0;
+		uint32_t cpu_dim = 0;
+		wi::vector<XMFLOAT2> cpu_h0;			// (cpu_dim + 1) * (cpu_dim + 1), the central band of H(0)
+		wi::vector<float> cpu_omega;			// cpu_dim * cpu_dim
+		wi::vector<XMFLOAT2> cpu_twiddles;		// cpu_dim / 2
+		wi::vector<uint32_t> cpu_bitreverse;	// cpu_dim
+		wi::vector<float> cpu_fft[4];			// real and imaginary parts of H(t) and Dx(t) + i * Dy(t), in frequency and then space domain
+		wi::vector<float> cpu_fft_transposed[4];
+		wi::vector<XMFLOAT3> cpu_displacement;	// cpu_dim * cpu_dim, world space displacement of the surface
 
 
 		// Initial height field H(0) generated by Phillips spectrum & Gauss distribution.
@@ -925,6 +925,121 @@ namespace wi::primitive
 		return true;
 	}
 
+	uint64_t Frustum::CheckBoxesFast(const AABBArray& boxes, size_t offset, uint32_t count, uint32_t layerMask) const
+	{
+		assert(count <= 64);
+		assert(offset + count <= boxes.size());
+		if (count == 0)
+			return 0;
+
+		// The box corner furthest along the plane normal only depends on the plane, so it is selected per plane instead of per box:
+		const float* corner_x[6];
+		const float* corner_y[6];
+		const float* corner_z[6];
+		for (int p = 0; p < 6; ++p)
+		{
+			corner_x[p] = planes[p].x < 0 ? boxes.min_x.data() : boxes.max_x.data();
+			corner_y[p] = planes[p].y < 0 ? boxes.min_y.data() : boxes.max_y.data();
+			corner_z[p] = planes[p].z < 0 ? boxes.min_z.data() : boxes.max_z.data();
+		}
+
+		uint64_t result = 0;
+
+#ifdef _XM_AVX2_INTRINSICS_
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256i zero_int = _mm256_setzero_si256();
+		const __m256i layer = _mm256_set1_epi32((int)layerMask);
+		for (uint32_t i = 0; i < count; i += 8)
+		{
+			const size_t index = offset + i;
+
+			// Invalid boxes and boxes not in the layer are rejected:
+			__m256 rejected = _mm256_cmp_ps(_mm256_loadu_ps(&boxes.min_x[index]), _mm256_loadu_ps(&boxes.max_x[index]), _CMP_GT_OQ);
+			rejected = _mm256_or_ps(rejected, _mm256_cmp_ps(_mm256_loadu_ps(&boxes.min_y[index]), _mm256_loadu_ps(&boxes.max_y[index]), _CMP_GT_OQ));
+			rejected = _mm256_or_ps(rejected, _mm256_cmp_ps(_mm256_loadu_ps(&boxes.min_z[index]), _mm256_loadu_ps(&boxes.max_z[index]), _CMP_GT_OQ));
+			const __m256i layers = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)&boxes.layerMask[index]), layer);
+			rejected = _mm256_or_ps(rejected, _mm256_castsi256_ps(_mm256_cmpeq_epi32(layers, zero_int)));
+
+			for (int p = 0; p < 6; ++p)
+			{
+				__m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[p].x), _mm256_loadu_ps(corner_x[p] + index), _mm256_set1_ps(planes[p].w));
+				distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[p].y), _mm256_loadu_ps(corner_y[p] + index), distance);
+				distance = _mm256_fmadd_ps(_mm256_set1_ps(planes[p].z), _mm256_loadu_ps(corner_z[p] + index), distance);
+				rejected = _mm256_or_ps(rejected, _mm256_cmp_ps(distance, zero, _CMP_LT_OQ));
+			}
+
+			result |= uint64_t(~_mm256_movemask_ps(rejected) & 0xFF) << i;
+		}
+#else
+		// 4-wide fallback with DirectXMath, which maps to SSE or NEON:
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR layer = XMVectorReplicateInt(layerMask);
+		for (uint32_t i = 0; i < count; i += 4)
+		{
+			const size_t index = offset + i;
+
+			XMVECTOR rejected = XMVectorGreater(XMLoadFloat4((const XMFLOAT4*)&boxes.min_x[index]), XMLoadFloat4((const XMFLOAT4*)&boxes.max_x[index]));
+			rejected = XMVectorOrInt(rejected, XMVectorGreater(XMLoadFloat4((const XMFLOAT4*)&boxes.min_y[index]), XMLoadFloat4((const XMFLOAT4*)&boxes.max_y[index])));
+			rejected = XMVectorOrInt(rejected, XMVectorGreater(XMLoadFloat4((const XMFLOAT4*)&boxes.min_z[index]), XMLoadFloat4((const XMFLOAT4*)&boxes.max_z[index])));
+			const XMVECTOR layers = XMVectorAndInt(XMLoadInt4(&boxes.layerMask[index]), layer);
+			rejected = XMVectorOrInt(rejected, XMVectorEqualInt(layers, zero));
+
+			for (int p = 0; p < 6; ++p)
+			{
+				XMVECTOR distance = XMVectorMultiplyAdd(XMVectorReplicate(planes[p].x), XMLoadFloat4((const XMFLOAT4*)(corner_x[p] + index)), XMVectorReplicate(planes[p].w));
+				distance = XMVectorMultiplyAdd(XMVectorReplicate(planes[p].y), XMLoadFloat4((const XMFLOAT4*)(corner_y[p] + index)), distance);
+				distance = XMVectorMultiplyAdd(XMVectorReplicate(planes[p].z), XMLoadFloat4((const XMFLOAT4*)(corner_z[p] + index)), distance);
+				rejected = XMVectorOrInt(rejected, XMVectorLess(distance, zero));
+			}
+
+#ifdef _XM_SSE_INTRINSICS_
+			const uint32_t rejected_bits = (uint32_t)_mm_movemask_ps(rejected);
+#else
+			XMUINT4 rejected_lanes;
+			XMStoreUInt4(&rejected_lanes, rejected);
+			const uint32_t rejected_bits = (rejected_lanes.x & 1) | ((rejected_lanes.y & 1) << 1) | ((rejected_lanes.z & 1) << 2) | ((rejected_lanes.w & 1) << 3);
+#endif // _XM_SSE_INTRINSICS_
+			result |= uint64_t(~rejected_bits & 0xF) << i;
+		}
+#endif // _XM_AVX2_INTRINSICS_
+
+		if (count < 64)
+		{
+			result &= (1ull << count) - 1; // the last iteration could have processed boxes after the requested range
+		}
+		return result;
+	}
+
+	void AABBArray::resize(size_t newCount)
+	{
+		count = newCount;
+		const size_t padded = newCount + padding;
+		min_x.resize(padded);
+		min_y.resize(padded);
+		min_z.resize(padded);
+		max_x.resize(padded);
+		max_y.resize(padded);
+		max_z.resize(padded);
+		layerMask.resize(padded);
+		for (size_t i = newCount; i < padded; ++i)
+		{
+			min_x[i] = min_y[i] = min_z[i] = std::numeric_limits<float>::max();
+			max_x[i] = max_y[i] = max_z[i] = std::numeric_limits<float>::lowest();
+			layerMask[i] = 0;
+		}
+	}
+	void AABBArray::clear()
+	{
+		min_x.clear();
+		min_y.clear();
+		min_z.clear();
+		max_x.clear();
+		max_y.clear();
+		max_z.clear();
+		layerMask.clear();
+		count = 0;
+	}
+
 	const XMFLOAT4& Frustum::getNearPlane() const { return planes[0]; }
 	const XMFLOAT4& Frustum::getFarPlane() const { return planes[1]; }
 	const XMFLOAT4& Frustum::getLeftPlane() const { return planes[2]; }
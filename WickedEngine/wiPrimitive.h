@@ -222,6 +222,32 @@ namespace wi::primitive
 		XMFLOAT4X4 GetPlacementOrientation(const XMFLOAT3& position, const XMFLOAT3& normal) const;
 	};
 
+	// Structure of arrays copy of AABBs for SIMD culling
+	//	The arrays are padded with invalid boxes, so that culling kernels can always process 8 boxes at a time
+	struct AABBArray
+	{
+		static constexpr size_t padding = 8;
+		wi::vector<float> min_x, min_y, min_z;
+		wi::vector<float> max_x, max_y, max_z;
+		wi::vector<uint32_t> layerMask;
+		size_t count = 0;
+
+		void resize(size_t newCount);
+		void clear();
+		inline size_t size() const { return count; }
+		inline void set(size_t index, const AABB& aabb)
+		{
+			assert(index < count);
+			min_x[index] = aabb._min.x;
+			min_y[index] = aabb._min.y;
+			min_z[index] = aabb._min.z;
+			max_x[index] = aabb._max.x;
+			max_y[index] = aabb._max.y;
+			max_z[index] = aabb._max.z;
+			layerMask[index] = aabb.layerMask;
+		}
+	};
+
 	struct Frustum
 	{
 		XMFLOAT4 planes[6];
@@ -239,6 +265,12 @@ namespace wi::primitive
 		};
 		BoxFrustumIntersect CheckBox(const AABB& box) const;
 		bool CheckBoxFast(const AABB& box) const;
+		// Check multiple boxes with SIMD, the result for each box is the same as CheckBoxFast() combined with a layerMask test
+		//	offset		: index of the first box to check
+		//	count		: number of boxes to check, at most 64
+		//	layerMask	: boxes that don't share any layer bits with this are not visible
+		//	returns a bitmask where bit i is set if the box at (offset + i) is visible
+		uint64_t CheckBoxesFast(const AABBArray& boxes, size_t offset, uint32_t count, uint32_t layerMask = ~0u) const;
 
 		const XMFLOAT4& getNearPlane() const;
 		const XMFLOAT4& getFarPlane() const;
@@ -20,6 +20,8 @@
 #include <mutex>
 #include <atomic>
 #include <sstream>
+#include <chrono>
+#include <cstring>
 
 using namespace wi::graphics;
 
@@ -44,6 +46,7 @@ namespace wi::profiler
 	PerformanceAPI_Functions superluminal_functions = {};
 #endif // PERFORMANCEAPI_ENABLED
 
+	struct TimelineThread;
 	struct Range
 	{
 		bool in_use = false;
@@ -51,6 +54,7 @@ namespace wi::profiler
 		float times[20] = {};
 		int avg_counter = 0;
 		float time = 0;
+		std::string info;
 		CommandList cmd;
 
 		wi::Timer cpuTimer;
@@ -58,16 +62,320 @@ namespace wi::profiler
 		int gpuBegin[arraysize(queryResultBuffer)];
 		int gpuEnd[arraysize(queryResultBuffer)];
 
+		// The timeline span of a CPU range is recorded on the thread that began the range:
+		TimelineThread* timeline_thread = nullptr;
+		uint32_t timeline_generation = 0;
+		uint32_t timeline_event = ~0u;
+
 		bool IsCPURange() const { return !cmd.IsValid(); }
 	};
 	wi::unordered_map<size_t, Range> ranges;
 
+	// Timeline: every thread records its own events without locking, the main thread only reads them when the capture is finished
+	struct TimelineEvent
+	{
+		uint64_t timestamp; // nanoseconds
+		uint32_t depth;
+		std::atomic<char> phase; // 'B' = begin, 'E' = end, 0 = begin that was cancelled by another thread
+		char name[51];
+	};
+	static_assert(sizeof(TimelineEvent) == 64);
+	struct TimelineThread
+	{
+		static constexpr uint32_t capacity = 64 * 1024;
+		std::unique_ptr<TimelineEvent[]> events; // allocated at the first capture that this thread takes part in
+		std::atomic<uint32_t> count{ 0 };
+		std::atomic<uint32_t> generation{ 0 };
+		std::atomic<uint32_t> depth{ 0 }; // can be decremented by other threads when they cancel a begin event
+		uint32_t dropped = 0;
+		uint32_t tid = 0;
+		std::string name;
+		bool exited = false; // the thread is freed when a capture no longer needs its events, guarded by timeline_threads_lock
+	};
+	std::mutex timeline_threads_lock; // only for registering threads and reading the results
+	wi::vector<std::unique_ptr<TimelineThread>> timeline_threads;
+	uint32_t timeline_next_tid = 0;
+	std::atomic_bool timeline_recording{ false };
+	std::atomic<uint32_t> timeline_generation{ 0 };
+
+	struct GPUTimelineEvent
+	{
+		std::string name;
+		uint64_t begin; // nanoseconds on CPU timeline
+		uint64_t end; // nanoseconds on CPU timeline
+	};
+	wi::vector<GPUTimelineEvent> timeline_gpu_events;
+
+	std::mutex capture_lock; // for capture requests from any thread
+	std::string capture_request_filename;
+	uint32_t capture_request_frames = 0;
+	std::string capture_filename;
+	bool capture_active = false;
+	uint32_t capture_frames_remaining = 0;
+	uint32_t capture_readback_frames_remaining = 0;
+	uint64_t capture_start = 0;
+	uint64_t capture_gpu_frame_time[arraysize(queryResultBuffer)] = {};
+	bool capture_gpu_frame[arraysize(queryResultBuffer)] = {};
+
+	// Threads can exit after the timeline was destroyed at application exit (for example job system workers), they must not touch it after that:
+	std::atomic_bool timeline_destroyed{ false };
+	struct TimelineDestroyedGuard
+	{
+		~TimelineDestroyedGuard() { timeline_destroyed.store(true); }
+	} timeline_destroyed_guard;
+
+	inline uint64_t timeline_now()
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	// Frees the timeline threads that exited and whose events are not part of the active capture, timeline_threads_lock must be held
+	void FreeExitedTimelineThreads(bool capturing)
+	{
+		const uint32_t generation = timeline_generation.load();
+		for (size_t i = 0; i < timeline_threads.size();)
+		{
+			TimelineThread* thread = timeline_threads[i].get();
+			if (thread->exited && (!capturing || thread->generation.load(std::memory_order_relaxed) != generation))
+			{
+				for (auto& x : ranges)
+				{
+					if (x.second.timeline_thread == thread)
+					{
+						x.second.timeline_thread = nullptr;
+					}
+				}
+				timeline_threads.erase(timeline_threads.begin() + i);
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+	TimelineThread* GetTimelineThread()
+	{
+		// The owner marks the timeline of the thread as exited when the thread exits, so its 4 MB event buffer can be freed:
+		struct TimelineThreadOwner
+		{
+			TimelineThread* thread = nullptr;
+			~TimelineThreadOwner()
+			{
+				if (thread == nullptr || timeline_destroyed.load())
+					return;
+				{
+					std::scoped_lock lck(timeline_threads_lock);
+					thread->exited = true;
+				}
+				// If a capture is active, the thread will be freed after the capture was written:
+				bool capturing = false;
+				{
+					std::scoped_lock lck(capture_lock);
+					capturing = capture_active;
+				}
+				std::scoped_lock lck(lock, timeline_threads_lock); // lock guards the ranges that can refer to the thread
+				FreeExitedTimelineThreads(capturing);
+				thread = nullptr;
+			}
+		};
+		thread_local TimelineThreadOwner owner;
+		TimelineThread*& thread = owner.thread;
+		if (thread == nullptr)
+		{
+			std::scoped_lock lck(timeline_threads_lock);
+			thread = timeline_threads.emplace_back(std::make_unique<TimelineThread>()).get();
+			thread->tid = ++timeline_next_tid;
+		}
+		return thread;
+	}
+	// Returns the index of the recorded event, or ~0u if it was not recorded
+	inline uint32_t TimelineRecord(char phase, const char* name)
+	{
+		TimelineThread* thread = GetTimelineThread();
+		const uint32_t generation = timeline_generation.load(std::memory_order_acquire);
+		if (thread->generation.load(std::memory_order_relaxed) != generation)
+		{
+			// First event of this thread in a new capture:
+			if (thread->events == nullptr)
+			{
+				thread->events = std::make_unique<TimelineEvent[]>(TimelineThread::capacity);
+			}
+			thread->count.store(0, std::memory_order_relaxed);
+			thread->depth.store(0, std::memory_order_relaxed);
+			thread->dropped = 0;
+			thread->generation.store(generation, std::memory_order_release);
+		}
+		if (phase == 'E')
+		{
+			uint32_t depth = thread->depth.load(std::memory_order_relaxed);
+			do
+			{
+				if (depth == 0)
+					return ~0u; // the span was begun before the capture
+			} while (!thread->depth.compare_exchange_weak(depth, depth - 1, std::memory_order_relaxed));
+		}
+		const uint32_t count = thread->count.load(std::memory_order_relaxed);
+		if (count >= TimelineThread::capacity)
+		{
+			thread->dropped++;
+			return ~0u;
+		}
+		TimelineEvent& ev = thread->events[count];
+		ev.timestamp = timeline_now();
+		ev.depth = thread->depth.load(std::memory_order_relaxed);
+		ev.phase.store(phase, std::memory_order_relaxed);
+		if (name != nullptr)
+		{
+			strncpy(ev.name, name, sizeof(ev.name) - 1);
+			ev.name[sizeof(ev.name) - 1] = 0;
+		}
+		else
+		{
+			ev.name[0] = 0;
+		}
+		if (phase == 'B')
+		{
+			thread->depth.fetch_add(1, std::memory_order_relaxed);
+		}
+		thread->count.store(count + 1, std::memory_order_release);
+		return count;
+	}
+	// A range that was begun on one thread and ended on an other thread can't be ended on the timeline of the thread that began it
+	//	without writing into that thread's events, so instead its begin event is removed and the timeline stays balanced on both threads
+	inline void TimelineCancelBegin(TimelineThread* thread, uint32_t generation, uint32_t event)
+	{
+		if (event == ~0u || thread->generation.load(std::memory_order_acquire) != generation)
+			return;
+		if (event >= thread->count.load(std::memory_order_acquire))
+			return;
+		char expected = 'B';
+		if (!thread->events[event].phase.compare_exchange_strong(expected, 0, std::memory_order_relaxed))
+			return;
+		uint32_t depth = thread->depth.load(std::memory_order_relaxed);
+		while (depth > 0 && !thread->depth.compare_exchange_weak(depth, depth - 1, std::memory_order_relaxed));
+	}
+
+	void json_escape(std::string& dst, const char* str)
+	{
+		for (const char* c = str; *c != 0; ++c)
+		{
+			switch (*c)
+			{
+			case '"':
+				dst += "\\\"";
+				break;
+			case '\\':
+				dst += "\\\\";
+				break;
+			default:
+				if ((unsigned char)*c >= 0x20)
+				{
+					dst += *c;
+				}
+				break;
+			}
+		}
+	}
+	void WriteCapture()
+	{
+		std::string json;
+		json.reserve(1024 * 1024);
+		json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		char text[256];
+		size_t event_count = 0;
+		uint32_t dropped = 0;
+
+		snprintf(text, sizeof(text), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+		json += text;
+		snprintf(text, sizeof(text), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"GPU\"}}");
+		json += text;
+
+		const uint32_t generation = timeline_generation.load();
+		{
+			std::scoped_lock lck(timeline_threads_lock);
+			for (auto& thread : timeline_threads)
+			{
+				if (thread->generation.load(std::memory_order_acquire) != generation)
+					continue;
+				const uint32_t count = thread->count.load(std::memory_order_acquire);
+				if (count == 0)
+					continue;
+				dropped += thread->dropped;
+
+				json += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+				json += std::to_string(thread->tid);
+				json += ",\"args\":{\"name\":\"";
+				json_escape(json, thread->name.empty() ? ("Thread " + std::to_string(thread->tid)).c_str() : thread->name.c_str());
+				json += "\"}}";
+				snprintf(text, sizeof(text), ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}", thread->tid, thread->tid);
+				json += text;
+
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					const TimelineEvent& ev = thread->events[i];
+					if (ev.timestamp < capture_start)
+						continue;
+					const double ts = double(ev.timestamp - capture_start) / 1000.0;
+					const char phase = ev.phase.load(std::memory_order_relaxed);
+					if (phase == 0)
+						continue; // cancelled
+					if (phase == 'B')
+					{
+						json += ",\n{\"name\":\"";
+						json_escape(json, ev.name);
+						snprintf(text, sizeof(text), "\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"depth\":%u}}", ts, thread->tid, ev.depth);
+					}
+					else
+					{
+						snprintf(text, sizeof(text), ",\n{\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", ts, thread->tid);
+					}
+					json += text;
+					event_count++;
+				}
+			}
+		}
+
+		json += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":1,\"args\":{\"name\":\"Queue\"}}";
+		for (auto& ev : timeline_gpu_events)
+		{
+			if (ev.begin < capture_start || ev.end < ev.begin)
+				continue;
+			json += ",\n{\"name\":\"";
+			json_escape(json, ev.name.c_str());
+			snprintf(text, sizeof(text), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":2,\"tid\":1}", double(ev.begin - capture_start) / 1000.0, double(ev.end - ev.begin) / 1000.0);
+			json += text;
+			event_count++;
+		}
+		json += "\n]}\n";
+
+		if (wi::helper::FileWrite(capture_filename, (const uint8_t*)json.c_str(), json.length()))
+		{
+			wilog("[wi::profiler] Capture written to %s (%d events)", capture_filename.c_str(), (int)event_count);
+		}
+		else
+		{
+			wilog_error("[wi::profiler] Failed to write capture to %s", capture_filename.c_str());
+		}
+		if (dropped > 0)
+		{
+			wilog_warning("[wi::profiler] Capture dropped %d events because the per thread event buffer was full", (int)dropped);
+		}
+		timeline_gpu_events.clear();
+	}
+
 	void BeginFrame()
 	{
-		if (ENABLED_REQUEST != ENABLED)
+		bool capture_requested = false;
+		{
+			std::scoped_lock lck(capture_lock);
+			capture_requested = capture_request_frames > 0;
+		}
+
+		// The profiler is kept enabled while capturing:
+		const bool enable_request = ENABLED_REQUEST || capture_active || capture_requested;
+		if (enable_request != ENABLED)
 		{
 			ranges.clear();
-			ENABLED = ENABLED_REQUEST;
+			ENABLED = enable_request;
 		}
 
 		if (!ENABLED)
@@ -106,8 +414,6 @@ namespace wi::profiler
 #endif // PERFORMANCEAPI_ENABLED
 		}
 
-		cpu_frame = BeginRangeCPU("CPU Frame");
-
 		GraphicsDevice* device = wi::graphics::GetDevice();
 		CommandList cmd = device->BeginCommandList();
 		queryheap_idx = device->GetBufferIndex();
@@ -116,6 +422,20 @@ namespace wi::profiler
 		// This should be done before we begin reallocating new queries for current buffer index
 		const uint64_t* queryResults = (const uint64_t*)queryResultBuffer[queryheap_idx].mapped_data;
 		double gpu_frequency = (double)device->GetTimestampFrequency() / 1000.0;
+
+		// If the frame of these results was captured, the GPU ranges are mapped to the CPU timeline relative to the GPU Frame range:
+		const bool capture_gpu = capture_gpu_frame[queryheap_idx] && queryResults != nullptr && gpu_frequency > 0;
+		uint64_t capture_gpu_base = 0;
+		if (capture_gpu)
+		{
+			const int frame_begin_idx = ranges[gpu_frame].gpuBegin[queryheap_idx];
+			if (frame_begin_idx >= 0)
+			{
+				capture_gpu_base = queryResults[frame_begin_idx];
+			}
+		}
+		capture_gpu_frame[queryheap_idx] = false;
+
 		for (auto& x : ranges)
 		{
 			auto& range = x.second;
@@ -131,6 +451,15 @@ namespace wi::profiler
 					const uint64_t begin_result = queryResults[begin_idx];
 					const uint64_t end_result = queryResults[end_idx];
 					range.time = (float)abs((double)(end_result - begin_result) / gpu_frequency);
+
+					if (capture_gpu && begin_result >= capture_gpu_base && end_result >= begin_result)
+					{
+						const double to_ns = 1000000.0 / gpu_frequency;
+						GPUTimelineEvent& ev = timeline_gpu_events.emplace_back();
+						ev.name = range.name;
+						ev.begin = capture_gpu_frame_time[queryheap_idx] + uint64_t(double(begin_result - capture_gpu_base) * to_ns);
+						ev.end = capture_gpu_frame_time[queryheap_idx] + uint64_t(double(end_result - capture_gpu_base) * to_ns);
+					}
 				}
 				range.gpuBegin[queryheap_idx] = -1;
 				range.gpuEnd[queryheap_idx] = -1;
@@ -150,6 +479,39 @@ namespace wi::profiler
 			range.in_use = false;
 		}
 
+		if (capture_active && !timeline_recording.load() && capture_readback_frames_remaining > 0)
+		{
+			capture_readback_frames_remaining--;
+			if (capture_readback_frames_remaining == 0)
+			{
+				WriteCapture();
+				{
+					std::scoped_lock lck(capture_lock);
+					capture_active = false;
+				}
+				std::scoped_lock lck(lock, timeline_threads_lock);
+				FreeExitedTimelineThreads(false);
+			}
+		}
+		if (capture_requested && !capture_active)
+		{
+			std::scoped_lock lck(capture_lock);
+			capture_active = true;
+			capture_filename = capture_request_filename;
+			capture_frames_remaining = capture_request_frames;
+			capture_request_frames = 0;
+			capture_start = timeline_now();
+			timeline_gpu_events.clear();
+			timeline_generation.fetch_add(1);
+			timeline_recording.store(true);
+			if (GetTimelineThread()->name.empty())
+			{
+				SetThreadName("Main Thread");
+			}
+		}
+
+		cpu_frame = BeginRangeCPU("CPU Frame");
+
 		device->QueryReset(
 			&queryHeap,
 			0,
@@ -174,6 +536,18 @@ namespace wi::profiler
 
 		EndRange(cpu_frame);
 
+		if (timeline_recording.load())
+		{
+			capture_gpu_frame[queryheap_idx] = true;
+			capture_gpu_frame_time[queryheap_idx] = timeline_now();
+			capture_frames_remaining--;
+			if (capture_frames_remaining == 0)
+			{
+				timeline_recording.store(false);
+				capture_readback_frames_remaining = GraphicsDevice::GetBufferCount();
+			}
+		}
+
 		device->QueryResolve(
 			&queryHeap,
 			0,
@@ -198,6 +572,16 @@ namespace wi::profiler
 		}
 #endif // PERFORMANCEAPI_ENABLED
 
+		TimelineThread* timeline_thread = nullptr;
+		uint32_t timeline_generation = 0;
+		uint32_t timeline_event = ~0u;
+		if (timeline_recording.load(std::memory_order_relaxed))
+		{
+			timeline_thread = GetTimelineThread();
+			timeline_event = TimelineRecord('B', name);
+			timeline_generation = timeline_thread->generation.load(std::memory_order_relaxed);
+		}
+
 		range_id id = wi::helper::string_hash(name);
 
 		lock.lock();
@@ -210,6 +594,9 @@ namespace wi::profiler
 		}
 		ranges[id].in_use = true;
 		ranges[id].name = name;
+		ranges[id].timeline_thread = timeline_event == ~0u ? nullptr : timeline_thread;
+		ranges[id].timeline_generation = timeline_generation;
+		ranges[id].timeline_event = timeline_event;
 		ranges[id].cpuTimer.record();
 
 		lock.unlock();
@@ -243,6 +630,34 @@ namespace wi::profiler
 
 		return id;
 	}
+	void AddRangeCPU(const char* name, float time, const char* info)
+	{
+		if (!ENABLED || !initialized)
+			return;
+
+		range_id id = wi::helper::string_hash(name);
+
+		std::scoped_lock lck(lock);
+
+		size_t differentiator = 0;
+		while (ranges[id].in_use)
+		{
+			wi::helper::hash_combine(id, differentiator++);
+		}
+		Range& range = ranges[id];
+		range.in_use = true;
+		range.name = name;
+		range.time = time;
+		if (info != nullptr)
+		{
+			range.info = info;
+		}
+		else
+		{
+			range.info.clear();
+		}
+	}
+
 	void EndRange(range_id id)
 	{
 		if (!ENABLED || !initialized)
@@ -256,6 +671,18 @@ namespace wi::profiler
 			if (it->second.IsCPURange())
 			{
 				it->second.time = (float)it->second.cpuTimer.elapsed();
+				if (it->second.timeline_thread != nullptr)
+				{
+					if (it->second.timeline_thread == GetTimelineThread())
+					{
+						EndSpan();
+					}
+					else
+					{
+						TimelineCancelBegin(it->second.timeline_thread, it->second.timeline_generation, it->second.timeline_event);
+					}
+					it->second.timeline_thread = nullptr;
+				}
 
 #if PERFORMANCEAPI_ENABLED
 				if (superluminal_handle)
@@ -310,6 +737,7 @@ namespace wi::profiler
 	{
 		uint32_t num_hits = 0;
 		float total_time = 0;
+		std::string info;
 	};
 	wi::unordered_map<std::string, Hits> time_cache_cpu;
 	wi::unordered_map<std::string, Hits> time_cache_gpu;
@@ -343,8 +771,10 @@ namespace wi::profiler
 			{
 				if (x.first == cpu_frame)
 					continue;
-				time_cache_cpu[x.second.name].num_hits++;
-				time_cache_cpu[x.second.name].total_time += x.second.time;
+				Hits& hits = time_cache_cpu[x.second.name];
+				hits.num_hits++;
+				hits.total_time += x.second.time;
+				hits.info = x.second.info;
 			}
 			else
 			{
@@ -365,7 +795,12 @@ namespace wi::profiler
 			}
 			else if(x.second.num_hits == 1)
 			{
-				ss << "\t" << x.first << ": " << std::fixed << x.second.total_time << " ms" << std::endl;
+				ss << "\t" << x.first << ": " << std::fixed << x.second.total_time << " ms";
+				if (!x.second.info.empty())
+				{
+					ss << " (" << x.second.info << ")";
+				}
+				ss << std::endl;
 			}
 			x.second.num_hits = 0;
 			x.second.total_time = 0;
@@ -388,6 +823,13 @@ namespace wi::profiler
 			x.second.total_time = 0;
 		}
 
+		// Resource uploads:
+		const GraphicsDevice::UploadStats upload_stats = wi::graphics::GetDevice()->GetUploadStats();
+		if (upload_stats.uploads > 0)
+		{
+			ss << std::endl << "Uploads: " << upload_stats.uploads << " (" << std::fixed << double(upload_stats.bytes) / (1024.0 * 1024.0) << " MB, " << upload_stats.submits << " submits)" << std::endl;
+		}
+
 		wi::font::Params params = wi::font::Params(x, y + (graph_size.y + graph_padding_y) * 2, wi::font::WIFONTSIZE_DEFAULT - 6, wi::font::WIFALIGN_LEFT, wi::font::WIFALIGN_TOP, text_color);
 
 		// Background:
@@ -663,6 +1105,37 @@ namespace wi::profiler
 		return ENABLED;
 	}
 
+	void BeginCapture(const std::string& filename, uint32_t frame_count)
+	{
+		std::scoped_lock lck(capture_lock);
+		capture_request_filename = filename;
+		capture_request_frames = std::max(1u, frame_count);
+	}
+	bool IsCapturing()
+	{
+		std::scoped_lock lck(capture_lock);
+		return capture_active || capture_request_frames > 0;
+	}
+
+	void BeginSpan(const char* name)
+	{
+		if (!timeline_recording.load(std::memory_order_relaxed))
+			return;
+		TimelineRecord('B', name);
+	}
+	void EndSpan()
+	{
+		if (!timeline_recording.load(std::memory_order_relaxed))
+			return;
+		TimelineRecord('E', nullptr);
+	}
+	void SetThreadName(const char* name)
+	{
+		TimelineThread* thread = GetTimelineThread();
+		std::scoped_lock lck(timeline_threads_lock);
+		thread->name = name;
+	}
+
 	void SetBackgroundColor(wi::Color color)
 	{
 		background_color = color;
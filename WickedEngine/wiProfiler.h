@@ -3,6 +3,8 @@
 #include "wiCanvas.h"
 #include "wiColor.h"
 
+#include <string>
+
 
 // QoL macros, allows writing just ScopedXxxProfiling without needing to declare a variable manually
 #define ScopedCPUProfiling(name) wi::profiler::ScopedRangeCPU WI_PROFILER_CONCAT(_wi_profiler_cpu_range,__LINE__)(name)
@@ -36,6 +38,11 @@ namespace wi::profiler
 	// End a profiling range
 	void EndRange(range_id id);
 
+	// Add a CPU range with a time that was measured outside of the profiler, for example accumulated from many small calls
+	//	time	: milliseconds
+	//	info	: optional text that will be displayed next to the time
+	void AddRangeCPU(const char* name, float time, const char* info = nullptr);
+
 	// helper using RAII to avoid having to manually call BeginRangeCPU/EndRange at beginning/end
 	struct ScopedRangeCPU
 	{
@@ -52,6 +59,24 @@ namespace wi::profiler
 		inline ~ScopedRangeGPU() { EndRange(id); }
 	};
 
+	// Timeline capture: records CPU ranges, job system jobs and GPU ranges with timestamps per thread, for a number of frames
+	//	The result is written to a Chrome trace event JSON file that can be opened with chrome://tracing or https://ui.perfetto.dev
+	//	The capture starts at the next BeginFrame(), and the profiler will be enabled while capturing
+	//	The file is written a few frames after the last captured frame, when its GPU timestamps become available
+	//	GPU ranges are placed on the CPU timeline relative to the end of the CPU frame that recorded them
+	void BeginCapture(const std::string& filename, uint32_t frame_count = 1);
+	// Returns true while a capture is requested or in progress
+	bool IsCapturing();
+
+	// Begin a span on the timeline of the calling thread, these are only recorded while capturing
+	//	Unlike ranges, spans are not aggregated and don't require the profiler to be enabled
+	//	The name is copied, so it doesn't need to remain valid
+	void BeginSpan(const char* name);
+	// End the last span that was begun on the calling thread
+	void EndSpan();
+	// Set the name of the calling thread that will appear in captures
+	void SetThreadName(const char* name);
+
 	// Renders a basic text of the Profiling results to the (x,y) screen coordinate
 	void DrawData(
 		const wi::Canvas& canvas,
@@ -232,6 +232,7 @@ namespace wi
 		bool stencil_scaled = false;
 
 		device->EventBegin("Layers", cmd);
+		wi::image::BeginBatch(cmd); // sprites are batched, other rendering must flush them first
 		for (auto& x : layers)
 		{
 			for (auto& y : x.items)
@@ -246,6 +247,7 @@ namespace wi
 						{
 							// Only need a scaled stencil mask if there are any stenciled sprites, and only once is enough before the first one
 							stencil_scaled = true;
+							wi::image::FlushBatch(cmd);
 							wi::renderer::ScaleStencilMask(vp, rtStencilExtracted, cmd);
 						}
 						y.sprite->Draw(cmd);
@@ -254,12 +256,14 @@ namespace wi
 				case RenderItem2D::TYPE::FONT:
 					if (y.font != nullptr)
 					{
+						wi::image::FlushBatch(cmd);
 						y.font->Draw(cmd);
 					}
 					break;
 				}
 			}
 		}
+		wi::image::EndBatch(cmd);
 		device->EventEnd(cmd);
 
 		GetGUI().Render(*this, cmd);
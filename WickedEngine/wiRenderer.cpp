@@ -117,6 +117,7 @@ bool variableRateShadingClassificationDebug = false;
 float GameSpeed = 1;
 bool debugLightCulling = false;
 bool occlusionCulling = true;
+bool cpuOcclusionCulling = false;
 bool temporalAA = false;
 bool temporalAADEBUG = false;
 uint32_t raytraceBounceCount = 8;
@@ -2063,6 +2064,8 @@ void LoadShaders()
 }
 bool IsPipelineCreationActive()
 {
+	if (device->IsPipelineCompilationActive())
+		return true;
 	if (wi::jobsystem::IsBusy(raytracing_ctx))
 		return true;
 	if (wi::jobsystem::IsBusy(objectps_ctx))
@@ -3353,8 +3356,10 @@ void UpdateVisibility(Visibility& vis)
 	//	more coherent (less randomly organized compared to original order)
 	static constexpr uint32_t groupSize = 63;
 	static_assert(groupSize <= 256); // groupIndex must fit into uint8_t stream compaction element
+	static_assert(groupSize <= 64); // group visibility is computed into a single uint64_t mask
 	struct StreamCompaction
 	{
+		uint64_t visibility; // frustum culling result of the whole group, computed by the first thread with SIMD
 		uint8_t list[groupSize];
 		uint8_t count;
 	};
@@ -3368,6 +3373,9 @@ void UpdateVisibility(Visibility& vis)
 		vis.frustum = vis.camera->frustum;
 	}
 
+	// CPU occlusion culling is independent of GPU occlusion culling, but it is also allowed by the ALLOW_OCCLUSION_CULLING flag:
+	const bool cpu_occlusion = GetCPUOcclusionCullingEnabled() && (vis.flags & Visibility::ALLOW_OCCLUSION_CULLING) && (vis.flags & Visibility::ALLOW_OBJECTS) && !GetFreezeCullingCameraEnabled();
+
 	if (!GetOcclusionCullingEnabled() || GetFreezeCullingCameraEnabled())
 	{
 		vis.flags &= ~Visibility::ALLOW_OCCLUSION_CULLING;
@@ -3376,7 +3384,7 @@ void UpdateVisibility(Visibility& vis)
 	if (vis.flags & Visibility::ALLOW_LIGHTS)
 	{
 		// Cull lights:
-		const uint32_t light_loop = (uint32_t)std::min(vis.scene->aabb_lights.size(), vis.scene->lights.GetCount());
+		const uint32_t light_loop = (uint32_t)std::min(std::min(vis.scene->aabb_lights.size(), vis.scene->aabb_lights_soa.size()), vis.scene->lights.GetCount());
 		vis.visibleLights.resize(light_loop);
 		vis.visibleLightShadowRects.clear();
 		vis.visibleLightShadowRects.resize(light_loop);
@@ -3387,11 +3395,13 @@ void UpdateVisibility(Visibility& vis)
 			if (args.isFirstJobInGroup)
 			{
 				stream_compaction.count = 0; // first thread initializes local counter
+				const uint32_t groupOffset = args.groupID * groupSize;
+				stream_compaction.visibility = vis.frustum.CheckBoxesFast(vis.scene->aabb_lights_soa, groupOffset, std::min(groupSize, light_loop - groupOffset), vis.layerMask);
 			}
 
 			const AABB& aabb = vis.scene->aabb_lights[args.jobIndex];
 
-			if ((aabb.layerMask & vis.layerMask) && vis.frustum.CheckBoxFast(aabb))
+			if (stream_compaction.visibility & (1ull << args.groupIndex))
 			{
 				const LightComponent& light = vis.scene->lights[args.jobIndex];
 				if (!light.IsInactive())
@@ -3433,8 +3443,51 @@ void UpdateVisibility(Visibility& vis)
 	if (vis.flags & Visibility::ALLOW_OBJECTS)
 	{
 		// Cull objects:
-		const uint32_t object_loop = (uint32_t)std::min(vis.scene->aabb_objects.size(), vis.scene->objects.GetCount());
+		const uint32_t object_loop = (uint32_t)std::min(std::min(vis.scene->aabb_objects.size(), vis.scene->aabb_objects_soa.size()), vis.scene->objects.GetCount());
 		vis.visibleObjects.resize(object_loop);
+
+		if (cpu_occlusion)
+		{
+			// Rasterize occluders that are inside the frustum, this is finished before the object culling starts:
+			auto range_occluders = wi::profiler::BeginRangeCPU("CPU Occlusion Culling - Rasterize");
+			const uint32_t occlusion_width = 256;
+			const uint32_t occlusion_height = vis.camera->width > 0 ? uint32_t(occlusion_width * vis.camera->height / vis.camera->width) : occlusion_width;
+			vis.occlusion_buffer.Clear(occlusion_width, occlusion_height, vis.camera->GetViewProjection());
+
+			wi::jobsystem::context occluder_ctx;
+			wi::jobsystem::Dispatch(occluder_ctx, (object_loop + 63) / 64, 1, [&](wi::jobsystem::JobArgs args) {
+				const uint32_t block = args.jobIndex * 64;
+				uint64_t visibility = vis.frustum.CheckBoxesFast(vis.scene->aabb_objects_soa, block, std::min(64u, object_loop - block), vis.layerMask);
+				while (visibility != 0)
+				{
+					const uint32_t objectIndex = block + (uint32_t)firstbitlow(visibility);
+					visibility &= visibility - 1;
+
+					const ObjectComponent& object = vis.scene->objects[objectIndex];
+					if (object.mesh_index >= vis.scene->meshes.GetCount())
+						continue;
+					const MeshComponent& mesh = vis.scene->meshes[object.mesh_index];
+					if (!mesh.IsOccluder() || mesh.IsSkinned() || !mesh.morph_targets.empty() || mesh.vertex_positions.empty())
+						continue;
+
+					const XMMATRIX W = XMLoadFloat4x4(&vis.scene->matrix_objects[objectIndex]);
+					uint32_t first_subset = 0;
+					uint32_t last_subset = 0;
+					mesh.GetLODSubsetRange(mesh.GetLODCount() - 1, first_subset, last_subset);
+					for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
+					{
+						const MeshComponent::MeshSubset& subset = mesh.subsets[subsetIndex];
+						if (subset.indexCount == 0 || size_t(subset.indexOffset) + size_t(subset.indexCount) > mesh.indices.size())
+							continue;
+						vis.occlusion_buffer.AddOccluder(mesh.vertex_positions.data(), mesh.indices.data() + subset.indexOffset, subset.indexCount, W, !mesh.IsDoubleSided());
+					}
+				}
+			});
+			wi::jobsystem::Wait(occluder_ctx);
+			vis.occlusion_buffer.Rasterize();
+			wi::profiler::EndRange(range_occluders);
+		}
+
 		wi::jobsystem::Dispatch(ctx, object_loop, groupSize, [&](wi::jobsystem::JobArgs args) {
 
 			// Setup stream compaction:
@@ -3442,11 +3495,13 @@ void UpdateVisibility(Visibility& vis)
 			if (args.isFirstJobInGroup)
 			{
 				stream_compaction.count = 0; // first thread initializes local counter
+				const uint32_t groupOffset = args.groupID * groupSize;
+				stream_compaction.visibility = vis.frustum.CheckBoxesFast(vis.scene->aabb_objects_soa, groupOffset, std::min(groupSize, object_loop - groupOffset), vis.layerMask);
 			}
 
 			const AABB& aabb = vis.scene->aabb_objects[args.jobIndex];
 
-			if ((aabb.layerMask & vis.layerMask) && vis.frustum.CheckBoxFast(aabb))
+			if ((stream_compaction.visibility & (1ull << args.groupIndex)) && !(cpu_occlusion && vis.occlusion_buffer.IsOccluded(aabb)))
 			{
 				// Local stream compaction:
 				stream_compaction.list[stream_compaction.count++] = args.groupIndex;
@@ -3519,13 +3574,15 @@ void UpdateVisibility(Visibility& vis)
 	{
 		// Note: decals must be appended in order for correct blending, must not use parallelization!
 		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
-			for (size_t i = 0; i < vis.scene->aabb_decals.size(); ++i)
+			const size_t decal_count = std::min(vis.scene->aabb_decals.size(), vis.scene->aabb_decals_soa.size());
+			for (size_t block = 0; block < decal_count; block += 64)
 			{
-				const AABB& aabb = vis.scene->aabb_decals[i];
-
-				if ((aabb.layerMask & vis.layerMask) && vis.frustum.CheckBoxFast(aabb))
+				uint64_t visibility = vis.frustum.CheckBoxesFast(vis.scene->aabb_decals_soa, block, (uint32_t)std::min(size_t(64), decal_count - block), vis.layerMask);
+				while (visibility != 0)
 				{
-					vis.visibleDecals.push_back(uint32_t(i));
+					const uint32_t bit = (uint32_t)firstbitlow(visibility);
+					visibility &= visibility - 1;
+					vis.visibleDecals.push_back(uint32_t(block + bit));
 				}
 			}
 		});
@@ -3535,13 +3592,15 @@ void UpdateVisibility(Visibility& vis)
 	{
 		// Note: probes must be appended in order for correct blending, must not use parallelization!
 		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
-			for (size_t i = 0; i < vis.scene->aabb_probes.size(); ++i)
+			const size_t probe_count = std::min(vis.scene->aabb_probes.size(), vis.scene->aabb_probes_soa.size());
+			for (size_t block = 0; block < probe_count; block += 64)
 			{
-				const AABB& aabb = vis.scene->aabb_probes[i];
-
-				if ((aabb.layerMask & vis.layerMask) && vis.frustum.CheckBoxFast(aabb))
+				uint64_t visibility = vis.frustum.CheckBoxesFast(vis.scene->aabb_probes_soa, block, (uint32_t)std::min(size_t(64), probe_count - block), vis.layerMask);
+				while (visibility != 0)
 				{
-					vis.visibleEnvProbes.push_back((uint32_t)i);
+					const uint32_t bit = (uint32_t)firstbitlow(visibility);
+					visibility &= visibility - 1;
+					vis.visibleEnvProbes.push_back(uint32_t(block + bit));
 				}
 			}
 			});
@@ -6276,19 +6335,33 @@ void DrawShadowmaps(
 				if (light.cascade_distances.empty())
 					break;
 
-				const uint32_t cascade_count = std::min((uint32_t)light.cascade_distances.size(), max_viewport_count);
-				Viewport* viewports = (Viewport*)alloca(sizeof(Viewport) * cascade_count);
-				Rect* scissors = (Rect*)alloca(sizeof(Rect) * cascade_count);
-				SHCAM* shcams = (SHCAM*)alloca(sizeof(SHCAM) * cascade_count);
+				// The cascade count is bounded by the 8-bit camera_mask of render batches, so fixed size stack arrays are used:
+				Viewport viewports[8];
+				Rect scissors[8];
+				SHCAM shcams[8];
+				uint64_t cascade_visibility[8];
+				const uint32_t cascade_count = std::min(std::min((uint32_t)light.cascade_distances.size(), max_viewport_count), (uint32_t)arraysize(shcams));
 				CreateDirLightShadowCams(light, *vis.camera, shcams, cascade_count, shadow_rect);
 
 				renderQueue.init();
 				bool transparentShadowsRequested = false;
-				for (size_t i = 0; i < vis.scene->aabb_objects.size(); ++i)
+				const size_t object_count = std::min(vis.scene->aabb_objects.size(), vis.scene->aabb_objects_soa.size());
+				for (size_t block = 0; block < object_count; block += 64)
 				{
-					const AABB& aabb = vis.scene->aabb_objects[i];
-					if (aabb.layerMask & vis.layerMask)
+					// Cull a block of objects against all cascades with SIMD:
+					const uint32_t block_count = (uint32_t)std::min(size_t(64), object_count - block);
+					uint64_t visibility = 0;
+					for (uint32_t cascade = 0; cascade < cascade_count; ++cascade)
 					{
+						cascade_visibility[cascade] = shcams[cascade].frustum.CheckBoxesFast(vis.scene->aabb_objects_soa, block, block_count, vis.layerMask);
+						visibility |= cascade_visibility[cascade];
+					}
+					while (visibility != 0)
+					{
+						const uint32_t bit = (uint32_t)firstbitlow(visibility);
+						visibility &= visibility - 1;
+						const size_t i = block + bit;
+						const AABB& aabb = vis.scene->aabb_objects[i];
 						const ObjectComponent& object = vis.scene->objects[i];
 						if (object.IsRenderable() && object.IsCastingShadow())
 						{
@@ -6301,7 +6374,7 @@ void DrawShadowmaps(
 							uint8_t shadow_lod = 0xFF;
 							for (uint32_t cascade = 0; cascade < cascade_count; ++cascade)
 							{
-								if ((cascade < (cascade_count - object.cascadeMask)) && shcams[cascade].frustum.CheckBoxFast(aabb))
+								if ((cascade < (cascade_count - object.cascadeMask)) && ((cascade_visibility[cascade] >> bit) & 1))
 								{
 									camera_mask |= 1 << cascade;
 									if (IsShadowLODOverrideEnabled())
@@ -6412,11 +6485,15 @@ void DrawShadowmaps(
 
 				renderQueue.init();
 				bool transparentShadowsRequested = false;
-				for (size_t i = 0; i < vis.scene->aabb_objects.size(); ++i)
+				const size_t object_count = std::min(vis.scene->aabb_objects.size(), vis.scene->aabb_objects_soa.size());
+				for (size_t block = 0; block < object_count; block += 64)
 				{
-					const AABB& aabb = vis.scene->aabb_objects[i];
-					if ((aabb.layerMask & vis.layerMask) && shcam.frustum.CheckBoxFast(aabb))
+					uint64_t visibility = shcam.frustum.CheckBoxesFast(vis.scene->aabb_objects_soa, block, (uint32_t)std::min(size_t(64), object_count - block), vis.layerMask);
+					while (visibility != 0)
 					{
+						const size_t i = block + firstbitlow(visibility);
+						visibility &= visibility - 1;
+						const AABB& aabb = vis.scene->aabb_objects[i];
 						const ObjectComponent& object = vis.scene->objects[i];
 						if (object.IsRenderable() && object.IsCastingShadow())
 						{
@@ -6571,11 +6648,26 @@ void DrawShadowmaps(
 
 				renderQueue.init();
 				bool transparentShadowsRequested = false;
-				for (size_t i = 0; i < vis.scene->aabb_objects.size(); ++i)
+				const size_t object_count = std::min(vis.scene->aabb_objects.size(), vis.scene->aabb_objects_soa.size());
+				uint64_t frustum_visibility[arraysize(frusta)] = {};
+				for (size_t block = 0; block < object_count; block += 64)
 				{
-					const AABB& aabb = vis.scene->aabb_objects[i];
-					if ((aabb.layerMask & vis.layerMask) && boundingsphere.intersects(aabb))
+					// Cull a block of objects against all visible cubemap faces with SIMD:
+					const uint32_t block_count = (uint32_t)std::min(size_t(64), object_count - block);
+					uint64_t visibility = 0;
+					for (uint32_t camera_index = 0; camera_index < camera_count; ++camera_index)
+					{
+						frustum_visibility[camera_index] = frusta[camera_index].CheckBoxesFast(vis.scene->aabb_objects_soa, block, block_count, vis.layerMask);
+						visibility |= frustum_visibility[camera_index];
+					}
+					while (visibility != 0)
 					{
+						const uint32_t bit = (uint32_t)firstbitlow(visibility);
+						visibility &= visibility - 1;
+						const size_t i = block + bit;
+						const AABB& aabb = vis.scene->aabb_objects[i];
+						if (!boundingsphere.intersects(aabb))
+							continue;
 						const ObjectComponent& object = vis.scene->objects[i];
 						if (object.IsRenderable() && object.IsCastingShadow())
 						{
@@ -6588,7 +6680,7 @@ void DrawShadowmaps(
 							uint8_t shadow_lod = 0xFF;
 							for (uint32_t camera_index = 0; camera_index < camera_count; ++camera_index)
 							{
-								if (frusta[camera_index].CheckBoxFast(aabb))
+								if ((frustum_visibility[camera_index] >> bit) & 1)
 								{
 									camera_mask |= 1 << camera_index;
 									if (IsShadowLODOverrideEnabled())
@@ -6689,22 +6781,18 @@ void DrawShadowmaps(
 			CreateDirLightShadowCams(vis.scene->rain_blocker_dummy_light, *vis.camera, &shcam, 1, vis.rain_blocker_shadow_rect);
 
 			renderQueue.init();
-			for (size_t i = 0; i < vis.scene->aabb_objects.size(); ++i)
+			const size_t object_count = std::min(vis.scene->aabb_objects.size(), vis.scene->aabb_objects_soa.size());
+			for (size_t block = 0; block < object_count; block += 64)
 			{
-				const AABB& aabb = vis.scene->aabb_objects[i];
-				if (aabb.layerMask & vis.layerMask)
+				uint64_t visibility = shcam.frustum.CheckBoxesFast(vis.scene->aabb_objects_soa, block, (uint32_t)std::min(size_t(64), object_count - block), vis.layerMask);
+				while (visibility != 0)
 				{
+					const size_t i = block + firstbitlow(visibility);
+					visibility &= visibility - 1;
 					const ObjectComponent& object = vis.scene->objects[i];
 					if (object.IsRenderable())
 					{
-						uint8_t camera_mask = 0;
-						if (shcam.frustum.CheckBoxFast(aabb))
-						{
-							camera_mask |= 1 << 0;
-						}
-						if (camera_mask == 0)
-							continue;
-
+						const uint8_t camera_mask = 1 << 0;
 						renderQueue.add(object.mesh_index, uint32_t(i), 0, object.sort_bits, camera_mask);
 					}
 				}
@@ -8794,24 +8882,38 @@ void RefreshEnvProbes(const Visibility& vis, CommandList cmd)
 
 			static thread_local RenderQueue renderQueue;
 			renderQueue.init();
-			for (size_t i = 0; i < vis.scene->aabb_objects.size(); ++i)
-			{
-				const AABB& aabb = vis.scene->aabb_objects[i];
-				if ((aabb.layerMask & vis.layerMask) && (aabb.layerMask & probe_aabb.layerMask) && culler.intersects(aabb))
+			const size_t object_count = std::min(vis.scene->aabb_objects.size(), vis.scene->aabb_objects_soa.size());
+			const uint32_t layerMask = vis.layerMask & probe_aabb.layerMask;
+			for (size_t block = 0; block < object_count; block += 64)
+			{
+				// Cull a block of objects against all cubemap faces with SIMD:
+				const uint32_t block_count = (uint32_t)std::min(size_t(64), object_count - block);
+				uint64_t face_visibility[arraysize(cameras)];
+				uint64_t visibility = 0;
+				for (uint32_t camera_index = 0; camera_index < arraysize(cameras); ++camera_index)
 				{
+					face_visibility[camera_index] = cameras[camera_index].frustum.CheckBoxesFast(vis.scene->aabb_objects_soa, block, block_count, layerMask);
+					visibility |= face_visibility[camera_index];
+				}
+				while (visibility != 0)
+				{
+					const uint32_t bit = (uint32_t)firstbitlow(visibility);
+					visibility &= visibility - 1;
+					const size_t i = block + bit;
+					const AABB& aabb = vis.scene->aabb_objects[i];
+					if ((aabb.layerMask & vis.layerMask) == 0 || (aabb.layerMask & probe_aabb.layerMask) == 0 || !culler.intersects(aabb))
+						continue;
 					const ObjectComponent& object = vis.scene->objects[i];
 					if (object.IsRenderable() && !object.IsNotVisibleInReflections())
 					{
 						uint8_t camera_mask = 0;
 						for (uint32_t camera_index = 0; camera_index < arraysize(cameras); ++camera_index)
 						{
-							if (cameras[camera_index].frustum.CheckBoxFast(aabb))
+							if ((face_visibility[camera_index] >> bit) & 1)
 							{
 								camera_mask |= 1 << camera_index;
 							}
 						}
-						if (camera_mask == 0)
-							continue;
 
 						renderQueue.add(object.mesh_index, uint32_t(i), 0, object.sort_bits, camera_mask);
 					}
@@ -18356,6 +18458,8 @@ void SetOcclusionCullingEnabled(bool value)
 	occlusionCulling = value;
 }
 bool GetOcclusionCullingEnabled() { return occlusionCulling; }
+void SetCPUOcclusionCullingEnabled(bool value) { cpuOcclusionCulling = value; }
+bool GetCPUOcclusionCullingEnabled() { return cpuOcclusionCulling; }
 void SetTemporalAAEnabled(bool enabled) { temporalAA = enabled; }
 bool GetTemporalAAEnabled() { return temporalAA; }
 void SetTemporalAADebugEnabled(bool enabled) { temporalAADEBUG = enabled; }
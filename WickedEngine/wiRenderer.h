@@ -12,6 +12,7 @@
 #include "shaders/ShaderInterop_SurfelGI.h"
 #include "wiVector.h"
 #include "wiSpinLock.h"
+#include "wiOcclusionBuffer.h"
 
 #include <memory>
 #include <limits>
@@ -139,6 +140,7 @@ namespace wi::renderer
 		wi::rectpacker::State shadow_packer;
 		wi::rectpacker::Rect rain_blocker_shadow_rect;
 		wi::vector<wi::rectpacker::Rect> visibleLightShadowRects;
+		wi::OcclusionBuffer occlusion_buffer; // CPU occlusion culling depth buffer, if GetCPUOcclusionCullingEnabled()
 
 		std::atomic<uint32_t> object_counter;
 		std::atomic<uint32_t> light_counter;
@@ -1101,6 +1103,10 @@ namespace wi::renderer
 	bool GetVariableRateShadingClassificationDebug();
 	void SetOcclusionCullingEnabled(bool enabled);
 	bool GetOcclusionCullingEnabled();
+	// CPU occlusion culling: meshes marked with MeshComponent::SetOccluder() are rasterized on the CPU into a small depth buffer,
+	//	and objects that are hidden behind them are removed in UpdateVisibility() in the same frame. Disabled by default.
+	void SetCPUOcclusionCullingEnabled(bool enabled);
+	bool GetCPUOcclusionCullingEnabled();
 	void SetTemporalAAEnabled(bool enabled);
 	bool GetTemporalAAEnabled();
 	void SetTemporalAADebugEnabled(bool enabled);
@@ -30,6 +30,9 @@ namespace wi
 		StreamingSubresourceData streaming_data[16] = {};
 		uint32_t mip_count = 0; // mip count of full resource
 		float min_lod_clamp_absolute = 0; // relative to mip_count of full resource
+		std::string cache_filename; // if not empty, mip levels are streamed from texture cache file instead of the container file
+		size_t cache_fileoffset = 0;
+		std::shared_ptr<void> cache_file_reference; // keeps the cache file from being evicted while it is streamed from
 	};
 	//static constexpr size_t streaming_texture_min_size = 4096; // 4KB is the minimum texture memory alignment
 	static constexpr size_t streaming_texture_min_size = 64 * 1024; // 64KB is the usual texture memory alignment, this allows higher base tex size than 4KB
@@ -298,6 +301,575 @@ namespace wi
 			return ret;
 		}
 
+		// Creates texture from DDS file data
+		//	swizzle : if not nullptr, it overrides the swizzle of the texture
+		static bool LoadTextureDDS(
+			const std::string& name,
+			Flags& flags,
+			const uint8_t* filedata,
+			size_t filesize,
+			ResourceInternal* resource,
+			const Swizzle* swizzle = nullptr
+		)
+		{
+			GraphicsDevice* device = wi::graphics::GetDevice();
+			bool success = false;
+
+			dds::Header header = dds::read_header(filedata, filesize);
+			if (header.is_valid())
+			{
+				TextureDesc desc;
+				desc.array_size = 1;
+				desc.bind_flags = BindFlag::SHADER_RESOURCE;
+				desc.width = header.width();
+				desc.height = header.height();
+				desc.depth = header.depth();
+				desc.mip_levels = header.mip_levels();
+				desc.array_size = header.array_size();
+				desc.format = Format::R8G8B8A8_UNORM;
+				desc.layout = ResourceState::SHADER_RESOURCE;
+				desc.misc_flags = ResourceMiscFlag::TYPED_FORMAT_CASTING;
+
+				if (header.is_cubemap())
+				{
+					desc.misc_flags |= ResourceMiscFlag::TEXTURECUBE;
+				}
+				if (desc.mip_levels == 1 || desc.depth > 1 || desc.array_size > 1)
+				{
+					// don't allow streaming for single mip, array and 3D textures
+					flags &= ~Flags::STREAMING;
+				}
+
+				auto ddsFormat = header.format();
+
+				switch (ddsFormat)
+				{
+				case dds::DXGI_FORMAT_R32G32B32A32_FLOAT: desc.format = Format::R32G32B32A32_FLOAT; break;
+				case dds::DXGI_FORMAT_R32G32B32A32_UINT: desc.format = Format::R32G32B32A32_UINT; break;
+				case dds::DXGI_FORMAT_R32G32B32A32_SINT: desc.format = Format::R32G32B32A32_SINT; break;
+				case dds::DXGI_FORMAT_R32G32B32_FLOAT: desc.format = Format::R32G32B32_FLOAT; break;
+				case dds::DXGI_FORMAT_R32G32B32_UINT: desc.format = Format::R32G32B32_UINT; break;
+				case dds::DXGI_FORMAT_R32G32B32_SINT: desc.format = Format::R32G32B32_SINT; break;
+				case dds::DXGI_FORMAT_R16G16B16A16_FLOAT: desc.format = Format::R16G16B16A16_FLOAT; break;
+				case dds::DXGI_FORMAT_R16G16B16A16_UNORM: desc.format = Format::R16G16B16A16_UNORM; break;
+				case dds::DXGI_FORMAT_R16G16B16A16_UINT: desc.format = Format::R16G16B16A16_UINT; break;
+				case dds::DXGI_FORMAT_R16G16B16A16_SNORM: desc.format = Format::R16G16B16A16_SNORM; break;
+				case dds::DXGI_FORMAT_R16G16B16A16_SINT: desc.format = Format::R16G16B16A16_SINT; break;
+				case dds::DXGI_FORMAT_R32G32_FLOAT: desc.format = Format::R32G32_FLOAT; break;
+				case dds::DXGI_FORMAT_R32G32_UINT: desc.format = Format::R32G32_UINT; break;
+				case dds::DXGI_FORMAT_R32G32_SINT: desc.format = Format::R32G32_SINT; break;
+				case dds::DXGI_FORMAT_R10G10B10A2_UNORM: desc.format = Format::R10G10B10A2_UNORM; break;
+				case dds::DXGI_FORMAT_R10G10B10A2_UINT: desc.format = Format::R10G10B10A2_UINT; break;
+				case dds::DXGI_FORMAT_R11G11B10_FLOAT: desc.format = Format::R11G11B10_FLOAT; break;
+				case dds::DXGI_FORMAT_R9G9B9E5_SHAREDEXP: desc.format = Format::R9G9B9E5_SHAREDEXP; break;
+				case dds::DXGI_FORMAT_B8G8R8X8_UNORM: desc.format = Format::B8G8R8A8_UNORM; break;
+				case dds::DXGI_FORMAT_B8G8R8A8_UNORM: desc.format = Format::B8G8R8A8_UNORM; break;
+				case dds::DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: desc.format = Format::B8G8R8A8_UNORM_SRGB; break;
+				case dds::DXGI_FORMAT_R8G8B8A8_UNORM: desc.format = Format::R8G8B8A8_UNORM; break;
+				case dds::DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: desc.format = Format::R8G8B8A8_UNORM_SRGB; break;
+				case dds::DXGI_FORMAT_R8G8B8A8_UINT: desc.format = Format::R8G8B8A8_UINT; break;
+				case dds::DXGI_FORMAT_R8G8B8A8_SNORM: desc.format = Format::R8G8B8A8_SNORM; break;
+				case dds::DXGI_FORMAT_R8G8B8A8_SINT: desc.format = Format::R8G8B8A8_SINT; break;
+				case dds::DXGI_FORMAT_R16G16_FLOAT: desc.format = Format::R16G16_FLOAT; break;
+				case dds::DXGI_FORMAT_R16G16_UNORM: desc.format = Format::R16G16_UNORM; break;
+				case dds::DXGI_FORMAT_R16G16_UINT: desc.format = Format::R16G16_UINT; break;
+				case dds::DXGI_FORMAT_R16G16_SNORM: desc.format = Format::R16G16_SNORM; break;
+				case dds::DXGI_FORMAT_R16G16_SINT: desc.format = Format::R16G16_SINT; break;
+				case dds::DXGI_FORMAT_D32_FLOAT: desc.format = Format::D32_FLOAT; break;
+				case dds::DXGI_FORMAT_R32_FLOAT: desc.format = Format::R32_FLOAT; break;
+				case dds::DXGI_FORMAT_R32_UINT: desc.format = Format::R32_UINT; break;
+				case dds::DXGI_FORMAT_R32_SINT: desc.format = Format::R32_SINT; break;
+				case dds::DXGI_FORMAT_R8G8_UNORM: desc.format = Format::R8G8_UNORM; break;
+				case dds::DXGI_FORMAT_R8G8_UINT: desc.format = Format::R8G8_UINT; break;
+				case dds::DXGI_FORMAT_R8G8_SNORM: desc.format = Format::R8G8_SNORM; break;
+				case dds::DXGI_FORMAT_R8G8_SINT: desc.format = Format::R8G8_SINT; break;
+				case dds::DXGI_FORMAT_R16_FLOAT: desc.format = Format::R16_FLOAT; break;
+				case dds::DXGI_FORMAT_D16_UNORM: desc.format = Format::D16_UNORM; break;
+				case dds::DXGI_FORMAT_R16_UNORM: desc.format = Format::R16_UNORM; break;
+				case dds::DXGI_FORMAT_R16_UINT: desc.format = Format::R16_UINT; break;
+				case dds::DXGI_FORMAT_R16_SNORM: desc.format = Format::R16_SNORM; break;
+				case dds::DXGI_FORMAT_R16_SINT: desc.format = Format::R16_SINT; break;
+				case dds::DXGI_FORMAT_R8_UNORM: desc.format = Format::R8_UNORM; break;
+				case dds::DXGI_FORMAT_R8_UINT: desc.format = Format::R8_UINT; break;
+				case dds::DXGI_FORMAT_R8_SNORM: desc.format = Format::R8_SNORM; break;
+				case dds::DXGI_FORMAT_R8_SINT: desc.format = Format::R8_SINT; break;
+				case dds::DXGI_FORMAT_BC1_UNORM: desc.format = Format::BC1_UNORM; break;
+				case dds::DXGI_FORMAT_BC1_UNORM_SRGB: desc.format = Format::BC1_UNORM_SRGB; break;
+				case dds::DXGI_FORMAT_BC2_UNORM: desc.format = Format::BC2_UNORM; break;
+				case dds::DXGI_FORMAT_BC2_UNORM_SRGB: desc.format = Format::BC2_UNORM_SRGB; break;
+				case dds::DXGI_FORMAT_BC3_UNORM: desc.format = Format::BC3_UNORM; break;
+				case dds::DXGI_FORMAT_BC3_UNORM_SRGB: desc.format = Format::BC3_UNORM_SRGB; break;
+				case dds::DXGI_FORMAT_BC4_UNORM: desc.format = Format::BC4_UNORM; break;
+				case dds::DXGI_FORMAT_BC4_SNORM: desc.format = Format::BC4_SNORM; break;
+				case dds::DXGI_FORMAT_BC5_UNORM: desc.format = Format::BC5_UNORM; break;
+				case dds::DXGI_FORMAT_BC5_SNORM: desc.format = Format::BC5_SNORM; break;
+				case dds::DXGI_FORMAT_BC6H_SF16: desc.format = Format::BC6H_SF16; break;
+				case dds::DXGI_FORMAT_BC6H_UF16: desc.format = Format::BC6H_UF16; break;
+				case dds::DXGI_FORMAT_BC7_UNORM: desc.format = Format::BC7_UNORM; break;
+				case dds::DXGI_FORMAT_BC7_UNORM_SRGB: desc.format = Format::BC7_UNORM_SRGB; break;
+				default:
+					assert(0); // incoming format is not supported 
+					break;
+				}
+
+				if (desc.format == Format::BC4_UNORM || desc.format == Format::BC4_SNORM)
+				{
+					desc.swizzle.r = ComponentSwizzle::R;
+					desc.swizzle.g = ComponentSwizzle::R;
+					desc.swizzle.b = ComponentSwizzle::R;
+					desc.swizzle.a = ComponentSwizzle::ONE;
+				}
+				if (desc.format == Format::BC5_UNORM || desc.format == Format::BC5_SNORM)
+				{
+					desc.swizzle.r = ComponentSwizzle::R;
+					desc.swizzle.g = ComponentSwizzle::G;
+					desc.swizzle.b = ComponentSwizzle::ONE;
+					desc.swizzle.a = ComponentSwizzle::ONE;
+				}
+				if (swizzle != nullptr)
+				{
+					desc.swizzle = *swizzle;
+				}
+
+				if (header.is_1d())
+				{
+					desc.type = TextureDesc::Type::TEXTURE_1D;
+				}
+				else if (header.is_3d())
+				{
+					desc.type = TextureDesc::Type::TEXTURE_3D;
+				}
+
+				if (IsFormatBlockCompressed(desc.format))
+				{
+					desc.width = AlignTo(desc.width, GetFormatBlockSize(desc.format));
+					desc.height = AlignTo(desc.height, GetFormatBlockSize(desc.format));
+				}
+
+				wi::vector<SubresourceData> initdata_heap;
+				SubresourceData initdata_stack[16] = {};
+				SubresourceData* initdata = nullptr;
+
+				// Determine if we need heap allocation for initdata, or it is small enough for stack:
+				if (desc.array_size * desc.mip_levels < arraysize(initdata_stack))
+				{
+					initdata = initdata_stack;
+				}
+				else
+				{
+					initdata_heap.resize(desc.array_size * desc.mip_levels);
+					initdata = initdata_heap.data();
+				}
+
+				uint32_t subresource_index = 0;
+				for (uint32_t slice = 0; slice < desc.array_size; ++slice)
+				{
+					for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+					{
+						SubresourceData& subresourceData = initdata[subresource_index++];
+						subresourceData.data_ptr = filedata + header.mip_offset(mip, slice);
+						subresourceData.row_pitch = header.row_pitch(mip);
+						subresourceData.slice_pitch = header.slice_pitch(mip);
+					}
+				}
+
+				int mip_offset = 0;
+				if (has_flag(flags, Flags::STREAMING))
+				{
+					// Remember full mipcount for streaming:
+					resource->streaming_texture.mip_count = desc.mip_levels;
+					// For streaming, remember relative memory offsets for mip levels:
+					for (uint32_t slice = 0; slice < desc.array_size; ++slice)
+					{
+						for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+						{
+							auto& streaming_data = resource->streaming_texture.streaming_data[mip];
+							streaming_data.data_offset = header.mip_offset(mip, slice);
+							streaming_data.row_pitch = header.row_pitch(mip);
+							streaming_data.slice_pitch = header.slice_pitch(mip);
+						}
+					}
+					// Reduce mip map count that will be uploaded to GPU:
+					while (desc.mip_levels > 1 && desc.depth == 1 && desc.array_size == 1 && ComputeTextureMemorySizeInBytes(desc) > streaming_texture_min_size)
+					{
+						desc.width >>= 1;
+						desc.height >>= 1;
+						desc.mip_levels -= 1;
+						mip_offset++;
+					}
+					resource->streaming_texture.min_lod_clamp_absolute = (float)mip_offset;
+				}
+
+				success = device->CreateTexture(&desc, initdata + mip_offset, &resource->texture);
+				device->SetName(&resource->texture, name.c_str());
+
+				Format srgb_format = GetFormatSRGB(desc.format);
+				if (srgb_format != Format::UNKNOWN && srgb_format != desc.format)
+				{
+					resource->srgb_subresource = device->CreateSubresource(
+						&resource->texture,
+						SubresourceType::SRV,
+						0, -1,
+						0, -1,
+						&srgb_format
+					);
+				}
+			}
+			else assert(0); // failed to load DDS
+
+			return success;
+		}
+
+		static bool texture_cache_enabled = false;
+		static uint64_t texture_cache_size_limit = 2ull * 1024ull * 1024ull * 1024ull; // 2 GB
+		static uint64_t texture_cache_size = ~0ull; // unknown until the cache directory is scanned
+		static std::mutex texture_cache_locker;
+		static constexpr uint32_t texture_cache_magic = 0x43544957; // "WITC"
+		static constexpr uint32_t texture_cache_version = 2; // increment this when texture import processing changes to invalidate old cache entries
+		static constexpr const char* texture_cache_extension = "witc";
+		static bool cpu_block_compression_enabled = false;
+		static wi::texturehelper::BlockCompressionQuality cpu_block_compression_quality = wi::texturehelper::BlockCompressionQuality::Normal;
+
+		// The texture cache file is this header followed by the DDS file data
+		struct TextureCacheHeader
+		{
+			uint32_t magic = texture_cache_magic;
+			uint32_t version = texture_cache_version;
+			uint64_t key = 0;
+			uint64_t source_size = 0;
+			Swizzle swizzle;
+			uint32_t reserved = 0;
+		};
+		static_assert(sizeof(TextureCacheHeader) == 32);
+
+		// Texture cache files that are in use by streaming resources, these are not deleted by eviction while referenced
+		//	texture_cache_locker must be held when accessing
+		static wi::unordered_map<std::string, std::weak_ptr<void>> texture_cache_references;
+		static bool IsTextureCacheFileReferenced(const std::string& filename)
+		{
+			auto it = texture_cache_references.find(filename);
+			return it != texture_cache_references.end() && !it->second.expired();
+		}
+		static void SetStreamingTextureCacheFile(StreamingTexture& streaming_texture, const std::string& filename, size_t fileoffset)
+		{
+			std::scoped_lock lck(texture_cache_locker);
+			streaming_texture.cache_filename = filename;
+			streaming_texture.cache_fileoffset = fileoffset;
+			streaming_texture.cache_file_reference = {};
+			if (filename.empty())
+				return;
+			std::weak_ptr<void>& reference = texture_cache_references[filename];
+			streaming_texture.cache_file_reference = reference.lock();
+			if (streaming_texture.cache_file_reference == nullptr)
+			{
+				streaming_texture.cache_file_reference = std::make_shared<uint8_t>();
+				reference = streaming_texture.cache_file_reference;
+			}
+		}
+
+		void SetTextureCacheEnabled(bool value)
+		{
+			texture_cache_enabled = value;
+		}
+		bool IsTextureCacheEnabled()
+		{
+			return texture_cache_enabled;
+		}
+		void SetTextureCacheSizeLimit(uint64_t size_in_bytes)
+		{
+			texture_cache_size_limit = size_in_bytes;
+		}
+		uint64_t GetTextureCacheSizeLimit()
+		{
+			return texture_cache_size_limit;
+		}
+		void SetCPUBlockCompressionEnabled(bool value)
+		{
+			cpu_block_compression_enabled = value;
+		}
+		bool IsCPUBlockCompressionEnabled()
+		{
+			return cpu_block_compression_enabled;
+		}
+		void SetCPUBlockCompressionQuality(wi::texturehelper::BlockCompressionQuality quality)
+		{
+			cpu_block_compression_quality = quality;
+		}
+		wi::texturehelper::BlockCompressionQuality GetCPUBlockCompressionQuality()
+		{
+			return cpu_block_compression_quality;
+		}
+		std::string GetTextureCacheDirectory()
+		{
+			return wi::helper::GetCacheDirectoryPath() + "/WickedEngine/texturecache/";
+		}
+		void ClearTextureCache()
+		{
+			std::scoped_lock lck(texture_cache_locker);
+			wi::helper::GetFileNamesInDirectory(GetTextureCacheDirectory(), [](std::string filename) {
+				if (!IsTextureCacheFileReferenced(filename))
+				{
+					wi::helper::FileDelete(filename);
+				}
+			}, texture_cache_extension);
+			texture_cache_size = ~0ull; // referenced files are kept, the size will be recounted at next eviction
+		}
+
+		static std::string GetTextureCacheFileName(uint64_t key)
+		{
+			char str[32] = {};
+			snprintf(str, arraysize(str), "%016llx.%s", (unsigned long long)key, texture_cache_extension);
+			return GetTextureCacheDirectory() + str;
+		}
+
+		// Returns zero if the texture is not cacheable with the specified flags
+		static uint64_t GetTextureCacheKey(const std::string& ext, Flags flags, const uint8_t* filedata, size_t filesize)
+		{
+			if (has_flag(flags, Flags::IMPORT_COLORGRADINGLUT))
+				return 0;
+			if (!ext.compare("DDS"))
+				return 0; // DDS is already in GPU-ready layout
+			const bool transcodable = !ext.compare("KTX2") || !ext.compare("BASIS") || !ext.compare("HDR");
+			const bool cpu_block_compression = !transcodable && cpu_block_compression_enabled && has_flag(flags, Flags::IMPORT_BLOCK_COMPRESSED);
+			if (!transcodable && !cpu_block_compression && has_flag(flags, Flags::IMPORT_BLOCK_COMPRESSED))
+				return 0; // block compression of decoded images happens on the GPU, the result is not available for caching
+			size_t key = wi::helper::HashByteData(filedata, filesize);
+			wi::helper::hash_combine(key, filesize);
+			wi::helper::hash_combine(key, uint32_t(flags & (Flags::IMPORT_BLOCK_COMPRESSED | Flags::IMPORT_NORMALMAP)));
+			if (cpu_block_compression)
+			{
+				wi::helper::hash_combine(key, uint32_t(cpu_block_compression_quality));
+			}
+			wi::helper::hash_combine(key, texture_cache_version);
+			return key == 0 ? 1 : key;
+		}
+
+		// Removes least recently used entries if the cache size limit is exceeded
+		//	texture_cache_locker must be held by the caller
+		static void TextureCacheEvict()
+		{
+			struct Entry
+			{
+				std::string filename;
+				uint64_t timestamp = 0;
+				size_t size = 0;
+			};
+			for (auto it = texture_cache_references.begin(); it != texture_cache_references.end();)
+			{
+				if (it->second.expired())
+				{
+					it = texture_cache_references.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+
+			wi::vector<Entry> entries;
+			texture_cache_size = 0;
+			wi::helper::GetFileNamesInDirectory(GetTextureCacheDirectory(), [&](std::string filename) {
+				Entry& entry = entries.emplace_back();
+				entry.timestamp = wi::helper::FileTimestamp(filename);
+				entry.size = wi::helper::FileSize(filename);
+				entry.filename = std::move(filename);
+				texture_cache_size += entry.size;
+			}, texture_cache_extension);
+
+			if (texture_cache_size <= texture_cache_size_limit)
+				return;
+
+			std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+				return a.timestamp < b.timestamp;
+			});
+
+			// Evict a bit more than strictly necessary, so that eviction doesn't happen after every write:
+			const uint64_t target_size = texture_cache_size_limit - texture_cache_size_limit / 8;
+			for (auto& entry : entries)
+			{
+				if (texture_cache_size <= target_size)
+					break;
+				if (IsTextureCacheFileReferenced(entry.filename))
+					continue;
+				if (wi::helper::FileDelete(entry.filename))
+				{
+					texture_cache_size -= std::min(texture_cache_size, (uint64_t)entry.size);
+				}
+			}
+		}
+
+		// Reads and validates the texture cache entry, returns true if it can be used
+		static bool TextureCacheRead(uint64_t key, size_t source_size, wi::vector<uint8_t>& cachedata)
+		{
+			const std::string filename = GetTextureCacheFileName(key);
+			if (!wi::helper::FileExists(filename) || !wi::helper::FileRead(filename, cachedata))
+				return false;
+
+			bool valid = false;
+			if (cachedata.size() > sizeof(TextureCacheHeader))
+			{
+				const TextureCacheHeader* header = (const TextureCacheHeader*)cachedata.data();
+				const uint8_t* ddsdata = cachedata.data() + sizeof(TextureCacheHeader);
+				const size_t ddssize = cachedata.size() - sizeof(TextureCacheHeader);
+				const dds::Header ddsheader = dds::read_header(ddsdata, ddssize);
+				valid =
+					header->magic == texture_cache_magic &&
+					header->version == texture_cache_version &&
+					header->key == key &&
+					header->source_size == source_size &&
+					ddsheader.is_valid() &&
+					ddsheader.data_offset() + ddsheader.data_size() <= ddssize // incomplete file, for example if writing was interrupted
+					;
+			}
+
+			if (!valid)
+			{
+				cachedata.clear();
+				std::scoped_lock lck(texture_cache_locker);
+				wi::helper::FileDelete(filename);
+				texture_cache_size = ~0ull;
+				return false;
+			}
+
+			wi::helper::FileTouch(filename); // refresh for least recently used eviction
+			return true;
+		}
+
+		// Writes the texture data in GPU-ready layout into the texture cache
+		//	initdata must contain desc.array_size * desc.mip_levels subresources (slice-major, as for DDS)
+		static void TextureCacheWrite(uint64_t key, size_t source_size, const TextureDesc& desc, const SubresourceData* initdata)
+		{
+			if (desc.type != TextureDesc::Type::TEXTURE_2D)
+				return;
+
+			const uint32_t block_size = GetFormatBlockSize(desc.format);
+			const uint32_t stride = GetFormatStride(desc.format);
+
+			// Tightly packed texture data:
+			wi::vector<uint8_t> texturedata;
+			texturedata.reserve(ComputeTextureMemorySizeInBytes(desc));
+			for (uint32_t slice = 0; slice < desc.array_size; ++slice)
+			{
+				for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+				{
+					const SubresourceData& subresource = initdata[slice * desc.mip_levels + mip];
+					const uint32_t num_blocks_x = (std::max(1u, desc.width >> mip) + block_size - 1) / block_size;
+					const uint32_t num_blocks_y = (std::max(1u, desc.height >> mip) + block_size - 1) / block_size;
+					const size_t row_size = size_t(num_blocks_x) * stride;
+					for (uint32_t y = 0; y < num_blocks_y; ++y)
+					{
+						const uint8_t* src = (const uint8_t*)subresource.data_ptr + size_t(y) * subresource.row_pitch;
+						texturedata.insert(texturedata.end(), src, src + row_size);
+					}
+				}
+			}
+
+			wi::vector<uint8_t> ddsdata;
+			if (!wi::helper::saveTextureToMemoryFile(texturedata, desc, "dds", ddsdata))
+				return;
+
+			TextureCacheHeader header;
+			header.key = key;
+			header.source_size = source_size;
+			header.swizzle = desc.swizzle;
+
+			wi::vector<uint8_t> cachedata(sizeof(TextureCacheHeader) + ddsdata.size());
+			std::memcpy(cachedata.data(), &header, sizeof(header));
+			std::memcpy(cachedata.data() + sizeof(header), ddsdata.data(), ddsdata.size());
+
+			std::scoped_lock lck(texture_cache_locker);
+			wi::helper::DirectoryCreate(GetTextureCacheDirectory());
+			if (!wi::helper::FileWrite(GetTextureCacheFileName(key), cachedata.data(), cachedata.size()))
+				return;
+			if (texture_cache_size == ~0ull || texture_cache_size + cachedata.size() > texture_cache_size_limit)
+			{
+				TextureCacheEvict();
+			}
+			else
+			{
+				texture_cache_size += cachedata.size();
+			}
+		}
+
+		// Generates the full mip chain on the CPU with box filter for 8-bit or 16-bit unorm data
+		//	The mip levels are written after each other tightly packed into dst, and initdata is filled with desc.mip_levels subresources
+		//	preserve_coverage: for 4 channel data, the color is weighted by alpha and the alpha is the maximum, the same as the GPU mip generation with preserve coverage
+		template<typename T>
+		static void GenerateMipChain(const T* src, const TextureDesc& desc, uint32_t channels, wi::vector<uint8_t>& dst, SubresourceData* initdata, bool preserve_coverage)
+		{
+			size_t total_elements = 0;
+			for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+			{
+				total_elements += size_t(std::max(1u, desc.width >> mip)) * size_t(std::max(1u, desc.height >> mip)) * channels;
+			}
+			dst.resize(total_elements * sizeof(T));
+			T* dst_data = (T*)dst.data();
+			std::memcpy(dst_data, src, size_t(desc.width) * size_t(desc.height) * channels * sizeof(T));
+
+			size_t offset = 0;
+			for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+			{
+				const uint32_t width = std::max(1u, desc.width >> mip);
+				const uint32_t height = std::max(1u, desc.height >> mip);
+				initdata[mip].data_ptr = dst_data + offset;
+				initdata[mip].row_pitch = width * channels * sizeof(T);
+				initdata[mip].slice_pitch = initdata[mip].row_pitch * height;
+				if (mip > 0)
+				{
+					const uint32_t prev_width = std::max(1u, desc.width >> (mip - 1));
+					const uint32_t prev_height = std::max(1u, desc.height >> (mip - 1));
+					const T* prev = (const T*)initdata[mip - 1].data_ptr;
+					T* next = dst_data + offset;
+					for (uint32_t y = 0; y < height; ++y)
+					{
+						const uint32_t y0 = std::min(y * 2, prev_height - 1);
+						const uint32_t y1 = std::min(y * 2 + 1, prev_height - 1);
+						for (uint32_t x = 0; x < width; ++x)
+						{
+							const uint32_t x0 = std::min(x * 2, prev_width - 1);
+							const uint32_t x1 = std::min(x * 2 + 1, prev_width - 1);
+							const T* texels[] = {
+								prev + (y0 * prev_width + x0) * channels,
+								prev + (y0 * prev_width + x1) * channels,
+								prev + (y1 * prev_width + x0) * channels,
+								prev + (y1 * prev_width + x1) * channels,
+							};
+							T* result = next + (y * width + x) * channels;
+							if (preserve_coverage && channels == 4)
+							{
+								const uint64_t alpha_sum = uint64_t(texels[0][3]) + uint64_t(texels[1][3]) + uint64_t(texels[2][3]) + uint64_t(texels[3][3]);
+								if (alpha_sum > 0)
+								{
+									// Weight by alpha if it has even partially opaque pixels, this avoids losing alpha coverage and bleeding in background color from transparent area:
+									for (uint32_t c = 0; c < 3; ++c)
+									{
+										uint64_t weighted_sum = 0;
+										for (auto& texel : texels)
+										{
+											weighted_sum += uint64_t(texel[c]) * uint64_t(texel[3]);
+										}
+										result[c] = T((weighted_sum + alpha_sum / 2) / alpha_sum);
+									}
+									result[3] = std::max(std::max(texels[0][3], texels[1][3]), std::max(texels[2][3], texels[3][3]));
+									continue;
+								}
+							}
+							for (uint32_t c = 0; c < channels; ++c)
+							{
+								const uint32_t sum =
+									uint32_t(texels[0][c]) +
+									uint32_t(texels[1][c]) +
+									uint32_t(texels[2][c]) +
+									uint32_t(texels[3][c]);
+								result[c] = T((sum + 2) / 4);
+							}
+						}
+					}
+				}
+				offset += size_t(width) * size_t(height) * channels;
+			}
+		}
+
 		bool LoadResourceDirectly(
 			const std::string& name,
 			Flags flags,
@@ -329,6 +901,38 @@ namespace wi
 			case DataType::IMAGE:
 			{
 				GraphicsDevice* device = wi::graphics::GetDevice();
+				if (device == nullptr)
+					break; // headless: textures can't be created without a graphics device
+				SetStreamingTextureCacheFile(resource->streaming_texture, {}, 0);
+
+				const uint64_t cache_key = texture_cache_enabled ? GetTextureCacheKey(ext, flags, filedata, filesize) : 0;
+				if (cache_key != 0)
+				{
+					wi::vector<uint8_t> cachedata;
+					if (TextureCacheRead(cache_key, filesize, cachedata))
+					{
+						const TextureCacheHeader* header = (const TextureCacheHeader*)cachedata.data();
+						const Swizzle swizzle = header->swizzle;
+						success = LoadTextureDDS(
+							name,
+							flags,
+							cachedata.data() + sizeof(TextureCacheHeader),
+							cachedata.size() - sizeof(TextureCacheHeader),
+							resource,
+							&swizzle
+						);
+						if (success)
+						{
+							if (has_flag(flags, Flags::STREAMING))
+							{
+								// Streaming will read mip levels from the cache file instead of the source file:
+								SetStreamingTextureCacheFile(resource->streaming_texture, GetTextureCacheFileName(cache_key), sizeof(TextureCacheHeader));
+							}
+							break;
+						}
+					}
+				}
+
 				if (!ext.compare("KTX2"))
 				{
 					flags &= ~Flags::STREAMING; // disable streaming
@@ -456,6 +1060,11 @@ namespace wi
 								success = device->CreateTexture(&desc, InitData.data(), &resource->texture);
 								device->SetName(&resource->texture, name.c_str());
 
+								if (success && cache_key != 0 && InitData.size() == size_t(desc.array_size * desc.mip_levels))
+								{
+									TextureCacheWrite(cache_key, filesize, desc, InitData.data());
+								}
+
 								Format srgb_format = GetFormatSRGB(desc.format);
 								if (srgb_format != Format::UNKNOWN && srgb_format != desc.format)
 								{
@@ -587,6 +1196,11 @@ namespace wi
 										success = device->CreateTexture(&desc, InitData.data(), &resource->texture);
 										device->SetName(&resource->texture, name.c_str());
 
+										if (success && cache_key != 0 && InitData.size() == size_t(desc.mip_levels))
+										{
+											TextureCacheWrite(cache_key, filesize, desc, InitData.data());
+										}
+
 										Format srgb_format = GetFormatSRGB(desc.format);
 										if (srgb_format != Format::UNKNOWN && srgb_format != desc.format)
 										{
@@ -606,204 +1220,7 @@ namespace wi
 				}
 				else if (!ext.compare("DDS"))
 				{
-					dds::Header header = dds::read_header(filedata, filesize);
-					if (header.is_valid())
-					{
-						TextureDesc desc;
-						desc.array_size = 1;
-						desc.bind_flags = BindFlag::SHADER_RESOURCE;
-						desc.width = header.width();
-						desc.height = header.height();
-						desc.depth = header.depth();
-						desc.mip_levels = header.mip_levels();
-						desc.array_size = header.array_size();
-						desc.format = Format::R8G8B8A8_UNORM;
-						desc.layout = ResourceState::SHADER_RESOURCE;
-						desc.misc_flags = ResourceMiscFlag::TYPED_FORMAT_CASTING;
-
-						if (header.is_cubemap())
-						{
-							desc.misc_flags |= ResourceMiscFlag::TEXTURECUBE;
-						}
-						if (desc.mip_levels == 1 || desc.depth > 1 || desc.array_size > 1)
-						{
-							// don't allow streaming for single mip, array and 3D textures
-							flags &= ~Flags::STREAMING;
-						}
-
-						auto ddsFormat = header.format();
-
-						switch (ddsFormat)
-						{
-						case dds::DXGI_FORMAT_R32G32B32A32_FLOAT: desc.format = Format::R32G32B32A32_FLOAT; break;
-						case dds::DXGI_FORMAT_R32G32B32A32_UINT: desc.format = Format::R32G32B32A32_UINT; break;
-						case dds::DXGI_FORMAT_R32G32B32A32_SINT: desc.format = Format::R32G32B32A32_SINT; break;
-						case dds::DXGI_FORMAT_R32G32B32_FLOAT: desc.format = Format::R32G32B32_FLOAT; break;
-						case dds::DXGI_FORMAT_R32G32B32_UINT: desc.format = Format::R32G32B32_UINT; break;
-						case dds::DXGI_FORMAT_R32G32B32_SINT: desc.format = Format::R32G32B32_SINT; break;
-						case dds::DXGI_FORMAT_R16G16B16A16_FLOAT: desc.format = Format::R16G16B16A16_FLOAT; break;
-						case dds::DXGI_FORMAT_R16G16B16A16_UNORM: desc.format = Format::R16G16B16A16_UNORM; break;
-						case dds::DXGI_FORMAT_R16G16B16A16_UINT: desc.format = Format::R16G16B16A16_UINT; break;
-						case dds::DXGI_FORMAT_R16G16B16A16_SNORM: desc.format = Format::R16G16B16A16_SNORM; break;
-						case dds::DXGI_FORMAT_R16G16B16A16_SINT: desc.format = Format::R16G16B16A16_SINT; break;
-						case dds::DXGI_FORMAT_R32G32_FLOAT: desc.format = Format::R32G32_FLOAT; break;
-						case dds::DXGI_FORMAT_R32G32_UINT: desc.format = Format::R32G32_UINT; break;
-						case dds::DXGI_FORMAT_R32G32_SINT: desc.format = Format::R32G32_SINT; break;
-						case dds::DXGI_FORMAT_R10G10B10A2_UNORM: desc.format = Format::R10G10B10A2_UNORM; break;
-						case dds::DXGI_FORMAT_R10G10B10A2_UINT: desc.format = Format::R10G10B10A2_UINT; break;
-						case dds::DXGI_FORMAT_R11G11B10_FLOAT: desc.format = Format::R11G11B10_FLOAT; break;
-						case dds::DXGI_FORMAT_R9G9B9E5_SHAREDEXP: desc.format = Format::R9G9B9E5_SHAREDEXP; break;
-						case dds::DXGI_FORMAT_B8G8R8X8_UNORM: desc.format = Format::B8G8R8A8_UNORM; break;
-						case dds::DXGI_FORMAT_B8G8R8A8_UNORM: desc.format = Format::B8G8R8A8_UNORM; break;
-						case dds::DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: desc.format = Format::B8G8R8A8_UNORM_SRGB; break;
-						case dds::DXGI_FORMAT_R8G8B8A8_UNORM: desc.format = Format::R8G8B8A8_UNORM; break;
-						case dds::DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: desc.format = Format::R8G8B8A8_UNORM_SRGB; break;
-						case dds::DXGI_FORMAT_R8G8B8A8_UINT: desc.format = Format::R8G8B8A8_UINT; break;
-						case dds::DXGI_FORMAT_R8G8B8A8_SNORM: desc.format = Format::R8G8B8A8_SNORM; break;
-						case dds::DXGI_FORMAT_R8G8B8A8_SINT: desc.format = Format::R8G8B8A8_SINT; break;
-						case dds::DXGI_FORMAT_R16G16_FLOAT: desc.format = Format::R16G16_FLOAT; break;
-						case dds::DXGI_FORMAT_R16G16_UNORM: desc.format = Format::R16G16_UNORM; break;
-						case dds::DXGI_FORMAT_R16G16_UINT: desc.format = Format::R16G16_UINT; break;
-						case dds::DXGI_FORMAT_R16G16_SNORM: desc.format = Format::R16G16_SNORM; break;
-						case dds::DXGI_FORMAT_R16G16_SINT: desc.format = Format::R16G16_SINT; break;
-						case dds::DXGI_FORMAT_D32_FLOAT: desc.format = Format::D32_FLOAT; break;
-						case dds::DXGI_FORMAT_R32_FLOAT: desc.format = Format::R32_FLOAT; break;
-						case dds::DXGI_FORMAT_R32_UINT: desc.format = Format::R32_UINT; break;
-						case dds::DXGI_FORMAT_R32_SINT: desc.format = Format::R32_SINT; break;
-						case dds::DXGI_FORMAT_R8G8_UNORM: desc.format = Format::R8G8_UNORM; break;
-						case dds::DXGI_FORMAT_R8G8_UINT: desc.format = Format::R8G8_UINT; break;
-						case dds::DXGI_FORMAT_R8G8_SNORM: desc.format = Format::R8G8_SNORM; break;
-						case dds::DXGI_FORMAT_R8G8_SINT: desc.format = Format::R8G8_SINT; break;
-						case dds::DXGI_FORMAT_R16_FLOAT: desc.format = Format::R16_FLOAT; break;
-						case dds::DXGI_FORMAT_D16_UNORM: desc.format = Format::D16_UNORM; break;
-						case dds::DXGI_FORMAT_R16_UNORM: desc.format = Format::R16_UNORM; break;
-						case dds::DXGI_FORMAT_R16_UINT: desc.format = Format::R16_UINT; break;
-						case dds::DXGI_FORMAT_R16_SNORM: desc.format = Format::R16_SNORM; break;
-						case dds::DXGI_FORMAT_R16_SINT: desc.format = Format::R16_SINT; break;
-						case dds::DXGI_FORMAT_R8_UNORM: desc.format = Format::R8_UNORM; break;
-						case dds::DXGI_FORMAT_R8_UINT: desc.format = Format::R8_UINT; break;
-						case dds::DXGI_FORMAT_R8_SNORM: desc.format = Format::R8_SNORM; break;
-						case dds::DXGI_FORMAT_R8_SINT: desc.format = Format::R8_SINT; break;
-						case dds::DXGI_FORMAT_BC1_UNORM: desc.format = Format::BC1_UNORM; break;
-						case dds::DXGI_FORMAT_BC1_UNORM_SRGB: desc.format = Format::BC1_UNORM_SRGB; break;
-						case dds::DXGI_FORMAT_BC2_UNORM: desc.format = Format::BC2_UNORM; break;
-						case dds::DXGI_FORMAT_BC2_UNORM_SRGB: desc.format = Format::BC2_UNORM_SRGB; break;
-						case dds::DXGI_FORMAT_BC3_UNORM: desc.format = Format::BC3_UNORM; break;
-						case dds::DXGI_FORMAT_BC3_UNORM_SRGB: desc.format = Format::BC3_UNORM_SRGB; break;
-						case dds::DXGI_FORMAT_BC4_UNORM: desc.format = Format::BC4_UNORM; break;
-						case dds::DXGI_FORMAT_BC4_SNORM: desc.format = Format::BC4_SNORM; break;
-						case dds::DXGI_FORMAT_BC5_UNORM: desc.format = Format::BC5_UNORM; break;
-						case dds::DXGI_FORMAT_BC5_SNORM: desc.format = Format::BC5_SNORM; break;
-						case dds::DXGI_FORMAT_BC6H_SF16: desc.format = Format::BC6H_SF16; break;
-						case dds::DXGI_FORMAT_BC6H_UF16: desc.format = Format::BC6H_UF16; break;
-						case dds::DXGI_FORMAT_BC7_UNORM: desc.format = Format::BC7_UNORM; break;
-						case dds::DXGI_FORMAT_BC7_UNORM_SRGB: desc.format = Format::BC7_UNORM_SRGB; break;
-						default:
-							assert(0); // incoming format is not supported 
-							break;
-						}
-
-						if (desc.format == Format::BC4_UNORM || desc.format == Format::BC4_SNORM)
-						{
-							desc.swizzle.r = ComponentSwizzle::R;
-							desc.swizzle.g = ComponentSwizzle::R;
-							desc.swizzle.b = ComponentSwizzle::R;
-							desc.swizzle.a = ComponentSwizzle::ONE;
-						}
-						if (desc.format == Format::BC5_UNORM || desc.format == Format::BC5_SNORM)
-						{
-							desc.swizzle.r = ComponentSwizzle::R;
-							desc.swizzle.g = ComponentSwizzle::G;
-							desc.swizzle.b = ComponentSwizzle::ONE;
-							desc.swizzle.a = ComponentSwizzle::ONE;
-						}
-
-						if (header.is_1d())
-						{
-							desc.type = TextureDesc::Type::TEXTURE_1D;
-						}
-						else if (header.is_3d())
-						{
-							desc.type = TextureDesc::Type::TEXTURE_3D;
-						}
-
-						if (IsFormatBlockCompressed(desc.format))
-						{
-							desc.width = AlignTo(desc.width, GetFormatBlockSize(desc.format));
-							desc.height = AlignTo(desc.height, GetFormatBlockSize(desc.format));
-						}
-
-						wi::vector<SubresourceData> initdata_heap;
-						SubresourceData initdata_stack[16] = {};
-						SubresourceData* initdata = nullptr;
-
-						// Determine if we need heap allocation for initdata, or it is small enough for stack:
-						if (desc.array_size * desc.mip_levels < arraysize(initdata_stack))
-						{
-							initdata = initdata_stack;
-						}
-						else
-						{
-							initdata_heap.resize(desc.array_size * desc.mip_levels);
-							initdata = initdata_heap.data();
-						}
-
-						uint32_t subresource_index = 0;
-						for (uint32_t slice = 0; slice < desc.array_size; ++slice)
-						{
-							for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
-							{
-								SubresourceData& subresourceData = initdata[subresource_index++];
-								subresourceData.data_ptr = filedata + header.mip_offset(mip, slice);
-								subresourceData.row_pitch = header.row_pitch(mip);
-								subresourceData.slice_pitch = header.slice_pitch(mip);
-							}
-						}
-
-						int mip_offset = 0;
-						if (has_flag(flags, Flags::STREAMING))
-						{
-							// Remember full mipcount for streaming:
-							resource->streaming_texture.mip_count = desc.mip_levels;
-							// For streaming, remember relative memory offsets for mip levels:
-							for (uint32_t slice = 0; slice < desc.array_size; ++slice)
-							{
-								for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
-								{
-									auto& streaming_data = resource->streaming_texture.streaming_data[mip];
-									streaming_data.data_offset = header.mip_offset(mip, slice);
-									streaming_data.row_pitch = header.row_pitch(mip);
-									streaming_data.slice_pitch = header.slice_pitch(mip);
-								}
-							}
-							// Reduce mip map count that will be uploaded to GPU:
-							while (desc.mip_levels > 1 && desc.depth == 1 && desc.array_size == 1 && ComputeTextureMemorySizeInBytes(desc) > streaming_texture_min_size)
-							{
-								desc.width >>= 1;
-								desc.height >>= 1;
-								desc.mip_levels -= 1;
-								mip_offset++;
-							}
-							resource->streaming_texture.min_lod_clamp_absolute = (float)mip_offset;
-						}
-
-						success = device->CreateTexture(&desc, initdata + mip_offset, &resource->texture);
-						device->SetName(&resource->texture, name.c_str());
-
-						Format srgb_format = GetFormatSRGB(desc.format);
-						if (srgb_format != Format::UNKNOWN && srgb_format != desc.format)
-						{
-							resource->srgb_subresource = device->CreateSubresource(
-								&resource->texture,
-								SubresourceType::SRV,
-								0, -1,
-								0, -1,
-								&srgb_format
-							);
-						}
-					}
-					else assert(0); // failed to load DDS
-
+					success = LoadTextureDDS(name, flags, filedata, filesize, resource);
 				}
 				else if (!ext.compare("HDR"))
 				{
@@ -892,6 +1309,11 @@ namespace wi
 						success = device->CreateTexture(&desc, &InitData, &resource->texture);
 						device->SetName(&resource->texture, name.c_str());
 
+						if (success && cache_key != 0)
+						{
+							TextureCacheWrite(cache_key, filesize, desc, &InitData);
+						}
+
 						stbi_image_free(data);
 					}
 				}
@@ -1059,6 +1481,157 @@ namespace wi
 								device->SetName(&resource->texture, name.c_str());
 							}
 						}
+						else if (cpu_block_compression_enabled && has_flag(flags, Flags::IMPORT_BLOCK_COMPRESSED))
+						{
+							// Mip generation and block compression on the CPU:
+							const wi::texturehelper::BlockCompressionQuality quality = cpu_block_compression_quality;
+							bool normalmap = false;
+							desc.format = bc_format;
+							if (has_flag(flags, Flags::IMPORT_NORMALMAP))
+							{
+								desc.format = Format::BC5_UNORM;
+								desc.swizzle = { ComponentSwizzle::R, ComponentSwizzle::G, ComponentSwizzle::ONE, ComponentSwizzle::ONE };
+								normalmap = true;
+							}
+							else if (quality == wi::texturehelper::BlockCompressionQuality::High && (bc_format == Format::BC1_UNORM || bc_format == Format::BC3_UNORM))
+							{
+								desc.format = Format::BC7_UNORM;
+							}
+							desc.bind_flags = BindFlag::SHADER_RESOURCE;
+							desc.usage = Usage::DEFAULT;
+							desc.misc_flags = ResourceMiscFlag::TYPED_FORMAT_CASTING;
+
+							const uint32_t block_size = GetFormatBlockSize(desc.format);
+							const uint32_t stride = GetFormatStride(desc.format);
+							desc.width = AlignTo(desc.width, block_size);
+							desc.height = AlignTo(desc.height, block_size);
+							desc.mip_levels = GetMipCount(desc.width, desc.height, desc.depth, block_size, block_size);
+
+							// The compressor takes RGBA8 input, the source is expanded and padded to block size by replicating the edges:
+							const uint32_t components = GetFormatStride(format) / (is_16bit ? 2 : 1);
+							wi::vector<uint8_t> rgba8(size_t(desc.width) * size_t(desc.height) * 4);
+							for (uint32_t y = 0; y < desc.height; ++y)
+							{
+								const uint32_t src_y = std::min(y, uint32_t(height) - 1);
+								for (uint32_t x = 0; x < desc.width; ++x)
+								{
+									const uint32_t src_x = std::min(x, uint32_t(width) - 1);
+									const size_t src_index = (size_t(src_y) * size_t(width) + src_x) * components;
+									uint8_t* dst = rgba8.data() + (size_t(y) * desc.width + x) * 4;
+									dst[0] = 0;
+									dst[1] = 0;
+									dst[2] = 0;
+									dst[3] = 255;
+									for (uint32_t c = 0; c < components; ++c)
+									{
+										dst[c] = is_16bit ? uint8_t((uint32_t(((const uint16_t*)rgba)[src_index + c]) + 128) / 257) : ((const uint8_t*)rgba)[src_index + c];
+									}
+								}
+							}
+
+							TextureDesc mipdesc = desc;
+							mipdesc.format = Format::R8G8B8A8_UNORM;
+							wi::vector<uint8_t> mipdata;
+							SubresourceData mip_init_data[16] = {};
+							GenerateMipChain(rgba8.data(), mipdesc, 4, mipdata, mip_init_data, true);
+
+							size_t compressed_size = 0;
+							for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+							{
+								const uint32_t num_blocks_x = (std::max(1u, desc.width >> mip) + block_size - 1) / block_size;
+								const uint32_t num_blocks_y = (std::max(1u, desc.height >> mip) + block_size - 1) / block_size;
+								compressed_size += size_t(num_blocks_x) * size_t(num_blocks_y) * stride;
+							}
+							wi::vector<uint8_t> compressed(compressed_size);
+							SubresourceData init_data[16] = {};
+							size_t offset = 0;
+							success = true;
+							for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+							{
+								const uint32_t mipwidth = std::max(1u, desc.width >> mip);
+								const uint32_t mipheight = std::max(1u, desc.height >> mip);
+								const uint32_t num_blocks_x = (mipwidth + block_size - 1) / block_size;
+								const uint32_t num_blocks_y = (mipheight + block_size - 1) / block_size;
+								init_data[mip].data_ptr = compressed.data() + offset;
+								init_data[mip].row_pitch = num_blocks_x * stride;
+								init_data[mip].slice_pitch = init_data[mip].row_pitch * num_blocks_y;
+								success &= wi::texturehelper::BlockCompress(
+									(const uint8_t*)mip_init_data[mip].data_ptr,
+									mipwidth,
+									mipheight,
+									mip_init_data[mip].row_pitch,
+									desc.format,
+									compressed.data() + offset,
+									quality,
+									normalmap
+								);
+								offset += init_data[mip].slice_pitch;
+							}
+
+							if (success)
+							{
+								success = device->CreateTexture(&desc, init_data, &resource->texture);
+								device->SetName(&resource->texture, name.c_str());
+
+								Format srgb_format = GetFormatSRGB(desc.format);
+								if (srgb_format != Format::UNKNOWN && srgb_format != desc.format)
+								{
+									resource->srgb_subresource = device->CreateSubresource(
+										&resource->texture,
+										SubresourceType::SRV,
+										0, -1,
+										0, -1,
+										&srgb_format
+									);
+								}
+
+								if (success && cache_key != 0)
+								{
+									TextureCacheWrite(cache_key, filesize, desc, init_data);
+								}
+							}
+						}
+						else if (cache_key != 0)
+						{
+							// The mip chain is generated on the CPU instead of the GPU, so that the complete texture can be written to the texture cache
+							//	Coverage is preserved the same way as with the GPU mip generation, so cached and uncached loads look the same:
+							desc.bind_flags = BindFlag::SHADER_RESOURCE;
+							desc.mip_levels = GetMipCount(desc.width, desc.height);
+							desc.usage = Usage::DEFAULT;
+							desc.misc_flags = ResourceMiscFlag::TYPED_FORMAT_CASTING;
+
+							const uint32_t channels = GetFormatStride(desc.format) / (is_16bit ? 2 : 1);
+							wi::vector<uint8_t> mipdata;
+							SubresourceData init_data[16] = {};
+							if (is_16bit)
+							{
+								GenerateMipChain((const uint16_t*)rgba, desc, channels, mipdata, init_data, true);
+							}
+							else
+							{
+								GenerateMipChain((const uint8_t*)rgba, desc, channels, mipdata, init_data, true);
+							}
+
+							success = device->CreateTexture(&desc, init_data, &resource->texture);
+							device->SetName(&resource->texture, name.c_str());
+
+							Format srgb_format = GetFormatSRGB(desc.format);
+							if (srgb_format != Format::UNKNOWN && srgb_format != desc.format)
+							{
+								resource->srgb_subresource = device->CreateSubresource(
+									&resource->texture,
+									SubresourceType::SRV,
+									0, -1,
+									0, -1,
+									&srgb_format
+								);
+							}
+
+							if (success)
+							{
+								TextureCacheWrite(cache_key, filesize, desc, init_data);
+							}
+						}
 						else
 						{
 							desc.bind_flags = BindFlag::SHADER_RESOURCE | BindFlag::UNORDERED_ACCESS;
@@ -1489,16 +2062,17 @@ namespace wi
 					{
 						// memory offset of the first mip level in current streaming range:
 						const size_t mip_data_offset = resource->streaming_texture.streaming_data[mip_offset].data_offset;
-						const uint8_t* firstmipdata = resource->filedata.data();
+						const bool cached = !resource->streaming_texture.cache_filename.empty();
+						const uint8_t* firstmipdata = cached ? nullptr : resource->filedata.data(); // retained file data is the source, not the cached texture
 
 						static wi::vector<uint8_t> streaming_file; // make this static to not reallocate for each file loading
 						if (firstmipdata == nullptr)
 						{
 							// If file data is not available, then open the file partially with the streaming file parameters:
-							size_t filesize = resource->container_filesize - mip_data_offset;
-							size_t fileoffset = resource->container_fileoffset + mip_data_offset;
+							size_t filesize = cached ? ~0ull : resource->container_filesize - mip_data_offset;
+							size_t fileoffset = (cached ? resource->streaming_texture.cache_fileoffset : resource->container_fileoffset) + mip_data_offset;
 							if (!wi::helper::FileRead(
-								resource->container_filename,
+								cached ? resource->streaming_texture.cache_filename : resource->container_filename,
 								streaming_file,
 								filesize,
 								fileoffset
@@ -7,6 +7,7 @@
 #include "wiVector.h"
 #include "wiVideo.h"
 #include "wiUnorderedSet.h"
+#include "wiTextureHelper.h"
 
 #include <memory>
 #include <string>
@@ -114,6 +115,28 @@ namespace wi
 		// Reload all resources that are outdated
 		void ReloadOutdatedResources();
 
+		// Texture cache: decoded and transcoded images can be stored on disk in GPU-ready DDS layout with full mip chain
+		//	Cache entries are identified by the hash of the source file data and import flags, so they are shared between resources that have the same content
+		//	Subsequent loads of the same content can skip decoding, transcoding and mip generation, and cached textures can be streamed
+		//	The cache is located in wi::helper::GetCacheDirectoryPath(), and it is disabled by default
+		void SetTextureCacheEnabled(bool value);
+		bool IsTextureCacheEnabled();
+		// Set the maximum size of the texture cache on disk in bytes. If it is exceeded, the least recently used entries will be removed
+		void SetTextureCacheSizeLimit(uint64_t size_in_bytes);
+		uint64_t GetTextureCacheSizeLimit();
+		// Returns the directory where the texture cache entries are stored
+		std::string GetTextureCacheDirectory();
+		// Removes all texture cache entries from disk
+		void ClearTextureCache();
+
+		// CPU block compression: images that are not transcodable (PNG, JPG, TGA, etc.) and imported with IMPORT_BLOCK_COMPRESSED can be compressed on the CPU instead of the GPU
+		//	This doesn't require GPU compute support, and the compressed result can be written to the texture cache
+		//	With BlockCompressionQuality::High, color images will be compressed to BC7 instead of BC1 or BC3
+		void SetCPUBlockCompressionEnabled(bool value);
+		bool IsCPUBlockCompressionEnabled();
+		void SetCPUBlockCompressionQuality(wi::texturehelper::BlockCompressionQuality quality);
+		wi::texturehelper::BlockCompressionQuality GetCPUBlockCompressionQuality();
+
 		struct ResourceSerializer
 		{
 			wi::vector<Resource> resources;
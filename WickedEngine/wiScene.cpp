@@ -35,6 +35,8 @@ namespace wi::scene
 
 		wi::jobsystem::context ctx;
 
+		const bool headless = IsHeadless();
+
 		UpdateHumanoidFacings();
 
 		// Script system runs first, because it could create new entities and components
@@ -46,7 +48,7 @@ namespace wi::scene
 		ScanAnimationDependencies();
 
 		// Terrains updates kick off:
-		if (dt > 0)
+		if (dt > 0 && !headless)
 		{
 			// Because this also spawns render tasks, this must not be during dt == 0 (eg. background loading)
 			for (size_t i = 0; i < terrains.GetCount(); ++i)
@@ -75,7 +77,7 @@ namespace wi::scene
 			rainInstanceOffset = uint32_t(instanceArraySize);
 			instanceArraySize += 1;
 		}
-		if (instanceUploadBuffer[0].desc.size < (instanceArraySize * sizeof(ShaderMeshInstance)))
+		if (!headless && instanceUploadBuffer[0].desc.size < (instanceArraySize * sizeof(ShaderMeshInstance)))
 		{
 			GPUBufferDesc desc;
 			desc.stride = sizeof(ShaderMeshInstance);
@@ -100,7 +102,7 @@ namespace wi::scene
 				device->SetName(&instanceUploadBuffer[i], "Scene::instanceUploadBuffer");
 			}
 		}
-		instanceArrayMapped = (ShaderMeshInstance*)instanceUploadBuffer[device->GetBufferIndex()].mapped_data;
+		instanceArrayMapped = headless ? nullptr : (ShaderMeshInstance*)instanceUploadBuffer[device->GetBufferIndex()].mapped_data;
 
 		materialArraySize = materials.GetCount();
 		if (impostors.GetCount() > 0)
@@ -113,7 +115,7 @@ namespace wi::scene
 			rainMaterialOffset = uint32_t(materialArraySize);
 			materialArraySize += 1;
 		}
-		if (materialUploadBuffer[0].desc.size < (materialArraySize * sizeof(ShaderMaterial)))
+		if (!headless && materialUploadBuffer[0].desc.size < (materialArraySize * sizeof(ShaderMaterial)))
 		{
 			GPUBufferDesc desc;
 			desc.stride = sizeof(ShaderMaterial);
@@ -138,9 +140,9 @@ namespace wi::scene
 				device->SetName(&materialUploadBuffer[i], "Scene::materialUploadBuffer");
 			}
 		}
-		materialArrayMapped = (ShaderMaterial*)materialUploadBuffer[device->GetBufferIndex()].mapped_data;
+		materialArrayMapped = headless ? nullptr : (ShaderMaterial*)materialUploadBuffer[device->GetBufferIndex()].mapped_data;
 
-		if (textureStreamingFeedbackBuffer.desc.size < materialArraySize * sizeof(uint32_t))
+		if (!headless && textureStreamingFeedbackBuffer.desc.size < materialArraySize * sizeof(uint32_t))
 		{
 			GPUBufferDesc desc;
 			desc.stride = sizeof(uint32_t);
@@ -160,10 +162,10 @@ namespace wi::scene
 				device->SetName(&textureStreamingFeedbackBuffer_readback[i], "Scene::textureStreamingFeedbackBuffer_readback");
 			}
 		}
-		textureStreamingFeedbackMapped = (const uint32_t*)textureStreamingFeedbackBuffer_readback[device->GetBufferIndex()].mapped_data;
+		textureStreamingFeedbackMapped = headless ? nullptr : (const uint32_t*)textureStreamingFeedbackBuffer_readback[device->GetBufferIndex()].mapped_data;
 
 		// Occlusion culling read:
-		if(wi::renderer::GetOcclusionCullingEnabled() && !wi::renderer::GetFreezeCullingCameraEnabled())
+		if(!headless && wi::renderer::GetOcclusionCullingEnabled() && !wi::renderer::GetFreezeCullingCameraEnabled())
 		{
 			uint32_t minQueryCount = uint32_t(objects.GetCount() + lights.GetCount() + 1); // +1: ocean (don't know for sure if it exists yet before weather update)
 			if (queryHeap.desc.query_count < minQueryCount)
@@ -229,15 +231,25 @@ namespace wi::scene
 				skinningAllocator.fetch_add(uint32_t(armature.boneCollection.size() * sizeof(ShaderTransform)));
 			});
 
-			wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
-				// Must not keep inactive instances, so init them for safety:
-				ShaderMeshInstance inst;
-				inst.init();
-				for (uint32_t i = 0; i < instanceArraySize; ++i)
-				{
-					std::memcpy(instanceArrayMapped + i, &inst, sizeof(inst));
-				}
-			});
+			if (instanceArrayMapped != nullptr)
+			{
+				wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+					// Must not keep inactive instances, so init them for safety:
+					ShaderMeshInstance inst;
+					inst.init();
+					for (uint32_t i = 0; i < instanceArraySize; ++i)
+					{
+						std::memcpy(instanceArrayMapped + i, &inst, sizeof(inst));
+					}
+				});
+			}
+		}
+
+		if (weather.IsOceanEnabled())
+		{
+			ocean.time = time;
+			// The CPU ocean is simulated before characters and physics, so they query the water surface of the current frame:
+			ocean.UpdateDisplacementMapCPU();
 		}
 
 		RunCharacterUpdateSystem(ctx);
@@ -260,7 +272,7 @@ namespace wi::scene
 
 		// This must be after lightmap requests were determined:
 		TLAS_instancesMapped = nullptr;
-		if (IsAccelerationStructureUpdateRequested() && device->CheckCapability(GraphicsDeviceCapability::RAYTRACING))
+		if (!headless && IsAccelerationStructureUpdateRequested() && device->CheckCapability(GraphicsDeviceCapability::RAYTRACING))
 		{
 			GPUBufferDesc desc;
 			desc.stride = (uint32_t)device->GetTopLevelAccelerationStructureInstanceSize();
@@ -296,7 +308,7 @@ namespace wi::scene
 			rainGeometryOffset = uint32_t(geometryArraySize);
 			geometryArraySize += 1;
 		}
-		if (geometryUploadBuffer[0].desc.size < (geometryArraySize * sizeof(ShaderGeometry)))
+		if (!headless && geometryUploadBuffer[0].desc.size < (geometryArraySize * sizeof(ShaderGeometry)))
 		{
 			GPUBufferDesc desc;
 			desc.stride = sizeof(ShaderGeometry);
@@ -321,12 +333,12 @@ namespace wi::scene
 				device->SetName(&geometryUploadBuffer[i], "Scene::geometryUploadBuffer");
 			}
 		}
-		geometryArrayMapped = (ShaderGeometry*)geometryUploadBuffer[device->GetBufferIndex()].mapped_data;
+		geometryArrayMapped = headless ? nullptr : (ShaderGeometry*)geometryUploadBuffer[device->GetBufferIndex()].mapped_data;
 
 		// Skinning data size is ready at this point:
 		skinningDataSize = skinningAllocator.load();
 		skinningAllocator.store(0);
-		if (skinningUploadBuffer[0].desc.size < skinningDataSize)
+		if (!headless && skinningUploadBuffer[0].desc.size < skinningDataSize)
 		{
 			GPUBufferDesc desc;
 			desc.size = skinningDataSize * 2; // *2 to grow fast
@@ -350,7 +362,7 @@ namespace wi::scene
 				device->SetName(&skinningUploadBuffer[i], "Scene::skinningUploadBuffer");
 			}
 		}
-		skinningDataMapped = skinningUploadBuffer[device->GetBufferIndex()].mapped_data;
+		skinningDataMapped = headless ? nullptr : skinningUploadBuffer[device->GetBufferIndex()].mapped_data;
 
 		RunExpressionUpdateSystem(ctx);
 
@@ -372,6 +384,27 @@ namespace wi::scene
 
 		wi::jobsystem::Wait(ctx); // dependencies
 
+		// Skinned query caches are invalidated after the armatures and soft bodies are updated, queries made earlier in the frame (scripts, characters, procedural animation) don't store last frame's pose as current:
+		skinned_query_frame++;
+		if (IsSkinnedQueryCacheEnabled())
+		{
+			for (auto it = skinned_query_caches.begin(); it != skinned_query_caches.end();)
+			{
+				if (meshes.Contains(it->first))
+				{
+					++it;
+				}
+				else
+				{
+					it = skinned_query_caches.erase(it);
+				}
+			}
+		}
+		else
+		{
+			skinned_query_caches.clear();
+		}
+
 		RunObjectUpdateSystem(ctx);
 
 		RunCameraUpdateSystem(ctx);
@@ -398,6 +431,39 @@ namespace wi::scene
 
 		wi::jobsystem::Wait(ctx); // dependencies
 
+		// CPU particle simulation (depends on force and particle update systems):
+		for (size_t i = 0; i < emitters.GetCount(); ++i)
+		{
+			EmittedParticleSystem& emitter = emitters[i];
+			if (!emitter.IsCPUSimulationEnabled())
+				continue;
+			const MaterialComponent* material = materials.GetComponent(emitters.GetEntity(i));
+			emitter.SimulateCPU(forces.GetCount() > 0 ? &forces[0] : nullptr, forces.GetCount(), material);
+		}
+
+		// Structure of arrays culling streams (depends on object, decal, probe and light update systems):
+		{
+			struct SOAStream
+			{
+				const wi::vector<AABB>* src;
+				wi::primitive::AABBArray* dst;
+			};
+			const SOAStream soa_streams[] = {
+				{ &aabb_objects, &aabb_objects_soa },
+				{ &aabb_lights, &aabb_lights_soa },
+				{ &aabb_probes, &aabb_probes_soa },
+				{ &aabb_decals, &aabb_decals_soa },
+			};
+			static constexpr uint32_t soa_groupsize = 1024;
+			for (auto& stream : soa_streams)
+			{
+				stream.dst->resize(stream.src->size());
+				wi::jobsystem::Dispatch(ctx, (uint32_t)stream.src->size(), soa_groupsize, [stream](wi::jobsystem::JobArgs args) {
+					stream.dst->set(args.jobIndex, (*stream.src)[args.jobIndex]);
+				});
+			}
+		}
+
 		// Merge parallel bounds computation (depends on object update system):
 		bounds = AABB();
 		for (auto& group_bound : parallel_bounds)
@@ -407,7 +473,7 @@ namespace wi::scene
 
 		// Meshlet buffer:
 		uint32_t meshletCount = meshletAllocator.load();
-		if(meshletBuffer.desc.size < meshletCount * sizeof(ShaderMeshlet))
+		if(!headless && meshletBuffer.desc.size < meshletCount * sizeof(ShaderMeshlet))
 		{
 			GPUBufferDesc desc;
 			desc.stride = sizeof(ShaderMeshlet);
@@ -419,7 +485,7 @@ namespace wi::scene
 			device->SetName(&meshletBuffer, "meshletBuffer");
 		}
 
-		if (IsAccelerationStructureUpdateRequested())
+		if (!headless && IsAccelerationStructureUpdateRequested())
 		{
 			if (device->CheckCapability(GraphicsDeviceCapability::RAYTRACING))
 			{
@@ -464,7 +530,7 @@ namespace wi::scene
 			}
 		}
 
-		if (wi::renderer::GetSurfelGIEnabled())
+		if (!headless && wi::renderer::GetSurfelGIEnabled())
 		{
 			if (!surfelgi.surfelBuffer.IsValid())
 			{
@@ -556,7 +622,7 @@ namespace wi::scene
 			surfelgi = {};
 		}
 
-		if (wi::renderer::GetDDGIEnabled())
+		if (!headless && wi::renderer::GetDDGIEnabled())
 		{
 			ddgi.frame_index++;
 			if (!TLAS.IsValid() && !BVH.IsValid())
@@ -640,7 +706,7 @@ namespace wi::scene
 			ddgi = {};
 		}
 
-		if (wi::renderer::GetVXGIEnabled())
+		if (!headless && wi::renderer::GetVXGIEnabled())
 		{
 			if(!vxgi.radiance.IsValid())
 			{
@@ -695,7 +761,7 @@ namespace wi::scene
 			vxgi.clipmap_to_update = (vxgi.clipmap_to_update + 1) % VXGI_CLIPMAP_COUNT;
 		}
 
-		if (impostors.GetCount() > 0 && objects.GetCount() > 0)
+		if (!headless && impostors.GetCount() > 0 && objects.GetCount() > 0)
 		{
 			impostor_ib_format = GetIndexBufferFormatRaw((uint32_t)objects.GetCount() * 4);
 
@@ -814,6 +880,13 @@ namespace wi::scene
 			}
 		}
 
+		if (headless)
+		{
+			// Shader scene resources are not needed without rendering:
+			wi::jobsystem::Wait(ctx); // SOA culling streams
+			return;
+		}
+
 		// Shader scene resources:
 		if (device->CheckCapability(GraphicsDeviceCapability::CACHE_COHERENT_UMA))
 		{
@@ -953,6 +1026,8 @@ namespace wi::scene
 			shaderscene.voxelgrid.voxelSize = voxelgrid.voxelSize;
 			shaderscene.voxelgrid.voxelSize_rcp = voxelgrid.voxelSize_rcp;
 		}
+
+		wi::jobsystem::Wait(ctx); // SOA culling streams
 	}
 	void Scene::Clear()
 	{
@@ -964,6 +1039,7 @@ namespace wi::scene
 		TLAS = RaytracingAccelerationStructure();
 		BVH.Clear();
 		waterRipples.clear();
+		skinned_query_caches.clear();
 
 		surfelgi = {};
 		ddgi = {};
@@ -975,6 +1051,11 @@ namespace wi::scene
 		aabb_probes.clear();
 		aabb_fonts.clear();
 
+		aabb_objects_soa.clear();
+		aabb_lights_soa.clear();
+		aabb_decals_soa.clear();
+		aabb_probes_soa.clear();
+
 		matrix_objects.clear();
 		matrix_objects_prev.clear();
 
@@ -3829,7 +3910,7 @@ namespace wi::scene
 			const uint32_t dataSize = uint32_t(softbody.boneData.size() * sizeof(ShaderTransform));
 			softbody.gpuBoneOffset = skinningAllocator.fetch_add(dataSize);
 			ShaderTransform* gpu_dst = (ShaderTransform*)((uint8_t*)skinningDataMapped + softbody.gpuBoneOffset);
-			if (((size_t)gpu_dst - (size_t)skinningDataMapped + (size_t)dataSize) <= skinningDataSize)
+			if (skinningDataMapped != nullptr && ((size_t)gpu_dst - (size_t)skinningDataMapped + (size_t)dataSize) <= skinningDataSize)
 			{
 				std::memcpy(gpu_dst, softbody.boneData.data(), dataSize);
 			}
@@ -4071,27 +4152,30 @@ namespace wi::scene
 				material.SetDirty(false);
 			}
 
-			material.WriteShaderMaterial(materialArrayMapped + args.jobIndex);
-
-			VideoComponent* video = videos.GetComponent(entity);
-			if (video != nullptr)
+			if (materialArrayMapped != nullptr)
 			{
-				// Video attachment will overwrite texture slots on shader side:
-				int descriptor = GetDevice()->GetDescriptorIndex(&video->videoinstance.output.texture, SubresourceType::SRV, video->videoinstance.output.subresource_srgb);
-				material.WriteShaderTextureSlot(materialArrayMapped + args.jobIndex, BASECOLORMAP, descriptor);
-				material.WriteShaderTextureSlot(materialArrayMapped + args.jobIndex, EMISSIVEMAP, descriptor);
-			}
+				material.WriteShaderMaterial(materialArrayMapped + args.jobIndex);
 
-			if (material.cameraSource != INVALID_ENTITY)
-			{
-				const CameraComponent* camera = cameras.GetComponent(material.cameraSource);
-				if (camera != nullptr && camera->render_to_texture.rendertarget_render.IsValid())
+				VideoComponent* video = videos.GetComponent(entity);
+				if (video != nullptr)
 				{
-					// Camera attachment will overwrite texture slots on shader side:
-					int descriptor = GetDevice()->GetDescriptorIndex(&camera->render_to_texture.rendertarget_render, SubresourceType::SRV);
+					// Video attachment will overwrite texture slots on shader side:
+					int descriptor = GetDevice()->GetDescriptorIndex(&video->videoinstance.output.texture, SubresourceType::SRV, video->videoinstance.output.subresource_srgb);
 					material.WriteShaderTextureSlot(materialArrayMapped + args.jobIndex, BASECOLORMAP, descriptor);
 					material.WriteShaderTextureSlot(materialArrayMapped + args.jobIndex, EMISSIVEMAP, descriptor);
 				}
+
+				if (material.cameraSource != INVALID_ENTITY)
+				{
+					const CameraComponent* camera = cameras.GetComponent(material.cameraSource);
+					if (camera != nullptr && camera->render_to_texture.rendertarget_render.IsValid())
+					{
+						// Camera attachment will overwrite texture slots on shader side:
+						int descriptor = GetDevice()->GetDescriptorIndex(&camera->render_to_texture.rendertarget_render, SubresourceType::SRV);
+						material.WriteShaderTextureSlot(materialArrayMapped + args.jobIndex, BASECOLORMAP, descriptor);
+						material.WriteShaderTextureSlot(materialArrayMapped + args.jobIndex, EMISSIVEMAP, descriptor);
+					}
+				}
 			}
 
 			if (textureStreamingFeedbackMapped != nullptr)
@@ -4267,6 +4351,8 @@ namespace wi::scene
 	}
 	void Scene::RunObjectUpdateSystem(wi::jobsystem::context& ctx)
 	{
+		const bool headless = IsHeadless();
+
 		aabb_objects.resize(objects.GetCount());
 		matrix_objects.resize(objects.GetCount());
 		matrix_objects_prev.resize(objects.GetCount());
@@ -4329,7 +4415,7 @@ namespace wi::scene
 				object.mesh_index = (uint32_t)meshes.GetIndex(object.meshID);
 				const MeshComponent& mesh = meshes[object.mesh_index];
 
-				if (object.IsWetmapEnabled() && !object.wetmap.IsValid())
+				if (!headless && object.IsWetmapEnabled() && !object.wetmap.IsValid())
 				{
 					GPUBufferDesc desc;
 					desc.size = mesh.vertex_positions.size() * sizeof(uint16_t);
@@ -4453,100 +4539,104 @@ namespace wi::scene
 				//XMFLOAT4X4 transformNormal;
 				//XMStoreFloat4x4(&transformNormal, worldMatrixInverseTranspose);
 
-				// Create GPU instance data:
-				ShaderMeshInstance inst;
-				inst.init();
 				XMFLOAT4X4 worldMatrixPrev = matrix_objects[args.jobIndex];
 				matrix_objects_prev[args.jobIndex] = worldMatrixPrev;
 				XMStoreFloat4x4(matrix_objects.data() + args.jobIndex, W);
 				XMFLOAT4X4 worldMatrix = matrix_objects[args.jobIndex];
 
-				inst.transformRaw.Create(worldMatrix);
-				if (IsFormatUnorm(mesh.position_format) && !mesh.so_pos.IsValid())
-				{
-					// The UNORM correction is only done for the GPU data!
-					XMMATRIX R = mesh.aabb.getUnormRemapMatrix();
-					XMStoreFloat4x4(&worldMatrix, R * W);
-					XMStoreFloat4x4(&worldMatrixPrev, R * XMLoadFloat4x4(&worldMatrixPrev));
-				}
-				inst.transform.Create(worldMatrix);
-				inst.transformPrev.Create(worldMatrixPrev);
-
-				XMVECTOR S, R, T;
-				XMMatrixDecompose(&S, &R, &T, W);
-				float size = std::max(XMVectorGetX(S), std::max(XMVectorGetY(S), XMVectorGetZ(S)));
-
-				if (object.lightmap.IsValid())
-				{
-					inst.lightmap = device->GetDescriptorIndex(&object.lightmap, SubresourceType::SRV);
-				}
-				inst.uid = entity;
-				inst.layerMask = layerMask;
-				inst.color = wi::math::pack_half4(object.color);
-				inst.emissive = wi::math::pack_half3(XMFLOAT3(object.emissiveColor.x * object.emissiveColor.w, object.emissiveColor.y * object.emissiveColor.w, object.emissiveColor.z * object.emissiveColor.w));
-				inst.baseGeometryOffset = mesh.geometryOffset;
-				inst.baseGeometryCount = (uint)mesh.subsets.size();
-				inst.geometryOffset = inst.baseGeometryOffset + first_subset;
-				inst.geometryCount = last_subset - first_subset;
-				inst.meshletOffset = meshletAllocator.fetch_add(mesh.meshletCount);
-				inst.fadeDistance = object.fadeDistance;
-				inst.center = object.center;
-				inst.radius = object.radius;
-				inst.vb_ao = object.vb_ao_srv;
-				inst.vb_wetmap = device->GetDescriptorIndex(&object.wetmap, SubresourceType::SRV);
-				inst.alphaTest_size = wi::math::pack_half2(XMFLOAT2(1 - object.alphaRef, size));
-				inst.SetUserStencilRef(object.userStencilRef);
-				inst.rimHighlight = wi::math::pack_half4(XMFLOAT4(object.rimHighlightColor.x * object.rimHighlightColor.w, object.rimHighlightColor.y * object.rimHighlightColor.w, object.rimHighlightColor.z * object.rimHighlightColor.w, object.rimHighlightFalloff));
-
-				std::memcpy(instanceArrayMapped + args.jobIndex, &inst, sizeof(inst)); // memcpy whole structure into mapped pointer to avoid read from uncached memory
+				// Create GPU instance data:
+				if (instanceArrayMapped != nullptr)
+				{
+					ShaderMeshInstance inst;
+					inst.init();
+
+					inst.transformRaw.Create(worldMatrix);
+					if (IsFormatUnorm(mesh.position_format) && !mesh.so_pos.IsValid())
+					{
+						// The UNORM correction is only done for the GPU data!
+						XMMATRIX R = mesh.aabb.getUnormRemapMatrix();
+						XMStoreFloat4x4(&worldMatrix, R * W);
+						XMStoreFloat4x4(&worldMatrixPrev, R * XMLoadFloat4x4(&worldMatrixPrev));
+					}
+					inst.transform.Create(worldMatrix);
+					inst.transformPrev.Create(worldMatrixPrev);
+
+					XMVECTOR S, R, T;
+					XMMatrixDecompose(&S, &R, &T, W);
+					float size = std::max(XMVectorGetX(S), std::max(XMVectorGetY(S), XMVectorGetZ(S)));
+
+					if (object.lightmap.IsValid())
+					{
+						inst.lightmap = device->GetDescriptorIndex(&object.lightmap, SubresourceType::SRV);
+					}
+					inst.uid = entity;
+					inst.layerMask = layerMask;
+					inst.color = wi::math::pack_half4(object.color);
+					inst.emissive = wi::math::pack_half3(XMFLOAT3(object.emissiveColor.x * object.emissiveColor.w, object.emissiveColor.y * object.emissiveColor.w, object.emissiveColor.z * object.emissiveColor.w));
+					inst.baseGeometryOffset = mesh.geometryOffset;
+					inst.baseGeometryCount = (uint)mesh.subsets.size();
+					inst.geometryOffset = inst.baseGeometryOffset + first_subset;
+					inst.geometryCount = last_subset - first_subset;
+					inst.meshletOffset = meshletAllocator.fetch_add(mesh.meshletCount);
+					inst.fadeDistance = object.fadeDistance;
+					inst.center = object.center;
+					inst.radius = object.radius;
+					inst.vb_ao = object.vb_ao_srv;
+					inst.vb_wetmap = device->GetDescriptorIndex(&object.wetmap, SubresourceType::SRV);
+					inst.alphaTest_size = wi::math::pack_half2(XMFLOAT2(1 - object.alphaRef, size));
+					inst.SetUserStencilRef(object.userStencilRef);
+					inst.rimHighlight = wi::math::pack_half4(XMFLOAT4(object.rimHighlightColor.x * object.rimHighlightColor.w, object.rimHighlightColor.y * object.rimHighlightColor.w, object.rimHighlightColor.z * object.rimHighlightColor.w, object.rimHighlightFalloff));
+
+					std::memcpy(instanceArrayMapped + args.jobIndex, &inst, sizeof(inst)); // memcpy whole structure into mapped pointer to avoid read from uncached memory
+
+					if (TLAS_instancesMapped != nullptr)
+					{
+						// TLAS instance data:
+						RaytracingAccelerationStructureDesc::TopLevel::Instance instance;
+						for (int i = 0; i < arraysize(instance.transform); ++i)
+						{
+							for (int j = 0; j < arraysize(instance.transform[i]); ++j)
+							{
+								instance.transform[i][j] = worldMatrix.m[j][i];
+							}
+						}
+						instance.instance_id = args.jobIndex;
+						instance.instance_mask = layerMask == 0 ? 0 : 0xFF;
+						if (!object.IsRenderable() || !mesh.IsRenderable())
+						{
+							instance.instance_mask = 0;
+						}
+						if (!object.IsCastingShadow())
+						{
+							instance.instance_mask &= ~wi::renderer::raytracing_inclusion_mask_shadow;
+						}
+						if (object.IsNotVisibleInReflections())
+						{
+							instance.instance_mask &= ~wi::renderer::raytracing_inclusion_mask_reflection;
+						}
+						instance.bottom_level = &mesh.BLASes[object.lod];
+						instance.instance_contribution_to_hit_group_index = 0;
+						instance.flags = 0;
 
-				if (TLAS_instancesMapped != nullptr)
-				{
-					// TLAS instance data:
-					RaytracingAccelerationStructureDesc::TopLevel::Instance instance;
-					for (int i = 0; i < arraysize(instance.transform); ++i)
-					{
-						for (int j = 0; j < arraysize(instance.transform[i]); ++j)
+						if (mesh.IsDoubleSided() || mesh._flags & MeshComponent::TLAS_FORCE_DOUBLE_SIDED)
 						{
-							instance.transform[i][j] = worldMatrix.m[j][i];
+							instance.flags |= RaytracingAccelerationStructureDesc::TopLevel::Instance::FLAG_TRIANGLE_CULL_DISABLE;
 						}
-					}
-					instance.instance_id = args.jobIndex;
-					instance.instance_mask = layerMask == 0 ? 0 : 0xFF;
-					if (!object.IsRenderable() || !mesh.IsRenderable())
-					{
-						instance.instance_mask = 0;
-					}
-					if (!object.IsCastingShadow())
-					{
-						instance.instance_mask &= ~wi::renderer::raytracing_inclusion_mask_shadow;
-					}
-					if (object.IsNotVisibleInReflections())
-					{
-						instance.instance_mask &= ~wi::renderer::raytracing_inclusion_mask_reflection;
-					}
-					instance.bottom_level = &mesh.BLASes[object.lod];
-					instance.instance_contribution_to_hit_group_index = 0;
-					instance.flags = 0;
 
-					if (mesh.IsDoubleSided() || mesh._flags & MeshComponent::TLAS_FORCE_DOUBLE_SIDED)
-					{
-						instance.flags |= RaytracingAccelerationStructureDesc::TopLevel::Instance::FLAG_TRIANGLE_CULL_DISABLE;
-					}
+						if (XMVectorGetX(XMMatrixDeterminant(W)) > 0)
+						{
+							// There is a mismatch between object space winding and BLAS winding:
+							//	https://docs.microsoft.com/en-us/windows/win32/api/d3d12/ne-d3d12-d3d12_raytracing_instance_flags
+							instance.flags |= RaytracingAccelerationStructureDesc::TopLevel::Instance::FLAG_TRIANGLE_FRONT_COUNTERCLOCKWISE;
+						}
 
-					if (XMVectorGetX(XMMatrixDeterminant(W)) > 0)
-					{
-						// There is a mismatch between object space winding and BLAS winding:
-						//	https://docs.microsoft.com/en-us/windows/win32/api/d3d12/ne-d3d12-d3d12_raytracing_instance_flags
-						instance.flags |= RaytracingAccelerationStructureDesc::TopLevel::Instance::FLAG_TRIANGLE_FRONT_COUNTERCLOCKWISE;
+						void* dest = (void*)((size_t)TLAS_instancesMapped + (size_t)args.jobIndex * device->GetTopLevelAccelerationStructureInstanceSize());
+						device->WriteTopLevelAccelerationStructureInstance(&instance, dest);
 					}
-
-					void* dest = (void*)((size_t)TLAS_instancesMapped + (size_t)args.jobIndex * device->GetTopLevelAccelerationStructureInstanceSize());
-					device->WriteTopLevelAccelerationStructureInstance(&instance, dest);
 				}
 
 				// lightmap things:
-				if (object.IsLightmapRenderRequested() && dt > 0)
+				if (!headless && object.IsLightmapRenderRequested() && dt > 0)
 				{
 					if (!object.lightmap_render.IsValid())
 					{
@@ -4586,7 +4676,7 @@ namespace wi::scene
 					}
 				}
 
-				if (!object.lightmapTextureData.empty() && !object.lightmap.IsValid())
+				if (!headless && !object.lightmapTextureData.empty() && !object.lightmap.IsValid())
 				{
 					// Create a GPU-side per object lightmap if there is none yet, but the data exists already:
 					const size_t lightmap_size = object.lightmapTextureData.size();
@@ -4746,10 +4836,13 @@ namespace wi::scene
 				probe.render_dirty = true;
 			}
 
-			probe.CreateRenderData();
+			if (!IsHeadless())
+			{
+				probe.CreateRenderData();
+			}
 		}
 
-		if (probes.GetCount() == 0)
+		if (probes.GetCount() == 0 && !IsHeadless())
 		{
 			global_dynamic_probe.SetRealTime(true);
 			global_dynamic_probe.resolution = 64;
@@ -4762,6 +4855,11 @@ namespace wi::scene
 
 			ForceFieldComponent& force = forces[args.jobIndex];
 			Entity entity = forces.GetEntity(args.jobIndex);
+
+			// Same as the layer mask of the force field shader entity:
+			const LayerComponent* layer = layers.GetComponent(entity);
+			force.layerMask = layer == nullptr ? ~0u : layer->layerMask;
+
 			if (!transforms.Contains(entity))
 				return;
 			const TransformComponent& transform = *transforms.GetComponent(entity);
@@ -4857,6 +4955,22 @@ namespace wi::scene
 	}
 	void Scene::RunParticleUpdateSystem(wi::jobsystem::context& ctx)
 	{
+		if (IsHeadless())
+		{
+			// particle systems are only visual, and they need GPU resources, except for the CPU simulated emitters:
+			wi::jobsystem::Dispatch(ctx, (uint32_t)emitters.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
+
+				EmittedParticleSystem& emitter = emitters[args.jobIndex];
+				if (!emitter.IsCPUSimulationEnabled())
+					return;
+				const TransformComponent* transform = transforms.GetComponent(emitters.GetEntity(args.jobIndex));
+				if (transform == nullptr)
+					return;
+				emitter.UpdateCPU(*transform, dt);
+
+			});
+			return;
+		}
 		wi::jobsystem::Dispatch(ctx, (uint32_t)hairs.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
 
 			HairParticleSystem& hair = hairs[args.jobIndex];
@@ -5083,9 +5197,15 @@ namespace wi::scene
 			weather = weathers[0];
 			weather.most_important_light_index = ~0;
 
-			if (weather.IsOceanEnabled() && !ocean.IsValid())
+			if (weather.IsOceanEnabled())
 			{
-				OceanRegenerate();
+				const bool gpu_missing = !IsHeadless() && !ocean.IsValid();
+				const bool cpu_missing = weather.oceanParameters.cpu_simulation_dim > 0 && !ocean.IsCPUSimulationValid();
+				const bool cpu_changed = (ocean.IsValid() || ocean.IsCPUSimulationValid()) && weather.oceanParameters.cpu_simulation_dim != ocean.GetCreatedCPUSimulationDim(); // resolution changed or CPU simulation disabled
+				if (gpu_missing || cpu_missing || cpu_changed)
+				{
+					OceanRegenerate();
+				}
 			}
 			if (!weather.IsOceanEnabled())
 			{
@@ -5113,12 +5233,12 @@ namespace wi::scene
 			ocean.occlusionQueries[queryheap_idx] = -1; // invalidate query
 		}
 
-		if (ocean.IsValid())
+		if (ocean.IsValid() || ocean.IsCPUSimulationValid())
 		{
 			ocean.params = weather.oceanParameters;
 		}
 
-		if (weather.rain_amount > 0)
+		if (weather.rain_amount > 0 && !IsHeadless())
 		{
 			GraphicsDevice* device = wi::graphics::GetDevice();
 			rainEmitter.opacityCurveControlPeakStart = 0;
@@ -5344,12 +5464,14 @@ namespace wi::scene
 					script.script.clear();
 					script.script_hash = script.resource.GetScriptHash();
 					std::string str = script.resource.GetScript();
-					wi::lua::AttachScriptParameters(str, script.filename, wi::lua::GeneratePID(), "local function GetEntity() return " + std::to_string(entity) + "; end;", "");
+					script.script_pid = wi::lua::AttachScriptParameters(str, script.filename, wi::lua::GeneratePID(), "local function GetEntity() return " + std::to_string(entity) + "; end;", "");
 					wi::lua::CompileText(str, script.script);
 				}
 				if (!script.script.empty())
 				{
+					wi::lua::BeginScriptProfiling(script.script_pid);
 					wi::lua::RunBinaryData(script.script.data(), script.script.size(), script.filename.c_str());
+					wi::lua::EndScriptProfiling();
 				}
 
 				if (script.IsPlayingOnlyOnce())
@@ -5400,6 +5522,29 @@ namespace wi::scene
 			aabb_fonts[args.jobIndex] = font.GetAABB();
 		});
 	}
+	inline XMINT3 character_grid_cell(const XMFLOAT3& position, float cell_size_rcp)
+	{
+		// Clamped before the conversion to integer, because out of range conversion is undefined:
+		auto coord = [&](float value) {
+			return (int)std::floor(std::max(-1e9f, std::min(1e9f, value * cell_size_rcp)));
+		};
+		return XMINT3(coord(position.x), coord(position.y), coord(position.z));
+	}
+	// Cell range of an AABB that is not larger than the cell size, so it can overlap at most 2 cells per axis
+	inline void character_grid_cell_range(const AABB& aabb, float cell_size_rcp, XMINT3& cell_min, XMINT3& cell_max)
+	{
+		cell_min = character_grid_cell(aabb.getMin(), cell_size_rcp);
+		cell_max = character_grid_cell(aabb.getMax(), cell_size_rcp);
+		assert(cell_max.x - cell_min.x <= 1 && cell_max.y - cell_min.y <= 1 && cell_max.z - cell_min.z <= 1);
+		cell_max.x = std::min(cell_max.x, cell_min.x + 1);
+		cell_max.y = std::min(cell_max.y, cell_min.y + 1);
+		cell_max.z = std::min(cell_max.z, cell_min.z + 1);
+	}
+	constexpr uint32_t character_grid_hash(int x, int y, int z)
+	{
+		// Hash collisions only result in extra candidates, which are rejected by the exact capsule test
+		return (uint32_t(x) * 73856093u) ^ (uint32_t(y) * 19349663u) ^ (uint32_t(z) * 83492791u);
+	}
 	void Scene::RunCharacterUpdateSystem(wi::jobsystem::context& ctx)
 	{
 		if (dt == 0)
@@ -5410,6 +5555,7 @@ namespace wi::scene
 		static const int max_substeps = 6;
 
 		character_capsules.resize(characters.GetCount());
+		float max_capsule_extent = 0;
 		for (size_t i = 0; i < characters.GetCount(); ++i)
 		{
 			const HumanoidComponent* humanoid = humanoids.GetComponent(characters[i].humanoidEntity);
@@ -5419,7 +5565,66 @@ namespace wi::scene
 				continue;
 			}
 			character_capsules[i] = characters[i].GetCapsule();
+			const XMFLOAT3 halfwidth = character_capsules[i].getAABB().getHalfWidth();
+			max_capsule_extent = std::max(max_capsule_extent, std::max(halfwidth.x, std::max(halfwidth.y, halfwidth.z)) * 2);
+		}
+
+		// Character-character broadphase: every capsule is put into all grid cells that its AABB overlaps
+		//	The cell size is slightly larger than the largest capsule extent, so a capsule occupies at most 2 cells per axis (8 cells) even with rounding errors
+		//	Two capsules can only collide if their AABBs overlap, and in that case they will share at least one cell
+		character_grid_cell_size = std::max(0.01f, max_capsule_extent * 1.01f);
+		const float cell_size_rcp = 1.0f / character_grid_cell_size;
+		character_grid.resize(characters.GetCount() * 8);
+		wi::jobsystem::context grid_ctx;
+		wi::jobsystem::Dispatch(grid_ctx, (uint32_t)characters.GetCount(), 64, [&](wi::jobsystem::JobArgs args) {
+			CharacterGridEntry* entries = character_grid.data() + args.jobIndex * 8;
+			for (int i = 0; i < 8; ++i)
+			{
+				entries[i] = {};
+			}
+			const CharacterComponent& character = characters[args.jobIndex];
+			if (!character.IsActive() || character.IsCharacterToCharacterCollisionDisabled())
+				return;
+			XMINT3 cell_min, cell_max;
+			character_grid_cell_range(character_capsules[args.jobIndex].getAABB(), cell_size_rcp, cell_min, cell_max);
+			int count = 0;
+			for (int z = cell_min.z; z <= cell_max.z; ++z)
+			{
+				for (int y = cell_min.y; y <= cell_max.y; ++y)
+				{
+					for (int x = cell_min.x; x <= cell_max.x; ++x)
+					{
+						entries[count].cell = character_grid_hash(x, y, z);
+						entries[count].character_index = args.jobIndex;
+						count++;
+					}
+				}
+			}
+		});
+
+		// World collision candidates are collected once, instead of every query going through all objects:
+		character_world_candidates.clear();
+		const size_t objectCount = std::min(objects.GetCount(), aabb_objects.size());
+		for (size_t i = 0; i < objectCount; ++i)
+		{
+			const ObjectComponent& object = objects[i];
+			if (object.meshID == INVALID_ENTITY)
+				continue;
+			if ((object.GetFilterMask() & (FILTER_NAVIGATION_MESH | FILTER_COLLIDER)) == 0)
+				continue;
+			character_world_candidates.push_back((uint32_t)i);
+		}
+		// The candidates are put into a BVH, so every query only checks the objects near the character, instead of all candidates in the world:
+		character_world_candidate_aabbs.resize(character_world_candidates.size());
+		for (size_t i = 0; i < character_world_candidates.size(); ++i)
+		{
+			character_world_candidate_aabbs[i] = aabb_objects[character_world_candidates[i]];
 		}
+		character_world_bvh.Build(character_world_candidate_aabbs.data(), (uint32_t)character_world_candidate_aabbs.size());
+
+		wi::jobsystem::Wait(grid_ctx);
+		character_grid.erase(std::remove_if(character_grid.begin(), character_grid.end(), [](const CharacterGridEntry& entry) { return entry.character_index == ~0u; }), character_grid.end());
+		std::sort(character_grid.begin(), character_grid.end());
 
 		wi::jobsystem::Dispatch(ctx, (uint32_t)characters.GetCount(), 1, [&](wi::jobsystem::JobArgs args) {
 			CharacterComponent& character = characters[args.jobIndex];
@@ -5524,6 +5729,20 @@ namespace wi::scene
 					character.wall_intersect = false;
 				}
 
+				static thread_local wi::vector<uint32_t> character_candidates;
+				static thread_local wi::vector<uint32_t> world_candidates;
+				auto gather_world_candidates = [&](const Capsule& capsule) -> const wi::vector<uint32_t>& {
+					world_candidates.clear();
+					if (!character_world_candidates.empty())
+					{
+						character_world_bvh.Intersects(capsule.getAABB(), 0, [&](uint32_t index) {
+							world_candidates.push_back(character_world_candidates[index]);
+						});
+						std::sort(world_candidates.begin(), world_candidates.end()); // same order as in the full candidate list, so the result doesn't depend on the BVH layout
+					}
+					return world_candidates;
+				};
+
 				// Fixed timestep logic:
 				int steps = 0;
 				while (character.accumulator >= timestep && steps <= max_substeps)
@@ -5546,7 +5765,7 @@ namespace wi::scene
 
 					// Check ground:
 					Capsule capsule = Capsule(position, position + height, character.width);
-					CapsuleIntersectionResult result = Intersects(capsule, FILTER_NAVIGATION_MESH | FILTER_COLLIDER, ~layer);
+					CapsuleIntersectionResult result = Intersects(capsule, gather_world_candidates(capsule), FILTER_NAVIGATION_MESH | FILTER_COLLIDER, ~layer);
 					if (result.entity != INVALID_ENTITY)
 					{
 						XMVECTOR collisionNormal = XMLoadFloat3(&result.normal);
@@ -5570,7 +5789,7 @@ namespace wi::scene
 
 					// Check wall:
 					capsule = Capsule(position, position + height, character.width);
-					result = Intersects(capsule, FILTER_NAVIGATION_MESH | FILTER_COLLIDER, ~layer);
+					result = Intersects(capsule, gather_world_candidates(capsule), FILTER_NAVIGATION_MESH | FILTER_COLLIDER, ~layer);
 					if (result.entity != INVALID_ENTITY)
 					{
 						XMVECTOR collisionNormal = XMLoadFloat3(&result.normal);
@@ -5599,7 +5818,32 @@ namespace wi::scene
 						XMFLOAT3 incident_position = XMFLOAT3(0, 0, 0);
 						XMFLOAT3 incident_normal = XMFLOAT3(0, 0, 0);
 						float penetration_depth = 0;
-						for (size_t i = 0; i < character_capsules.size(); ++i)
+
+						// Gather nearby characters from the grid, sorted by index to keep the same collision order as a full search:
+						XMINT3 cell_min, cell_max;
+						character_grid_cell_range(capsule.getAABB(), cell_size_rcp, cell_min, cell_max);
+						character_candidates.clear();
+						for (int z = cell_min.z; z <= cell_max.z; ++z)
+						{
+							for (int y = cell_min.y; y <= cell_max.y; ++y)
+							{
+								for (int x = cell_min.x; x <= cell_max.x; ++x)
+								{
+									CharacterGridEntry key;
+									key.cell = character_grid_hash(x, y, z);
+									key.character_index = 0;
+									auto it = std::lower_bound(character_grid.begin(), character_grid.end(), key);
+									for (; it != character_grid.end() && it->cell == key.cell; ++it)
+									{
+										character_candidates.push_back(it->character_index);
+									}
+								}
+							}
+						}
+						std::sort(character_candidates.begin(), character_candidates.end());
+						character_candidates.erase(std::unique(character_candidates.begin(), character_candidates.end()), character_candidates.end());
+
+						for (uint32_t i : character_candidates)
 						{
 							if (i == args.jobIndex)
 								continue;
@@ -6117,6 +6361,9 @@ namespace wi::scene
 				const XMVECTOR rayOrigin_local = XMVector3Transform(rayOrigin, objectMat_Inverse);
 				const XMVECTOR rayDirection_local = XMVector3Normalize(XMVector3TransformNormal(rayDirection, objectMat_Inverse));
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedQueryCache* skinned_cache = GetSkinnedQueryCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned_cache != nullptr && skinned_cache->bvh.IsValid() ? skinned_cache->bvh : mesh->bvh;
+				const wi::vector<AABB>& bvh_leaf_aabbs = skinned_cache != nullptr && skinned_cache->bvh.IsValid() ? skinned_cache->bvh_leaf_aabbs : mesh->bvh_leaf_aabbs;
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex)
 				{
@@ -6129,15 +6376,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i0]) : SkinVertex(*mesh, *softbody, i0);
+						p1 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i1]) : SkinVertex(*mesh, *softbody, i1);
+						p2 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i2]) : SkinVertex(*mesh, *softbody, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i0]) : SkinVertex(*mesh, *armature, i0);
+						p1 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i1]) : SkinVertex(*mesh, *armature, i1);
+						p2 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i2]) : SkinVertex(*mesh, *armature, i2);
 					}
 					else
 					{
@@ -6215,12 +6462,12 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					Ray ray_local = Ray(rayOrigin_local, rayDirection_local);
 
-					mesh->bvh.Intersects(ray_local, 0, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.Intersects(ray_local, 0, [&](uint32_t index) {
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -6371,6 +6618,9 @@ namespace wi::scene
 				const XMVECTOR rayOrigin_local = XMVector3Transform(rayOrigin, objectMat_Inverse);
 				const XMVECTOR rayDirection_local = XMVector3Normalize(XMVector3TransformNormal(rayDirection, objectMat_Inverse));
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedQueryCache* skinned_cache = GetSkinnedQueryCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned_cache != nullptr && skinned_cache->bvh.IsValid() ? skinned_cache->bvh : mesh->bvh;
+				const wi::vector<AABB>& bvh_leaf_aabbs = skinned_cache != nullptr && skinned_cache->bvh.IsValid() ? skinned_cache->bvh_leaf_aabbs : mesh->bvh_leaf_aabbs;
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex)
 				{
@@ -6383,15 +6633,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i0]) : SkinVertex(*mesh, *softbody, i0);
+						p1 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i1]) : SkinVertex(*mesh, *softbody, i1);
+						p2 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i2]) : SkinVertex(*mesh, *softbody, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i0]) : SkinVertex(*mesh, *armature, i0);
+						p1 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i1]) : SkinVertex(*mesh, *armature, i1);
+						p2 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i2]) : SkinVertex(*mesh, *armature, i2);
 					}
 					else
 					{
@@ -6418,12 +6668,12 @@ namespace wi::scene
 					return false;
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					Ray ray_local = Ray(rayOrigin_local, rayDirection_local);
 
-					mesh->bvh.IntersectsFirst(ray_local, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.IntersectsFirst(ray_local, [&](uint32_t index) {
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -6569,6 +6819,9 @@ namespace wi::scene
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const XMMATRIX objectMatInverse = XMMatrixInverse(nullptr, objectMat);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedQueryCache* skinned_cache = GetSkinnedQueryCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned_cache != nullptr && skinned_cache->bvh.IsValid() ? skinned_cache->bvh : mesh->bvh;
+				const wi::vector<AABB>& bvh_leaf_aabbs = skinned_cache != nullptr && skinned_cache->bvh.IsValid() ? skinned_cache->bvh_leaf_aabbs : mesh->bvh_leaf_aabbs;
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
 				{
@@ -6581,15 +6834,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i0]) : SkinVertex(*mesh, *softbody, i0);
+						p1 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i1]) : SkinVertex(*mesh, *softbody, i1);
+						p2 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i2]) : SkinVertex(*mesh, *softbody, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i0]) : SkinVertex(*mesh, *armature, i0);
+						p1 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i1]) : SkinVertex(*mesh, *armature, i1);
+						p2 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i2]) : SkinVertex(*mesh, *armature, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -6720,7 +6973,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					XMFLOAT3 center_local;
 					float radius_local;
@@ -6728,8 +6981,8 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&sphere.radius), objectMatInverse)));
 					Sphere sphere_local = Sphere(center_local, radius_local);
 
-					mesh->bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -6800,6 +7053,14 @@ namespace wi::scene
 		return result;
 	}
 	Scene::CapsuleIntersectionResult Scene::Intersects(const Capsule& capsule, uint32_t filterMask, uint32_t layerMask, uint32_t lod) const
+	{
+		return Intersects_Capsule(capsule, nullptr, filterMask, layerMask, lod);
+	}
+	Scene::CapsuleIntersectionResult Scene::Intersects(const Capsule& capsule, const wi::vector<uint32_t>& object_candidates, uint32_t filterMask, uint32_t layerMask, uint32_t lod) const
+	{
+		return Intersects_Capsule(capsule, &object_candidates, filterMask, layerMask, lod);
+	}
+	Scene::CapsuleIntersectionResult Scene::Intersects_Capsule(const Capsule& capsule, const wi::vector<uint32_t>* object_candidates, uint32_t filterMask, uint32_t layerMask, uint32_t lod) const
 	{
 		CapsuleIntersectionResult result;
 
@@ -6860,8 +7121,12 @@ namespace wi::scene
 		if (filterMask & FILTER_OBJECT_ALL)
 		{
 			const size_t objectCount = std::min(objects.GetCount(), aabb_objects.size());
-			for (size_t objectIndex = 0; objectIndex < objectCount; ++objectIndex)
+			const size_t candidateCount = object_candidates == nullptr ? objectCount : object_candidates->size();
+			for (size_t candidateIndex = 0; candidateIndex < candidateCount; ++candidateIndex)
 			{
+				const size_t objectIndex = object_candidates == nullptr ? candidateIndex : (size_t)(*object_candidates)[candidateIndex];
+				if (objectIndex >= objectCount)
+					continue;
 				const AABB& aabb = aabb_objects[objectIndex];
 				if ((layerMask & aabb.layerMask) == 0)
 					continue;
@@ -6884,6 +7149,9 @@ namespace wi::scene
 				const XMMATRIX objectMat = XMLoadFloat4x4(&matrix_objects[objectIndex]);
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedQueryCache* skinned_cache = GetSkinnedQueryCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned_cache != nullptr && skinned_cache->bvh.IsValid() ? skinned_cache->bvh : mesh->bvh;
+				const wi::vector<AABB>& bvh_leaf_aabbs = skinned_cache != nullptr && skinned_cache->bvh.IsValid() ? skinned_cache->bvh_leaf_aabbs : mesh->bvh_leaf_aabbs;
 				const XMMATRIX objectMat_Inverse = XMMatrixInverse(nullptr, objectMat);
 				
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
@@ -6897,15 +7165,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i0]) : SkinVertex(*mesh, *softbody, i0);
+						p1 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i1]) : SkinVertex(*mesh, *softbody, i1);
+						p2 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i2]) : SkinVertex(*mesh, *softbody, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i0]) : SkinVertex(*mesh, *armature, i0);
+						p1 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i1]) : SkinVertex(*mesh, *armature, i1);
+						p2 = skinned_cache != nullptr ? XMLoadFloat3(&skinned_cache->positions[i2]) : SkinVertex(*mesh, *armature, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -7148,7 +7416,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					XMFLOAT3 base_local;
 					XMFLOAT3 tip_local;
@@ -7158,8 +7426,8 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&capsule.radius), objectMat_Inverse)));
 					AABB capsule_local_aabb = Capsule(base_local, tip_local, radius_local).getAABB();
 
-					mesh->bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index){
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index){
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -7458,10 +7726,19 @@ namespace wi::scene
 
 	XMFLOAT3 Scene::GetOceanPosAt(const XMFLOAT3& worldPosition) const
 	{
-		if (!ocean.IsValid())
+		if (!ocean.IsValid() && !ocean.IsCPUSimulationValid())
 			return worldPosition;
 		return ocean.GetDisplacedPosition(worldPosition);
 	}
+	void Scene::GetOceanPosAt(const XMFLOAT3* worldPositions, XMFLOAT3* results, size_t count) const
+	{
+		if (!ocean.IsValid() && !ocean.IsCPUSimulationValid())
+		{
+			std::copy(worldPositions, worldPositions + count, results);
+			return;
+		}
+		ocean.GetDisplacedPositions(worldPositions, results, count);
+	}
 
 	uint32_t Scene::ComputeObjectLODForView(const ObjectComponent& object, const AABB& aabb, const MeshComponent& mesh, const XMMATRIX& ViewProjection) const
 	{
@@ -7515,6 +7792,69 @@ namespace wi::scene
 		locker.unlock();
 	}
 
+	const Scene::SkinnedQueryCache* Scene::GetSkinnedQueryCache(Entity meshID, const MeshComponent& mesh, const SoftBodyPhysicsComponent* softbody, const ArmatureComponent* armature) const
+	{
+		if (!IsSkinnedQueryCacheEnabled())
+			return nullptr;
+
+		const bool use_softbody = softbody != nullptr && !softbody->boneData.empty();
+		const bool use_armature = !use_softbody && armature != nullptr && !armature->boneData.empty();
+		if (!use_softbody && !use_armature)
+			return nullptr;
+
+		skinned_query_caches_locker.lock();
+		std::unique_ptr<SkinnedQueryCache>& ptr = skinned_query_caches[meshID];
+		if (ptr == nullptr)
+		{
+			ptr = std::make_unique<SkinnedQueryCache>();
+		}
+		SkinnedQueryCache* cache = ptr.get();
+		skinned_query_caches_locker.unlock();
+
+		// The first query of the frame fills the cache, concurrent queries of the same mesh wait for it:
+		std::scoped_lock lock(cache->locker);
+		if (cache->frame == skinned_query_frame && cache->positions.size() == mesh.vertex_positions.size())
+			return cache;
+
+		SkinVertices(mesh, use_softbody ? softbody->boneData : armature->boneData, cache->positions);
+
+		if (use_armature && mesh.bvh.IsValid())
+		{
+			// The leaf AABBs are recomputed from skinned triangles, and the tree topology of the first build is kept, only the bounds are refitted:
+			const bool rebuild = !cache->bvh.IsValid() || cache->bvh_leaf_aabbs.size() != mesh.bvh_leaf_aabbs.size();
+			cache->bvh_leaf_aabbs.resize(mesh.bvh_leaf_aabbs.size());
+			for (size_t i = 0; i < mesh.bvh_leaf_aabbs.size(); ++i)
+			{
+				const AABB& src = mesh.bvh_leaf_aabbs[i];
+				const uint32_t triangleIndex = src.layerMask;
+				const uint32_t indexOffset = mesh.subsets[src.userdata].indexOffset;
+				const XMFLOAT3& p0 = cache->positions[mesh.indices[indexOffset + triangleIndex * 3 + 0]];
+				const XMFLOAT3& p1 = cache->positions[mesh.indices[indexOffset + triangleIndex * 3 + 1]];
+				const XMFLOAT3& p2 = cache->positions[mesh.indices[indexOffset + triangleIndex * 3 + 2]];
+				AABB& dst = cache->bvh_leaf_aabbs[i];
+				dst = AABB(wi::math::Min(p0, wi::math::Min(p1, p2)), wi::math::Max(p0, wi::math::Max(p1, p2)));
+				dst.layerMask = src.layerMask;
+				dst.userdata = src.userdata;
+			}
+			if (rebuild)
+			{
+				cache->bvh.Build(cache->bvh_leaf_aabbs.data(), (uint32_t)cache->bvh_leaf_aabbs.size());
+			}
+			else
+			{
+				cache->bvh.Refit(cache->bvh_leaf_aabbs.data());
+			}
+		}
+		else
+		{
+			cache->bvh_leaf_aabbs.clear();
+			cache->bvh = {};
+		}
+
+		cache->frame = skinned_query_frame;
+		return cache;
+	}
+
 	XMVECTOR SkinVertex(const MeshComponent& mesh, const wi::vector<ShaderTransform>& boneData, uint32_t index, XMVECTOR* N)
 	{
 		XMVECTOR P = XMLoadFloat3(&mesh.vertex_positions[index]);
@@ -7565,6 +7905,37 @@ namespace wi::scene
 
 		return P;
 	}
+	void SkinVertices(const MeshComponent& mesh, const wi::vector<ShaderTransform>& boneData, wi::vector<XMFLOAT3>& positions)
+	{
+		const size_t vertex_count = mesh.vertex_positions.size();
+		positions.resize(vertex_count);
+
+		// Bone matrices are converted only once for the whole mesh:
+		static thread_local wi::vector<XMMATRIX> bone_matrices;
+		bone_matrices.resize(boneData.size());
+		for (size_t i = 0; i < boneData.size(); ++i)
+		{
+			const XMFLOAT4X4 mat = boneData[i].GetMatrix();
+			bone_matrices[i] = XMMatrixTranspose(XMLoadFloat4x4(&mat));
+		}
+
+		const uint32_t influence_div4 = mesh.GetBoneInfluenceDiv4();
+		for (size_t index = 0; index < vertex_count; ++index)
+		{
+			const XMVECTOR P = XMLoadFloat3(&mesh.vertex_positions[index]);
+			XMVECTOR skinnedP = XMVectorZero();
+			for (uint32_t influence = 0; influence < influence_div4; ++influence)
+			{
+				const XMUINT4& ind = influence == 0 ? mesh.vertex_boneindices[index] : mesh.vertex_boneindices2[index];
+				const XMFLOAT4& wei = influence == 0 ? mesh.vertex_boneweights[index] : mesh.vertex_boneweights2[index];
+				skinnedP = XMVectorMultiplyAdd(XMVector3Transform(P, bone_matrices[ind.x]), XMVectorReplicate(wei.x), skinnedP);
+				skinnedP = XMVectorMultiplyAdd(XMVector3Transform(P, bone_matrices[ind.y]), XMVectorReplicate(wei.y), skinnedP);
+				skinnedP = XMVectorMultiplyAdd(XMVector3Transform(P, bone_matrices[ind.z]), XMVectorReplicate(wei.z), skinnedP);
+				skinnedP = XMVectorMultiplyAdd(XMVector3Transform(P, bone_matrices[ind.w]), XMVectorReplicate(wei.w), skinnedP);
+			}
+			XMStoreFloat3(&positions[index], skinnedP);
+		}
+	}
 	XMVECTOR SkinVertex(const MeshComponent& mesh, const ArmatureComponent& armature, uint32_t index, XMVECTOR* N)
 	{
 		return SkinVertex(mesh, armature.boneData, index, N);
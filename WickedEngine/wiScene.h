@@ -18,6 +18,7 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
 #include <limits>
 
 namespace wi::scene
@@ -71,9 +72,39 @@ namespace wi::scene
 		enum FLAGS
 		{
 			EMPTY = 0,
+			SKINNED_QUERY_CACHE = 1 << 0,
+			HEADLESS = 1 << 1,
 		};
 		uint32_t flags = EMPTY;
 
+		// Enable caching of skinned vertex positions for CPU intersection queries (Intersects(), IntersectsFirst())
+		//	The first query that touches a skinned or soft body mesh in a frame skins all of its vertices at once, then all later queries in the same frame reuse them
+		//	If the mesh has a BVH, it will be refitted to the skinned positions (only for armature skinning)
+		void SetSkinnedQueryCacheEnabled(bool value = true) { if (value) { flags |= SKINNED_QUERY_CACHE; } else { flags &= ~SKINNED_QUERY_CACHE; } }
+		bool IsSkinnedQueryCacheEnabled() const { return flags & SKINNED_QUERY_CACHE; }
+
+		// Headless mode: Update() only runs the CPU simulation (transforms, animations, physics, springs, colliders, characters...)
+		//	Update() doesn't create GPU resources and doesn't upload GPU scene data, rendering the scene is not supported
+		//	Mesh GPU buffers are still created by MeshComponent::CreateRenderData() (when meshes are created or loaded) if there is a graphics device, only the device decides that
+		//	This is always enabled when there is no graphics device, for example on a dedicated server
+		void SetHeadless(bool value = true) { if (value) { flags |= HEADLESS; } else { flags &= ~HEADLESS; } }
+		bool IsHeadless() const { return (flags & HEADLESS) || wi::graphics::GetDevice() == nullptr; }
+
+		struct SkinnedQueryCache
+		{
+			std::mutex locker;
+			uint32_t frame = ~0u;
+			wi::vector<XMFLOAT3> positions;
+			wi::vector<wi::primitive::AABB> bvh_leaf_aabbs;
+			wi::BVH bvh;
+		};
+		mutable wi::unordered_map<wi::ecs::Entity, std::unique_ptr<SkinnedQueryCache>> skinned_query_caches; // per mesh
+		mutable wi::SpinLock skinned_query_caches_locker;
+		uint32_t skinned_query_frame = 0; // incremented in every Update() after the armature and soft body update, older cache entries are refilled when they are used
+		// Returns the skinned vertex position cache of a mesh for the current frame, or nullptr if it's not skinned or caching is disabled
+		//	This is thread safe
+		const SkinnedQueryCache* GetSkinnedQueryCache(wi::ecs::Entity meshID, const MeshComponent& mesh, const SoftBodyPhysicsComponent* softbody, const ArmatureComponent* armature) const;
+
 		float time = 0;
 		CameraComponent camera; // for LOD and 3D sound update
 		std::shared_ptr<void> physics_scene;
@@ -91,6 +122,18 @@ namespace wi::scene
 		bool IsLightmapUpdateRequested() const { return lightmap_request_allocator.load() > 0; }
 		wi::Archive optimized_instatiation_data;
 		wi::vector<wi::primitive::Capsule> character_capsules;
+		// Spatial hash of character_capsules for character-character collision broadphase, rebuilt in every RunCharacterUpdateSystem():
+		struct CharacterGridEntry
+		{
+			uint32_t cell = ~0u; // hashed cell coordinate
+			uint32_t character_index = ~0u;
+			constexpr bool operator<(const CharacterGridEntry& other) const { return cell < other.cell || (cell == other.cell && character_index < other.character_index); }
+		};
+		wi::vector<CharacterGridEntry> character_grid; // sorted by cell
+		float character_grid_cell_size = 1;
+		wi::vector<uint32_t> character_world_candidates; // object indices that characters can collide with, shared by all character world collision queries
+		wi::vector<wi::primitive::AABB> character_world_candidate_aabbs;
+		wi::BVH character_world_bvh; // BVH of character_world_candidate_aabbs, leaf indices refer to character_world_candidates
 		wi::unordered_map<wi::ecs::Entity, wi::vector<wi::ecs::Entity>> topdown_hierarchy; // managed by BuildTopDownHierarchy() in every Update(), allows parent->children traversal
 		wi::jobsystem::context topdown_hierarchy_workload;
 
@@ -101,6 +144,12 @@ namespace wi::scene
 		wi::vector<wi::primitive::AABB> aabb_decals;
 		wi::vector<wi::primitive::AABB> aabb_fonts;
 
+		// Structure of arrays copies of the AABB culling streams for SIMD culling with Frustum::CheckBoxesFast(), rebuilt in every Update():
+		wi::primitive::AABBArray aabb_objects_soa;
+		wi::primitive::AABBArray aabb_lights_soa;
+		wi::primitive::AABBArray aabb_probes_soa;
+		wi::primitive::AABBArray aabb_decals_soa;
+
 		// Separate stream of world matrices:
 		wi::vector<XMFLOAT4X4> matrix_objects;
 		wi::vector<XMFLOAT4X4> matrix_objects_prev;
@@ -283,7 +332,7 @@ namespace wi::scene
 
 		// Ocean GPU state:
 		wi::Ocean ocean;
-		void OceanRegenerate() { ocean.Create(weather.oceanParameters); }
+		void OceanRegenerate() { ocean.Create(weather.oceanParameters, !IsHeadless()); }
 
 		// Simple water ripple sprites:
 		mutable wi::vector<wi::Sprite> waterRipples;
@@ -456,8 +505,24 @@ namespace wi::scene
 
 		void GatherChildren(wi::ecs::Entity parent, wi::vector<wi::ecs::Entity>& children) const;
 
+		// Options for partial scene serialization
+		struct SerializeOptions
+		{
+			// Reading: if not empty, only the component managers with these names are read (for example "wi::scene::Scene::transforms"), the others are skipped without parsing them
+			wi::unordered_set<std::string> components;
+			// Reading: if valid, only the components of entities whose position is inside a spatial index cell that intersects this region are read
+			//	This only has an effect if the archive was written with a spatial index
+			//	Components of entities without a transform (for example meshes and materials) are always read
+			//	Entities in a hierarchy are indexed by the position of the hierarchy root, so a child is only read if its root's cell intersects the region, and then the whole hierarchy is read
+			wi::primitive::AABB region;
+			// Writing: if greater than zero, a spatial index is written with cells of this size, which allows loading by region
+			float spatial_index_cell_size = 0;
+		};
+
 		// Read/write whole scene into an archive
 		void Serialize(wi::Archive& archive);
+		// Read/write scene into an archive with options for partial serialization
+		void Serialize(wi::Archive& archive, const SerializeOptions& options);
 
 		void RunAnimationUpdateSystem(wi::jobsystem::context& ctx);
 		void RunTransformUpdateSystem(wi::jobsystem::context& ctx);
@@ -536,6 +601,10 @@ namespace wi::scene
 
 		using CapsuleIntersectionResult = SphereIntersectionResult;
 		CapsuleIntersectionResult Intersects(const wi::primitive::Capsule& capsule, uint32_t filterMask = wi::enums::FILTER_OPAQUE, uint32_t layerMask = ~0, uint32_t lod = 0) const;
+		// Capsule intersection that only checks the specified object indices instead of all objects (other filter types are not affected)
+		//	This is useful when many queries are made against the same small subset of objects, the candidate list can be built once and shared by them
+		CapsuleIntersectionResult Intersects(const wi::primitive::Capsule& capsule, const wi::vector<uint32_t>& object_candidates, uint32_t filterMask = wi::enums::FILTER_OPAQUE, uint32_t layerMask = ~0, uint32_t lod = 0) const;
+		CapsuleIntersectionResult Intersects_Capsule(const wi::primitive::Capsule& capsule, const wi::vector<uint32_t>* object_candidates, uint32_t filterMask, uint32_t layerMask, uint32_t lod) const; // implementation of capsule intersection, object_candidates can be nullptr to check all objects
 
 		// Goes through the hierarchy backwards and computes entity's world space matrix:
 		XMMATRIX ComputeEntityMatrixRecursive(wi::ecs::Entity entity) const;
@@ -580,8 +649,11 @@ namespace wi::scene
 		// Returns the approximate position on the ocean surface seen from a position in world space.
 		//	If current weather doesn't have ocean enabled, returns the world position itself.
 		//	The result position is approximate because it involves reading back from GPU to the CPU, so the result can be delayed compared to the current GPU simulation.
+		//	If the CPU ocean simulation is enabled (OceanParameters::cpu_simulation_dim), the result is not delayed, it is the surface of the current frame, which also works in headless mode.
 		//	Note that the input position to this function will be taken on the XZ plane and modified by the displacement map's XZ value, and the Y (vertical) position will be taken from the ocean water height and displacement map only.
 		XMFLOAT3 GetOceanPosAt(const XMFLOAT3& worldPosition) const;
+		// Batched version of GetOceanPosAt()
+		void GetOceanPosAt(const XMFLOAT3* worldPositions, XMFLOAT3* results, size_t count) const;
 
 		// Computes the LOD for an object AABB for a given view projection matrix
 		uint32_t ComputeObjectLODForView(const ObjectComponent& object, const wi::primitive::AABB& aabb, const MeshComponent& mesh, const XMMATRIX& ViewProjection) const;
@@ -600,6 +672,10 @@ namespace wi::scene
 	// Returns skinned vertex position
 	//	N : normal (out, optional)
 	XMVECTOR SkinVertex(const MeshComponent& mesh, const wi::vector<ShaderTransform>& boneData, uint32_t index, XMVECTOR* N = nullptr);
+	// Skins all vertex positions of a mesh at once
+	//	This is much faster than calling SkinVertex() for every vertex, because the bone matrices are only loaded once
+	//	positions : the result array, it will be resized to the vertex count
+	void SkinVertices(const MeshComponent& mesh, const wi::vector<ShaderTransform>& boneData, wi::vector<XMFLOAT3>& positions);
 	// Returns skinned vertex position in armature local space
 	//	N : normal (out, optional)
 	XMVECTOR SkinVertex(const MeshComponent& mesh, const ArmatureComponent& armature, uint32_t index, XMVECTOR* N = nullptr);
@@ -535,6 +535,12 @@ Luna<Scene_BindLua>::FunctionType Scene_BindLua::methods[] = {
 	lunamethod(Scene_BindLua, UpdateHierarchy),
 	lunamethod(Scene_BindLua, Intersects),
 	lunamethod(Scene_BindLua, IntersectsFirst),
+	lunamethod(Scene_BindLua, IntersectsRays),
+	lunamethod(Scene_BindLua, GetTransformPositions),
+	lunamethod(Scene_BindLua, GetTransformMatrices),
+	lunamethod(Scene_BindLua, SetTransformPositions),
+	lunamethod(Scene_BindLua, SetTransformRotations),
+	lunamethod(Scene_BindLua, SetTransformScales),
 	lunamethod(Scene_BindLua, FindAllEntities),
 	lunamethod(Scene_BindLua, Entity_FindByName),
 	lunamethod(Scene_BindLua, Entity_Remove),
@@ -706,6 +712,55 @@ Luna<Scene_BindLua>::PropertyType Scene_BindLua::properties[] = {
 	{ NULL, NULL }
 };
 
+// Bulk access helpers, these work with flat number tables (for example positions are stored as x0,y0,z0,x1,y1,z1,...)
+//	The result table can be provided by the caller, in that case it is overwritten in place and no new table is allocated
+static inline lua_Number GetTableNumber(lua_State* L, int table, lua_Integer index)
+{
+	lua_rawgeti(L, table, index);
+	lua_Number value = lua_tonumber(L, -1);
+	lua_pop(L, 1);
+	return value;
+}
+static inline Entity GetTableEntity(lua_State* L, int table, lua_Integer index)
+{
+	lua_rawgeti(L, table, index);
+	Entity value = (Entity)lua_tointeger(L, -1);
+	lua_pop(L, 1);
+	return value;
+}
+static inline void SetTableNumber(lua_State* L, int table, lua_Integer index, lua_Number value)
+{
+	lua_pushnumber(L, value);
+	lua_rawseti(L, table, index);
+}
+// Pushes a math object result, if an object of the same type was given as the first argument, that is overwritten and returned instead of allocating a new one
+template<typename T, typename V>
+static inline void PushMathResult(lua_State* L, const V& value)
+{
+	T* result = wi::lua::SGetArgCount(L) > 0 ? Luna<T>::lightcheck(L, 1) : nullptr;
+	if (result != nullptr)
+	{
+		*result = T(value);
+		lua_pushvalue(L, 1);
+	}
+	else
+	{
+		Luna<T>::push(L, value);
+	}
+}
+static inline int PushResultTable(lua_State* L, int stackpos, int size)
+{
+	if (lua_istable(L, stackpos))
+	{
+		lua_pushvalue(L, stackpos);
+	}
+	else
+	{
+		lua_createtable(L, size, 0);
+	}
+	return lua_gettop(L);
+}
+
 int Scene_BindLua::Update(lua_State* L)
 {
 	int argc = wi::lua::SGetArgCount(L);
@@ -1037,6 +1092,212 @@ int Scene_BindLua::IntersectsFirst(lua_State* L)
 	return 0;
 }
 
+int Scene_BindLua::IntersectsRays(lua_State* L)
+{
+	int argc = wi::lua::SGetArgCount(L);
+	if (argc > 1 && lua_istable(L, 1) && lua_istable(L, 2))
+	{
+		float tmax = std::numeric_limits<float>::max();
+		uint32_t filterMask = wi::enums::FILTER_ALL;
+		uint32_t layerMask = ~0u;
+		uint lod = 0;
+		if (argc > 2)
+		{
+			tmax = wi::lua::SGetFloat(L, 3);
+			if (argc > 3)
+			{
+				filterMask = (uint32_t)wi::lua::SGetInt(L, 4);
+				if (argc > 4)
+				{
+					layerMask = (uint32_t)wi::lua::SGetInt(L, 5);
+					if (argc > 5)
+					{
+						lod = (uint32_t)wi::lua::SGetInt(L, 6);
+					}
+				}
+			}
+		}
+
+		const size_t count = std::min(lua_rawlen(L, 1), lua_rawlen(L, 2)) / 3;
+		static thread_local wi::vector<wi::primitive::Ray> rays;
+		static thread_local wi::vector<wi::scene::Scene::RayIntersectionResult> results;
+		rays.resize(count);
+		results.resize(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const lua_Integer idx = lua_Integer(i * 3 + 1);
+			XMFLOAT3 origin = XMFLOAT3(
+				(float)GetTableNumber(L, 1, idx + 0),
+				(float)GetTableNumber(L, 1, idx + 1),
+				(float)GetTableNumber(L, 1, idx + 2)
+			);
+			XMFLOAT3 direction = XMFLOAT3(
+				(float)GetTableNumber(L, 2, idx + 0),
+				(float)GetTableNumber(L, 2, idx + 1),
+				(float)GetTableNumber(L, 2, idx + 2)
+			);
+			rays[i] = wi::primitive::Ray(origin, direction, 0, tmax);
+		}
+
+		// The rays are independent, so larger batches are traced in parallel:
+		const wi::scene::Scene* intersect_scene = scene;
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, (uint32_t)count, 16, [&](wi::jobsystem::JobArgs args) {
+			results[args.jobIndex] = intersect_scene->Intersects(rays[args.jobIndex], filterMask, layerMask, lod);
+		});
+		wi::jobsystem::Wait(ctx);
+
+		// Results are 8 numbers per ray: entity, distance, position.xyz, normal.xyz
+		int result_table = PushResultTable(L, 7, int(count * 8));
+		for (size_t i = 0; i < count; ++i)
+		{
+			const wi::scene::Scene::RayIntersectionResult& result = results[i];
+			const lua_Integer idx = lua_Integer(i * 8 + 1);
+			SetTableNumber(L, result_table, idx + 0, (lua_Number)result.entity);
+			SetTableNumber(L, result_table, idx + 1, result.entity == INVALID_ENTITY ? 0 : result.distance);
+			SetTableNumber(L, result_table, idx + 2, result.position.x);
+			SetTableNumber(L, result_table, idx + 3, result.position.y);
+			SetTableNumber(L, result_table, idx + 4, result.position.z);
+			SetTableNumber(L, result_table, idx + 5, result.normal.x);
+			SetTableNumber(L, result_table, idx + 6, result.normal.y);
+			SetTableNumber(L, result_table, idx + 7, result.normal.z);
+		}
+		wi::lua::SSetInt(L, (int)count);
+		return 2;
+	}
+	else
+	{
+		wi::lua::SError(L, "Scene::IntersectsRays(table origins, table directions, opt float tmax = FLT_MAX, opt uint filterMask = ~0u, opt uint layerMask = ~0u, opt uint lod = 0, opt table result) not enough arguments!");
+	}
+	return 0;
+}
+
+int Scene_BindLua::GetTransformPositions(lua_State* L)
+{
+	if (wi::lua::SGetArgCount(L) > 0 && lua_istable(L, 1))
+	{
+		const size_t count = lua_rawlen(L, 1);
+		int result_table = PushResultTable(L, 2, int(count * 3));
+		for (size_t i = 0; i < count; ++i)
+		{
+			XMFLOAT3 position = XMFLOAT3(0, 0, 0);
+			const TransformComponent* transform = scene->transforms.GetComponent(GetTableEntity(L, 1, lua_Integer(i + 1)));
+			if (transform != nullptr)
+			{
+				position = transform->GetPosition();
+			}
+			const lua_Integer idx = lua_Integer(i * 3 + 1);
+			SetTableNumber(L, result_table, idx + 0, position.x);
+			SetTableNumber(L, result_table, idx + 1, position.y);
+			SetTableNumber(L, result_table, idx + 2, position.z);
+		}
+		return 1;
+	}
+	else
+	{
+		wi::lua::SError(L, "Scene::GetTransformPositions(table entities, opt table result) not enough arguments!");
+	}
+	return 0;
+}
+int Scene_BindLua::GetTransformMatrices(lua_State* L)
+{
+	if (wi::lua::SGetArgCount(L) > 0 && lua_istable(L, 1))
+	{
+		const size_t count = lua_rawlen(L, 1);
+		int result_table = PushResultTable(L, 2, int(count * 16));
+		for (size_t i = 0; i < count; ++i)
+		{
+			XMFLOAT4X4 world = wi::math::IDENTITY_MATRIX;
+			const TransformComponent* transform = scene->transforms.GetComponent(GetTableEntity(L, 1, lua_Integer(i + 1)));
+			if (transform != nullptr)
+			{
+				world = transform->world;
+			}
+			const lua_Integer idx = lua_Integer(i * 16 + 1);
+			for (int j = 0; j < 16; ++j)
+			{
+				SetTableNumber(L, result_table, idx + j, world.m[j / 4][j % 4]);
+			}
+		}
+		return 1;
+	}
+	else
+	{
+		wi::lua::SError(L, "Scene::GetTransformMatrices(table entities, opt table result) not enough arguments!");
+	}
+	return 0;
+}
+int Scene_BindLua::SetTransformPositions(lua_State* L)
+{
+	if (wi::lua::SGetArgCount(L) > 1 && lua_istable(L, 1) && lua_istable(L, 2))
+	{
+		const size_t count = std::min(lua_rawlen(L, 1), lua_rawlen(L, 2) / 3);
+		for (size_t i = 0; i < count; ++i)
+		{
+			TransformComponent* transform = scene->transforms.GetComponent(GetTableEntity(L, 1, lua_Integer(i + 1)));
+			if (transform == nullptr)
+				continue;
+			const lua_Integer idx = lua_Integer(i * 3 + 1);
+			transform->translation_local.x = (float)GetTableNumber(L, 2, idx + 0);
+			transform->translation_local.y = (float)GetTableNumber(L, 2, idx + 1);
+			transform->translation_local.z = (float)GetTableNumber(L, 2, idx + 2);
+			transform->SetDirty();
+		}
+	}
+	else
+	{
+		wi::lua::SError(L, "Scene::SetTransformPositions(table entities, table positions) not enough arguments!");
+	}
+	return 0;
+}
+int Scene_BindLua::SetTransformRotations(lua_State* L)
+{
+	if (wi::lua::SGetArgCount(L) > 1 && lua_istable(L, 1) && lua_istable(L, 2))
+	{
+		const size_t count = std::min(lua_rawlen(L, 1), lua_rawlen(L, 2) / 4);
+		for (size_t i = 0; i < count; ++i)
+		{
+			TransformComponent* transform = scene->transforms.GetComponent(GetTableEntity(L, 1, lua_Integer(i + 1)));
+			if (transform == nullptr)
+				continue;
+			const lua_Integer idx = lua_Integer(i * 4 + 1);
+			transform->rotation_local.x = (float)GetTableNumber(L, 2, idx + 0);
+			transform->rotation_local.y = (float)GetTableNumber(L, 2, idx + 1);
+			transform->rotation_local.z = (float)GetTableNumber(L, 2, idx + 2);
+			transform->rotation_local.w = (float)GetTableNumber(L, 2, idx + 3);
+			transform->SetDirty();
+		}
+	}
+	else
+	{
+		wi::lua::SError(L, "Scene::SetTransformRotations(table entities, table quaternions) not enough arguments!");
+	}
+	return 0;
+}
+int Scene_BindLua::SetTransformScales(lua_State* L)
+{
+	if (wi::lua::SGetArgCount(L) > 1 && lua_istable(L, 1) && lua_istable(L, 2))
+	{
+		const size_t count = std::min(lua_rawlen(L, 1), lua_rawlen(L, 2) / 3);
+		for (size_t i = 0; i < count; ++i)
+		{
+			TransformComponent* transform = scene->transforms.GetComponent(GetTableEntity(L, 1, lua_Integer(i + 1)));
+			if (transform == nullptr)
+				continue;
+			const lua_Integer idx = lua_Integer(i * 3 + 1);
+			transform->scale_local.x = (float)GetTableNumber(L, 2, idx + 0);
+			transform->scale_local.y = (float)GetTableNumber(L, 2, idx + 1);
+			transform->scale_local.z = (float)GetTableNumber(L, 2, idx + 2);
+			transform->SetDirty();
+		}
+	}
+	else
+	{
+		wi::lua::SError(L, "Scene::SetTransformScales(table entities, table scales) not enough arguments!");
+	}
+	return 0;
+}
+
 int Scene_BindLua::Component_CreateName(lua_State* L)
 {
 	int argc = wi::lua::SGetArgCount(L);
@@ -3746,8 +4007,7 @@ int TransformComponent_BindLua::MatrixTransform(lua_State* L)
 }
 int TransformComponent_BindLua::GetMatrix(lua_State* L)
 {
-	XMMATRIX M = XMLoadFloat4x4(&component->world);
-	Luna<Matrix_BindLua>::push(L, M);
+	PushMathResult<Matrix_BindLua>(L, component->world);
 	return 1;
 }
 int TransformComponent_BindLua::ClearTransform(lua_State* L)
@@ -3762,32 +4022,32 @@ int TransformComponent_BindLua::UpdateTransform(lua_State* L)
 }
 int TransformComponent_BindLua::GetPosition(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, component->GetPosition());
+	PushMathResult<Vector_BindLua>(L, component->GetPosition());
 	return 1;
 }
 int TransformComponent_BindLua::GetRotation(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, component->GetRotation());
+	PushMathResult<Vector_BindLua>(L, component->GetRotation());
 	return 1;
 }
 int TransformComponent_BindLua::GetScale(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, component->GetScale());
+	PushMathResult<Vector_BindLua>(L, component->GetScale());
 	return 1;
 }
 int TransformComponent_BindLua::GetForward(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, component->GetForward());
+	PushMathResult<Vector_BindLua>(L, component->GetForward());
 	return 1;
 }
 int TransformComponent_BindLua::GetUp(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, component->GetUp());
+	PushMathResult<Vector_BindLua>(L, component->GetUp());
 	return 1;
 }
 int TransformComponent_BindLua::GetRight(lua_State* L)
 {
-	Luna<Vector_BindLua>::push(L, component->GetRight());
+	PushMathResult<Vector_BindLua>(L, component->GetRight());
 	return 1;
 }
 int TransformComponent_BindLua::IsDirty(lua_State *L)
@@ -42,6 +42,13 @@ namespace wi::lua::scene
 
 		int Intersects(lua_State* L);
 		int IntersectsFirst(lua_State* L);
+		int IntersectsRays(lua_State* L);
+
+		int GetTransformPositions(lua_State* L);
+		int GetTransformMatrices(lua_State* L);
+		int SetTransformPositions(lua_State* L);
+		int SetTransformRotations(lua_State* L);
+		int SetTransformScales(lua_State* L);
 
 		int FindAllEntities(lua_State* L);
 		int Entity_FindByName(lua_State* L);
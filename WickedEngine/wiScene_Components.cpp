@@ -607,6 +607,49 @@ namespace wi::scene
 			morph.offset_nor = ~0ull;
 		}
 	}
+	// Normalize weights:
+	//	Note: if multiple influence streams are present,
+	//	we have to normalize them together, not separately
+	static void NormalizeBoneWeights(XMFLOAT4& weights0, XMFLOAT4* weights1)
+	{
+		float weights[8] = {};
+		weights[0] = weights0.x;
+		weights[1] = weights0.y;
+		weights[2] = weights0.z;
+		weights[3] = weights0.w;
+		if (weights1 != nullptr)
+		{
+			weights[4] = weights1->x;
+			weights[5] = weights1->y;
+			weights[6] = weights1->z;
+			weights[7] = weights1->w;
+		}
+		float sum = 0;
+		for (auto& weight : weights)
+		{
+			sum += weight;
+		}
+		if (sum > 0)
+		{
+			const float norm = 1.0f / sum;
+			for (auto& weight : weights)
+			{
+				weight *= norm;
+			}
+		}
+		// Store back normalized weights:
+		weights0.x = weights[0];
+		weights0.y = weights[1];
+		weights0.z = weights[2];
+		weights0.w = weights[3];
+		if (weights1 != nullptr)
+		{
+			weights1->x = weights[4];
+			weights1->y = weights[5];
+			weights1->z = weights[6];
+			weights1->w = weights[7];
+		}
+	}
 	void MeshComponent::CreateRenderData()
 	{
 		DeleteRenderData();
@@ -793,6 +836,17 @@ namespace wi::scene
 			}
 		}
 
+		if (device == nullptr)
+		{
+			// Headless: only the CPU side data is processed, the bone weights are normalized the same way as when creating the GPU buffer
+			const bool second_stream = GetBoneInfluenceDiv4() > 1;
+			for (size_t i = 0; i < vertex_boneweights.size(); ++i)
+			{
+				NormalizeBoneWeights(vertex_boneweights[i], second_stream ? &vertex_boneweights2[i] : nullptr);
+			}
+			return;
+		}
+
 		// Determine UV range for normalization:
 		size_t uv_stride = sizeof(Vertex_UVS);
 		Format uv_format = Vertex_UVS::FORMAT;
@@ -1162,46 +1216,7 @@ namespace wi::scene
 				assert(vertex_boneindices2.size() == vertex_boneweights2.size()); // must have same number of indices as weights
 				for (size_t i = 0; i < vertex_boneindices.size(); ++i)
 				{
-					// Normalize weights:
-					//	Note: if multiple influence streams are present,
-					//	we have to normalize them together, not separately
-					float weights[8] = {};
-					weights[0] = vertex_boneweights[i].x;
-					weights[1] = vertex_boneweights[i].y;
-					weights[2] = vertex_boneweights[i].z;
-					weights[3] = vertex_boneweights[i].w;
-					if (influence_div4 > 1)
-					{
-						weights[4] = vertex_boneweights2[i].x;
-						weights[5] = vertex_boneweights2[i].y;
-						weights[6] = vertex_boneweights2[i].z;
-						weights[7] = vertex_boneweights2[i].w;
-					}
-					float sum = 0;
-					for (auto& weight : weights)
-					{
-						sum += weight;
-					}
-					if (sum > 0)
-					{
-						const float norm = 1.0f / sum;
-						for (auto& weight : weights)
-						{
-							weight *= norm;
-						}
-					}
-					// Store back normalized weights:
-					vertex_boneweights[i].x = weights[0];
-					vertex_boneweights[i].y = weights[1];
-					vertex_boneweights[i].z = weights[2];
-					vertex_boneweights[i].w = weights[3];
-					if (influence_div4 > 1)
-					{
-						vertex_boneweights2[i].x = weights[4];
-						vertex_boneweights2[i].y = weights[5];
-						vertex_boneweights2[i].z = weights[6];
-						vertex_boneweights2[i].w = weights[7];
-					}
+					NormalizeBoneWeights(vertex_boneweights[i], influence_div4 > 1 ? &vertex_boneweights2[i] : nullptr);
 
 					Vertex_BON vert;
 					vert.FromFULL(vertex_boneindices[i], vertex_boneweights[i]);
@@ -1510,6 +1525,123 @@ namespace wi::scene
 		}
 		bvh.Build(bvh_leaf_aabbs.data(), (uint32_t)bvh_leaf_aabbs.size());
 	}
+	// Grid cell hash for vertex welding, same as the hash of the character spatial grid
+	static constexpr uint32_t weld_grid_hash(int x, int y, int z)
+	{
+		return (uint32_t(x) * 73856093u) ^ (uint32_t(y) * 19349663u) ^ (uint32_t(z) * 83492791u);
+	}
+	// Grid cell coordinate, clamped before the conversion to integer (also for NaN), because out of range conversion is undefined
+	static inline int weld_grid_cell(float value)
+	{
+		const float cell = std::floor(value);
+		if (!(cell > -1e9f))
+			return -1000000000;
+		if (!(cell < 1e9f))
+			return 1000000000;
+		return int(cell);
+	}
+	static inline bool weld_is_finite(const XMFLOAT3& p)
+	{
+		return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+	}
+	// Assigns the same cluster to vertices whose positions are equal by wi::math::float_equal()
+	//	Clusters are numbered in the order of their first vertex, and the search uses a spatial hash grid instead of comparing every vertex pair
+	//	Returns the number of clusters
+	static uint32_t ClusterVertexPositions(const XMFLOAT3* positions, uint32_t vertex_count, uint32_t* clusters)
+	{
+		if (vertex_count == 0)
+			return 0;
+
+		// float_equal() tolerance is relative to the magnitude, a match can be in the neighbor cell if the position is close to the cell border:
+		const float tolerance = std::numeric_limits<float>::epsilon() * 2;
+
+		XMFLOAT3 bounds_min = XMFLOAT3(0, 0, 0);
+		XMFLOAT3 bounds_max = XMFLOAT3(0, 0, 0);
+		bool bounds_valid = false;
+		for (uint32_t i = 0; i < vertex_count; ++i)
+		{
+			if (!weld_is_finite(positions[i]))
+				continue;
+			bounds_min = bounds_valid ? wi::math::Min(bounds_min, positions[i]) : positions[i];
+			bounds_max = bounds_valid ? wi::math::Max(bounds_max, positions[i]) : positions[i];
+			bounds_valid = true;
+		}
+		const float max_abs = std::max(
+			std::max(std::max(std::abs(bounds_min.x), std::abs(bounds_max.x)), std::max(std::abs(bounds_min.y), std::abs(bounds_max.y))),
+			std::max(std::abs(bounds_min.z), std::abs(bounds_max.z))
+		);
+		const float extent = std::max(bounds_max.x - bounds_min.x, std::max(bounds_max.y - bounds_min.y, bounds_max.z - bounds_min.z));
+		float cell_size = extent > 0 && std::isfinite(extent) ? extent / std::max(1.0f, std::sqrt(float(vertex_count))) : std::max(1.0f, max_abs);
+		cell_size = std::max(cell_size, max_abs * tolerance * 4); // the tolerance range is never wider than one cell, so at most 2 cells are checked per axis
+		const float cell_size_rcp = 1.0f / cell_size;
+
+		uint32_t bucket_count = 64;
+		while (bucket_count < vertex_count)
+		{
+			bucket_count <<= 1;
+		}
+		const uint32_t bucket_mask = bucket_count - 1;
+		wi::vector<uint32_t> bucket_heads(bucket_count, ~0u);
+		wi::vector<uint32_t> next(vertex_count, ~0u); // links the first vertices of the clusters within a bucket
+
+		uint32_t cluster_count = 0;
+		for (uint32_t i = 0; i < vertex_count; ++i)
+		{
+			const XMFLOAT3& p = positions[i];
+			if (!weld_is_finite(p))
+			{
+				// NaN or infinite position is never equal to anything by float_equal(), so it gets its own cluster:
+				clusters[i] = cluster_count++;
+				continue;
+			}
+			const float tx = std::abs(p.x) * tolerance;
+			const float ty = std::abs(p.y) * tolerance;
+			const float tz = std::abs(p.z) * tolerance;
+			const int x0 = weld_grid_cell((p.x - tx - bounds_min.x) * cell_size_rcp);
+			const int x1 = weld_grid_cell((p.x + tx - bounds_min.x) * cell_size_rcp);
+			const int y0 = weld_grid_cell((p.y - ty - bounds_min.y) * cell_size_rcp);
+			const int y1 = weld_grid_cell((p.y + ty - bounds_min.y) * cell_size_rcp);
+			const int z0 = weld_grid_cell((p.z - tz - bounds_min.z) * cell_size_rcp);
+			const int z1 = weld_grid_cell((p.z + tz - bounds_min.z) * cell_size_rcp);
+
+			uint32_t cluster = ~0u;
+			for (int x = x0; x <= x1 && cluster == ~0u; ++x)
+			{
+				for (int y = y0; y <= y1 && cluster == ~0u; ++y)
+				{
+					for (int z = z0; z <= z1 && cluster == ~0u; ++z)
+					{
+						for (uint32_t j = bucket_heads[weld_grid_hash(x, y, z) & bucket_mask]; j != ~0u; j = next[j])
+						{
+							const XMFLOAT3& q = positions[j];
+							if (
+								wi::math::float_equal(p.x, q.x) &&
+								wi::math::float_equal(p.y, q.y) &&
+								wi::math::float_equal(p.z, q.z)
+								)
+							{
+								cluster = clusters[j];
+								break;
+							}
+						}
+					}
+				}
+			}
+
+			if (cluster == ~0u)
+			{
+				cluster = cluster_count++;
+				const int x = weld_grid_cell((p.x - bounds_min.x) * cell_size_rcp);
+				const int y = weld_grid_cell((p.y - bounds_min.y) * cell_size_rcp);
+				const int z = weld_grid_cell((p.z - bounds_min.z) * cell_size_rcp);
+				uint32_t& head = bucket_heads[weld_grid_hash(x, y, z) & bucket_mask];
+				next[i] = head;
+				head = i;
+			}
+			clusters[i] = cluster;
+		}
+		return cluster_count;
+	}
 	void MeshComponent::ComputeNormals(COMPUTE_NORMALS compute)
 	{
 		// Start recalculating normals:
@@ -1519,26 +1651,36 @@ namespace wi::scene
 			// Compute hard surface normals:
 
 			// Right now they are always computed even before smooth setting
+			//	Every face gets its own three vertices, so the faces are written in parallel
+
+			const uint32_t face_count = uint32_t(indices.size() / 3);
+			const size_t vertex_count = size_t(face_count) * 3;
+
+			wi::vector<uint32_t> newIndexBuffer(vertex_count);
+			wi::vector<XMFLOAT3> newPositionsBuffer(vertex_count);
+			wi::vector<XMFLOAT3> newNormalsBuffer(vertex_count);
+			wi::vector<XMFLOAT2> newUV0Buffer(vertex_uvset_0.empty() ? 0 : vertex_count);
+			wi::vector<XMFLOAT2> newUV1Buffer(vertex_uvset_1.empty() ? 0 : vertex_count);
+			wi::vector<XMFLOAT2> newAtlasBuffer(vertex_atlas.empty() ? 0 : vertex_count);
+			wi::vector<XMUINT4> newBoneIndicesBuffer(vertex_boneindices.empty() ? 0 : vertex_count);
+			wi::vector<XMFLOAT4> newBoneWeightsBuffer(vertex_boneweights.empty() ? 0 : vertex_count);
+			wi::vector<XMUINT4> newBoneIndices2Buffer(vertex_boneindices2.empty() ? 0 : vertex_count);
+			wi::vector<XMFLOAT4> newBoneWeights2Buffer(vertex_boneweights2.empty() ? 0 : vertex_count);
+			wi::vector<uint32_t> newColorsBuffer(vertex_colors.empty() ? 0 : vertex_count);
+			wi::vector<uint8_t> newWindWeightsBuffer(vertex_windweights.empty() ? 0 : vertex_count);
 
-			wi::vector<uint32_t> newIndexBuffer;
-			wi::vector<XMFLOAT3> newPositionsBuffer;
-			wi::vector<XMFLOAT3> newNormalsBuffer;
-			wi::vector<XMFLOAT2> newUV0Buffer;
-			wi::vector<XMFLOAT2> newUV1Buffer;
-			wi::vector<XMFLOAT2> newAtlasBuffer;
-			wi::vector<XMUINT4> newBoneIndicesBuffer;
-			wi::vector<XMFLOAT4> newBoneWeightsBuffer;
-			wi::vector<uint32_t> newColorsBuffer;
-
-			for (size_t face = 0; face < indices.size() / 3; face++)
-			{
-				uint32_t i0 = indices[face * 3 + 0];
-				uint32_t i1 = indices[face * 3 + 1];
-				uint32_t i2 = indices[face * 3 + 2];
+			wi::jobsystem::context ctx;
+			wi::jobsystem::Dispatch(ctx, face_count, 1024, [&](wi::jobsystem::JobArgs args) {
+				const uint32_t face = args.jobIndex;
+				const uint32_t face_indices[] = {
+					indices[face * 3 + 0],
+					indices[face * 3 + 1],
+					indices[face * 3 + 2],
+				};
 
-				XMFLOAT3& p0 = vertex_positions[i0];
-				XMFLOAT3& p1 = vertex_positions[i1];
-				XMFLOAT3& p2 = vertex_positions[i2];
+				const XMFLOAT3& p0 = vertex_positions[face_indices[0]];
+				const XMFLOAT3& p1 = vertex_positions[face_indices[1]];
+				const XMFLOAT3& p2 = vertex_positions[face_indices[2]];
 
 				XMVECTOR U = XMLoadFloat3(&p2) - XMLoadFloat3(&p0);
 				XMVECTOR V = XMLoadFloat3(&p1) - XMLoadFloat3(&p0);
@@ -1549,77 +1691,66 @@ namespace wi::scene
 				XMFLOAT3 normal;
 				XMStoreFloat3(&normal, N);
 
-				newPositionsBuffer.push_back(p0);
-				newPositionsBuffer.push_back(p1);
-				newPositionsBuffer.push_back(p2);
-
-				newNormalsBuffer.push_back(normal);
-				newNormalsBuffer.push_back(normal);
-				newNormalsBuffer.push_back(normal);
-
-				if (!vertex_uvset_0.empty())
-				{
-					newUV0Buffer.push_back(vertex_uvset_0[i0]);
-					newUV0Buffer.push_back(vertex_uvset_0[i1]);
-					newUV0Buffer.push_back(vertex_uvset_0[i2]);
-				}
-
-				if (!vertex_uvset_1.empty())
-				{
-					newUV1Buffer.push_back(vertex_uvset_1[i0]);
-					newUV1Buffer.push_back(vertex_uvset_1[i1]);
-					newUV1Buffer.push_back(vertex_uvset_1[i2]);
-				}
-
-				if (!vertex_atlas.empty())
-				{
-					newAtlasBuffer.push_back(vertex_atlas[i0]);
-					newAtlasBuffer.push_back(vertex_atlas[i1]);
-					newAtlasBuffer.push_back(vertex_atlas[i2]);
-				}
-
-				if (!vertex_boneindices.empty())
-				{
-					newBoneIndicesBuffer.push_back(vertex_boneindices[i0]);
-					newBoneIndicesBuffer.push_back(vertex_boneindices[i1]);
-					newBoneIndicesBuffer.push_back(vertex_boneindices[i2]);
-				}
-
-				if (!vertex_boneweights.empty())
+				for (uint32_t corner = 0; corner < 3; ++corner)
 				{
-					newBoneWeightsBuffer.push_back(vertex_boneweights[i0]);
-					newBoneWeightsBuffer.push_back(vertex_boneweights[i1]);
-					newBoneWeightsBuffer.push_back(vertex_boneweights[i2]);
-				}
-
-				if (!vertex_colors.empty())
-				{
-					newColorsBuffer.push_back(vertex_colors[i0]);
-					newColorsBuffer.push_back(vertex_colors[i1]);
-					newColorsBuffer.push_back(vertex_colors[i2]);
+					const uint32_t src = face_indices[corner];
+					const size_t dst = size_t(face) * 3 + corner;
+					newIndexBuffer[dst] = uint32_t(dst);
+					newPositionsBuffer[dst] = vertex_positions[src];
+					newNormalsBuffer[dst] = normal;
+					if (!newUV0Buffer.empty())
+					{
+						newUV0Buffer[dst] = vertex_uvset_0[src];
+					}
+					if (!newUV1Buffer.empty())
+					{
+						newUV1Buffer[dst] = vertex_uvset_1[src];
+					}
+					if (!newAtlasBuffer.empty())
+					{
+						newAtlasBuffer[dst] = vertex_atlas[src];
+					}
+					if (!newBoneIndicesBuffer.empty())
+					{
+						newBoneIndicesBuffer[dst] = vertex_boneindices[src];
+					}
+					if (!newBoneWeightsBuffer.empty())
+					{
+						newBoneWeightsBuffer[dst] = vertex_boneweights[src];
+					}
+					if (!newBoneIndices2Buffer.empty())
+					{
+						newBoneIndices2Buffer[dst] = vertex_boneindices2[src];
+					}
+					if (!newBoneWeights2Buffer.empty())
+					{
+						newBoneWeights2Buffer[dst] = vertex_boneweights2[src];
+					}
+					if (!newColorsBuffer.empty())
+					{
+						newColorsBuffer[dst] = vertex_colors[src];
+					}
+					if (!newWindWeightsBuffer.empty())
+					{
+						newWindWeightsBuffer[dst] = vertex_windweights[src];
+					}
 				}
-
-				newIndexBuffer.push_back(static_cast<uint32_t>(newIndexBuffer.size()));
-				newIndexBuffer.push_back(static_cast<uint32_t>(newIndexBuffer.size()));
-				newIndexBuffer.push_back(static_cast<uint32_t>(newIndexBuffer.size()));
-			}
+			});
+			wi::jobsystem::Wait(ctx);
 
 			// For hard surface normals, we created a new mesh in the previous loop through faces, so swap data:
-			vertex_positions = newPositionsBuffer;
-			vertex_normals = newNormalsBuffer;
-			vertex_uvset_0 = newUV0Buffer;
-			vertex_uvset_1 = newUV1Buffer;
-			vertex_atlas = newAtlasBuffer;
-			vertex_colors = newColorsBuffer;
-			if (!vertex_boneindices.empty())
-			{
-				vertex_boneindices = newBoneIndicesBuffer;
-			}
-			if (!vertex_boneweights.empty())
-			{
-				vertex_boneweights = newBoneWeightsBuffer;
-			}
-			indices = newIndexBuffer;
+			vertex_positions = std::move(newPositionsBuffer);
+			vertex_normals = std::move(newNormalsBuffer);
+			vertex_uvset_0 = std::move(newUV0Buffer);
+			vertex_uvset_1 = std::move(newUV1Buffer);
+			vertex_atlas = std::move(newAtlasBuffer);
+			vertex_colors = std::move(newColorsBuffer);
+			vertex_boneindices = std::move(newBoneIndicesBuffer);
+			vertex_boneweights = std::move(newBoneWeightsBuffer);
+			vertex_boneindices2 = std::move(newBoneIndices2Buffer);
+			vertex_boneweights2 = std::move(newBoneWeights2Buffer);
+			vertex_windweights = std::move(newWindWeightsBuffer);
+			indices = std::move(newIndexBuffer);
 		}
 
 		switch (compute)
@@ -1630,159 +1761,188 @@ namespace wi::scene
 		case MeshComponent::COMPUTE_NORMALS_SMOOTH:
 		{
 			// Compute smooth surface normals:
+			//	After the hard pass, vertex i belongs to face i / 3 and its normal is the face normal
+			const uint32_t vertex_count = uint32_t(vertex_positions.size());
+			const uint32_t face_count = vertex_count / 3;
 
-			// 1.) Zero normals, they will be averaged later
-			for (size_t i = 0; i < vertex_normals.size(); i++)
+			// 1.) Find identical vertices by POSITION:
+			wi::vector<uint32_t> clusters(vertex_count);
+			const uint32_t cluster_count = ClusterVertexPositions(vertex_positions.data(), vertex_count, clusters.data());
+
+			// 2.) Accumulate face normals for each position in face order, every face is counted once even if it is degenerate:
+			wi::vector<uint32_t> cluster_face_offsets(cluster_count + 1, 0);
+			for (uint32_t face = 0; face < face_count; ++face)
 			{
-				vertex_normals[i] = XMFLOAT3(0, 0, 0);
+				const uint32_t c0 = clusters[face * 3 + 0];
+				const uint32_t c1 = clusters[face * 3 + 1];
+				const uint32_t c2 = clusters[face * 3 + 2];
+				cluster_face_offsets[c0 + 1]++;
+				if (c1 != c0)
+				{
+					cluster_face_offsets[c1 + 1]++;
+				}
+				if (c2 != c0 && c2 != c1)
+				{
+					cluster_face_offsets[c2 + 1]++;
+				}
 			}
-
-			// 2.) Find identical vertices by POSITION, accumulate face normals
-			for (size_t i = 0; i < vertex_positions.size(); i++)
+			for (uint32_t i = 0; i < cluster_count; ++i)
 			{
-				XMFLOAT3& v_search_pos = vertex_positions[i];
-
-				for (size_t ind = 0; ind < indices.size() / 3; ++ind)
+				cluster_face_offsets[i + 1] += cluster_face_offsets[i];
+			}
+			wi::vector<uint32_t> cluster_faces(cluster_face_offsets.back());
+			{
+				wi::vector<uint32_t> cluster_face_counts(cluster_count, 0);
+				for (uint32_t face = 0; face < face_count; ++face)
 				{
-					uint32_t i0 = indices[ind * 3 + 0];
-					uint32_t i1 = indices[ind * 3 + 1];
-					uint32_t i2 = indices[ind * 3 + 2];
-
-					XMFLOAT3& v0 = vertex_positions[i0];
-					XMFLOAT3& v1 = vertex_positions[i1];
-					XMFLOAT3& v2 = vertex_positions[i2];
-
-
-					bool match_pos0 =
-						wi::math::float_equal(v_search_pos.x, v0.x) &&
-						wi::math::float_equal(v_search_pos.y, v0.y) &&
-						wi::math::float_equal(v_search_pos.z, v0.z);
-
-					bool match_pos1 =
-						wi::math::float_equal(v_search_pos.x, v1.x) &&
-						wi::math::float_equal(v_search_pos.y, v1.y) &&
-						wi::math::float_equal(v_search_pos.z, v1.z);
-
-					bool match_pos2 =
-						wi::math::float_equal(v_search_pos.x, v2.x) &&
-						wi::math::float_equal(v_search_pos.y, v2.y) &&
-						wi::math::float_equal(v_search_pos.z, v2.z);
-
-					if (match_pos0 || match_pos1 || match_pos2)
+					const uint32_t c0 = clusters[face * 3 + 0];
+					const uint32_t c1 = clusters[face * 3 + 1];
+					const uint32_t c2 = clusters[face * 3 + 2];
+					cluster_faces[cluster_face_offsets[c0] + cluster_face_counts[c0]++] = face;
+					if (c1 != c0)
 					{
-						XMVECTOR U = XMLoadFloat3(&v2) - XMLoadFloat3(&v0);
-						XMVECTOR V = XMLoadFloat3(&v1) - XMLoadFloat3(&v0);
-
-						XMVECTOR N = XMVector3Cross(U, V);
-						N = XMVector3Normalize(N);
-
-						XMFLOAT3 normal;
-						XMStoreFloat3(&normal, N);
-
-						vertex_normals[i].x += normal.x;
-						vertex_normals[i].y += normal.y;
-						vertex_normals[i].z += normal.z;
+						cluster_faces[cluster_face_offsets[c1] + cluster_face_counts[c1]++] = face;
+					}
+					if (c2 != c0 && c2 != c1)
+					{
+						cluster_faces[cluster_face_offsets[c2] + cluster_face_counts[c2]++] = face;
 					}
-
 				}
 			}
 
+			wi::vector<XMFLOAT3> cluster_normals(cluster_count);
+			wi::jobsystem::context ctx;
+			wi::jobsystem::Dispatch(ctx, cluster_count, 1024, [&](wi::jobsystem::JobArgs args) {
+				XMFLOAT3 sum = XMFLOAT3(0, 0, 0);
+				for (uint32_t i = cluster_face_offsets[args.jobIndex]; i < cluster_face_offsets[args.jobIndex + 1]; ++i)
+				{
+					const XMFLOAT3& normal = vertex_normals[cluster_faces[i] * 3];
+					sum.x += normal.x;
+					sum.y += normal.y;
+					sum.z += normal.z;
+				}
+				cluster_normals[args.jobIndex] = sum;
+			});
+			wi::jobsystem::Wait(ctx);
+
+			wi::jobsystem::Dispatch(ctx, vertex_count, 4096, [&](wi::jobsystem::JobArgs args) {
+				vertex_normals[args.jobIndex] = cluster_normals[clusters[args.jobIndex]];
+			});
+
 			// 3.) Find duplicated vertices by POSITION and UV0 and UV1 and ATLAS and SUBSET and remove them:
-			uint32_t first_subset = 0;
-			uint32_t last_subset = 0;
-			GetLODSubsetRange(0, first_subset, last_subset);
-			for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
+			//	Every vertex is merged into the first equal vertex of its subset, only the vertices of the same position cluster need to be compared
+			wi::vector<uint32_t> remap(vertex_count);
+			for (uint32_t i = 0; i < vertex_count; ++i)
 			{
-				const MeshComponent::MeshSubset& subset = subsets[subsetIndex];
-				for (uint32_t i = 0; i < subset.indexCount - 1; i++)
+				remap[i] = i;
+			}
+			{
+				wi::vector<uint32_t> cluster_heads(cluster_count, ~0u);
+				wi::vector<uint32_t> cluster_subsets(cluster_count, ~0u);
+				wi::vector<uint32_t> next(vertex_count, ~0u);
+				const XMFLOAT2 zero = XMFLOAT2(0, 0);
+				uint32_t first_subset = 0;
+				uint32_t last_subset = 0;
+				GetLODSubsetRange(0, first_subset, last_subset);
+				for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
 				{
-					uint32_t ind0 = indices[subset.indexOffset + (uint32_t)i];
-					const XMFLOAT3& p0 = vertex_positions[ind0];
-					const XMFLOAT2& u00 = vertex_uvset_0.empty() ? XMFLOAT2(0, 0) : vertex_uvset_0[ind0];
-					const XMFLOAT2& u10 = vertex_uvset_1.empty() ? XMFLOAT2(0, 0) : vertex_uvset_1[ind0];
-					const XMFLOAT2& at0 = vertex_atlas.empty() ? XMFLOAT2(0, 0) : vertex_atlas[ind0];
-
-					for (uint32_t j = i + 1; j < subset.indexCount; j++)
+					const MeshComponent::MeshSubset& subset = subsets[subsetIndex];
+					const uint32_t index_end = std::min(subset.indexOffset + subset.indexCount, vertex_count);
+					for (uint32_t i = subset.indexOffset; i < index_end; ++i)
 					{
-						uint32_t ind1 = indices[subset.indexOffset + (uint32_t)j];
-
-						if (ind1 == ind0)
-						{
+						const uint32_t ind1 = indices[i];
+						if (remap[ind1] != ind1)
 							continue;
+						const uint32_t cluster = clusters[ind1];
+						if (cluster_subsets[cluster] != subsetIndex)
+						{
+							cluster_subsets[cluster] = subsetIndex;
+							cluster_heads[cluster] = ~0u;
 						}
+						const XMFLOAT2& u01 = vertex_uvset_0.empty() ? zero : vertex_uvset_0[ind1];
+						const XMFLOAT2& u11 = vertex_uvset_1.empty() ? zero : vertex_uvset_1[ind1];
+						const XMFLOAT2& at1 = vertex_atlas.empty() ? zero : vertex_atlas[ind1];
 
-						const XMFLOAT3& p1 = vertex_positions[ind1];
-						const XMFLOAT2& u01 = vertex_uvset_0.empty() ? XMFLOAT2(0, 0) : vertex_uvset_0[ind1];
-						const XMFLOAT2& u11 = vertex_uvset_1.empty() ? XMFLOAT2(0, 0) : vertex_uvset_1[ind1];
-						const XMFLOAT2& at1 = vertex_atlas.empty() ? XMFLOAT2(0, 0) : vertex_atlas[ind1];
+						uint32_t ind0 = cluster_heads[cluster];
+						for (; ind0 != ~0u; ind0 = next[ind0])
+						{
+							const XMFLOAT2& u00 = vertex_uvset_0.empty() ? zero : vertex_uvset_0[ind0];
+							const XMFLOAT2& u10 = vertex_uvset_1.empty() ? zero : vertex_uvset_1[ind0];
+							const XMFLOAT2& at0 = vertex_atlas.empty() ? zero : vertex_atlas[ind0];
 
-						const bool duplicated_pos =
-							wi::math::float_equal(p0.x, p1.x) &&
-							wi::math::float_equal(p0.y, p1.y) &&
-							wi::math::float_equal(p0.z, p1.z);
+							const bool duplicated_uv0 =
+								wi::math::float_equal(u00.x, u01.x) &&
+								wi::math::float_equal(u00.y, u01.y);
 
-						const bool duplicated_uv0 =
-							wi::math::float_equal(u00.x, u01.x) &&
-							wi::math::float_equal(u00.y, u01.y);
+							const bool duplicated_uv1 =
+								wi::math::float_equal(u10.x, u11.x) &&
+								wi::math::float_equal(u10.y, u11.y);
 
-						const bool duplicated_uv1 =
-							wi::math::float_equal(u10.x, u11.x) &&
-							wi::math::float_equal(u10.y, u11.y);
+							const bool duplicated_atl =
+								wi::math::float_equal(at0.x, at1.x) &&
+								wi::math::float_equal(at0.y, at1.y);
 
-						const bool duplicated_atl =
-							wi::math::float_equal(at0.x, at1.x) &&
-							wi::math::float_equal(at0.y, at1.y);
+							if (duplicated_uv0 && duplicated_uv1 && duplicated_atl)
+								break;
+						}
 
-						if (duplicated_pos && duplicated_uv0 && duplicated_uv1 && duplicated_atl)
+						if (ind0 == ~0u)
 						{
-							// Erase vertices[ind1] because it is a duplicate:
-							if (ind1 < vertex_positions.size())
-							{
-								vertex_positions.erase(vertex_positions.begin() + ind1);
-							}
-							if (ind1 < vertex_normals.size())
-							{
-								vertex_normals.erase(vertex_normals.begin() + ind1);
-							}
-							if (ind1 < vertex_uvset_0.size())
-							{
-								vertex_uvset_0.erase(vertex_uvset_0.begin() + ind1);
-							}
-							if (ind1 < vertex_uvset_1.size())
-							{
-								vertex_uvset_1.erase(vertex_uvset_1.begin() + ind1);
-							}
-							if (ind1 < vertex_atlas.size())
-							{
-								vertex_atlas.erase(vertex_atlas.begin() + ind1);
-							}
-							if (ind1 < vertex_boneindices.size())
-							{
-								vertex_boneindices.erase(vertex_boneindices.begin() + ind1);
-							}
-							if (ind1 < vertex_boneweights.size())
-							{
-								vertex_boneweights.erase(vertex_boneweights.begin() + ind1);
-							}
-
-							// The vertices[ind1] was removed, so each index after that needs to be updated:
-							for (auto& index : indices)
-							{
-								if (index > ind1 && index > 0)
-								{
-									index--;
-								}
-								else if (index == ind1)
-								{
-									index = ind0;
-								}
-							}
-
+							// First occurence, other vertices can be merged into this:
+							next[ind1] = cluster_heads[cluster];
+							cluster_heads[cluster] = ind1;
+						}
+						else
+						{
+							remap[ind1] = ind0;
 						}
-
 					}
 				}
+			}
+			wi::jobsystem::Wait(ctx);
 
+			// The kept vertices are compacted in their original order and the indices are remapped to them:
+			wi::vector<uint32_t> compacted(vertex_count);
+			uint32_t compacted_count = 0;
+			for (uint32_t i = 0; i < vertex_count; ++i)
+			{
+				if (remap[i] == i)
+				{
+					compacted[i] = compacted_count++;
+				}
+			}
+			if (compacted_count < vertex_count)
+			{
+				auto compact = [&](auto& vertex_data) {
+					if (vertex_data.size() != vertex_count)
+						return;
+					std::remove_reference_t<decltype(vertex_data)> compacted_data(compacted_count);
+					wi::jobsystem::Dispatch(ctx, vertex_count, 4096, [&vertex_data, &compacted_data, &remap, &compacted](wi::jobsystem::JobArgs args) {
+						if (remap[args.jobIndex] == args.jobIndex)
+						{
+							compacted_data[compacted[args.jobIndex]] = vertex_data[args.jobIndex];
+						}
+					});
+					wi::jobsystem::Wait(ctx);
+					vertex_data = std::move(compacted_data);
+				};
+				compact(vertex_positions);
+				compact(vertex_normals);
+				compact(vertex_uvset_0);
+				compact(vertex_uvset_1);
+				compact(vertex_atlas);
+				compact(vertex_boneindices);
+				compact(vertex_boneweights);
+				compact(vertex_boneindices2);
+				compact(vertex_boneweights2);
+				compact(vertex_colors);
+				compact(vertex_windweights);
+
+				wi::jobsystem::Dispatch(ctx, (uint32_t)indices.size(), 4096, [&](wi::jobsystem::JobArgs args) {
+					uint32_t& index = indices[args.jobIndex];
+					index = compacted[remap[index]];
+				});
+				wi::jobsystem::Wait(ctx);
 			}
 
 		}
@@ -1801,9 +1961,13 @@ namespace wi::scene
 			for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
 			{
 				const MeshSubset& subset = subsets[subsetIndex];
+				const uint32_t face_count = subset.indexCount / 3;
 
-				for (uint32_t i = 0; i < subset.indexCount / 3; ++i)
-				{
+				// Face normals are computed in parallel, but accumulated in face order to keep the result deterministic:
+				wi::vector<XMFLOAT3> face_normals(face_count);
+				wi::jobsystem::context ctx;
+				wi::jobsystem::Dispatch(ctx, face_count, 1024, [&](wi::jobsystem::JobArgs args) {
+					const uint32_t i = args.jobIndex;
 					uint32_t index1 = indices[subset.indexOffset + i * 3 + 0];
 					uint32_t index2 = indices[subset.indexOffset + i * 3 + 1];
 					uint32_t index3 = indices[subset.indexOffset + i * 3 + 2];
@@ -1811,8 +1975,17 @@ namespace wi::scene
 					XMVECTOR side1 = XMLoadFloat3(&vertex_positions[index1]) - XMLoadFloat3(&vertex_positions[index3]);
 					XMVECTOR side2 = XMLoadFloat3(&vertex_positions[index1]) - XMLoadFloat3(&vertex_positions[index2]);
 					XMVECTOR N = XMVector3Normalize(XMVector3Cross(side1, side2));
-					XMFLOAT3 normal;
-					XMStoreFloat3(&normal, N);
+					XMStoreFloat3(&face_normals[i], N);
+				});
+				wi::jobsystem::Wait(ctx);
+
+				for (uint32_t i = 0; i < face_count; ++i)
+				{
+					uint32_t index1 = indices[subset.indexOffset + i * 3 + 0];
+					uint32_t index2 = indices[subset.indexOffset + i * 3 + 1];
+					uint32_t index3 = indices[subset.indexOffset + i * 3 + 2];
+
+					const XMFLOAT3& normal = face_normals[i];
 
 					vertex_normals[index1].x += normal.x;
 					vertex_normals[index1].y += normal.y;
@@ -2161,6 +2334,8 @@ namespace wi::scene
 		DeleteRenderData();
 
 		GraphicsDevice* device = wi::graphics::GetDevice();
+		if (device == nullptr)
+			return;
 
 		if (!vertex_ao.empty())
 		{
@@ -2199,6 +2374,8 @@ namespace wi::scene
 		SetDirty();
 
 		GraphicsDevice* device = wi::graphics::GetDevice();
+		if (device == nullptr)
+			return;
 
 		TextureDesc desc;
 		desc.array_size = 6;
@@ -644,6 +644,7 @@ namespace wi::scene
 			DOUBLE_SIDED_SHADOW = 1 << 7,
 			BVH_ENABLED = 1 << 8,
 			QUANTIZED_POSITIONS_DISABLED = 1 << 9,
+			OCCLUDER = 1 << 10,
 		};
 		uint32_t _flags = RENDERABLE;
 
@@ -775,12 +776,18 @@ namespace wi::scene
 		//	This should be enabled for connecting meshes like terrain chunks if their AABB is not consistent with each other
 		constexpr void SetQuantizedPositionsDisabled(bool value) { if (value) { _flags |= QUANTIZED_POSITIONS_DISABLED; } else { _flags &= ~QUANTIZED_POSITIONS_DISABLED; } }
 
+		// Mark the mesh as occluder for CPU occlusion culling (see wi::renderer::SetCPUOcclusionCullingEnabled())
+		//	The lowest detail LOD is rasterized, it should be fully contained inside the visible surface, like a simplified wall or building
+		//	Skinned and morphed meshes are not used as occluders
+		constexpr void SetOccluder(bool value) { if (value) { _flags |= OCCLUDER; } else { _flags &= ~OCCLUDER; } }
+
 		constexpr bool IsRenderable() const { return _flags & RENDERABLE; }
 		constexpr bool IsDoubleSided() const { return _flags & DOUBLE_SIDED; }
 		constexpr bool IsDoubleSidedShadow() const { return _flags & DOUBLE_SIDED_SHADOW; }
 		constexpr bool IsDynamic() const { return _flags & DYNAMIC; }
 		constexpr bool IsBVHEnabled() const { return _flags & BVH_ENABLED; }
 		constexpr bool IsQuantizedPositionsDisabled() const { return _flags & QUANTIZED_POSITIONS_DISABLED; }
+		constexpr bool IsOccluder() const { return _flags & OCCLUDER; }
 
 		constexpr float GetTessellationFactor() const { return tessellationFactor; }
 		constexpr bool IsSkinned() const { return armatureID != wi::ecs::INVALID_ENTITY; }
@@ -1544,6 +1551,7 @@ namespace wi::scene
 		// Non-serialized attributes:
 		XMFLOAT3 position;
 		XMFLOAT3 direction;
+		uint32_t layerMask = ~0u;
 
 		constexpr float GetRange() const { return range; }
 
@@ -2029,6 +2037,7 @@ namespace wi::scene
 		wi::vector<uint8_t> script; // compiled script binary data
 		wi::Resource resource;
 		size_t script_hash = 0;
+		uint32_t script_pid = 0;
 
 		constexpr void Play() { _flags |= PLAYING; }
 		constexpr void SetPlayOnce(bool once = true) { if (once) { _flags |= PLAY_ONCE; } else { _flags &= ~PLAY_ONCE; } }
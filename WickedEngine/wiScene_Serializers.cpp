@@ -2539,7 +2539,35 @@ namespace wi::scene
 		}
 	}
 
+	// Spatial index cells are packed as 3 * 21 bit signed coordinates:
+	static constexpr uint64_t spatial_index_no_cell = ~0ull;
+	static constexpr int spatial_index_cell_bias = 1 << 20;
+	static inline uint64_t PackSpatialIndexCell(const XMFLOAT3& position, float cell_size)
+	{
+		if (std::isnan(position.x) || std::isnan(position.y) || std::isnan(position.z))
+			return spatial_index_no_cell; // it can't be placed, so it will be always loaded
+		auto coord = [&](float value) {
+			// Clamped before the conversion to integer, because out of range conversion is undefined (infinity is clamped to the border cells):
+			const float cell = std::floor(value / cell_size);
+			const float cell_clamped = std::max(-float(spatial_index_cell_bias), std::min(float(spatial_index_cell_bias - 1), cell));
+			return uint64_t(int(cell_clamped) + spatial_index_cell_bias);
+		};
+		return coord(position.x) | (coord(position.y) << 21ull) | (coord(position.z) << 42ull);
+	}
+	static inline wi::primitive::AABB UnpackSpatialIndexCell(uint64_t cell, float cell_size)
+	{
+		auto coord = [&](uint64_t shift) {
+			return float(int((cell >> shift) & ((1ull << 21ull) - 1)) - spatial_index_cell_bias) * cell_size;
+		};
+		XMFLOAT3 _min = XMFLOAT3(coord(0), coord(21), coord(42));
+		return wi::primitive::AABB(_min, XMFLOAT3(_min.x + cell_size, _min.y + cell_size, _min.z + cell_size));
+	}
+
 	void Scene::Serialize(wi::Archive& archive)
+	{
+		Serialize(archive, SerializeOptions());
+	}
+	void Scene::Serialize(wi::Archive& archive, const SerializeOptions& options)
 	{
 		wi::Timer timer;
 
@@ -2592,6 +2620,55 @@ namespace wi::scene
 
 		if(archive.GetVersion() >= 84)
 		{
+			// Partial serialization:
+			float spatial_index_cell_size = 0;
+			if (archive.GetVersion() >= 94)
+			{
+				if (archive.IsReadMode())
+				{
+					archive >> spatial_index_cell_size;
+				}
+				else
+				{
+					spatial_index_cell_size = options.spatial_index_cell_size;
+					archive << spatial_index_cell_size;
+				}
+			}
+			if (archive.IsReadMode())
+			{
+				if (!options.components.empty())
+				{
+					seri.component_filter = &options.components;
+				}
+				if (spatial_index_cell_size > 0 && options.region.IsValid())
+				{
+					seri.spatial_filter = [&](uint64_t cell) {
+						if (cell == spatial_index_no_cell)
+							return true;
+						return options.region.intersects(UnpackSpatialIndexCell(cell, spatial_index_cell_size)) != wi::primitive::AABB::OUTSIDE;
+					};
+				}
+			}
+			else if (spatial_index_cell_size > 0)
+			{
+				seri.spatial_index = [&](Entity entity) {
+					// Entities in a hierarchy are indexed by the cell of the hierarchy root, so a hierarchy is always loaded together
+					//	Otherwise a child could be loaded without its parent, and its local transform would be treated as world transform
+					Entity root = entity;
+					for (size_t depth = 0; depth < hierarchy.GetCount(); ++depth)
+					{
+						const HierarchyComponent* parent = hierarchy.GetComponent(root);
+						if (parent == nullptr || parent->parentID == INVALID_ENTITY)
+							break;
+						root = parent->parentID;
+					}
+					const TransformComponent* transform = transforms.GetComponent(root);
+					if (transform == nullptr)
+						return spatial_index_no_cell;
+					return PackSpatialIndexCell(transform->GetPosition(), spatial_index_cell_size);
+				};
+			}
+
 			// New scene serialization path with component library:
 			componentLibrary.Serialize(archive, seri);
 		}
@@ -4,6 +4,8 @@
 #include "wiHelper.h"
 #include "wiArchive.h"
 #include "wiUnorderedSet.h"
+#include "wiUnorderedMap.h"
+#include "wiTimer.h"
 
 #include <mutex>
 
@@ -49,6 +51,7 @@ namespace wi::shadercompiler
 	struct InternalState_DXC
 	{
 		DxcCreateInstanceProc DxcCreateInstance = nullptr;
+		uint64_t version = 0; // major, minor, commit count and commit hash combined, used by ComputeInputHash()
 
 		InternalState_DXC(const std::string& modifier = "")
 		{
@@ -74,6 +77,22 @@ namespace wi::shadercompiler
 					uint32_t major = 0;
 					hr = info->GetVersion(&major, &minor);
 					assert(SUCCEEDED(hr));
+					version = (uint64_t(major) << 32ull) | uint64_t(minor);
+					CComPtr<IDxcVersionInfo2> info2;
+					if (SUCCEEDED(dxcCompiler->QueryInterface(IID_PPV_ARGS(&info2))))
+					{
+						uint32_t commit_count = 0;
+						char* commit_hash = nullptr;
+						if (SUCCEEDED(info2->GetCommitInfo(&commit_count, &commit_hash)))
+						{
+							version = wi::helper::stable_hash(version, commit_count);
+							if (commit_hash != nullptr)
+							{
+								version = wi::helper::stable_hash(version, std::string(commit_hash));
+								CoTaskMemFree(commit_hash);
+							}
+						}
+					}
 					wi::backlog::post("wi::shadercompiler: loaded " + library + " (version: " + std::to_string(major) + "." + std::to_string(minor) + ")");
 				}
 			}
@@ -712,6 +731,7 @@ namespace wi::shadercompiler
 		output = CompilerOutput();
 
 #ifdef SHADERCOMPILER_ENABLED
+		wi::Timer timer;
 		switch (input.format)
 		{
 		default:
@@ -738,9 +758,284 @@ namespace wi::shadercompiler
 #endif // SHADERCOMPILER_PS5_INCLUDED
 
 		}
+		output.compile_time = (float)timer.elapsed_seconds();
 #endif // SHADERCOMPILER_ENABLED
 	}
 
+	static uint64_t GetCompilerVersion(ShaderFormat format)
+	{
+		switch (format)
+		{
+		default:
+			break;
+#ifdef SHADERCOMPILER_ENABLED_DXCOMPILER
+		case ShaderFormat::HLSL6:
+		case ShaderFormat::SPIRV:
+			return dxc_compiler().version;
+		case ShaderFormat::HLSL6_XS:
+			return dxc_compiler_xs().version;
+#endif // SHADERCOMPILER_ENABLED_DXCOMPILER
+#ifdef SHADERCOMPILER_ENABLED_D3DCOMPILER
+		case ShaderFormat::HLSL5:
+			return D3D_COMPILER_VERSION;
+#endif // SHADERCOMPILER_ENABLED_D3DCOMPILER
+		}
+		return 0;
+	}
+
+	// Source files are shared by many shaders and permutations, so their content hash and includes are cached:
+	struct SourceFileInfo
+	{
+		uint64_t timestamp = 0;
+		uint64_t content_hash = 0;
+		wi::vector<std::string> includes; // include names as they are written in the file
+	};
+	static std::mutex source_files_locker;
+	static wi::unordered_map<std::string, SourceFileInfo> source_files;
+
+	static bool GetSourceFileInfo(const std::string& filename, SourceFileInfo& info)
+	{
+		const uint64_t timestamp = wi::helper::FileTimestamp(filename);
+		{
+			std::scoped_lock lck(source_files_locker);
+			auto it = source_files.find(filename);
+			if (it != source_files.end() && it->second.timestamp == timestamp)
+			{
+				info = it->second;
+				return true;
+			}
+		}
+
+		wi::vector<uint8_t> filedata;
+		if (!wi::helper::FileRead(filename, filedata))
+			return false;
+
+		info = {};
+		info.timestamp = timestamp;
+		info.content_hash = wi::helper::stable_hash_seed;
+		for (uint8_t c : filedata)
+		{
+			if (c == '\r')
+				continue; // line endings can differ between checkouts
+			info.content_hash = wi::helper::stable_hash(info.content_hash, &c, 1);
+		}
+
+		// Collect #include "name" and #include <name> directives
+		//	Includes in comments and inactive preprocessor branches are also collected, that can only result in extra dependencies
+		//	The exception is #ifdef __cplusplus blocks, because shader interop headers include engine headers in those
+		const char* text = (const char*)filedata.data();
+		const size_t size = filedata.size();
+		wi::vector<bool> cplusplus_blocks; // one entry for each nested #if, true if it is only active for C++
+		auto skip_spaces = [&](size_t j) {
+			while (j < size && (text[j] == ' ' || text[j] == '\t'))
+				j++;
+			return j;
+		};
+		auto read_word = [&](size_t& j) {
+			const size_t begin = j;
+			while (j < size && (std::isalnum((unsigned char)text[j]) || text[j] == '_'))
+				j++;
+			return std::string(text + begin, j - begin);
+		};
+		for (size_t i = 0; i < size; ++i)
+		{
+			if (text[i] != '#')
+				continue;
+			size_t j = skip_spaces(i + 1);
+			const std::string directive = read_word(j);
+			j = skip_spaces(j);
+			size_t line_end = j;
+			while (line_end < size && text[line_end] != '\n')
+				line_end++;
+			const std::string arguments(text + j, line_end - j);
+			i = line_end;
+
+			if (directive == "ifdef")
+			{
+				cplusplus_blocks.push_back(arguments.compare(0, 11, "__cplusplus") == 0);
+			}
+			else if (directive == "if")
+			{
+				cplusplus_blocks.push_back(arguments.find("__cplusplus") != std::string::npos && arguments.find('!') == std::string::npos);
+			}
+			else if (directive == "ifndef")
+			{
+				cplusplus_blocks.push_back(false);
+			}
+			else if (directive == "else" || directive == "elif")
+			{
+				if (!cplusplus_blocks.empty())
+				{
+					cplusplus_blocks.back() = false;
+				}
+			}
+			else if (directive == "endif")
+			{
+				if (!cplusplus_blocks.empty())
+				{
+					cplusplus_blocks.pop_back();
+				}
+			}
+			else if (directive == "include" && !arguments.empty() && (arguments[0] == '"' || arguments[0] == '<'))
+			{
+				if (std::find(cplusplus_blocks.begin(), cplusplus_blocks.end(), true) != cplusplus_blocks.end())
+					continue;
+				const size_t end = arguments.find(arguments[0] == '"' ? '"' : '>', 1);
+				if (end != std::string::npos)
+				{
+					info.includes.push_back(arguments.substr(1, end - 1));
+				}
+			}
+		}
+
+		std::scoped_lock lck(source_files_locker);
+		source_files[filename] = info;
+		return true;
+	}
+
+	uint64_t ComputeInputHash(const CompilerInput& input, wi::vector<std::string>* dependencies)
+	{
+		uint64_t hash = wi::helper::stable_hash_seed;
+
+		std::string rootfile = input.shadersourcefilename;
+		wi::helper::MakePathAbsolute(rootfile);
+
+		// Depth first traversal of the include graph, the order is deterministic, so the combined content hash is stable:
+		wi::unordered_set<std::string> visited;
+		wi::vector<std::string> stack;
+		stack.push_back(rootfile);
+		visited.insert(rootfile);
+		while (!stack.empty())
+		{
+			std::string filename = std::move(stack.back());
+			stack.pop_back();
+
+			SourceFileInfo info;
+			if (!GetSourceFileInfo(filename, info))
+			{
+				if (filename == rootfile)
+					return 0;
+				continue;
+			}
+			hash = wi::helper::stable_hash(hash, info.content_hash);
+			if (dependencies != nullptr)
+			{
+				dependencies->push_back(filename);
+			}
+
+			const std::string directory = wi::helper::GetDirectoryFromPath(filename);
+			for (auto it = info.includes.rbegin(); it != info.includes.rend(); ++it)
+			{
+				// Resolve relative to the including file first, then the include directories:
+				std::string resolved = directory + *it;
+				wi::helper::MakePathAbsolute(resolved);
+				if (!wi::helper::FileExists(resolved))
+				{
+					resolved.clear();
+					for (auto& include_directory : input.include_directories)
+					{
+						std::string candidate = include_directory + *it;
+						wi::helper::MakePathAbsolute(candidate);
+						if (wi::helper::FileExists(candidate))
+						{
+							resolved = candidate;
+							break;
+						}
+					}
+				}
+				if (!resolved.empty() && visited.insert(resolved).second)
+				{
+					stack.push_back(resolved);
+				}
+			}
+		}
+
+		hash = wi::helper::stable_hash(hash, uint32_t(input.flags));
+		hash = wi::helper::stable_hash(hash, uint32_t(input.format));
+		hash = wi::helper::stable_hash(hash, uint32_t(input.stage));
+		hash = wi::helper::stable_hash(hash, uint32_t(input.minshadermodel));
+		hash = wi::helper::stable_hash(hash, input.entrypoint);
+		for (auto& x : input.defines)
+		{
+			hash = wi::helper::stable_hash(hash, x);
+		}
+		hash = wi::helper::stable_hash(hash, GetCompilerVersion(input.format));
+		return hash == 0 ? 1 : hash;
+	}
+
+	static constexpr uint32_t shadercache_magic = 0x48535749; // "IWSH"
+	static constexpr uint32_t shadercache_version = 1;
+	static constexpr const char* shadercache_extension = "wishadercache";
+	struct ShaderCacheHeader
+	{
+		uint32_t magic = shadercache_magic;
+		uint32_t version = shadercache_version;
+		uint64_t input_hash = 0;
+		uint64_t shadersize = 0;
+		float compile_time = 0;
+		uint32_t reserved = 0;
+	};
+	static_assert(sizeof(ShaderCacheHeader) == 32);
+	static std::string GetShaderCacheFileName(const std::string& cachedirectory, uint64_t input_hash)
+	{
+		char name[32] = {};
+		snprintf(name, arraysize(name), "%016llx.", (unsigned long long)input_hash);
+		std::string filename = cachedirectory;
+		if (!filename.empty() && filename.back() != '/' && filename.back() != '\\')
+		{
+			filename += "/";
+		}
+		return filename + name + shadercache_extension;
+	}
+
+	bool ShaderCacheRead(const std::string& cachedirectory, uint64_t input_hash, CompilerOutput& output)
+	{
+		const std::string filename = GetShaderCacheFileName(cachedirectory, input_hash);
+		if (input_hash == 0 || !wi::helper::FileExists(filename))
+			return false;
+
+		auto filedata = std::make_shared<wi::vector<uint8_t>>();
+		if (!wi::helper::FileRead(filename, *filedata) || filedata->size() < sizeof(ShaderCacheHeader))
+			return false;
+
+		const ShaderCacheHeader* header = (const ShaderCacheHeader*)filedata->data();
+		if (
+			header->magic != shadercache_magic ||
+			header->version != shadercache_version ||
+			header->input_hash != input_hash ||
+			header->shadersize != filedata->size() - sizeof(ShaderCacheHeader) // incomplete file, for example if writing was interrupted
+			)
+		{
+			return false;
+		}
+
+		output = CompilerOutput();
+		output.internal_state = filedata;
+		output.shaderdata = filedata->data() + sizeof(ShaderCacheHeader);
+		output.shadersize = (size_t)header->shadersize;
+		output.input_hash = input_hash;
+		output.compile_time = header->compile_time;
+		return true;
+	}
+
+	bool ShaderCacheWrite(const std::string& cachedirectory, uint64_t input_hash, const CompilerOutput& output)
+	{
+		if (input_hash == 0 || !output.IsValid())
+			return false;
+
+		ShaderCacheHeader header;
+		header.input_hash = input_hash;
+		header.shadersize = output.shadersize;
+		header.compile_time = output.compile_time;
+
+		wi::vector<uint8_t> filedata(sizeof(ShaderCacheHeader) + output.shadersize);
+		std::memcpy(filedata.data(), &header, sizeof(header));
+		std::memcpy(filedata.data() + sizeof(header), output.shaderdata, output.shadersize);
+
+		wi::helper::DirectoryCreate(cachedirectory);
+		return wi::helper::FileWrite(GetShaderCacheFileName(cachedirectory, input_hash), filedata.data(), filedata.size());
+	}
+
 	constexpr const char* shadermetaextension = "wishadermeta";
 	bool SaveShaderAndMetadata(const std::string& shaderfilename, const CompilerOutput& output)
 	{
@@ -757,6 +1052,8 @@ namespace wi::shadercompiler
 				wi::helper::MakePathRelative(rootdir, x);
 			}
 			dependencyLibrary << dependencies;
+			dependencyLibrary << output.input_hash;
+			dependencyLibrary << output.compile_time;
 		}
 
 		if (wi::helper::FileWrite(shaderfilename, output.shaderdata, output.shadersize))
@@ -767,6 +1064,33 @@ namespace wi::shadercompiler
 
 		return false;
 	}
+	bool LoadShaderMetadata(const std::string& shaderfilename, ShaderMetadata& metadata)
+	{
+		metadata = {};
+		std::string dependencylibrarypath = wi::helper::ReplaceExtension(shaderfilename, shadermetaextension);
+		if (!wi::helper::FileExists(dependencylibrarypath))
+			return false;
+
+		wi::Archive dependencyLibrary(dependencylibrarypath);
+		if (!dependencyLibrary.IsOpen())
+			return false;
+
+		std::string rootdir = dependencyLibrary.GetSourceDirectory();
+		dependencyLibrary >> metadata.dependencies;
+		for (auto& x : metadata.dependencies)
+		{
+			x = rootdir + x;
+			wi::helper::MakePathAbsolute(x);
+		}
+		if (dependencyLibrary.GetPos() < dependencyLibrary.GetSize())
+		{
+			// older metadata files don't contain these:
+			dependencyLibrary >> metadata.input_hash;
+			dependencyLibrary >> metadata.compile_time;
+		}
+		return true;
+	}
+
 	bool IsShaderOutdated(const std::string& shaderfilename)
 	{
 #ifdef SHADERCOMPILER_ENABLED
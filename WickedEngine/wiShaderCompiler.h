@@ -36,9 +36,31 @@ namespace wi::shadercompiler
 		wi::vector<uint8_t> shaderhash;
 		std::string error_message;
 		wi::vector<std::string> dependencies;
+		uint64_t input_hash = 0; // if not zero, it will be saved into the metadata, it can be computed with ComputeInputHash()
+		float compile_time = 0; // duration of the compilation in seconds
 	};
 	void Compile(const CompilerInput& input, CompilerOutput& output);
 
+	// Computes a content hash of the compiler input, which identifies the compiled shader independently of file timestamps and paths
+	//	The hash includes the contents of the source file and all files that it includes recursively, the defines, target format, stage, shader model, flags and compiler version
+	//	dependencies : if not null, the absolute paths of the source file and included files will be returned here (optional)
+	//	returns 0 if the source file could not be read
+	uint64_t ComputeInputHash(const CompilerInput& input, wi::vector<std::string>* dependencies = nullptr);
+
+	// Shader cache: compiled shaders can be stored in a content addressed directory, identified by ComputeInputHash()
+	//	The directory can be shared between targets and machines (for example a network drive or a CI cache)
+	bool ShaderCacheRead(const std::string& cachedirectory, uint64_t input_hash, CompilerOutput& output);
+	bool ShaderCacheWrite(const std::string& cachedirectory, uint64_t input_hash, const CompilerOutput& output);
+
+	// Information that is saved next to the shader file by SaveShaderAndMetadata()
+	struct ShaderMetadata
+	{
+		wi::vector<std::string> dependencies; // absolute file paths
+		uint64_t input_hash = 0; // 0 if unknown
+		float compile_time = 0; // duration of the last compilation in seconds, 0 if unknown
+	};
+	bool LoadShaderMetadata(const std::string& shaderfilename, ShaderMetadata& metadata);
+
 	bool SaveShaderAndMetadata(const std::string& shaderfilename, const CompilerOutput& output);
 	bool IsShaderOutdated(const std::string& shaderfilename);
 
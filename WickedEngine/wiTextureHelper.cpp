@@ -6,6 +6,7 @@
 #include "wiTimer.h"
 #include "wiUnorderedMap.h"
 #include "wiNoise.h"
+#include "wiJobSystem.h"
 
 // embedded image datas:
 #include "logo.h"
@@ -531,4 +532,637 @@ namespace wi::texturehelper
 		return texture;
 	}
 
+	// CPU block compression:
+	//	The endpoint search uses principal component analysis and least squares refinement with DirectXMath SIMD vectors
+	namespace bc
+	{
+		// Source block with 16 pixels in [0, 255] range
+		struct Block
+		{
+			XMVECTOR pixels[16];
+		};
+
+		struct BC1Result
+		{
+			uint16_t c0 = 0;
+			uint16_t c1 = 0;
+			uint32_t indices = 0;
+			float error = FLT_MAX;
+		};
+		struct BC4Result
+		{
+			uint8_t e0 = 0;
+			uint8_t e1 = 0;
+			uint64_t indices = 0;
+			float error = FLT_MAX;
+		};
+		struct BC7Mode6Result
+		{
+			uint8_t e0[4] = {}; // 7-bit
+			uint8_t e1[4] = {}; // 7-bit
+			uint8_t p0 = 0;
+			uint8_t p1 = 0;
+			uint8_t indices[16] = {};
+			float error = FLT_MAX;
+		};
+
+		struct QualityParams
+		{
+			int power_iterations;
+			int refine_iterations;
+			bool endpoint_search; // brute force search around the single channel endpoints
+		};
+		constexpr QualityParams GetQualityParams(BlockCompressionQuality quality)
+		{
+			switch (quality)
+			{
+			case BlockCompressionQuality::Fast:
+				return { 2, 0, false };
+			default:
+			case BlockCompressionQuality::Normal:
+				return { 4, 1, false };
+			case BlockCompressionQuality::High:
+				return { 8, 3, true };
+			}
+		}
+
+		inline void LoadBlock(const uint8_t* src, uint32_t width, uint32_t height, uint32_t row_pitch, uint32_t block_x, uint32_t block_y, Block& block)
+		{
+			for (uint32_t y = 0; y < 4; ++y)
+			{
+				const uint32_t py = std::min(block_y * 4 + y, height - 1); // clamp to edge for partial blocks
+				const uint8_t* row = src + size_t(py) * row_pitch;
+				for (uint32_t x = 0; x < 4; ++x)
+				{
+					const uint32_t px = std::min(block_x * 4 + x, width - 1);
+					block.pixels[y * 4 + x] = XMLoadUByte4((const XMUBYTE4*)(row + px * 4));
+				}
+			}
+		}
+
+		// Computes the mean and principal axis of the block pixels, channel_mask selects the channels that are used
+		inline void ComputePrincipalAxis(const Block& block, XMVECTOR channel_mask, int power_iterations, XMVECTOR& mean, XMVECTOR& axis)
+		{
+			XMVECTOR sum = XMVectorZero();
+			XMVECTOR minimum = XMVectorReplicate(255);
+			XMVECTOR maximum = XMVectorZero();
+			for (int i = 0; i < 16; ++i)
+			{
+				sum = XMVectorAdd(sum, block.pixels[i]);
+				minimum = XMVectorMin(minimum, block.pixels[i]);
+				maximum = XMVectorMax(maximum, block.pixels[i]);
+			}
+			mean = XMVectorMultiply(XMVectorScale(sum, 1.0f / 16.0f), channel_mask);
+
+			XMMATRIX covariance = XMMatrixSet(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+			for (int i = 0; i < 16; ++i)
+			{
+				const XMVECTOR d = XMVectorMultiply(XMVectorSubtract(block.pixels[i], mean), channel_mask);
+				covariance.r[0] = XMVectorMultiplyAdd(XMVectorSplatX(d), d, covariance.r[0]);
+				covariance.r[1] = XMVectorMultiplyAdd(XMVectorSplatY(d), d, covariance.r[1]);
+				covariance.r[2] = XMVectorMultiplyAdd(XMVectorSplatZ(d), d, covariance.r[2]);
+				covariance.r[3] = XMVectorMultiplyAdd(XMVectorSplatW(d), d, covariance.r[3]);
+			}
+
+			// Power iteration, starting from the bounding box diagonal:
+			axis = XMVectorMultiply(XMVectorSubtract(maximum, minimum), channel_mask);
+			if (XMVector4Less(XMVector4LengthSq(axis), XMVectorReplicate(1e-6f)))
+			{
+				axis = channel_mask;
+			}
+			for (int i = 0; i < power_iterations; ++i)
+			{
+				const XMVECTOR next = XMVector4Transform(axis, covariance);
+				if (XMVector4Less(XMVector4LengthSq(next), XMVectorReplicate(1e-12f)))
+					break;
+				axis = XMVector4Normalize(next);
+			}
+			axis = XMVector4Normalize(axis);
+		}
+
+		// Endpoints from the extents of the pixels projected onto the axis
+		inline void ComputeAxisEndpoints(const Block& block, XMVECTOR mean, XMVECTOR axis, XMVECTOR& e0, XMVECTOR& e1)
+		{
+			XMVECTOR tmin = XMVectorReplicate(FLT_MAX);
+			XMVECTOR tmax = XMVectorReplicate(-FLT_MAX);
+			for (int i = 0; i < 16; ++i)
+			{
+				const XMVECTOR t = XMVector4Dot(XMVectorSubtract(block.pixels[i], mean), axis);
+				tmin = XMVectorMin(tmin, t);
+				tmax = XMVectorMax(tmax, t);
+			}
+			const XMVECTOR limit = XMVectorReplicate(255);
+			e0 = XMVectorClamp(XMVectorMultiplyAdd(axis, tmax, mean), XMVectorZero(), limit);
+			e1 = XMVectorClamp(XMVectorMultiplyAdd(axis, tmin, mean), XMVectorZero(), limit);
+		}
+
+		// Least squares fit of endpoints for pixels interpolated with the given weights (0 = e0, 1 = e1)
+		inline bool LeastSquaresEndpoints(const Block& block, const float weights[16], XMVECTOR& e0, XMVECTOR& e1)
+		{
+			float aa = 0, bb = 0, ab = 0;
+			XMVECTOR ax = XMVectorZero();
+			XMVECTOR bx = XMVectorZero();
+			for (int i = 0; i < 16; ++i)
+			{
+				const float b = weights[i];
+				const float a = 1 - b;
+				aa += a * a;
+				bb += b * b;
+				ab += a * b;
+				ax = XMVectorMultiplyAdd(XMVectorReplicate(a), block.pixels[i], ax);
+				bx = XMVectorMultiplyAdd(XMVectorReplicate(b), block.pixels[i], bx);
+			}
+			const float det = aa * bb - ab * ab;
+			if (std::abs(det) < 1e-6f)
+				return false;
+			const float rcp_det = 1.0f / det;
+			const XMVECTOR limit = XMVectorReplicate(255);
+			e0 = XMVectorClamp(XMVectorScale(XMVectorSubtract(XMVectorScale(ax, bb), XMVectorScale(bx, ab)), rcp_det), XMVectorZero(), limit);
+			e1 = XMVectorClamp(XMVectorScale(XMVectorSubtract(XMVectorScale(bx, aa), XMVectorScale(ax, ab)), rcp_det), XMVectorZero(), limit);
+			return true;
+		}
+
+		inline uint16_t PackRGB565(XMVECTOR color)
+		{
+			XMFLOAT4 c;
+			XMStoreFloat4(&c, color);
+			const uint32_t r = uint32_t(std::round(saturate(c.x / 255.0f) * 31));
+			const uint32_t g = uint32_t(std::round(saturate(c.y / 255.0f) * 63));
+			const uint32_t b = uint32_t(std::round(saturate(c.z / 255.0f) * 31));
+			return uint16_t((r << 11) | (g << 5) | b);
+		}
+		inline XMVECTOR UnpackRGB565(uint16_t color)
+		{
+			const uint32_t r = (color >> 11) & 31;
+			const uint32_t g = (color >> 5) & 63;
+			const uint32_t b = color & 31;
+			return XMVectorSet(float((r << 3) | (r >> 2)), float((g << 2) | (g >> 4)), float((b << 3) | (b >> 2)), 0);
+		}
+
+		inline BC1Result EvaluateBC1(const Block& block, XMVECTOR e0, XMVECTOR e1)
+		{
+			BC1Result result;
+			result.c0 = PackRGB565(e0);
+			result.c1 = PackRGB565(e1);
+			if (result.c0 < result.c1)
+			{
+				std::swap(result.c0, result.c1); // c0 > c1 selects the four color mode
+			}
+			XMVECTOR palette[4];
+			palette[0] = UnpackRGB565(result.c0);
+			palette[1] = UnpackRGB565(result.c1);
+			palette[2] = XMVectorLerp(palette[0], palette[1], 1.0f / 3.0f);
+			palette[3] = XMVectorLerp(palette[0], palette[1], 2.0f / 3.0f);
+			const int palette_count = result.c0 == result.c1 ? 1 : 4; // equal endpoints would select three color mode, so only index 0 is valid
+
+			result.error = 0;
+			result.indices = 0;
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				const XMVECTOR color = XMVectorSelect(XMVectorZero(), block.pixels[i], g_XMSelect1110);
+				float best_error = FLT_MAX;
+				uint32_t best_index = 0;
+				for (int j = 0; j < palette_count; ++j)
+				{
+					const float error = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(color, palette[j])));
+					if (error < best_error)
+					{
+						best_error = error;
+						best_index = j;
+					}
+				}
+				result.indices |= best_index << (i * 2);
+				result.error += best_error;
+			}
+			return result;
+		}
+
+		inline void EncodeBC1(const Block& block, const QualityParams& params, uint8_t* dst)
+		{
+			const XMVECTOR rgb_mask = g_XMSelect1110;
+			XMVECTOR mean, axis, e0, e1;
+			ComputePrincipalAxis(block, XMVectorSelect(XMVectorZero(), XMVectorSplatOne(), rgb_mask), params.power_iterations, mean, axis);
+			ComputeAxisEndpoints(block, mean, axis, e0, e1);
+
+			BC1Result best = EvaluateBC1(block, e0, e1);
+			for (int iteration = 0; iteration < params.refine_iterations && best.error > 0; ++iteration)
+			{
+				static constexpr float index_weights[] = { 0, 1, 1.0f / 3.0f, 2.0f / 3.0f };
+				float weights[16];
+				for (int i = 0; i < 16; ++i)
+				{
+					weights[i] = index_weights[(best.indices >> (i * 2)) & 3];
+				}
+				e0 = UnpackRGB565(best.c0);
+				e1 = UnpackRGB565(best.c1);
+				if (!LeastSquaresEndpoints(block, weights, e0, e1))
+					break;
+				BC1Result result = EvaluateBC1(block, e0, e1);
+				if (result.error >= best.error)
+					break;
+				best = result;
+			}
+
+			std::memcpy(dst + 0, &best.c0, sizeof(best.c0));
+			std::memcpy(dst + 2, &best.c1, sizeof(best.c1));
+			std::memcpy(dst + 4, &best.indices, sizeof(best.indices));
+		}
+
+		inline BC4Result EvaluateBC4(const float values[16], uint8_t e0, uint8_t e1)
+		{
+			BC4Result result;
+			result.e0 = e0;
+			result.e1 = e1;
+			float palette[8];
+			palette[0] = e0;
+			palette[1] = e1;
+			if (e0 > e1)
+			{
+				for (int i = 1; i < 7; ++i)
+				{
+					palette[i + 1] = (float(7 - i) * e0 + float(i) * e1) / 7.0f;
+				}
+			}
+			else
+			{
+				for (int i = 1; i < 5; ++i)
+				{
+					palette[i + 1] = (float(5 - i) * e0 + float(i) * e1) / 5.0f;
+				}
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+
+			result.error = 0;
+			result.indices = 0;
+			for (int i = 0; i < 16; ++i)
+			{
+				float best_error = FLT_MAX;
+				uint64_t best_index = 0;
+				for (int j = 0; j < 8; ++j)
+				{
+					const float d = values[i] - palette[j];
+					const float error = d * d;
+					if (error < best_error)
+					{
+						best_error = error;
+						best_index = j;
+					}
+				}
+				result.indices |= best_index << (i * 3);
+				result.error += best_error;
+			}
+			return result;
+		}
+
+		inline uint8_t QuantizeUnorm8(float value)
+		{
+			return uint8_t(std::round(clamp(value, 0.0f, 255.0f)));
+		}
+
+		inline void EncodeBC4(const float values[16], const QualityParams& params, uint8_t* dst)
+		{
+			float minimum = values[0];
+			float maximum = values[0];
+			float minimum_inner = 255; // excluding 0 and 255, for the six value mode
+			float maximum_inner = 0;
+			for (int i = 1; i < 16; ++i)
+			{
+				minimum = std::min(minimum, values[i]);
+				maximum = std::max(maximum, values[i]);
+			}
+			for (int i = 0; i < 16; ++i)
+			{
+				if (values[i] > 0 && values[i] < 255)
+				{
+					minimum_inner = std::min(minimum_inner, values[i]);
+					maximum_inner = std::max(maximum_inner, values[i]);
+				}
+			}
+
+			BC4Result best = EvaluateBC4(values, QuantizeUnorm8(maximum), QuantizeUnorm8(minimum));
+			if (best.e0 == best.e1)
+			{
+				// Solid block
+				best.indices = 0;
+				best.error = 0;
+			}
+
+			for (int iteration = 0; iteration < params.refine_iterations && best.error > 0 && best.e0 > best.e1; ++iteration)
+			{
+				// Least squares in the eight value mode:
+				float aa = 0, bb = 0, ab = 0, ax = 0, bx = 0;
+				for (int i = 0; i < 16; ++i)
+				{
+					const uint32_t index = uint32_t((best.indices >> (i * 3)) & 7);
+					const float b = index == 0 ? 0 : index == 1 ? 1 : float(index - 1) / 7.0f;
+					const float a = 1 - b;
+					aa += a * a;
+					bb += b * b;
+					ab += a * b;
+					ax += a * values[i];
+					bx += b * values[i];
+				}
+				const float det = aa * bb - ab * ab;
+				if (std::abs(det) < 1e-6f)
+					break;
+				const uint8_t e0 = QuantizeUnorm8((ax * bb - bx * ab) / det);
+				const uint8_t e1 = QuantizeUnorm8((bx * aa - ax * ab) / det);
+				if (e0 <= e1)
+					break;
+				BC4Result result = EvaluateBC4(values, e0, e1);
+				if (result.error >= best.error)
+					break;
+				best = result;
+			}
+
+			if (params.endpoint_search && best.error > 0)
+			{
+				// Search around the current endpoints in the eight value mode:
+				const int base0 = best.e0;
+				const int base1 = best.e1;
+				for (int d0 = -2; d0 <= 2; ++d0)
+				{
+					for (int d1 = -2; d1 <= 2; ++d1)
+					{
+						const int e0 = base0 + d0;
+						const int e1 = base1 + d1;
+						if (e0 < 0 || e0 > 255 || e1 < 0 || e1 > 255 || e0 <= e1)
+							continue;
+						BC4Result result = EvaluateBC4(values, uint8_t(e0), uint8_t(e1));
+						if (result.error < best.error)
+						{
+							best = result;
+						}
+					}
+				}
+				// Six value mode can represent 0 and 255 exactly while interpolating the rest:
+				if (minimum_inner <= maximum_inner && (minimum == 0 || maximum == 255))
+				{
+					BC4Result result = EvaluateBC4(values, QuantizeUnorm8(minimum_inner), QuantizeUnorm8(maximum_inner));
+					if (result.error < best.error)
+					{
+						best = result;
+					}
+				}
+			}
+
+			dst[0] = best.e0;
+			dst[1] = best.e1;
+			for (int i = 0; i < 6; ++i)
+			{
+				dst[2 + i] = uint8_t((best.indices >> (i * 8)) & 0xFF);
+			}
+		}
+
+		inline void EncodeBC4Channel(const Block& block, int channel, const QualityParams& params, uint8_t* dst)
+		{
+			float values[16];
+			for (int i = 0; i < 16; ++i)
+			{
+				values[i] = XMVectorGetByIndex(block.pixels[i], channel);
+			}
+			EncodeBC4(values, params, dst);
+		}
+
+		static constexpr uint32_t bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		inline void QuantizeBC7Mode6Endpoint(XMVECTOR endpoint, uint8_t color[4], uint8_t& pbit)
+		{
+			XMFLOAT4 e;
+			XMStoreFloat4(&e, endpoint);
+			const float values[4] = { e.x, e.y, e.z, e.w };
+			float best_error = FLT_MAX;
+			for (uint8_t p = 0; p < 2; ++p)
+			{
+				uint8_t quantized[4];
+				float error = 0;
+				for (int i = 0; i < 4; ++i)
+				{
+					quantized[i] = uint8_t(clamp(std::round((values[i] - p) / 2.0f), 0.0f, 127.0f));
+					const float d = float((quantized[i] << 1) | p) - values[i];
+					error += d * d;
+				}
+				if (error < best_error)
+				{
+					best_error = error;
+					pbit = p;
+					std::memcpy(color, quantized, sizeof(quantized));
+				}
+			}
+		}
+
+		inline BC7Mode6Result EvaluateBC7Mode6(const Block& block, XMVECTOR e0, XMVECTOR e1)
+		{
+			BC7Mode6Result result;
+			QuantizeBC7Mode6Endpoint(e0, result.e0, result.p0);
+			QuantizeBC7Mode6Endpoint(e1, result.e1, result.p1);
+
+			uint32_t endpoint0[4];
+			uint32_t endpoint1[4];
+			for (int i = 0; i < 4; ++i)
+			{
+				endpoint0[i] = (uint32_t(result.e0[i]) << 1) | result.p0;
+				endpoint1[i] = (uint32_t(result.e1[i]) << 1) | result.p1;
+			}
+			XMVECTOR palette[16];
+			for (int j = 0; j < 16; ++j)
+			{
+				const uint32_t w = bc7_weights4[j];
+				palette[j] = XMVectorSet(
+					float(((64 - w) * endpoint0[0] + w * endpoint1[0] + 32) >> 6),
+					float(((64 - w) * endpoint0[1] + w * endpoint1[1] + 32) >> 6),
+					float(((64 - w) * endpoint0[2] + w * endpoint1[2] + 32) >> 6),
+					float(((64 - w) * endpoint0[3] + w * endpoint1[3] + 32) >> 6)
+				);
+			}
+
+			result.error = 0;
+			for (int i = 0; i < 16; ++i)
+			{
+				float best_error = FLT_MAX;
+				uint8_t best_index = 0;
+				for (uint8_t j = 0; j < 16; ++j)
+				{
+					const float error = XMVectorGetX(XMVector4LengthSq(XMVectorSubtract(block.pixels[i], palette[j])));
+					if (error < best_error)
+					{
+						best_error = error;
+						best_index = j;
+					}
+				}
+				result.indices[i] = best_index;
+				result.error += best_error;
+			}
+			return result;
+		}
+
+		struct BitWriter
+		{
+			uint8_t* dst = nullptr;
+			uint32_t bit = 0;
+			inline void write(uint32_t value, uint32_t count)
+			{
+				for (uint32_t i = 0; i < count; ++i, ++bit)
+				{
+					if ((value >> i) & 1)
+					{
+						dst[bit >> 3] |= uint8_t(1u << (bit & 7));
+					}
+				}
+			}
+		};
+
+		inline void EncodeBC7(const Block& block, const QualityParams& params, uint8_t* dst)
+		{
+			// Only mode 6 is used (single subset, RGBA endpoints with unique p-bits, 4-bit indices)
+			XMVECTOR mean, axis, e0, e1;
+			ComputePrincipalAxis(block, XMVectorSplatOne(), params.power_iterations, mean, axis);
+			ComputeAxisEndpoints(block, mean, axis, e0, e1);
+
+			BC7Mode6Result best = EvaluateBC7Mode6(block, e0, e1);
+			for (int iteration = 0; iteration < params.refine_iterations + 1 && best.error > 0; ++iteration)
+			{
+				float weights[16];
+				for (int i = 0; i < 16; ++i)
+				{
+					weights[i] = float(bc7_weights4[best.indices[i]]) / 64.0f;
+				}
+				if (!LeastSquaresEndpoints(block, weights, e0, e1))
+					break;
+				BC7Mode6Result result = EvaluateBC7Mode6(block, e0, e1);
+				if (result.error >= best.error)
+					break;
+				best = result;
+			}
+
+			// The anchor index (first pixel) must have its most significant bit zero:
+			if (best.indices[0] >= 8)
+			{
+				for (int i = 0; i < 4; ++i)
+				{
+					std::swap(best.e0[i], best.e1[i]);
+				}
+				std::swap(best.p0, best.p1);
+				for (int i = 0; i < 16; ++i)
+				{
+					best.indices[i] = 15 - best.indices[i];
+				}
+			}
+
+			std::memset(dst, 0, 16);
+			BitWriter writer;
+			writer.dst = dst;
+			writer.write(1u << 6, 7); // mode 6
+			for (int i = 0; i < 4; ++i)
+			{
+				writer.write(best.e0[i], 7);
+				writer.write(best.e1[i], 7);
+			}
+			writer.write(best.p0, 1);
+			writer.write(best.p1, 1);
+			writer.write(best.indices[0], 3);
+			for (int i = 1; i < 16; ++i)
+			{
+				writer.write(best.indices[i], 4);
+			}
+		}
+
+		inline void NormalizeNormalMapBlock(Block& block)
+		{
+			// Renormalize tangent space normals, because the blue channel is discarded and reconstructed from the red and green channels
+			const XMVECTOR scale = XMVectorReplicate(2.0f / 255.0f);
+			for (int i = 0; i < 16; ++i)
+			{
+				XMVECTOR n = XMVectorMultiplyAdd(block.pixels[i], scale, XMVectorReplicate(-1));
+				n = XMVectorSelect(XMVectorZero(), n, g_XMSelect1110);
+				if (XMVector3Greater(XMVector3LengthSq(n), XMVectorReplicate(1e-6f)))
+				{
+					n = XMVector3Normalize(n);
+				}
+				block.pixels[i] = XMVectorClamp(XMVectorScale(XMVectorAdd(n, XMVectorSplatOne()), 127.5f), XMVectorZero(), XMVectorReplicate(255));
+			}
+		}
+	}
+
+	bool BlockCompress(
+		const uint8_t* src,
+		uint32_t width,
+		uint32_t height,
+		uint32_t src_row_pitch,
+		Format dst_format,
+		uint8_t* dst,
+		BlockCompressionQuality quality,
+		bool normalmap
+	)
+	{
+		switch (dst_format)
+		{
+		case Format::BC1_UNORM:
+		case Format::BC1_UNORM_SRGB:
+		case Format::BC3_UNORM:
+		case Format::BC3_UNORM_SRGB:
+		case Format::BC4_UNORM:
+		case Format::BC5_UNORM:
+		case Format::BC7_UNORM:
+		case Format::BC7_UNORM_SRGB:
+			break;
+		default:
+			assert(0); // unsupported format
+			return false;
+		}
+		if (src == nullptr || dst == nullptr || width == 0 || height == 0)
+			return false;
+
+		const uint32_t num_blocks_x = (width + 3) / 4;
+		const uint32_t num_blocks_y = (height + 3) / 4;
+		const uint32_t block_stride = GetFormatStride(dst_format);
+		const bc::QualityParams params = bc::GetQualityParams(quality);
+
+		// One job compresses one row of blocks:
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, num_blocks_y, 1, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t block_y = args.jobIndex;
+			uint8_t* dst_row = dst + size_t(block_y) * num_blocks_x * block_stride;
+			bc::Block block;
+			for (uint32_t block_x = 0; block_x < num_blocks_x; ++block_x)
+			{
+				bc::LoadBlock(src, width, height, src_row_pitch, block_x, block_y, block);
+				uint8_t* dst_block = dst_row + block_x * block_stride;
+				switch (dst_format)
+				{
+				case Format::BC1_UNORM:
+				case Format::BC1_UNORM_SRGB:
+					bc::EncodeBC1(block, params, dst_block);
+					break;
+				case Format::BC3_UNORM:
+				case Format::BC3_UNORM_SRGB:
+					bc::EncodeBC4Channel(block, 3, params, dst_block);
+					bc::EncodeBC1(block, params, dst_block + 8);
+					break;
+				case Format::BC4_UNORM:
+					bc::EncodeBC4Channel(block, 0, params, dst_block);
+					break;
+				case Format::BC5_UNORM:
+					if (normalmap)
+					{
+						bc::NormalizeNormalMapBlock(block);
+					}
+					bc::EncodeBC4Channel(block, 0, params, dst_block);
+					bc::EncodeBC4Channel(block, 1, params, dst_block + 8);
+					break;
+				case Format::BC7_UNORM:
+				case Format::BC7_UNORM_SRGB:
+					bc::EncodeBC7(block, params, dst_block);
+					break;
+				default:
+					break;
+				}
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+
+		return true;
+	}
+
 }
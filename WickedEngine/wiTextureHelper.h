@@ -84,6 +84,34 @@ namespace wi::texturehelper
 		float blend = 1,
 		float edge_smoothness = 0.04f
 	);
+
+	enum class BlockCompressionQuality
+	{
+		Fast,	// principal axis endpoints without refinement
+		Normal,	// principal axis endpoints with least squares refinement
+		High,	// more refinement iterations and endpoint search
+	};
+
+	// Block compression on the CPU, the work is distributed with wi::jobsystem
+	//	src			: R8G8B8A8 pixel data
+	//	width		: width of the source image in pixels
+	//	height		: height of the source image in pixels
+	//	src_row_pitch : size of one row of the source image in bytes
+	//	dst_format	: BC1, BC3, BC4 (red channel), BC5 (red and green channels) or BC7 format
+	//	dst			: destination memory for tightly packed blocks, must be at least ceil(width/4) * ceil(height/4) * GetFormatStride(dst_format) bytes
+	//	quality		: quality and speed preset
+	//	normalmap	: for BC5, the source is treated as tangent space normal map and it will be renormalized before compression
+	//	returns true if successful, false if the format is not supported
+	bool BlockCompress(
+		const uint8_t* src,
+		uint32_t width,
+		uint32_t height,
+		uint32_t src_row_pitch,
+		wi::graphics::Format dst_format,
+		uint8_t* dst,
+		BlockCompressionQuality quality = BlockCompressionQuality::Normal,
+		bool normalmap = false
+	);
 };
 
 template<>